@@ -0,0 +1,176 @@
+/**
+ * wsjtx_accounting.cpp - Per-receiver CPU accounting and quotas
+ *
+ * Jobs are charged to the receiver label of the instance that queued them:
+ * CPU time from the thread CPU clock of every thread that worked on them,
+ * and the time they spent queued. A receiver can be held to a share of the
+ * host's CPUs, averaged over a sliding minute; once over it, new jobs are
+ * run at lower priority or refused until the window drains.
+ */
+
+#include "wsjtx_c_api.h"
+#include "wsjtx_pool.h"
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#ifdef _WIN32
+  #include <windows.h>
+#else
+  #include <ctime>
+  #include <sys/resource.h>
+  #include <unistd.h>
+  #ifdef __linux__
+    #include <sys/syscall.h>
+  #endif
+#endif
+
+namespace {
+
+const int WINDOW_BUCKETS = 12;
+const int64_t BUCKET_US = 5000000;      /* 12 x 5 s = one minute */
+
+struct Account {
+    int64_t jobs = 0;
+    int64_t deprioritized = 0;
+    int64_t rejected = 0;
+    int64_t cpuUs = 0;
+    int64_t queueUs = 0;
+    double quotaShare = 0;
+    int quotaAction = WSJTX_QUOTA_NONE;
+    int64_t bucketCpu[WINDOW_BUCKETS] = {};
+    int64_t bucketEpoch[WINDOW_BUCKETS] = {};   /* which 5 s interval each bucket holds */
+};
+
+std::mutex g_mutex;
+std::unordered_map<std::string, Account> g_accounts;
+
+inline std::string receiver_name(const char* r) {
+    return r ? std::string(r) : std::string();
+}
+
+inline int64_t current_epoch() {
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::microseconds>(now).count() / BUCKET_US;
+}
+
+/* Share of all the host's CPUs this account used over the last minute */
+double window_share_locked(const Account& a, int64_t epoch) {
+    int64_t us = 0;
+    for (int i = 0; i < WINDOW_BUCKETS; i++)
+        if (epoch - a.bucketEpoch[i] < WINDOW_BUCKETS) us += a.bucketCpu[i];
+    unsigned cpus = std::thread::hardware_concurrency();
+    if (cpus == 0) cpus = 1;
+    return static_cast<double>(us) / (static_cast<double>(WINDOW_BUCKETS * BUCKET_US) * cpus);
+}
+
+} // namespace
+
+WSJTX_API int64_t wsjtx_thread_cpu_us(void) {
+#ifdef _WIN32
+    FILETIME created, exited, kernel, user;
+    if (!GetThreadTimes(GetCurrentThread(), &created, &exited, &kernel, &user)) return 0;
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime; k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime; u.HighPart = user.dwHighDateTime;
+    return static_cast<int64_t>((k.QuadPart + u.QuadPart) / 10);   /* 100 ns units */
+#else
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) return 0;
+    return static_cast<int64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+#endif
+}
+
+WSJTX_API int wsjtx_thread_lower_priority(void) {
+#if defined(_WIN32)
+    const bool lowered = SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL) != 0;
+#elif defined(__linux__)
+    /* Linux applies nice values per thread */
+    const bool lowered = setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 10) == 0;
+#elif defined(__APPLE__)
+    const bool lowered = setpriority(PRIO_DARWIN_THREAD, 0, PRIO_DARWIN_BG) == 0;
+#else
+    const bool lowered = false;
+#endif
+    if (!lowered) return WSJTX_ERR_IO;
+    wsjtx_core::pool_retire_thread();   /* no-op off the pool */
+    return WSJTX_OK;
+}
+
+WSJTX_API int wsjtx_quota_set(const char* receiver, double cpu_share, int action) {
+    if (action < WSJTX_QUOTA_NONE || action > WSJTX_QUOTA_REJECT) return WSJTX_ERR_INVALID_ARG;
+    if (action != WSJTX_QUOTA_NONE && !(cpu_share > 0.0 && cpu_share <= 1.0)) return WSJTX_ERR_INVALID_ARG;
+    try {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        Account& a = g_accounts[receiver_name(receiver)];
+        a.quotaAction = action;
+        a.quotaShare = action == WSJTX_QUOTA_NONE ? 0.0 : cpu_share;
+        return WSJTX_OK;
+    } catch (...) {
+        return WSJTX_ERR_EXCEPTION;
+    }
+}
+
+WSJTX_API int wsjtx_account_admit(const char* receiver) {
+    try {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        Account& a = g_accounts[receiver_name(receiver)];
+        const bool over = a.quotaAction != WSJTX_QUOTA_NONE &&
+            window_share_locked(a, current_epoch()) > a.quotaShare;
+        if (over && a.quotaAction == WSJTX_QUOTA_REJECT) {
+            a.rejected++;
+            return WSJTX_ERR_QUOTA;
+        }
+        a.jobs++;
+        return over ? 1 : 0;
+    } catch (...) {
+        return 0;   /* accounting never stands in the way of a job */
+    }
+}
+
+/* Jobs admitted at lower priority count here only once their thread was lowered */
+WSJTX_API void wsjtx_account_deprioritized(const char* receiver) {
+    try {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_accounts[receiver_name(receiver)].deprioritized++;
+    } catch (...) {
+    }
+}
+
+WSJTX_API void wsjtx_account_charge(const char* receiver, int64_t cpu_us, int64_t queue_us) {
+    if (cpu_us < 0) cpu_us = 0;
+    if (queue_us < 0) queue_us = 0;
+    try {
+        const int64_t epoch = current_epoch();
+        std::lock_guard<std::mutex> lock(g_mutex);
+        Account& a = g_accounts[receiver_name(receiver)];
+        a.cpuUs += cpu_us;
+        a.queueUs += queue_us;
+        const int i = static_cast<int>(epoch % WINDOW_BUCKETS);
+        if (a.bucketEpoch[i] != epoch) {
+            a.bucketEpoch[i] = epoch;
+            a.bucketCpu[i] = 0;
+        }
+        a.bucketCpu[i] += cpu_us;
+    } catch (...) {
+    }
+}
+
+WSJTX_API int wsjtx_account_get(const char* receiver, wsjtx_account_t* out) {
+    if (!out) return 0;
+    std::lock_guard<std::mutex> lock(g_mutex);
+    auto it = g_accounts.find(receiver_name(receiver));
+    if (it == g_accounts.end()) return 0;
+    const Account& a = it->second;
+    out->jobs = a.jobs;
+    out->deprioritized = a.deprioritized;
+    out->rejected = a.rejected;
+    out->cpu_seconds = static_cast<double>(a.cpuUs) / 1e6;
+    out->queue_seconds = static_cast<double>(a.queueUs) / 1e6;
+    out->cpu_share = window_share_locked(a, current_epoch());
+    out->quota_share = a.quotaShare;
+    out->quota_action = a.quotaAction;
+    return 1;
+}
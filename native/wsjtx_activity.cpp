@@ -0,0 +1,221 @@
+/**
+ * wsjtx_activity.cpp - Rolling band-activity statistics for the C API
+ *
+ * Decodes are folded into per-(band, mode) rings of fixed-size time
+ * buckets as they arrive. Each bucket holds a decode count, an SNR
+ * histogram, audio-frequency occupancy and a linear-counting bitmap of
+ * callsigns, so both memory and query cost are independent of how many
+ * spots have been seen. Bitmaps merge by OR, so distinct-call estimates
+ * over a range of buckets count each callsign once.
+ */
+
+#include "wsjtx_c_api.h"
+#include "wsjtx_text.h"
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+
+const int CALL_BITMAP_BITS = 2048;
+const int CALL_BITMAP_WORDS = CALL_BITMAP_BITS / 64;
+
+struct Bucket {
+    int64_t index = INT64_MIN;   /* absolute bucket number (time / bucket_seconds) */
+    int decodes = 0;
+    int snr[WSJTX_ACTIVITY_SNR_BINS] = {};
+    int audio[WSJTX_ACTIVITY_AUDIO_BINS] = {};
+    uint64_t calls[CALL_BITMAP_WORDS] = {};
+
+    void reset(int64_t idx) { *this = Bucket(); index = idx; }
+};
+
+/* FNV-1a; callsigns are short so this is cheap and spreads well */
+inline uint32_t hash_call(const std::string& s) {
+    uint32_t h = 2166136261u;
+    for (unsigned char c : s) { h ^= c; h *= 16777619u; }
+    return h;
+}
+
+inline int snr_bin(int snr) {
+    int b = (snr - WSJTX_ACTIVITY_SNR_MIN) / WSJTX_ACTIVITY_SNR_STEP;
+    return b < 0 ? 0 : (b >= WSJTX_ACTIVITY_SNR_BINS ? WSJTX_ACTIVITY_SNR_BINS - 1 : b);
+}
+
+inline int audio_bin(int freq) {
+    int b = freq / WSJTX_ACTIVITY_AUDIO_STEP;
+    return b < 0 ? 0 : (b >= WSJTX_ACTIVITY_AUDIO_BINS ? WSJTX_ACTIVITY_AUDIO_BINS - 1 : b);
+}
+
+/* Linear-counting estimate of distinct items from a bitmap */
+int estimate_distinct(const uint64_t* bits) {
+    int set = 0;
+    for (int i = 0; i < CALL_BITMAP_WORDS; i++) {
+        uint64_t w = bits[i];
+        while (w) { w &= w - 1; set++; }
+    }
+    if (set == 0) return 0;
+    if (set >= CALL_BITMAP_BITS) set = CALL_BITMAP_BITS - 1;
+    double m = CALL_BITMAP_BITS;
+    return static_cast<int>(std::lround(-m * std::log((m - set) / m)));
+}
+
+class ActivityAggregator {
+public:
+    ActivityAggregator(int bucketSeconds, int numBuckets)
+        : bucketSeconds_(bucketSeconds), numBuckets_(numBuckets) {}
+
+    void add(const std::string& band, int mode, int64_t time,
+             const wsjtx_message_t* msgs, int count) {
+        int64_t idx = floor_div(time, bucketSeconds_);
+        std::vector<Bucket>& ring = series_[Key{band, mode}];
+        if (ring.empty()) ring.resize(numBuckets_);
+        Bucket& b = ring[static_cast<size_t>(mod(idx, numBuckets_))];
+        if (b.index != idx) {
+            if (b.index > idx) return;   /* older than the ring window */
+            b.reset(idx);
+        }
+        if (idx > latest_) latest_ = idx;
+
+        for (int i = 0; i < count; i++) {
+            b.decodes++;
+            b.snr[snr_bin(msgs[i].snr)]++;
+            b.audio[audio_bin(msgs[i].freq)]++;
+            for (const auto& call : wsjtx_core::extract_calls(msgs[i].msg)) {
+                uint32_t h = hash_call(call) % CALL_BITMAP_BITS;
+                b.calls[h / 64] |= uint64_t(1) << (h % 64);
+            }
+        }
+    }
+
+    /* Aggregate matching series over [from, to] (seconds). Empty band or
+     * mode < 0 matches all. Per-bucket rows are written oldest first. */
+    int query(const char* band, int mode, int64_t from, int64_t to,
+              wsjtx_activity_stats_t* total, wsjtx_activity_stats_t* rows, int maxRows) {
+        int64_t lo = floor_div(from, bucketSeconds_);
+        int64_t hi = floor_div(to, bucketSeconds_);
+        clear_stats(total, lo);
+        if (hi > latest_) hi = latest_;
+        if (lo < latest_ - numBuckets_ + 1) lo = latest_ - numBuckets_ + 1;
+        if (lo > hi) return 0;
+
+        uint64_t totalCalls[CALL_BITMAP_WORDS] = {};
+
+        int nrows = 0;
+        for (int64_t idx = lo; idx <= hi; idx++) {
+            uint64_t rowCalls[CALL_BITMAP_WORDS] = {};
+            wsjtx_activity_stats_t* row = (rows && nrows < maxRows) ? &rows[nrows] : nullptr;
+            if (row) clear_stats(row, idx);
+
+            for (auto& [key, ring] : series_) {
+                if (band && band[0] && key.band != band) continue;
+                if (mode >= 0 && key.mode != mode) continue;
+                const Bucket& b = ring[static_cast<size_t>(mod(idx, numBuckets_))];
+                if (b.index != idx) continue;
+                accumulate(total, b);
+                if (row) accumulate(row, b);
+                for (int w = 0; w < CALL_BITMAP_WORDS; w++) {
+                    totalCalls[w] |= b.calls[w];
+                    rowCalls[w] |= b.calls[w];
+                }
+            }
+            if (row) {
+                row->unique_calls = estimate_distinct(rowCalls);
+                nrows++;
+            }
+        }
+        total->unique_calls = estimate_distinct(totalCalls);
+        return nrows;
+    }
+
+    std::mutex mutex;
+
+private:
+    struct Key {
+        std::string band;
+        int mode;
+        bool operator<(const Key& o) const { return mode != o.mode ? mode < o.mode : band < o.band; }
+    };
+
+    static int64_t floor_div(int64_t a, int64_t b) {
+        int64_t q = a / b;
+        return (a % b != 0 && ((a < 0) != (b < 0))) ? q - 1 : q;
+    }
+
+    static int64_t mod(int64_t a, int64_t b) {
+        int64_t r = a % b;
+        return r < 0 ? r + b : r;
+    }
+
+    void clear_stats(wsjtx_activity_stats_t* s, int64_t idx) const {
+        memset(s, 0, sizeof(*s));
+        s->bucket_start = idx * bucketSeconds_;
+    }
+
+    static void accumulate(wsjtx_activity_stats_t* s, const Bucket& b) {
+        s->decodes += b.decodes;
+        for (int i = 0; i < WSJTX_ACTIVITY_SNR_BINS; i++) s->snr_histogram[i] += b.snr[i];
+        for (int i = 0; i < WSJTX_ACTIVITY_AUDIO_BINS; i++) s->audio_occupancy[i] += b.audio[i];
+    }
+
+    int bucketSeconds_;
+    int numBuckets_;
+    int64_t latest_ = INT64_MIN / 2;
+    std::map<Key, std::vector<Bucket>> series_;
+};
+
+inline ActivityAggregator* to_activity(wsjtx_activity_t h) {
+    return static_cast<ActivityAggregator*>(h);
+}
+
+} // namespace
+
+WSJTX_API wsjtx_activity_t wsjtx_activity_create(int bucket_seconds, int num_buckets) {
+    if (bucket_seconds <= 0 || num_buckets <= 0) return nullptr;
+    try {
+        return static_cast<wsjtx_activity_t>(new ActivityAggregator(bucket_seconds, num_buckets));
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+WSJTX_API void wsjtx_activity_destroy(wsjtx_activity_t activity) {
+    delete to_activity(activity);
+}
+
+WSJTX_API int wsjtx_activity_add(wsjtx_activity_t activity,
+    const char* band, int mode, int64_t time_seconds,
+    const wsjtx_message_t* messages, int count)
+{
+    if (!activity) return WSJTX_ERR_INVALID_HANDLE;
+    if (!band || count < 0 || (count > 0 && !messages)) return WSJTX_ERR_INVALID_ARG;
+
+    try {
+        ActivityAggregator* a = to_activity(activity);
+        std::lock_guard<std::mutex> lock(a->mutex);
+        a->add(band, mode, time_seconds, messages, count);
+        return WSJTX_OK;
+    } catch (...) {
+        return WSJTX_ERR_EXCEPTION;
+    }
+}
+
+WSJTX_API int wsjtx_activity_query(wsjtx_activity_t activity,
+    const char* band, int mode, int64_t from_seconds, int64_t to_seconds,
+    wsjtx_activity_stats_t* out_total,
+    wsjtx_activity_stats_t* out_buckets, int max_buckets)
+{
+    if (!activity) return WSJTX_ERR_INVALID_HANDLE;
+    if (!out_total) return WSJTX_ERR_INVALID_ARG;
+
+    try {
+        ActivityAggregator* a = to_activity(activity);
+        std::lock_guard<std::mutex> lock(a->mutex);
+        return a->query(band, mode, from_seconds, to_seconds, out_total, out_buckets, max_buckets);
+    } catch (...) {
+        return WSJTX_ERR_EXCEPTION;
+    }
+}
@@ -7,31 +7,45 @@
  */
 
 #include "wsjtx_c_api.h"
+#include "wsjtx_fft.h"
+#include "wsjtx_probes.h"
+#include "wsjtx_text.h"
+#include "wsjtx_tones.h"
+#include "wsjtx_trace.h"
 #include <wsjtx_lib.h>
+#include <algorithm>
+#include <cmath>
 #include <cstring>
 #include <vector>
 #include <complex>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+
+#ifdef WSJTX_ENABLE_OPENMP
+#include <omp.h>
+#endif
 
 /* Mode metadata table (mirrors wsjtx_wrapper.cpp MODE_INFO) */
 struct ModeMetadata {
     int sampleRate;
     double duration;
+    double period;
     int encodingSupported;
     int decodingSupported;
 };
 
 static const ModeMetadata MODE_TABLE[] = {
-    /* FT8     */ { 48000, 12.64, 1, 1 },
-    /* FT4     */ { 48000,  6.0,  1, 1 },
-    /* JT4     */ { 11025, 47.1,  0, 1 },
-    /* JT65    */ { 11025, 46.8,  0, 1 },
-    /* JT9     */ { 12000, 49.0,  0, 1 },
-    /* FST4    */ { 12000, 60.0,  0, 1 },
-    /* Q65     */ { 12000, 60.0,  0, 1 },
-    /* FST4W   */ { 12000, 120.0, 0, 1 },
-    /* JT65JT9 */ { 11025, 46.8,  0, 1 },
-    /* WSPR    */ { 12000, 110.6, 0, 1 },
+    /* FT8     */ { 48000, 12.64,  15.0, 1, 1 },
+    /* FT4     */ { 48000,  6.0,    7.5, 1, 1 },
+    /* JT4     */ { 11025, 47.1,   60.0, 1, 1 },
+    /* JT65    */ { 11025, 46.8,   60.0, 1, 1 },
+    /* JT9     */ { 12000, 49.0,   60.0, 1, 1 },
+    /* FST4    */ { 12000, 60.0,   60.0, 1, 1 },
+    /* Q65     */ { 12000, 60.0,   60.0, 1, 1 },
+    /* FST4W   */ { 12000, 120.0, 120.0, 1, 1 },
+    /* JT65JT9 */ { 11025, 46.8,   60.0, 0, 1 },
+    /* WSPR    */ { 12000, 110.6, 120.0, 1, 1 },
 };
 
 static const int MODE_COUNT = sizeof(MODE_TABLE) / sizeof(MODE_TABLE[0]);
@@ -44,12 +58,55 @@ static inline wsjtx_lib* to_lib(wsjtx_handle_t h) {
     return static_cast<wsjtx_lib*>(h);
 }
 
+/* In an OpenMP build the thread hint sets the team size of the decoder's
+ * parallel regions. omp_set_num_threads is per calling thread, so every
+ * call applies its own hint. */
+static void apply_thread_hint(int threads) {
+#ifdef WSJTX_ENABLE_OPENMP
+    if (threads > 0) omp_set_num_threads(threads);
+#else
+    (void)threads;
+#endif
+}
+
+/* The DX station each handle was last given. wsjtx_lib cannot report it,
+ * and AP target passes must put it back when they are done. */
+struct DxStation {
+    std::string call;
+    std::string grid;
+};
+
+static std::mutex g_dx_mutex;
+static std::unordered_map<const wsjtx_lib*, DxStation> g_dx;
+
+static DxStation dx_station(const wsjtx_lib* lib) {
+    std::lock_guard<std::mutex> lock(g_dx_mutex);
+    auto it = g_dx.find(lib);
+    return it == g_dx.end() ? DxStation() : it->second;
+}
+
+static void set_dx_station(wsjtx_lib* lib, const DxStation& dx) {
+    lib->setDxCall(dx.call);
+    lib->setDxGrid(dx.grid);
+    std::lock_guard<std::mutex> lock(g_dx_mutex);
+    g_dx[lib] = dx;
+}
+
+/* `dx` updated by the non-empty hiscall/hisgrid of `opts` */
+static DxStation with_options(DxStation dx, const wsjtx_decode_options_t* opts) {
+    if (opts->hiscall[0]) dx.call = opts->hiscall;
+    if (opts->hisgrid[0]) dx.grid = opts->hisgrid;
+    return dx;
+}
+
 /* Apply v2 decode options (dxCall, dxGrid, freq range) onto the lib instance.
- * Empty hiscall/hisgrid leave existing dx info unchanged on the instance.
+ * Empty hiscall/hisgrid leave existing dx info unchanged on the instance,
+ * unless `replace_dx` (an AP target: its call and grid, or none).
  * Range fields are always applied so callers get deterministic behavior. */
-static void apply_decode_options(wsjtx_lib* lib, const wsjtx_decode_options_t* opts) {
-    if (opts->hiscall[0]) lib->setDxCall(std::string(opts->hiscall));
-    if (opts->hisgrid[0]) lib->setDxGrid(std::string(opts->hisgrid));
+static void apply_decode_options(wsjtx_lib* lib, const wsjtx_decode_options_t* opts,
+    bool replace_dx = false)
+{
+    set_dx_station(lib, with_options(replace_dx ? DxStation() : dx_station(lib), opts));
     lib->setDecodeRange(opts->low_freq, opts->high_freq, opts->tolerance);
 }
 
@@ -57,6 +114,7 @@ static void apply_decode_options(wsjtx_lib* lib, const wsjtx_decode_options_t* o
 
 WSJTX_API wsjtx_handle_t wsjtx_create(void) {
     try {
+        wsjtx_core::fft_init();   /* before wsjtx_lib plans anything */
         return static_cast<wsjtx_handle_t>(new wsjtx_lib());
     } catch (...) {
         return nullptr;
@@ -64,6 +122,10 @@ WSJTX_API wsjtx_handle_t wsjtx_create(void) {
 }
 
 WSJTX_API void wsjtx_destroy(wsjtx_handle_t handle) {
+    {
+        std::lock_guard<std::mutex> lock(g_dx_mutex);
+        g_dx.erase(to_lib(handle));
+    }
     delete to_lib(handle);
 }
 
@@ -76,7 +138,9 @@ WSJTX_API int wsjtx_decode_float(wsjtx_handle_t handle, int mode,
     if (!valid_mode(mode)) return WSJTX_ERR_INVALID_MODE;
 
     try {
+        apply_thread_hint(threads);
         std::vector<float> data(samples, samples + num_samples);
+        wsjtx_core::DecoderScope fortran;
         to_lib(handle)->decode(static_cast<wsjtxMode>(mode), data, freq, threads);
         return WSJTX_OK;
     } catch (...) {
@@ -91,7 +155,9 @@ WSJTX_API int wsjtx_decode_int16(wsjtx_handle_t handle, int mode,
     if (!valid_mode(mode)) return WSJTX_ERR_INVALID_MODE;
 
     try {
+        apply_thread_hint(threads);
         std::vector<short int> data(samples, samples + num_samples);
+        wsjtx_core::DecoderScope fortran;
         to_lib(handle)->decode(static_cast<wsjtxMode>(mode), data, freq, threads);
         return WSJTX_OK;
     } catch (...) {
@@ -108,15 +174,28 @@ WSJTX_API int wsjtx_decode_float_v2(wsjtx_handle_t handle, int mode,
     if (!handle || !options) return WSJTX_ERR_INVALID_HANDLE;
     if (!valid_mode(mode)) return WSJTX_ERR_INVALID_MODE;
 
+    WSJTX_PROBE3(decode__start, mode, num_samples, options->frequency);
+    int rc = WSJTX_OK;
     try {
         wsjtx_lib* lib = to_lib(handle);
-        apply_decode_options(lib, options);
-        std::vector<float> data(samples, samples + num_samples);
+        {
+            wsjtx_core::TraceSpan span("apply_options");
+            apply_decode_options(lib, options);
+            apply_thread_hint(options->threads);
+        }
+        std::vector<float> data;
+        {
+            wsjtx_core::TraceSpan span("copy_input");
+            data.assign(samples, samples + num_samples);
+        }
+        wsjtx_core::TraceSpan span("core_decode");
+        wsjtx_core::DecoderScope fortran;
         lib->decode(static_cast<wsjtxMode>(mode), data, options->frequency, options->threads);
-        return WSJTX_OK;
     } catch (...) {
-        return WSJTX_ERR_EXCEPTION;
+        rc = WSJTX_ERR_EXCEPTION;
     }
+    WSJTX_PROBE2(decode__done, mode, rc);
+    return rc;
 }
 
 WSJTX_API int wsjtx_decode_int16_v2(wsjtx_handle_t handle, int mode,
@@ -126,19 +205,34 @@ WSJTX_API int wsjtx_decode_int16_v2(wsjtx_handle_t handle, int mode,
     if (!handle || !options) return WSJTX_ERR_INVALID_HANDLE;
     if (!valid_mode(mode)) return WSJTX_ERR_INVALID_MODE;
 
+    WSJTX_PROBE3(decode__start, mode, num_samples, options->frequency);
+    int rc = WSJTX_OK;
     try {
         wsjtx_lib* lib = to_lib(handle);
-        apply_decode_options(lib, options);
-        std::vector<short int> data(samples, samples + num_samples);
+        {
+            wsjtx_core::TraceSpan span("apply_options");
+            apply_decode_options(lib, options);
+            apply_thread_hint(options->threads);
+        }
+        std::vector<short int> data;
+        {
+            wsjtx_core::TraceSpan span("copy_input");
+            data.assign(samples, samples + num_samples);
+        }
+        wsjtx_core::TraceSpan span("core_decode");
+        wsjtx_core::DecoderScope fortran;
         lib->decode(static_cast<wsjtxMode>(mode), data, options->frequency, options->threads);
-        return WSJTX_OK;
     } catch (...) {
-        return WSJTX_ERR_EXCEPTION;
+        rc = WSJTX_ERR_EXCEPTION;
     }
+    WSJTX_PROBE2(decode__done, mode, rc);
+    return rc;
 }
 
 /* ---- Encode ---- */
 
+/* Every mode is encoded with the WSJT-X tone generators and the synthesizer
+ * in wsjtx_tones.cpp, straight into the caller's buffer */
 WSJTX_API int wsjtx_encode(wsjtx_handle_t handle, int mode, int freq,
     const char* message,
     float* out_samples, int* out_num_samples, int out_buf_size,
@@ -146,29 +240,35 @@ WSJTX_API int wsjtx_encode(wsjtx_handle_t handle, int mode, int freq,
 {
     if (!handle) return WSJTX_ERR_INVALID_HANDLE;
     if (!valid_mode(mode)) return WSJTX_ERR_INVALID_MODE;
+    if (!out_samples || !out_num_samples) return WSJTX_ERR_INVALID_ARG;
 
+    WSJTX_PROBE2(encode__start, mode, freq);
+    int n = 0;
+    int rc = WSJTX_OK;
     try {
-        std::string messageSent;
-        std::vector<float> audio = to_lib(handle)->encode(
-            static_cast<wsjtxMode>(mode), freq, std::string(message), messageSent);
-
-        if (audio.empty()) return WSJTX_ERR_ENCODE_FAILED;
-
-        int n = static_cast<int>(audio.size());
-        if (n > out_buf_size) return WSJTX_ERR_BUFFER_TOO_SMALL;
-
-        memcpy(out_samples, audio.data(), n * sizeof(float));
-        *out_num_samples = n;
-
-        if (out_message_sent && out_msg_buf_size > 0) {
-            strncpy(out_message_sent, messageSent.c_str(), out_msg_buf_size - 1);
-            out_message_sent[out_msg_buf_size - 1] = '\0';
+        wsjtx_core::TraceSpan span("core_encode");
+        int tones[256];
+        int numTones = 0;
+        char sent[64] = {0};
+        rc = wsjtx_encode_tones(mode, message, tones, 256, &numTones, sent, sizeof(sent));
+        if (rc == WSJTX_OK && wsjtx_get_waveform_samples(mode) > out_buf_size) {
+            rc = WSJTX_ERR_BUFFER_TOO_SMALL;
+        }
+        if (rc == WSJTX_OK) {
+            rc = wsjtx_synthesize(mode, tones, numTones, freq, out_samples, out_buf_size, &n);
+        }
+        if (rc == WSJTX_OK) {
+            *out_num_samples = n;
+            if (out_message_sent && out_msg_buf_size > 0) {
+                strncpy(out_message_sent, sent, out_msg_buf_size - 1);
+                out_message_sent[out_msg_buf_size - 1] = '\0';
+            }
         }
-
-        return WSJTX_OK;
     } catch (...) {
-        return WSJTX_ERR_EXCEPTION;
+        rc = WSJTX_ERR_EXCEPTION;
     }
+    WSJTX_PROBE2(encode__done, mode, rc == WSJTX_OK ? n : rc);
+    return rc;
 }
 
 /* ---- Message queue ---- */
@@ -183,6 +283,9 @@ static void copy_message(wsjtx_message_t* dst, const WsjtxMessage& src) {
     dst->dt   = src.dt;
     memset(dst->msg, 0, sizeof(dst->msg));
     strncpy(dst->msg, src.msg.c_str(), sizeof(dst->msg) - 1);
+    /* WsjtxMessage carries no decoder bookkeeping; the AP type is the
+     * decoder's own "a1".."a7" text marker */
+    dst->ap_type = wsjtx_core::ap_annotation(src.msg);
 }
 
 WSJTX_API int wsjtx_pull_message(wsjtx_handle_t handle, wsjtx_message_t* out_msg) {
@@ -203,18 +306,213 @@ WSJTX_API int wsjtx_pull_messages(wsjtx_handle_t handle,
 {
     if (!handle || !out_messages || max_messages <= 0) return 0;
 
+    WSJTX_PROBE1(drain__start, max_messages);
+    int count = 0;
     try {
+        wsjtx_core::TraceSpan span("drain");
         wsjtx_lib* lib = to_lib(handle);
         WsjtxMessage msg;
-        int count = 0;
         while (count < max_messages && lib->pullMessage(msg)) {
             copy_message(&out_messages[count], msg);
             count++;
         }
-        return count;
     } catch (...) {
-        return 0;
+        count = 0;
+    }
+    WSJTX_PROBE1(drain__done, count);
+    return count;
+}
+
+/* ---- Decode (multi-target AP) ---- */
+
+const int MAX_STAGE_CANDIDATES = 300;
+const float STAGE_MIN_SCORE = 1.5f;
+
+inline float sample_to_float(float s) { return s; }
+inline float sample_to_float(short int s) { return s / 32768.0f; }
+
+/* Decodes `input` and merges the drained messages by normalized text. With
+ * no targets it decodes once with the plain options; for modes other than
+ * FT8/FT4 once per AP target not yet heard in the slot. For FT8/FT4 the
+ * targets share one candidate stage instead: the slot is decoded once with
+ * the plain options, those signals are subtracted, the residual is searched
+ * for sync candidates once, and each target not yet heard gets an AP decode
+ * of the residual limited to the band those candidates occupy. The handle
+ * ends up with the DX station the plain options would have left it.
+ * Sample is float or short int. */
+template <typename Sample>
+static int decode_targets(wsjtx_handle_t handle, int mode,
+    const Sample* samples, int num_samples,
+    const wsjtx_decode_options_t* options,
+    const wsjtx_ap_target_t* targets, int num_targets,
+    wsjtx_message_t* out_messages, int max_messages)
+{
+    if (!handle || !options) return WSJTX_ERR_INVALID_HANDLE;
+    if (!valid_mode(mode)) return WSJTX_ERR_INVALID_MODE;
+    if (!samples || num_samples <= 0 || !out_messages || max_messages <= 0 ||
+        num_targets < 0 || num_targets > WSJTX_MAX_AP_TARGETS ||
+        (num_targets > 0 && !targets)) return WSJTX_ERR_INVALID_ARG;
+
+    WSJTX_PROBE3(decode__start, mode, num_samples, options->frequency);
+    int rc = WSJTX_OK;
+    try {
+        wsjtx_lib* lib = to_lib(handle);
+        apply_thread_hint(options->threads);
+
+        std::vector<wsjtx_message_t> merged;
+        std::vector<std::string> seen;       /* normalized text of merged messages */
+        std::vector<std::string> heard;      /* calls decoded so far in this slot */
+
+        /* Target passes replace the DX station; put back what a plain
+         * decode would have left, whichever way the passes end */
+        struct DxRestore {
+            wsjtx_lib* lib;
+            DxStation dx;
+            ~DxRestore() {
+                try { set_dx_station(lib, dx); } catch (...) {}
+            }
+        };
+        const DxRestore restore{lib, with_options(dx_station(lib), options)};
+
+        /* One decoder call; `data` is a copy because the core may work in place */
+        auto decode_pass = [&](const wsjtx_decode_options_t& pass, bool target, auto data,
+                               const char* name) {
+            {
+                wsjtx_core::TraceSpan span("apply_options");
+                apply_decode_options(lib, &pass, target);
+            }
+            {
+                wsjtx_core::TraceSpan span(name);
+                wsjtx_core::DecoderScope fortran;
+                lib->decode(static_cast<wsjtxMode>(mode), data, pass.frequency, pass.threads);
+            }
+            wsjtx_core::TraceSpan span("merge");
+            WsjtxMessage msg;
+            while (lib->pullMessage(msg)) {
+                std::string key = wsjtx_core::normalize_message(msg.msg);
+                if (std::find(seen.begin(), seen.end(), key) != seen.end()) continue;
+                for (std::string& c : wsjtx_core::extract_calls(key)) heard.push_back(std::move(c));
+                seen.push_back(std::move(key));
+                merged.emplace_back();
+                copy_message(&merged.back(), msg);
+            }
+        };
+        /* The options with `t` as the DX station, or nothing if it was heard */
+        auto target_pass = [&](const wsjtx_ap_target_t& t, wsjtx_decode_options_t& o) {
+            std::string call = wsjtx_core::normalize_message(t.call);
+            if (call.empty() || std::find(heard.begin(), heard.end(), call) != heard.end()) return false;
+            o = *options;
+            strncpy(o.hiscall, t.call, sizeof(o.hiscall) - 1);
+            o.hiscall[sizeof(o.hiscall) - 1] = '\0';
+            strncpy(o.hisgrid, t.grid, sizeof(o.hisgrid) - 1);
+            o.hisgrid[sizeof(o.hisgrid) - 1] = '\0';
+            return true;
+        };
+
+        const std::vector<Sample> input(samples, samples + num_samples);
+        wsjtx_decode_options_t pass;
+        if (num_targets == 0) {
+            decode_pass(*options, false, input, "core_decode");
+        } else if (mode != WSJTX_MODE_FT8 && mode != WSJTX_MODE_FT4) {
+            bool decoded = false;
+            for (int i = 0; i < num_targets; i++) {
+                if (!target_pass(targets[i], pass)) continue;
+                decode_pass(pass, true, input, "core_decode");
+                decoded = true;
+            }
+            if (!decoded) decode_pass(*options, false, input, "core_decode");
+        } else {
+            decode_pass(*options, false, input, "core_decode");
+
+            std::vector<float> residual(input.size());
+            std::transform(input.begin(), input.end(), residual.begin(),
+                [](Sample s) { return sample_to_float(s); });
+            std::vector<wsjtx_candidate_t> candidates(MAX_STAGE_CANDIDATES);
+            int found;
+            {
+                wsjtx_core::TraceSpan span("candidate_stage");
+                wsjtx_subtract_messages(mode, residual.data(), num_samples,
+                    merged.data(), static_cast<int>(merged.size()));
+                found = wsjtx_find_candidates(mode, residual.data(), num_samples,
+                    options->low_freq, options->high_freq, STAGE_MIN_SCORE,
+                    candidates.data(), MAX_STAGE_CANDIDATES);
+            }
+
+            /* Nothing left to sync on means nothing left for AP to find */
+            if (found > 0) {
+                float lo = candidates[0].freq, hi = candidates[0].freq;
+                for (int i = 1; i < found; i++) {
+                    lo = std::min(lo, candidates[i].freq);
+                    hi = std::max(hi, candidates[i].freq);
+                }
+                const double margin = 2.0 * wsjtx_get_tone_spacing(mode);
+                for (int i = 0; i < num_targets; i++) {
+                    if (!target_pass(targets[i], pass)) continue;
+                    pass.low_freq = std::max(options->low_freq, static_cast<int>(std::floor(lo - margin)));
+                    pass.high_freq = std::min(options->high_freq, static_cast<int>(std::ceil(hi + margin)));
+                    decode_pass(pass, true, residual, "ap_decode");
+                }
+            }
+        }
+
+        rc = static_cast<int>(std::min(merged.size(), static_cast<size_t>(max_messages)));
+        std::copy(merged.begin(), merged.begin() + rc, out_messages);
+    } catch (...) {
+        rc = WSJTX_ERR_EXCEPTION;
     }
+    WSJTX_PROBE2(decode__done, mode, rc < 0 ? rc : WSJTX_OK);
+    return rc;
+}
+
+WSJTX_API int wsjtx_decode_float_targets(wsjtx_handle_t handle, int mode,
+    const float* samples, int num_samples,
+    const wsjtx_decode_options_t* options,
+    const wsjtx_ap_target_t* targets, int num_targets,
+    wsjtx_message_t* out_messages, int max_messages)
+{
+    return decode_targets(handle, mode, samples, num_samples, options,
+        targets, num_targets, out_messages, max_messages);
+}
+
+WSJTX_API int wsjtx_decode_int16_targets(wsjtx_handle_t handle, int mode,
+    const int16_t* samples, int num_samples,
+    const wsjtx_decode_options_t* options,
+    const wsjtx_ap_target_t* targets, int num_targets,
+    wsjtx_message_t* out_messages, int max_messages)
+{
+    return decode_targets(handle, mode, reinterpret_cast<const short int*>(samples), num_samples,
+        options, targets, num_targets, out_messages, max_messages);
+}
+
+/* ---- Decode (candidate band partitions) ---- */
+
+WSJTX_API int wsjtx_decode_partition(wsjtx_handle_t handle, int mode,
+    const float* samples, int num_samples,
+    const wsjtx_decode_options_t* options,
+    const wsjtx_candidate_t* candidates, int num_candidates,
+    wsjtx_message_t* out_messages, int max_messages)
+{
+    if (!handle || !options) return WSJTX_ERR_INVALID_HANDLE;
+    if (mode != WSJTX_MODE_FT8 && mode != WSJTX_MODE_FT4) return WSJTX_ERR_INVALID_MODE;
+    if (num_candidates < 0 || (num_candidates > 0 && !candidates) ||
+        !out_messages || max_messages <= 0) return WSJTX_ERR_INVALID_ARG;
+    if (num_candidates == 0) return 0;
+
+    /* The partition's band, two tones wider on each side for the decoder's
+     * own frequency refinement */
+    float lo = candidates[0].freq, hi = candidates[0].freq;
+    for (int i = 1; i < num_candidates; i++) {
+        lo = std::min(lo, candidates[i].freq);
+        hi = std::max(hi, candidates[i].freq);
+    }
+    const double margin = 2.0 * wsjtx_get_tone_spacing(mode);
+    wsjtx_decode_options_t band = *options;
+    band.low_freq = std::max(0, static_cast<int>(std::floor(lo - margin)));
+    band.high_freq = static_cast<int>(std::ceil(hi + margin));
+
+    int rc = wsjtx_decode_float_v2(handle, mode, samples, num_samples, &band);
+    if (rc != WSJTX_OK) return rc;
+    return wsjtx_pull_messages(handle, out_messages, max_messages);
 }
 
 /* ---- WSPR ---- */
@@ -226,7 +524,10 @@ WSJTX_API int wsjtx_wspr_decode(wsjtx_handle_t handle,
 {
     if (!handle) return WSJTX_ERR_INVALID_HANDLE;
 
+    WSJTX_PROBE1(wspr__start, num_iq_samples);
+    int count = 0;
     try {
+        wsjtx_core::TraceSpan span("core_wspr_decode");
         /* Reconstruct complex vector from interleaved floats */
         std::vector<std::complex<float>> iqData;
         iqData.reserve(num_iq_samples);
@@ -248,7 +549,7 @@ WSJTX_API int wsjtx_wspr_decode(wsjtx_handle_t handle,
 
         std::vector<decoder_results> results = to_lib(handle)->wspr_decode(iqData, opts);
 
-        int count = static_cast<int>(results.size());
+        count = static_cast<int>(results.size());
         if (count > max_results) count = max_results;
 
         for (int i = 0; i < count; i++) {
@@ -265,11 +566,11 @@ WSJTX_API int wsjtx_wspr_decode(wsjtx_handle_t handle,
             memcpy(out_results[i].loc, results[i].loc, sizeof(results[i].loc));
             memcpy(out_results[i].pwr, results[i].pwr, sizeof(results[i].pwr));
         }
-
-        return count;
     } catch (...) {
-        return WSJTX_ERR_EXCEPTION;
+        count = WSJTX_ERR_EXCEPTION;
     }
+    WSJTX_PROBE1(wspr__done, count);
+    return count;
 }
 
 /* ---- Stateless queries ---- */
@@ -293,3 +594,27 @@ WSJTX_API double wsjtx_get_transmission_duration(int mode) {
     if (!valid_mode(mode)) return 60.0;
     return MODE_TABLE[mode].duration;
 }
+
+WSJTX_API double wsjtx_get_slot_period(int mode) {
+    if (!valid_mode(mode)) return 60.0;
+    return MODE_TABLE[mode].period;
+}
+
+WSJTX_API int wsjtx_build_features(void) {
+    int features = 0;
+#ifdef WSJTX_ENABLE_OPENMP
+    features |= WSJTX_FEATURE_OPENMP;
+#endif
+#if defined(WSJTX_ENABLE_USDT) && defined(__linux__)
+    features |= WSJTX_FEATURE_USDT;
+#endif
+    return features;
+}
+
+WSJTX_API int wsjtx_openmp_max_threads(void) {
+#ifdef WSJTX_ENABLE_OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
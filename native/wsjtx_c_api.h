@@ -38,6 +38,13 @@ typedef void* wsjtx_handle_t;
 #define WSJTX_ERR_INVALID_MODE   -2
 #define WSJTX_ERR_ENCODE_FAILED  -3
 #define WSJTX_ERR_BUFFER_TOO_SMALL -4
+#define WSJTX_ERR_INVALID_ARG    -5
+#define WSJTX_ERR_INVALID_GRID   -6
+#define WSJTX_ERR_IO             -7
+#define WSJTX_ERR_TIMEOUT        -8   /* a watched decode overran its limit */
+#define WSJTX_ERR_QUARANTINED    -9   /* the handle was quarantined by the watchdog */
+#define WSJTX_ERR_QUOTA          -10  /* the receiver is over its CPU quota */
+#define WSJTX_ERR_BUSY           -11  /* too many runaway decodes are still running */
 #define WSJTX_ERR_EXCEPTION      -99
 
 /* Mode enumeration (must match wsjtxMode in wsjtx_lib.h) */
@@ -54,6 +61,16 @@ typedef enum {
     WSJTX_MODE_WSPR    = 9
 } wsjtx_mode_t;
 
+/* Raw PCM sample formats (little-endian, channels interleaved) */
+typedef enum {
+    WSJTX_PCM_U8  = 0,   /* unsigned, 128 = silence */
+    WSJTX_PCM_S16 = 1,
+    WSJTX_PCM_S24 = 2,   /* packed, 3 bytes per sample */
+    WSJTX_PCM_S32 = 3,
+    WSJTX_PCM_F32 = 4,
+    WSJTX_PCM_F64 = 5
+} wsjtx_pcm_format_t;
+
 /* Decoded message (C-compatible version of WsjtxMessage) */
 typedef struct {
     int hh;
@@ -64,6 +81,7 @@ typedef struct {
     float sync;
     float dt;
     char msg[64];
+    int ap_type;         /* 0 = no a-priori info, 1..7 = FT8/FT4 AP type ("a1".."a7"), -1 = unknown */
 } wsjtx_message_t;
 
 /* WSPR decoder options (C-compatible version of decoder_options) */
@@ -111,6 +129,23 @@ typedef struct {
     char hisgrid[7];
 } wsjtx_decode_options_t;
 
+/* One station to try AP decoding for (see wsjtx_decode_float_targets) */
+typedef struct {
+    char call[13];
+    char grid[7];     /* 4-char grid, empty if unknown */
+} wsjtx_ap_target_t;
+
+#define WSJTX_MAX_AP_TARGETS 16
+
+/* A sync candidate from wsjtx_find_candidates */
+typedef struct {
+    float freq;       /* Hz, lowest tone */
+    float dt;         /* seconds relative to the nominal start, as decodes report DT */
+    float score;      /* Costas sync over the band's 40th percentile, >= 1 */
+} wsjtx_candidate_t;
+
+#define WSJTX_MAX_DIVERSITY 8
+
 /* ---- Lifecycle ---- */
 
 WSJTX_API wsjtx_handle_t wsjtx_create(void);
@@ -151,6 +186,93 @@ WSJTX_API int wsjtx_decode_int16_v2(wsjtx_handle_t handle, int mode,
     const int16_t* samples, int num_samples,
     const wsjtx_decode_options_t* options);
 
+/**
+ * Decode one slot with AP for several DX stations — v2 options plus up to
+ * WSJTX_MAX_AP_TARGETS targets, whose call/grid replace options->hiscall
+ * and hisgrid (a target without a grid has none). A target is skipped once its call has appeared in a decode
+ * of this slot, since a station sends one message per slot.
+ *
+ * FT8/FT4 share the sync stage across targets: the slot is decoded once
+ * with the plain options, those signals are subtracted, the residual is
+ * searched for candidates once (wsjtx_find_candidates), and only the
+ * targets not yet heard get an AP decode, of the residual and limited to
+ * the band the remaining candidates occupy; with none left, no AP decode
+ * runs. Other modes decode the whole slot once per target. Messages are
+ * merged without duplicates (first pass wins) into `out_messages`, not the
+ * queue.
+ *
+ * Returns the number of messages written (>= 0), or a negative error code.
+ * With num_targets == 0 this is one v2 decode followed by a drain.
+ */
+WSJTX_API int wsjtx_decode_float_targets(wsjtx_handle_t handle, int mode,
+    const float* samples, int num_samples,
+    const wsjtx_decode_options_t* options,
+    const wsjtx_ap_target_t* targets, int num_targets,
+    wsjtx_message_t* out_messages, int max_messages);
+
+WSJTX_API int wsjtx_decode_int16_targets(wsjtx_handle_t handle, int mode,
+    const int16_t* samples, int num_samples,
+    const wsjtx_decode_options_t* options,
+    const wsjtx_ap_target_t* targets, int num_targets,
+    wsjtx_message_t* out_messages, int max_messages);
+
+/**
+ * Stage 1 of a pipelined FT8/FT4 decode: Costas-array sync search over
+ * [low_freq, high_freq] (the same statistic as WSJT-X's sync8), at the mode
+ * sample rate. Needs no handle, so it can run on any thread while decoders
+ * are busy. Writes up to `max_candidates` candidates scoring at least
+ * `min_score` (1.5 is WSJT-X's default), best first, at most one per 6 Hz.
+ * Returns the number written, or a negative error code.
+ */
+WSJTX_API int wsjtx_find_candidates(int mode, const float* samples, int num_samples,
+    int low_freq, int high_freq, float min_score,
+    wsjtx_candidate_t* out_candidates, int max_candidates);
+
+/**
+ * Band partitioning for wsjtx_find_candidates results: decode only the
+ * frequency band spanned by `candidates` (typically one contiguous
+ * partition of a result), plus two tone spacings either side, with the v2
+ * options; options->low_freq/high_freq are replaced by that band. This is
+ * a full decode of the band, not a per-candidate decode: the decoder
+ * repeats its own sync search inside it, as wsjtx_lib has no entry point
+ * below a whole decode. Partitions can go to different handles in
+ * parallel. Messages are written to `out_messages`, not the queue. Returns
+ * the number written, or a negative error code; no candidates means no
+ * decode and 0.
+ */
+WSJTX_API int wsjtx_decode_partition(wsjtx_handle_t handle, int mode,
+    const float* samples, int num_samples,
+    const wsjtx_decode_options_t* options,
+    const wsjtx_candidate_t* candidates, int num_candidates,
+    wsjtx_message_t* out_messages, int max_messages);
+
+/**
+ * Combine time-aligned audio of one slot from 2..WSJTX_MAX_DIVERSITY
+ * receivers into one channel for a single decode. Each receiver is
+ * whitened by its own noise floor, then every short-time spectrum bin is
+ * co-phased and weighted by the local signal estimate (maximal-ratio
+ * combining), so SNR adds across receivers wherever the signal is. All
+ * channels hold `num_samples` samples at the mode sample rate; `out` may
+ * alias channels[0]. Returns WSJTX_OK or a negative error code.
+ */
+WSJTX_API int wsjtx_combine_diversity(int mode, const float* const* channels, int num_channels,
+    int num_samples, float* out);
+
+/* ---- PCM input ---- */
+
+/* Bytes per sample of a wsjtx_pcm_format_t, 0 if unknown */
+WSJTX_API int wsjtx_pcm_sample_bytes(int format);
+
+/**
+ * Convert one channel of interleaved PCM to float in [-1, 1) in a single
+ * pass: `channels` interleaved channels (1..64), `channel` selecting one.
+ * `data` needs no alignment; a trailing partial frame is ignored. Writes
+ * min(out_size, frames) samples and returns the count, or a negative
+ * error code.
+ */
+WSJTX_API int wsjtx_pcm_to_float(const void* data, size_t num_bytes, int format,
+    int channels, int channel, float* out, int out_size);
+
 /* ---- Encode ---- */
 
 /**
@@ -158,7 +280,8 @@ WSJTX_API int wsjtx_decode_int16_v2(wsjtx_handle_t handle, int mode,
  *
  * @param out_samples      Caller-allocated buffer for output audio samples
  * @param out_num_samples  On return, the number of samples written
- * @param out_buf_size     Size of out_samples buffer (in floats)
+ * @param out_buf_size     Size of out_samples buffer (in floats), at least
+ *                         wsjtx_get_waveform_samples(mode)
  * @param out_message_sent Caller-allocated buffer for the actual message sent
  * @param out_msg_buf_size Size of out_message_sent buffer (in bytes)
  *
@@ -169,6 +292,50 @@ WSJTX_API int wsjtx_encode(wsjtx_handle_t handle, int mode, int freq,
     float* out_samples, int* out_num_samples, int out_buf_size,
     char* out_message_sent, int out_msg_buf_size);
 
+/* ---- Tone generation and synthesis ---- */
+
+/**
+ * Channel tones for `message` in `mode`: every mode except JT65JT9, using
+ * the WSJT-X generators (JT4A, JT65A, JT9A, FST4-60, Q65-60A, FST4W-120,
+ * WSPR-2 submodes). Writes wsjtx_get_symbol_count(mode) tones.
+ * Returns WSJTX_OK, WSJTX_ERR_BUFFER_TOO_SMALL or another negative code.
+ */
+WSJTX_API int wsjtx_encode_tones(int mode, const char* message,
+    int* out_tones, int max_tones, int* out_num_tones,
+    char* out_message_sent, int out_msg_buf_size);
+
+/* Channel symbols per transmission, 0 if `mode` cannot be encoded */
+WSJTX_API int wsjtx_get_symbol_count(int mode);
+/* Samples per channel symbol at wsjtx_get_sample_rate(mode) */
+WSJTX_API int wsjtx_get_samples_per_symbol(int mode);
+/* Spacing between adjacent tones in Hz */
+WSJTX_API double wsjtx_get_tone_spacing(int mode);
+/* Samples wsjtx_synthesize writes for one transmission, 0 if not encodable */
+WSJTX_API int wsjtx_get_waveform_samples(int mode);
+
+/**
+ * Continuous-phase FSK audio for `tones` at the mode's sample rate, symbol
+ * length and tone spacing, with raised-cosine ramps at both ends. FT8
+ * (BT 2.0) and FT4 (BT 1.0) are Gaussian-shaped as in WSJT-X, and FT4 keeps
+ * one extra symbol of pulse tail at each end. `freq` is the frequency of
+ * tone 0 (for WSPR, the centre of the four tones, as WSJT-X reports it).
+ * Writes (num_tones + 2) * samples_per_symbol samples for FT4 and
+ * num_tones * samples_per_symbol otherwise, peak amplitude 1.
+ */
+WSJTX_API int wsjtx_synthesize(int mode, const int* tones, int num_tones, double freq,
+    float* out_samples, int out_buf_size, int* out_num_samples);
+
+/**
+ * Subtract decoded FT8/FT4 signals from `samples` in place (mode sample
+ * rate, the audio they were decoded from), leaving the residual for another
+ * decoder. Each message is re-encoded, aligned around its DT and subtracted
+ * with a slowly varying amplitude and phase, as WSJT-X does between decode
+ * passes. Messages that cannot be re-encoded (unresolved hashed calls) are
+ * skipped. Returns the number subtracted, or a negative error code.
+ */
+WSJTX_API int wsjtx_subtract_messages(int mode, float* samples, int num_samples,
+    const wsjtx_message_t* messages, int num_messages);
+
 /* ---- Message queue ---- */
 
 /**
@@ -202,12 +369,588 @@ WSJTX_API int wsjtx_wspr_decode(wsjtx_handle_t handle,
     wsjtx_decoder_options_t* options,
     wsjtx_decoder_result_t* out_results, int max_results);
 
+/* ---- Maidenhead grid geometry ---- */
+
+/**
+ * Great-circle distance and initial bearing from `home_grid` to every entry
+ * of `grids`, in one call. Locators may be 4 or 6 characters.
+ *
+ * @param out_km       Caller-allocated array of `count` doubles (kilometres)
+ * @param out_bearing  Caller-allocated array of `count` doubles (degrees from true north, 0..360)
+ *
+ * Entries that are not valid locators get NaN in both outputs.
+ * Returns the number of grids resolved (>= 0), WSJTX_ERR_INVALID_GRID if
+ * `home_grid` is not a locator, or WSJTX_ERR_INVALID_ARG.
+ */
+WSJTX_API int wsjtx_grid_distance_bearing(const char* home_grid,
+    const char* const* grids, int count,
+    double* out_km, double* out_bearing);
+
+/**
+ * Extract the locator carried by a decoded message ("CQ K1ABC FN20").
+ * Writes an upper-case, NUL-terminated grid into `out_grid`.
+ * Returns the grid length (4 or 6), or 0 if the message carries none.
+ */
+WSJTX_API int wsjtx_message_grid(const char* message, char* out_grid, int out_size);
+
+/* ---- Cross-slot message history ---- */
+
+/* Opaque handle to a bounded LRU message history (one per receiver) */
+typedef void* wsjtx_history_t;
+
+/* Per-message result of wsjtx_history_observe() */
+typedef struct {
+    int is_new;          /* 1 if the message was not in the history */
+    int repeat_count;    /* observations so far, including this one */
+    int64_t first_slot;  /* slot the message was first seen in */
+    int64_t last_slot;   /* slot it was last seen in before this observation */
+} wsjtx_history_entry_t;
+
+/**
+ * Create a history holding at most `capacity` distinct messages. Messages
+ * are keyed by normalized text and frequency, where frequencies within
+ * `freq_tolerance` Hz of each other match. Returns NULL on bad arguments.
+ * The history is internally locked and may be shared across threads.
+ */
+WSJTX_API wsjtx_history_t wsjtx_history_create(int capacity, int freq_tolerance);
+WSJTX_API void wsjtx_history_destroy(wsjtx_history_t history);
+
+/**
+ * Record `count` decodes from `slot` and fill one entry per message.
+ * Returns `count`, or a negative error code.
+ */
+WSJTX_API int wsjtx_history_observe(wsjtx_history_t history,
+    const wsjtx_message_t* messages, int count, int64_t slot,
+    wsjtx_history_entry_t* out_entries);
+
+WSJTX_API int wsjtx_history_size(wsjtx_history_t history);
+WSJTX_API void wsjtx_history_clear(wsjtx_history_t history);
+
+/* ---- Band-activity aggregation ---- */
+
+/* Opaque handle to a rolling band-activity aggregator */
+typedef void* wsjtx_activity_t;
+
+/* Histogram layouts: SNR bins are WSJTX_ACTIVITY_SNR_STEP dB wide starting
+ * at WSJTX_ACTIVITY_SNR_MIN; audio bins are WSJTX_ACTIVITY_AUDIO_STEP Hz
+ * wide starting at 0. Out-of-range values land in the edge bins. */
+#define WSJTX_ACTIVITY_SNR_BINS   32
+#define WSJTX_ACTIVITY_SNR_MIN   -30
+#define WSJTX_ACTIVITY_SNR_STEP    2
+#define WSJTX_ACTIVITY_AUDIO_BINS 80
+#define WSJTX_ACTIVITY_AUDIO_STEP 50
+
+/* Statistics for one time bucket, or a total over a range of buckets */
+typedef struct {
+    int64_t bucket_start;   /* first second covered (unix time) */
+    int decodes;
+    int unique_calls;       /* estimated distinct callsigns */
+    int snr_histogram[WSJTX_ACTIVITY_SNR_BINS];
+    int audio_occupancy[WSJTX_ACTIVITY_AUDIO_BINS];
+} wsjtx_activity_stats_t;
+
+/**
+ * Create an aggregator keeping `num_buckets` buckets of `bucket_seconds`
+ * each per (band, mode) series. Memory is fixed per series.
+ * Internally locked; may be shared across threads.
+ */
+WSJTX_API wsjtx_activity_t wsjtx_activity_create(int bucket_seconds, int num_buckets);
+WSJTX_API void wsjtx_activity_destroy(wsjtx_activity_t activity);
+
+/**
+ * Fold `count` decodes observed at `time_seconds` into the (band, mode)
+ * series. Decodes older than the ring window are ignored.
+ */
+WSJTX_API int wsjtx_activity_add(wsjtx_activity_t activity,
+    const char* band, int mode, int64_t time_seconds,
+    const wsjtx_message_t* messages, int count);
+
+/**
+ * Aggregate statistics over [from_seconds, to_seconds]. An empty `band`
+ * or negative `mode` matches all series. The total is written to
+ * `out_total`; up to `max_buckets` per-bucket rows (oldest first) go to
+ * `out_buckets`, which may be NULL. Returns the number of rows written.
+ */
+WSJTX_API int wsjtx_activity_query(wsjtx_activity_t activity,
+    const char* band, int mode, int64_t from_seconds, int64_t to_seconds,
+    wsjtx_activity_stats_t* out_total,
+    wsjtx_activity_stats_t* out_buckets, int max_buckets);
+
+/* ---- Sound-card clock estimation and resampling ---- */
+
+/* Opaque handle to a sample-rate error estimator (one per sound card) */
+typedef void* wsjtx_clock_t;
+
+typedef struct {
+    double ppm;          /* sample-rate error; positive = card faster than nominal */
+    double ppm_error;    /* standard error of ppm */
+    double dt_offset;    /* fitted DT at the newest slot, seconds */
+    int slots;           /* slots in the fit */
+} wsjtx_clock_estimate_t;
+
+/**
+ * Create an estimator fitting the slots of the last `window_seconds`
+ * (at least 60). It is internally locked and may be shared across threads.
+ * Returns NULL on bad arguments.
+ */
+WSJTX_API wsjtx_clock_t wsjtx_clock_create(double window_seconds);
+WSJTX_API void wsjtx_clock_destroy(wsjtx_clock_t clock);
+
+/**
+ * Record the decodes of the slot starting at `slot_time` seconds, for a
+ * capture that cuts slots by counting samples: a clock error then shows up
+ * as DT growing slot after slot. Slots without decodes are ignored.
+ */
+WSJTX_API int wsjtx_clock_observe(wsjtx_clock_t clock, double slot_time,
+    const wsjtx_message_t* messages, int count);
+
+/**
+ * Fit the DT drift (robust line over the per-slot median DT). Returns 1 and
+ * fills `out` once at least 4 slots spanning 60 s are held, 0 before that,
+ * or a negative error code.
+ */
+WSJTX_API int wsjtx_clock_estimate(wsjtx_clock_t clock, wsjtx_clock_estimate_t* out);
+WSJTX_API void wsjtx_clock_clear(wsjtx_clock_t clock);
+
+/**
+ * Fractional resampling by `ratio` = output rate / input rate, 0.5..2
+ * (windowed-sinc polyphase interpolation). Correcting a card `ppm` fast
+ * uses ratio = 1 / (1 + ppm * 1e-6). Writes floor(num_in * ratio) samples,
+ * at most `out_size`, and returns the count or a negative error code.
+ */
+WSJTX_API int wsjtx_resample(const float* in, int num_in, double ratio, float* out, int out_size);
+
+/* ---- QSO sequencing ---- */
+
+/* Opaque handle to an FT8/FT4 QSO sequencer (one per transmitter) */
+typedef void* wsjtx_qso_t;
+
+/* What the sequencer transmits next, in the standard message order */
+typedef enum {
+    WSJTX_QSO_IDLE         = 0,   /* nothing */
+    WSJTX_QSO_CQ           = 1,   /* CQ MYCALL GRID */
+    WSJTX_QSO_CALLING      = 2,   /* DX MYCALL GRID (Tx1) */
+    WSJTX_QSO_REPORT       = 3,   /* DX MYCALL -NN (Tx2) */
+    WSJTX_QSO_ROGER_REPORT = 4,   /* DX MYCALL R-NN (Tx3) */
+    WSJTX_QSO_ROGER        = 5,   /* DX MYCALL RR73 (Tx4) */
+    WSJTX_QSO_SIGNOFF      = 6,   /* DX MYCALL 73 (Tx5) */
+    WSJTX_QSO_DONE         = 7    /* finished a QSO started with wsjtx_qso_call() */
+} wsjtx_qso_state_t;
+
+#define WSJTX_QSO_NO_REPORT -99
+
+typedef struct {
+    int state;               /* wsjtx_qso_state_t */
+    char dx_call[16];        /* empty while calling CQ or idle */
+    char dx_grid[8];
+    int report_sent;         /* dB, fixed when the QSO starts */
+    int report_received;     /* dB, WSJTX_QSO_NO_REPORT until heard */
+    int repeats;             /* slots tx_message has gone without progress */
+    int logged;              /* 1 once the reports are confirmed both ways */
+    char tx_message[40];     /* next transmission, empty when there is none */
+    int cache_hits;          /* wsjtx_qso_tx_audio() calls served pre-encoded */
+    int cache_misses;
+} wsjtx_qso_status_t;
+
+/**
+ * Create a sequencer for FT8 or FT4 transmitting at `tx_freq` Hz audio.
+ * A QSO is abandoned after `max_repeats` (>= 1) slots without a reply.
+ * It is internally locked and may be shared across threads. Returns NULL
+ * on bad arguments.
+ */
+WSJTX_API wsjtx_qso_t wsjtx_qso_create(int mode, const char* my_call, const char* my_grid,
+    int tx_freq, int max_repeats);
+WSJTX_API void wsjtx_qso_destroy(wsjtx_qso_t qso);
+
+/* Call CQ, answering the strongest station that replies and returning to CQ
+ * after each QSO */
+WSJTX_API int wsjtx_qso_start_cq(wsjtx_qso_t qso);
+
+/**
+ * Answer `dx_call` (grid optional, may be NULL), heard at `snr` dB. As in
+ * WSJT-X, the report sent through the QSO is that SNR.
+ */
+WSJTX_API int wsjtx_qso_call(wsjtx_qso_t qso, const char* dx_call, const char* dx_grid, int snr);
+
+/* Stop transmitting (state IDLE) */
+WSJTX_API void wsjtx_qso_stop(wsjtx_qso_t qso);
+
+/**
+ * Advance on one slot's decodes: replies to MYCALL move the QSO on, no
+ * reply repeats the last message. Call once per receive slot, also when it
+ * decoded nothing. Returns 1 if tx_message changed, 0 if not, or a
+ * negative error code.
+ */
+WSJTX_API int wsjtx_qso_observe(wsjtx_qso_t qso, const wsjtx_message_t* messages, int count);
+
+WSJTX_API int wsjtx_qso_status(wsjtx_qso_t qso, wsjtx_qso_status_t* out);
+
+/**
+ * Audio for tx_message at the mode's sample rate, taken from the
+ * pre-encoded messages when there (and encoded otherwise). Writes at most
+ * `out_size` samples; wsjtx_get_waveform_samples(mode) always fits.
+ * Returns the sample count, 0 if there is nothing to send, or a negative
+ * error code.
+ */
+WSJTX_API int wsjtx_qso_tx_audio(wsjtx_qso_t qso, float* out, int out_size);
+
+/**
+ * Pre-encode tx_message and the messages that follow it under the
+ * expected replies, dropping any others held. Meant to run while the
+ * current message is on the air. Returns the number newly encoded, or a
+ * negative error code.
+ */
+WSJTX_API int wsjtx_qso_speculate(wsjtx_qso_t qso);
+
+/* ---- WSJT-X UDP protocol emitter ---- */
+
+/* Opaque handle to a UDP emitter bound to one destination */
+typedef void* wsjtx_udp_t;
+
+/* Fields of the WSJT-X Status (type 1) message. Strings are NUL-terminated. */
+typedef struct {
+    uint64_t dial_frequency;
+    char mode[8];
+    char dx_call[16];
+    char report[8];
+    char tx_mode[8];
+    int tx_enabled;
+    int transmitting;
+    int decoding;
+    uint32_t rx_df;
+    uint32_t tx_df;
+    char de_call[16];
+    char de_grid[8];
+    char dx_grid[8];
+    int tx_watchdog;
+    char sub_mode[8];
+    int fast_mode;
+    int special_op_mode;
+    uint32_t freq_tolerance;
+    uint32_t tr_period;
+    char config_name[32];
+    char tx_message[40];
+} wsjtx_udp_status_t;
+
+/**
+ * Create an emitter sending to `host`:`port` (IPv4/IPv6 literal or name),
+ * identifying itself as `client_id` (default "WSJT-X"). For multicast
+ * destinations `multicast_ttl` sets the TTL/hop limit (0 = system default).
+ * Returns NULL on failure. Internally locked; may be shared across threads.
+ */
+WSJTX_API wsjtx_udp_t wsjtx_udp_create(const char* host, int port,
+    const char* client_id, int multicast_ttl);
+WSJTX_API void wsjtx_udp_destroy(wsjtx_udp_t udp);
+
+/* The send functions return the number of datagrams sent, or a negative
+ * error code if none could be sent. */
+WSJTX_API int wsjtx_udp_send_heartbeat(wsjtx_udp_t udp, const char* version, const char* revision);
+WSJTX_API int wsjtx_udp_send_status(wsjtx_udp_t udp, const wsjtx_udp_status_t* status);
+
+/**
+ * Send one Decode (type 2) message per entry. `is_new` may be NULL (all
+ * new); the message time is taken from each message's hh/min/sec.
+ */
+WSJTX_API int wsjtx_udp_send_decodes(wsjtx_udp_t udp, int mode,
+    const wsjtx_message_t* messages, int count, const int* is_new);
+
+/**
+ * Send one WSPRDecode (type 10) message per result. `time_ms` is the
+ * decode period start in ms since midnight UTC.
+ */
+WSJTX_API int wsjtx_udp_send_wspr_decodes(wsjtx_udp_t udp,
+    const wsjtx_decoder_result_t* results, int count,
+    uint32_t time_ms, uint64_t dial_frequency);
+
+/* ---- Columnar (Apache Arrow layout) export ---- */
+
+/* Byte range of one Arrow buffer inside the export buffer */
+typedef struct {
+    int64_t offset;
+    int64_t length;
+} wsjtx_buffer_span_t;
+
+/**
+ * Layout of a columnar export. Every span starts on a 64-byte boundary and
+ * follows the Arrow columnar format, so each can be handed to an Arrow
+ * reader as-is:
+ *   text      : utf8   (validity bitmap, int32 offsets, data)
+ *   snr       : int32
+ *   dt        : float32
+ *   freq      : int32
+ *   sync      : float32
+ *   time      : int32 (seconds since midnight UTC)
+ * Numeric columns carry no validity bitmap (null_count is 0).
+ */
+typedef struct {
+    int64_t length;      /* row count */
+    int64_t null_count;  /* nulls in the text column (always 0) */
+    wsjtx_buffer_span_t text_validity;
+    wsjtx_buffer_span_t text_offsets;
+    wsjtx_buffer_span_t text_data;
+    wsjtx_buffer_span_t snr;
+    wsjtx_buffer_span_t dt;
+    wsjtx_buffer_span_t freq;
+    wsjtx_buffer_span_t sync;
+    wsjtx_buffer_span_t time;
+} wsjtx_columnar_layout_t;
+
+/* Bytes needed to export `count` messages, including alignment padding. */
+WSJTX_API int64_t wsjtx_columnar_size(const wsjtx_message_t* messages, int count);
+
+/**
+ * Write `count` messages into `buffer` in columnar form and describe the
+ * buffers in `out_layout`. Padding is zero-filled. Returns the number of
+ * bytes written, or WSJTX_ERR_BUFFER_TOO_SMALL if `size` is insufficient.
+ */
+WSJTX_API int64_t wsjtx_columnar_export(const wsjtx_message_t* messages, int count,
+    uint8_t* buffer, int64_t size, wsjtx_columnar_layout_t* out_layout);
+
+/* ---- Tracing ---- */
+
+/**
+ * Process-wide span recording into a ring of `capacity` events (<= 0 uses
+ * 65536); the oldest events are overwritten once full. Starting again
+ * discards what was recorded. Core decode/encode stages record spans
+ * automatically while tracing is on.
+ */
+WSJTX_API void wsjtx_trace_start(int capacity);
+WSJTX_API void wsjtx_trace_stop(void);
+WSJTX_API int wsjtx_trace_enabled(void);
+
+/* Monotonic clock used for all span timestamps, in microseconds */
+WSJTX_API int64_t wsjtx_trace_now_us(void);
+
+/* Tag spans recorded by the calling thread with `job` (-1 clears) */
+WSJTX_API void wsjtx_trace_set_job(int64_t job);
+
+/* Record a complete span on the calling thread. `job` < 0 uses the
+ * thread's current job tag. No-op while tracing is off. */
+WSJTX_API void wsjtx_trace_record(const char* name, int64_t start_us, int64_t dur_us, int64_t job);
+
+/**
+ * Render recorded spans as Chrome trace-event JSON. Returns the length
+ * excluding the terminator; the text is written only if `size` exceeds it
+ * (call with NULL first to size the buffer).
+ */
+WSJTX_API int64_t wsjtx_trace_dump(char* buffer, int64_t size);
+
+/* ---- Metrics ---- */
+
+/* Operations tracked by the latency histograms */
+typedef enum {
+    WSJTX_OP_DECODE  = 0,
+    WSJTX_OP_ENCODE  = 1,
+    WSJTX_OP_WSPR    = 2,
+    WSJTX_OP_CONVERT = 3,
+    WSJTX_OP_COUNT   = 4
+} wsjtx_op_t;
+
+/**
+ * Record one completed operation for `receiver` (a free-form label; NULL
+ * is the same as ""). `queue_us` is the wait before a worker started it,
+ * `total_us` the time from submission to completion. Modes outside the
+ * mode enum are recorded as mode "none".
+ */
+WSJTX_API void wsjtx_metrics_record(const char* receiver, int op, int mode,
+    int64_t queue_us, int64_t total_us, int ok);
+
+/* Adjust the queued/running job gauges of `receiver` */
+WSJTX_API void wsjtx_metrics_jobs(const char* receiver, int queued_delta, int running_delta);
+
+/* Count messages returned by a decode */
+WSJTX_API void wsjtx_metrics_messages(const char* receiver, int mode, int count);
+
+/* Latency quantile in seconds (queue wait if `queue` != 0); NaN if no samples */
+WSJTX_API double wsjtx_metrics_quantile(const char* receiver, int op, int mode, double q, int queue);
+
+/**
+ * Render all metrics in the Prometheus text exposition format. Returns the
+ * length excluding the terminator; the text is written only if `size`
+ * exceeds it (call with NULL first to size the buffer).
+ */
+WSJTX_API int64_t wsjtx_metrics_prometheus(char* buffer, int64_t size);
+
+/* Count CPU time spent on one operation of `receiver` (see wsjtx_thread_cpu_us) */
+WSJTX_API void wsjtx_metrics_cpu(const char* receiver, int op, int mode, int64_t cpu_us);
+
+/* Clear histograms and counters (gauges of live jobs are kept) */
+WSJTX_API void wsjtx_metrics_reset(void);
+
+/* ---- Per-receiver accounting and quotas ---- */
+
+/* What happens to new jobs of a receiver over its CPU share */
+typedef enum {
+    WSJTX_QUOTA_NONE         = 0,   /* no quota */
+    WSJTX_QUOTA_DEPRIORITIZE = 1,   /* run them at lower OS priority */
+    WSJTX_QUOTA_REJECT       = 2    /* refuse them with WSJTX_ERR_QUOTA */
+} wsjtx_quota_action_t;
+
+/* CPU time consumed by the calling thread, in microseconds */
+WSJTX_API int64_t wsjtx_thread_cpu_us(void);
+
+/**
+ * Lower the OS scheduling priority of the calling thread. It cannot be
+ * raised again without privileges, so only call this on a thread that
+ * exits after the job; a thread of the job pool (wsjtx_pool_submit) is
+ * replaced by a fresh one once its job returns. Returns WSJTX_OK or
+ * WSJTX_ERR_IO.
+ */
+WSJTX_API int wsjtx_thread_lower_priority(void);
+
+/**
+ * Limit `receiver` (NULL is the same as "") to `cpu_share` of the host's
+ * CPUs (0..1, e.g. 0.25 = a quarter of all cores) averaged over the last
+ * minute, enforced by `action` once exceeded. WSJTX_QUOTA_NONE removes
+ * the quota. Returns WSJTX_OK or WSJTX_ERR_INVALID_ARG.
+ */
+WSJTX_API int wsjtx_quota_set(const char* receiver, double cpu_share, int action);
+
+/**
+ * Admission of a new job of `receiver`: 0 to run normally, 1 to run at
+ * lower priority, or WSJTX_ERR_QUOTA to refuse it. Counts the job.
+ */
+WSJTX_API int wsjtx_account_admit(const char* receiver);
+
+/* Count a job of `receiver` whose thread priority was actually lowered */
+WSJTX_API void wsjtx_account_deprioritized(const char* receiver);
+
+/* Charge a finished job's CPU and queue time to `receiver` */
+WSJTX_API void wsjtx_account_charge(const char* receiver, int64_t cpu_us, int64_t queue_us);
+
+typedef struct {
+    int64_t jobs;            /* admitted, including deprioritized */
+    int64_t deprioritized;   /* run at lowered priority */
+    int64_t rejected;
+    double cpu_seconds;      /* total charged */
+    double queue_seconds;    /* total charged */
+    double cpu_share;        /* share of the host's CPUs used over the last minute */
+    double quota_share;      /* 0 without a quota */
+    int quota_action;        /* wsjtx_quota_action_t */
+} wsjtx_account_t;
+
+/* Returns 1 and fills `out` if `receiver` has jobs or a quota, else 0 */
+WSJTX_API int wsjtx_account_get(const char* receiver, wsjtx_account_t* out);
+
+/* ---- Thread-scaling autotune ---- */
+
+/* Best decode configuration measured for one mode on this host */
+typedef struct {
+    int mode;
+    int threads;          /* decoder thread hint (wsjtx_decode_options_t.threads) */
+    int concurrency;      /* simultaneous decodes, one handle each */
+    double latency_ms;    /* mean wall time of one decode at this setting */
+    double throughput;    /* decodes per second across all concurrent decoders */
+} wsjtx_tuning_t;
+
+/**
+ * Benchmark decoding of a synthetic slot (three encoded signals plus noise;
+ * noise only for JT65JT9) for every combination of
+ * `thread_counts` (1..16) and `concurrency` (1..64) levels, `repeats` decodes
+ * per decoder. Per mode, the configuration with the highest throughput whose
+ * latency fits in the T/R period wins (fewer CPUs on near ties); it is written
+ * to out_results[i] and recorded as with wsjtx_tuning_set. WSPR has no thread
+ * hint and is rejected. Blocks for the whole run (seconds to minutes).
+ * Returns WSJTX_OK or a negative error code.
+ */
+WSJTX_API int wsjtx_autotune(const int* modes, int num_modes,
+    const int* thread_counts, int num_thread_counts,
+    const int* concurrency, int num_concurrency,
+    int repeats, wsjtx_tuning_t* out_results);
+
+/* Record (or with threads <= 0, clear) the tuned configuration for a mode. */
+WSJTX_API int wsjtx_tuning_set(const wsjtx_tuning_t* tuning);
+
+/* Returns 1 and fills `out` if the mode has a tuned configuration, else 0. */
+WSJTX_API int wsjtx_tuning_get(int mode, wsjtx_tuning_t* out);
+
+/* ---- Decode watchdog ---- */
+
+/**
+ * Wall-time limit in seconds for decodes of `mode` run through
+ * wsjtx_watchdog_run; 0 runs them unwatched. The default is two T/R
+ * periods. Returns WSJTX_OK or WSJTX_ERR_INVALID_MODE/INVALID_ARG.
+ */
+WSJTX_API int wsjtx_watchdog_set_limit(int mode, double seconds);
+WSJTX_API double wsjtx_watchdog_get_limit(int mode);
+
+/**
+ * Run `fn(ctx)` (a decode on `handle`) on a thread of the job pool under
+ * the limit of `mode`, counted from when it starts, and return its result.
+ * A decoder thread cannot be stopped, so an overrunning call is left
+ * running on its pool thread and the pool is lent another: the caller gets
+ * WSJTX_ERR_TIMEOUT, the handle is quarantined, and `abandon(ctx)` is
+ * called on that thread once `fn` returns, if ever, so the caller must hand
+ * `ctx` over to it. On a quarantined handle `fn` is not called and
+ * WSJTX_ERR_QUARANTINED is returned. A fresh handle does not isolate a new
+ * decode from a runaway, which still shares the process-wide Fortran
+ * decoder state, so while 4 runaways are running new watched calls are
+ * refused at once with WSJTX_ERR_BUSY. With no limit, on a pool thread, or
+ * with no thread to spare `fn` runs inline.
+ */
+WSJTX_API int wsjtx_watchdog_run(wsjtx_handle_t handle, int mode,
+    int (*fn)(void* ctx), void (*abandon)(void* ctx), void* ctx);
+
+/* 1 if a decode on `handle` overran its limit: schedule no more work on it */
+WSJTX_API int wsjtx_watchdog_quarantined(wsjtx_handle_t handle);
+
+/**
+ * References from queued and running jobs. wsjtx_watchdog_retire destroys
+ * the handle once the last reference is released (at once if there is
+ * none), so a handle can be retired while a runaway decode still uses it.
+ */
+WSJTX_API void wsjtx_watchdog_hold(wsjtx_handle_t handle);
+WSJTX_API void wsjtx_watchdog_release(wsjtx_handle_t handle);
+WSJTX_API void wsjtx_watchdog_retire(wsjtx_handle_t handle);
+
+typedef struct {
+    int64_t watched;         /* decodes run with a limit */
+    int64_t timeouts;        /* of those, overran it */
+    int runaways;            /* overrun decodes still running */
+    int quarantined;         /* quarantined handles not yet destroyed */
+} wsjtx_watchdog_stats_t;
+
+WSJTX_API void wsjtx_watchdog_stats(wsjtx_watchdog_stats_t* out);
+
+/* ---- Job pool ---- */
+
+/**
+ * Run fn(ctx) on the core's shared worker threads, for embedders that want
+ * blocking calls off their own threads (see wsjtx_coro.hpp). The pool
+ * starts on first use with one thread per CPU; jobs run in submission
+ * order as threads free up. Watched decodes (wsjtx_watchdog_run) run here
+ * too, with an extra thread started for each runaway left holding one.
+ * Returns WSJTX_OK or WSJTX_ERR_EXCEPTION if the job could not be queued.
+ */
+WSJTX_API int wsjtx_pool_submit(void (*fn)(void* ctx), void* ctx);
+
+/**
+ * Resize the pool (1..256 threads; 0 = one per CPU). New threads start at
+ * once; surplus ones exit after their current job.
+ * Returns WSJTX_OK or WSJTX_ERR_INVALID_ARG.
+ */
+WSJTX_API int wsjtx_pool_set_threads(int threads);
+
+/* Threads the pool is sized to */
+WSJTX_API int wsjtx_pool_threads(void);
+
 /* ---- Stateless queries ---- */
 
 WSJTX_API int wsjtx_is_encoding_supported(int mode);
 WSJTX_API int wsjtx_is_decoding_supported(int mode);
 WSJTX_API int wsjtx_get_sample_rate(int mode);
 WSJTX_API double wsjtx_get_transmission_duration(int mode);
+/* T/R period (slot length) in seconds, e.g. 15 for FT8 */
+WSJTX_API double wsjtx_get_slot_period(int mode);
+
+/* Optional features compiled into this wsjtx_core (bitmask) */
+#define WSJTX_FEATURE_OPENMP  (1 << 0)  /* decoders built with OpenMP; threads sets the team size */
+#define WSJTX_FEATURE_USDT    (1 << 1)  /* USDT probes, see wsjtx_probes.h */
+
+WSJTX_API int wsjtx_build_features(void);
+/* OpenMP threads available to a parallel region (omp_get_max_threads on
+ * the calling thread); 1 without WSJTX_FEATURE_OPENMP */
+WSJTX_API int wsjtx_openmp_max_threads(void);
 
 #ifdef __cplusplus
 }
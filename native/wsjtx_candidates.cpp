@@ -0,0 +1,180 @@
+/**
+ * wsjtx_candidates.cpp - FT8/FT4 sync candidate search for pipelined decoding
+ *
+ * The first stage of the decoder, lifted out so a scheduler can run it
+ * apart from demodulation and LDPC: a spectrogram at half-tone resolution
+ * and quarter-symbol steps, then the Costas-array sync statistic of
+ * WSJT-X's sync8 at every frequency and time lag. FFTs use the FFTW
+ * library wsjtx_lib already links, through the shared plan cache.
+ */
+
+#include "wsjtx_c_api.h"
+#include "wsjtx_fft.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+/* Sync layout of a Costas-synced mode */
+struct SyncLayout {
+    int tones;
+    int arrayLength;
+    int arrays;
+    int arrayStart[4];          /* first symbol of each Costas array */
+    int pattern[4][7];          /* tone of each symbol in each array */
+    double minDt, maxDt;        /* lag search range in seconds */
+};
+
+const SyncLayout FT8_SYNC = {
+    8, 7, 3, { 0, 36, 72, 0 },
+    { { 3, 1, 4, 0, 6, 5, 2 }, { 3, 1, 4, 0, 6, 5, 2 }, { 3, 1, 4, 0, 6, 5, 2 }, {} },
+    -2.5, 2.5,
+};
+
+const SyncLayout FT4_SYNC = {
+    4, 4, 4, { 0, 33, 66, 99 },
+    { { 0, 1, 3, 2 }, { 1, 0, 2, 3 }, { 2, 3, 1, 0 }, { 3, 2, 0, 1 } },
+    -1.0, 1.0,
+};
+
+const double NOMINAL_START = 0.5;   /* seconds into the slot at DT = 0 */
+const int STEPS_PER_SYMBOL = 4;
+const int BINS_PER_TONE = 2;
+const int MIN_SEPARATION = 2;       /* bins, i.e. one tone */
+
+/* Power spectrogram over bins [firstBin, firstBin + width) */
+struct Spectrogram {
+    int frames = 0, width = 0;
+    std::vector<float> power;   /* frames x width */
+    float at(int frame, int bin) const { return power[static_cast<size_t>(frame) * width + bin]; }
+};
+
+bool spectrogram(const float* x, int n, int nsps, int firstBin, int width, Spectrogram& out) {
+    const int nfft = 2 * nsps;
+    const int step = nsps / STEPS_PER_SYMBOL;
+    fftwf_plan plan = wsjtx_core::r2c_plan(nfft);
+    if (!plan) return false;
+    auto in = wsjtx_core::fftw_alloc<float>(nfft);
+    auto spec = wsjtx_core::fftw_alloc<fftwf_complex>(nfft / 2 + 1);
+    if (!in || !spec) return false;
+
+    out.frames = n < nsps ? 0 : (n - nsps) / step + 1;
+    out.width = width;
+    out.power.assign(static_cast<size_t>(out.frames) * width, 0.0f);
+    for (int m = 0; m < out.frames; m++) {
+        /* One symbol zero-padded to two: bins fall on half-tone spacing */
+        std::copy(x + static_cast<size_t>(m) * step, x + static_cast<size_t>(m) * step + nsps, in.get());
+        std::fill(in.get() + nsps, in.get() + nfft, 0.0f);
+        fftwf_execute_dft_r2c(plan, in.get(), spec.get());
+        float* row = &out.power[static_cast<size_t>(m) * width];
+        for (int b = 0; b < width; b++) {
+            const fftwf_complex& c = spec.get()[firstBin + b];
+            row[b] = c[0] * c[0] + c[1] * c[1];
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+WSJTX_API int wsjtx_find_candidates(int mode, const float* samples, int num_samples,
+    int low_freq, int high_freq, float min_score,
+    wsjtx_candidate_t* out_candidates, int max_candidates)
+{
+    const SyncLayout* layout = mode == WSJTX_MODE_FT8 ? &FT8_SYNC
+                             : mode == WSJTX_MODE_FT4 ? &FT4_SYNC : nullptr;
+    if (!layout) return WSJTX_ERR_INVALID_MODE;
+    if (!samples || num_samples <= 0 || !out_candidates || max_candidates <= 0 ||
+        low_freq < 0 || high_freq <= low_freq) return WSJTX_ERR_INVALID_ARG;
+
+    try {
+        const int rate = wsjtx_get_sample_rate(mode);
+        const int nsps = wsjtx_get_samples_per_symbol(mode);
+        const int step = nsps / STEPS_PER_SYMBOL;
+        const double df = static_cast<double>(rate) / (2 * nsps);
+        const int span = BINS_PER_TONE * (layout->tones - 1);
+        const int nyquistBin = nsps;
+        const int firstBin = std::max(1, static_cast<int>(low_freq / df));
+        const int lastBin = std::min(nyquistBin - span, static_cast<int>(high_freq / df));
+        if (lastBin <= firstBin) return 0;
+
+        Spectrogram s;
+        if (!spectrogram(samples, num_samples, nsps, firstBin, lastBin - firstBin + span + 1, s))
+            return WSJTX_ERR_EXCEPTION;
+        if (s.frames == 0) return 0;
+
+        /* Total power over the tone set at every (frame, start bin) */
+        const int bins = lastBin - firstBin + 1;
+        std::vector<float> toneSum(static_cast<size_t>(s.frames) * bins, 0.0f);
+        for (int m = 0; m < s.frames; m++)
+            for (int i = 0; i < bins; i++)
+                for (int t = 0; t < layout->tones; t++)
+                    toneSum[static_cast<size_t>(m) * bins + i] += s.at(m, i + BINS_PER_TONE * t);
+
+        /* Best sync over lags per start bin: Costas power against the mean of
+         * the other tones, over all arrays and over all but the first (late
+         * starts), as sync8 does */
+        const int nominal = static_cast<int>(std::lround(NOMINAL_START * rate / step));
+        const int minLag = static_cast<int>(std::floor(layout->minDt * rate / step));
+        const int maxLag = static_cast<int>(std::ceil(layout->maxDt * rate / step));
+        std::vector<float> best(bins, 0.0f);
+        std::vector<int> bestLag(bins, 0);
+        for (int i = 0; i < bins; i++) {
+            for (int lag = minLag; lag <= maxLag; lag++) {
+                double on[4] = {}, all[4] = {};
+                for (int a = 0; a < layout->arrays; a++) {
+                    for (int k = 0; k < layout->arrayLength; k++) {
+                        const int m = nominal + lag + STEPS_PER_SYMBOL * (layout->arrayStart[a] + k);
+                        if (m < 0 || m >= s.frames) continue;
+                        on[a] += s.at(m, i + BINS_PER_TONE * layout->pattern[a][k]);
+                        all[a] += toneSum[static_cast<size_t>(m) * bins + i];
+                    }
+                }
+                double onAll = 0, offAll = 0, onLate = 0, offLate = 0;
+                for (int a = 0; a < layout->arrays; a++) {
+                    onAll += on[a];
+                    offAll += all[a] - on[a];
+                    if (a > 0) { onLate += on[a]; offLate += all[a] - on[a]; }
+                }
+                const double others = layout->tones - 1;
+                const double sync = std::max(offAll > 0 ? onAll * others / offAll : 0.0,
+                                             offLate > 0 ? onLate * others / offLate : 0.0);
+                if (sync > best[i]) {
+                    best[i] = static_cast<float>(sync);
+                    bestLag[i] = lag;
+                }
+            }
+        }
+
+        /* Normalize by the 40th percentile so the score reads as "times the
+         * band's typical sync" */
+        std::vector<float> sorted(best);
+        std::nth_element(sorted.begin(), sorted.begin() + bins * 4 / 10, sorted.end());
+        const float base = sorted[bins * 4 / 10];
+        if (!(base > 0)) return 0;
+
+        std::vector<int> order(bins);
+        for (int i = 0; i < bins; i++) order[i] = i;
+        std::sort(order.begin(), order.end(), [&](int a, int b) { return best[a] > best[b]; });
+
+        int count = 0;
+        std::vector<int> taken;
+        for (int i : order) {
+            const float score = best[i] / base;
+            if (score < min_score || count >= max_candidates) break;
+            bool near = false;
+            for (int t : taken) near = near || std::abs(t - i) <= MIN_SEPARATION;
+            if (near) continue;
+            taken.push_back(i);
+            wsjtx_candidate_t& c = out_candidates[count++];
+            c.freq = static_cast<float>((firstBin + i) * df);
+            c.dt = static_cast<float>(bestLag[i] * step) / rate;
+            c.score = score;
+        }
+        return count;
+    } catch (...) {
+        return WSJTX_ERR_EXCEPTION;
+    }
+}
@@ -0,0 +1,228 @@
+/**
+ * wsjtx_clock.cpp - Sound-card sample-rate error estimation and correction
+ *
+ * A capture that cuts slots by counting samples drifts against the real
+ * slot boundaries when the card's clock is off nominal: every slot starts
+ * (period * error) seconds later than the one before, so the DT of decodes
+ * grows linearly at exactly the rate error. The estimator keeps the median
+ * DT of each slot over a time window and fits that line with the
+ * Theil-Sen estimator, which shrugs off the odd station with a bad clock.
+ * The resampler is a windowed-sinc polyphase interpolator that takes the
+ * audio back to the nominal rate before decoding.
+ */
+
+#include "wsjtx_c_api.h"
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+const int MIN_SLOTS = 4;
+const double MIN_SPAN_SECONDS = 60.0;
+const size_t MAX_POINTS = 512;        /* an hour of FT4; bounds the O(n^2) fit */
+const double MAD_TO_SIGMA = 1.4826;
+
+struct ClockPoint {
+    double time;    /* slot start, seconds */
+    double dt;      /* median DT of the slot's decodes */
+};
+
+class ClockEstimator {
+public:
+    explicit ClockEstimator(double window) : window_(window) {}
+
+    void observe(double time, const wsjtx_message_t* messages, int count) {
+        std::vector<double> dts(count);
+        for (int i = 0; i < count; i++) dts[i] = messages[i].dt;
+        points_.push_back({ time, median(dts) });
+        const double newest = std::max(time, newest_);
+        newest_ = newest;
+        while (!points_.empty() && (points_.front().time < newest - window_ || points_.size() > MAX_POINTS))
+            points_.pop_front();
+    }
+
+    bool estimate(wsjtx_clock_estimate_t* out) const {
+        const int n = static_cast<int>(points_.size());
+        if (n < MIN_SLOTS) return false;
+        double first = points_[0].time, last = points_[0].time;
+        for (const ClockPoint& p : points_) {
+            first = std::min(first, p.time);
+            last = std::max(last, p.time);
+        }
+        if (last - first < MIN_SPAN_SECONDS) return false;
+
+        /* Theil-Sen: median of the pairwise slopes, then the median intercept */
+        std::vector<double> slopes;
+        slopes.reserve(static_cast<size_t>(n) * (n - 1) / 2);
+        for (int i = 0; i < n; i++)
+            for (int j = i + 1; j < n; j++)
+                if (points_[j].time != points_[i].time)
+                    slopes.push_back((points_[j].dt - points_[i].dt) / (points_[j].time - points_[i].time));
+        if (slopes.empty()) return false;
+        const double slope = median(slopes);
+
+        std::vector<double> offsets(n);
+        for (int i = 0; i < n; i++) offsets[i] = points_[i].dt - slope * (points_[i].time - last);
+        const double offset = median(offsets);
+
+        /* Standard error of the slope from the residuals' MAD */
+        std::vector<double> residuals(n);
+        double meanTime = 0, spread = 0;
+        for (const ClockPoint& p : points_) meanTime += p.time / n;
+        for (int i = 0; i < n; i++) {
+            residuals[i] = std::fabs(offsets[i] - offset);
+            spread += (points_[i].time - meanTime) * (points_[i].time - meanTime);
+        }
+        const double sigma = MAD_TO_SIGMA * median(residuals);
+
+        out->ppm = slope * 1e6;
+        out->ppm_error = spread > 0 ? sigma / std::sqrt(spread) * 1e6 : 0.0;
+        out->dt_offset = offset;
+        out->slots = n;
+        return true;
+    }
+
+    void clear() {
+        points_.clear();
+        newest_ = -HUGE_VAL;
+    }
+
+    std::mutex mutex;
+
+private:
+    static double median(std::vector<double>& v) {
+        auto mid = v.begin() + v.size() / 2;
+        std::nth_element(v.begin(), mid, v.end());
+        return *mid;
+    }
+
+    double window_;
+    double newest_ = -HUGE_VAL;
+    std::deque<ClockPoint> points_;
+};
+
+inline ClockEstimator* to_clock(wsjtx_clock_t c) {
+    return static_cast<ClockEstimator*>(c);
+}
+
+/* Interpolation filter: PHASES + 1 rows of 2 * half taps, row p holding the
+ * windowed sinc at fractional offset p / PHASES, each row normalized to
+ * unity DC gain. Rows are linearly interpolated between. */
+const int PHASES = 256;
+const int TAPS_PER_SIDE = 16;
+const double CUTOFF = 0.45;     /* of the lower of the two rates */
+
+std::vector<float> filter_table(double ratio, int half) {
+    const double PI = 3.14159265358979323846;
+    const double fc = CUTOFF * std::min(1.0, ratio);    /* cycles per input sample */
+    const int taps = 2 * half;
+    std::vector<float> table(static_cast<size_t>(PHASES + 1) * taps);
+    for (int p = 0; p <= PHASES; p++) {
+        const double frac = static_cast<double>(p) / PHASES;
+        float* row = &table[static_cast<size_t>(p) * taps];
+        double sum = 0;
+        for (int k = 0; k < taps; k++) {
+            /* tap k weighs input sample floor(x) + k - half + 1 */
+            const double t = frac - (k - half + 1);
+            const double arg = 2.0 * PI * fc * t;
+            const double sinc = std::fabs(t) < 1e-12 ? 2.0 * fc : std::sin(arg) / (PI * t);
+            const double u = (t + half) / (2.0 * half);     /* Blackman over [-half, half] */
+            const double w = u <= 0 || u >= 1 ? 0.0
+                : 0.42 - 0.5 * std::cos(2.0 * PI * u) + 0.08 * std::cos(4.0 * PI * u);
+            row[k] = static_cast<float>(sinc * w);
+            sum += row[k];
+        }
+        for (int k = 0; k < taps; k++) row[k] = static_cast<float>(row[k] / sum);
+    }
+    return table;
+}
+
+} // namespace
+
+WSJTX_API wsjtx_clock_t wsjtx_clock_create(double window_seconds) {
+    if (!(window_seconds >= MIN_SPAN_SECONDS)) return nullptr;
+    try {
+        return static_cast<wsjtx_clock_t>(new ClockEstimator(window_seconds));
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+WSJTX_API void wsjtx_clock_destroy(wsjtx_clock_t clock) {
+    delete to_clock(clock);
+}
+
+WSJTX_API int wsjtx_clock_observe(wsjtx_clock_t clock, double slot_time,
+    const wsjtx_message_t* messages, int count)
+{
+    if (!clock) return WSJTX_ERR_INVALID_HANDLE;
+    if (count < 0 || (count > 0 && !messages) || !std::isfinite(slot_time)) return WSJTX_ERR_INVALID_ARG;
+    if (count == 0) return WSJTX_OK;
+    try {
+        ClockEstimator* c = to_clock(clock);
+        std::lock_guard<std::mutex> lock(c->mutex);
+        c->observe(slot_time, messages, count);
+        return WSJTX_OK;
+    } catch (...) {
+        return WSJTX_ERR_EXCEPTION;
+    }
+}
+
+WSJTX_API int wsjtx_clock_estimate(wsjtx_clock_t clock, wsjtx_clock_estimate_t* out) {
+    if (!clock) return WSJTX_ERR_INVALID_HANDLE;
+    if (!out) return WSJTX_ERR_INVALID_ARG;
+    try {
+        ClockEstimator* c = to_clock(clock);
+        std::lock_guard<std::mutex> lock(c->mutex);
+        return c->estimate(out) ? 1 : 0;
+    } catch (...) {
+        return WSJTX_ERR_EXCEPTION;
+    }
+}
+
+WSJTX_API void wsjtx_clock_clear(wsjtx_clock_t clock) {
+    if (!clock) return;
+    ClockEstimator* c = to_clock(clock);
+    std::lock_guard<std::mutex> lock(c->mutex);
+    c->clear();
+}
+
+WSJTX_API int wsjtx_resample(const float* in, int num_in, double ratio, float* out, int out_size) {
+    if (!in || num_in <= 0 || !out || out_size <= 0 || !(ratio >= 0.5 && ratio <= 2.0))
+        return WSJTX_ERR_INVALID_ARG;
+    try {
+        /* Downsampling widens the filter to keep its transition band in
+         * output-rate terms */
+        const int half = static_cast<int>(std::ceil(TAPS_PER_SIDE / std::min(1.0, ratio)));
+        const int taps = 2 * half;
+        const std::vector<float> table = filter_table(ratio, half);
+        const int count = static_cast<int>(std::min<double>(out_size, std::floor(num_in * ratio)));
+
+        for (int j = 0; j < count; j++) {
+            const double x = j / ratio;
+            const int base = static_cast<int>(std::floor(x));
+            const double pos = (x - base) * PHASES;
+            const int p = std::min(PHASES - 1, static_cast<int>(pos));
+            const float f = static_cast<float>(pos - p);
+            const float* lo = &table[static_cast<size_t>(p) * taps];
+            const float* hi = lo + taps;
+            const int first = base - half + 1;
+            float y = 0.0f;
+            if (first >= 0 && first + taps <= num_in) {
+                for (int k = 0; k < taps; k++) y += in[first + k] * (lo[k] + f * (hi[k] - lo[k]));
+            } else {
+                for (int k = 0; k < taps; k++) {
+                    const int i = first + k;
+                    if (i >= 0 && i < num_in) y += in[i] * (lo[k] + f * (hi[k] - lo[k]));
+                }
+            }
+            out[j] = y;
+        }
+        return count;
+    } catch (...) {
+        return WSJTX_ERR_EXCEPTION;
+    }
+}
@@ -0,0 +1,101 @@
+/**
+ * wsjtx_columnar.cpp - Apache Arrow-compatible columnar export for the C API
+ *
+ * Lays decoded messages out as Arrow columns (utf8 text plus fixed-width
+ * numeric columns) in one caller-provided buffer. No Arrow dependency: the
+ * format is simple enough to write directly, and consumers wrap the spans
+ * without copying.
+ */
+
+#include "wsjtx_c_api.h"
+#include <cstring>
+
+namespace {
+
+const int64_t ALIGNMENT = 64;   /* Arrow's recommended buffer alignment/padding */
+
+inline int64_t align_up(int64_t n) {
+    return (n + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+}
+
+inline int64_t text_length(const wsjtx_message_t& m) {
+    return static_cast<int64_t>(strnlen(m.msg, sizeof(m.msg)));
+}
+
+/* Assign consecutive aligned spans; returns the total size */
+int64_t plan(const wsjtx_message_t* msgs, int count, wsjtx_columnar_layout_t* l) {
+    int64_t textBytes = 0;
+    for (int i = 0; i < count; i++) textBytes += text_length(msgs[i]);
+
+    int64_t pos = 0;
+    auto span = [&pos](wsjtx_buffer_span_t& s, int64_t len) {
+        s.offset = pos;
+        s.length = len;
+        pos += align_up(len);
+    };
+
+    memset(l, 0, sizeof(*l));
+    l->length = count;
+    l->null_count = 0;
+    span(l->text_validity, (count + 7) / 8);
+    span(l->text_offsets, static_cast<int64_t>(count + 1) * 4);
+    span(l->text_data, textBytes);
+    span(l->snr, static_cast<int64_t>(count) * 4);
+    span(l->dt, static_cast<int64_t>(count) * 4);
+    span(l->freq, static_cast<int64_t>(count) * 4);
+    span(l->sync, static_cast<int64_t>(count) * 4);
+    span(l->time, static_cast<int64_t>(count) * 4);
+    return pos;
+}
+
+template <typename T>
+inline T* column(uint8_t* buf, const wsjtx_buffer_span_t& s) {
+    return reinterpret_cast<T*>(buf + s.offset);
+}
+
+} // namespace
+
+WSJTX_API int64_t wsjtx_columnar_size(const wsjtx_message_t* messages, int count) {
+    if (count < 0 || (count > 0 && !messages)) return WSJTX_ERR_INVALID_ARG;
+    wsjtx_columnar_layout_t layout;
+    return plan(messages, count, &layout);
+}
+
+WSJTX_API int64_t wsjtx_columnar_export(const wsjtx_message_t* messages, int count,
+    uint8_t* buffer, int64_t size, wsjtx_columnar_layout_t* out_layout)
+{
+    if (count < 0 || (count > 0 && !messages) || !buffer || !out_layout) return WSJTX_ERR_INVALID_ARG;
+
+    wsjtx_columnar_layout_t& l = *out_layout;
+    int64_t total = plan(messages, count, &l);
+    if (size < total) return WSJTX_ERR_BUFFER_TOO_SMALL;
+
+    /* Zero everything once: covers padding and the unused validity bits */
+    memset(buffer, 0, static_cast<size_t>(total));
+
+    uint8_t* validity = column<uint8_t>(buffer, l.text_validity);
+    int32_t* offsets = column<int32_t>(buffer, l.text_offsets);
+    uint8_t* data = column<uint8_t>(buffer, l.text_data);
+    int32_t* snr = column<int32_t>(buffer, l.snr);
+    float* dt = column<float>(buffer, l.dt);
+    int32_t* freq = column<int32_t>(buffer, l.freq);
+    float* sync = column<float>(buffer, l.sync);
+    int32_t* time = column<int32_t>(buffer, l.time);
+
+    int32_t off = 0;
+    for (int i = 0; i < count; i++) {
+        const wsjtx_message_t& m = messages[i];
+        int64_t n = text_length(m);
+        validity[i / 8] |= static_cast<uint8_t>(1u << (i % 8));
+        offsets[i] = off;
+        memcpy(data + off, m.msg, static_cast<size_t>(n));
+        off += static_cast<int32_t>(n);
+        snr[i] = m.snr;
+        dt[i] = m.dt;
+        freq[i] = m.freq;
+        sync[i] = m.sync;
+        time[i] = m.hh * 3600 + m.min * 60 + m.sec;
+    }
+    offsets[count] = off;
+    return total;
+}
@@ -0,0 +1,356 @@
+/**
+ * wsjtx_coro.hpp - C++20 coroutine API over the C API
+ *
+ * Header-only, for C++ programs that link wsjtx_core directly. decode(),
+ * encode() and decode_wspr() return awaitables that run the blocking call
+ * on the core's job pool (wsjtx_pool_submit) and resume the awaiting
+ * coroutine on that pool thread; failures are thrown as wsjtx::Error.
+ * Task<T> is a lazy coroutine type to compose them, when_all() runs tasks
+ * concurrently and sync_wait() drives a task from ordinary code.
+ *
+ *     wsjtx::Task<std::vector<wsjtx_message_t>> slot(wsjtx_handle_t h, std::vector<float> audio) {
+ *         co_return co_await wsjtx::decode(h, WSJTX_MODE_FT8, std::move(audio),
+ *                                          wsjtx::decode_options(1500));
+ *     }
+ *     auto messages = wsjtx::sync_wait(slot(handle, std::move(audio)));
+ *
+ * As with the Node workers, a handle decodes one slot at a time: run
+ * concurrent decodes on separate handles. Neither the decode watchdog nor
+ * per-receiver accounting applies here.
+ */
+
+#pragma once
+
+#include "wsjtx_c_api.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace wsjtx {
+
+/* A negative status from the C API */
+class Error : public std::runtime_error {
+public:
+    Error(const std::string& what, int code) : std::runtime_error(what), code_(code) {}
+    int code() const noexcept { return code_; }
+
+private:
+    int code_;
+};
+
+struct Encoded {
+    std::vector<float> audio;
+    std::string message_sent;
+};
+
+/* The v2 decode options with the Node binding's defaults */
+inline wsjtx_decode_options_t decode_options(int frequency, int threads = 1) {
+    wsjtx_decode_options_t o = {};
+    o.frequency = frequency;
+    o.threads = threads;
+    o.low_freq = 200;
+    o.high_freq = 4000;
+    o.tolerance = 20;
+    return o;
+}
+
+template <typename T = void>
+class Task;
+
+namespace detail {
+
+inline void check(int rc, const char* what) {
+    if (rc < 0) throw Error(std::string(what) + " failed with error code " + std::to_string(rc), rc);
+}
+
+/* Everything the last decode on `handle` queued */
+inline std::vector<wsjtx_message_t> pull_all(wsjtx_handle_t handle) {
+    std::vector<wsjtx_message_t> messages(200);
+    size_t n = 0;
+    for (int got; (got = wsjtx_pull_messages(handle, messages.data() + n, static_cast<int>(messages.size() - n))) > 0;) {
+        n += static_cast<size_t>(got);
+        if (n == messages.size()) messages.resize(n * 2);
+    }
+    messages.resize(n);
+    return messages;
+}
+
+/* Runs fn() on the core pool; the awaiting coroutine resumes on that thread */
+template <typename Fn>
+class PoolOp {
+public:
+    using Result = std::invoke_result_t<Fn&>;
+
+    explicit PoolOp(Fn fn) : fn_(std::move(fn)) {}
+
+    bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> caller) {
+        caller_ = caller;
+        const int rc = wsjtx_pool_submit(&PoolOp::run, this);
+        if (rc != WSJTX_OK) throw Error("Could not queue the job on the core pool", rc);
+    }
+
+    Result await_resume() {
+        if (error_) std::rethrow_exception(error_);
+        return std::move(*result_);
+    }
+
+private:
+    static void run(void* p) {
+        PoolOp* op = static_cast<PoolOp*>(p);
+        try {
+            op->result_.emplace(op->fn_());
+        } catch (...) {
+            op->error_ = std::current_exception();
+        }
+        op->caller_.resume();   /* may destroy *op, so nothing after this */
+    }
+
+    Fn fn_;
+    std::optional<Result> result_;
+    std::exception_ptr error_;
+    std::coroutine_handle<> caller_;
+};
+
+template <typename Fn>
+PoolOp<Fn> on_pool(Fn fn) {
+    return PoolOp<Fn>(std::move(fn));
+}
+
+struct PromiseBase {
+    std::coroutine_handle<> continuation = std::noop_coroutine();
+    std::exception_ptr error;
+
+    struct FinalAwaiter {
+        bool await_ready() const noexcept { return false; }
+        template <typename P>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) noexcept {
+            return h.promise().continuation;
+        }
+        void await_resume() const noexcept {}
+    };
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    FinalAwaiter final_suspend() const noexcept { return {}; }
+    void unhandled_exception() noexcept { error = std::current_exception(); }
+};
+
+template <typename T>
+struct Promise : PromiseBase {
+    std::optional<T> value;
+    template <typename U>
+    void return_value(U&& v) { value.emplace(std::forward<U>(v)); }
+    T take() { return std::move(*value); }
+};
+
+template <>
+struct Promise<void> : PromiseBase {
+    void return_void() const noexcept {}
+    void take() const noexcept {}
+};
+
+/* Fire-and-forget coroutine: starts at once and frees itself at the end */
+struct Detached {
+    struct promise_type {
+        Detached get_return_object() const noexcept { return {}; }
+        std::suspend_never initial_suspend() const noexcept { return {}; }
+        std::suspend_never final_suspend() const noexcept { return {}; }
+        void return_void() const noexcept {}
+        void unhandled_exception() const noexcept { std::terminate(); }
+    };
+};
+
+} // namespace detail
+
+/* A lazy coroutine: it starts when awaited and resumes its awaiter when done */
+template <typename T>
+class Task {
+public:
+    struct promise_type : detail::Promise<T> {
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+    };
+
+    Task(Task&& other) noexcept : h_(std::exchange(other.h_, nullptr)) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (h_) h_.destroy();
+            h_ = std::exchange(other.h_, nullptr);
+        }
+        return *this;
+    }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task() { if (h_) h_.destroy(); }
+
+    auto operator co_await() noexcept {
+        struct Awaiter {
+            std::coroutine_handle<promise_type> h;
+            bool await_ready() const noexcept { return !h || h.done(); }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept {
+                h.promise().continuation = caller;
+                return h;
+            }
+            T await_resume() {
+                if (h.promise().error) std::rethrow_exception(h.promise().error);
+                return h.promise().take();
+            }
+        };
+        return Awaiter{ h_ };
+    }
+
+private:
+    explicit Task(std::coroutine_handle<promise_type> h) : h_(h) {}
+    std::coroutine_handle<promise_type> h_;
+};
+
+/* ---- Operations ---- */
+
+/* Decode one slot of float audio; messages in decoder order */
+inline auto decode(wsjtx_handle_t handle, int mode, std::vector<float> samples, wsjtx_decode_options_t options) {
+    return detail::on_pool([=, samples = std::move(samples)]() {
+        detail::check(wsjtx_decode_float_v2(handle, mode, samples.data(), static_cast<int>(samples.size()), &options),
+            "Decode");
+        return detail::pull_all(handle);
+    });
+}
+
+/* Decode one slot of 16-bit audio */
+inline auto decode(wsjtx_handle_t handle, int mode, std::vector<int16_t> samples, wsjtx_decode_options_t options) {
+    return detail::on_pool([=, samples = std::move(samples)]() {
+        detail::check(wsjtx_decode_int16_v2(handle, mode, samples.data(), static_cast<int>(samples.size()), &options),
+            "Decode");
+        return detail::pull_all(handle);
+    });
+}
+
+/* One transmission of `message` with its lowest tone at `frequency` Hz */
+inline auto encode(wsjtx_handle_t handle, int mode, std::string message, int frequency) {
+    return detail::on_pool([=, message = std::move(message)]() {
+        Encoded out;
+        out.audio.resize(static_cast<size_t>(std::max(1, wsjtx_get_waveform_samples(mode))));
+        int numSamples = 0;
+        char sent[256] = {};
+        detail::check(wsjtx_encode(handle, mode, frequency, message.c_str(), out.audio.data(), &numSamples,
+            static_cast<int>(out.audio.size()), sent, sizeof(sent)), "Encode");
+        out.audio.resize(static_cast<size_t>(numSamples));
+        out.message_sent = sent;
+        return out;
+    });
+}
+
+/* Decode WSPR from interleaved IQ samples [re0, im0, re1, im1, ...] */
+inline auto decode_wspr(wsjtx_handle_t handle, std::vector<float> iq_interleaved, wsjtx_decoder_options_t options) {
+    return detail::on_pool([=, iq = std::move(iq_interleaved)]() mutable {
+        std::vector<wsjtx_decoder_result_t> results(256);
+        const int n = wsjtx_wspr_decode(handle, iq.data(), static_cast<int>(iq.size() / 2), &options,
+            results.data(), static_cast<int>(results.size()));
+        detail::check(n, "WSPR decode");
+        results.resize(static_cast<size_t>(n));
+        return results;
+    });
+}
+
+/* ---- Composition ---- */
+
+namespace detail {
+
+template <typename T>
+class WhenAll {
+public:
+    explicit WhenAll(std::vector<Task<T>> tasks)
+        : tasks_(std::move(tasks)), results_(tasks_.size()), remaining_(tasks_.size() + 1) {}
+
+    bool await_ready() const noexcept { return tasks_.empty(); }
+
+    /* The extra count is this call's own, so the last of the tasks and this
+     * call agree on who resumes the awaiter */
+    bool await_suspend(std::coroutine_handle<> caller) {
+        caller_ = caller;
+        for (size_t i = 0; i < tasks_.size(); i++) drive(*this, i);
+        return --remaining_ != 0;
+    }
+
+    std::vector<T> await_resume() {
+        if (error_) std::rethrow_exception(error_);
+        std::vector<T> out;
+        out.reserve(results_.size());
+        for (auto& r : results_) out.push_back(std::move(*r));
+        return out;
+    }
+
+private:
+    static Detached drive(WhenAll& all, size_t i) {
+        try {
+            all.results_[i].emplace(co_await all.tasks_[i]);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(all.mutex_);
+            if (!all.error_) all.error_ = std::current_exception();
+        }
+        if (--all.remaining_ == 0) all.caller_.resume();
+    }
+
+    std::vector<Task<T>> tasks_;
+    std::vector<std::optional<T>> results_;
+    std::atomic<size_t> remaining_;
+    std::mutex mutex_;
+    std::exception_ptr error_;
+    std::coroutine_handle<> caller_;
+};
+
+template <typename T>
+struct SyncState {
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool done = false;
+    std::optional<std::conditional_t<std::is_void_v<T>, bool, T>> value;
+    std::exception_ptr error;
+};
+
+template <typename T>
+Detached sync_drive(Task<T>& task, SyncState<T>& state) {
+    try {
+        if constexpr (std::is_void_v<T>) {
+            co_await task;
+        } else {
+            state.value.emplace(co_await task);
+        }
+    } catch (...) {
+        state.error = std::current_exception();
+    }
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.done = true;
+    state.cv.notify_one();
+}
+
+} // namespace detail
+
+/* Run every task concurrently; results in task order, the first error rethrown */
+template <typename T>
+Task<std::vector<T>> when_all(std::vector<Task<T>> tasks) {
+    static_assert(!std::is_void_v<T>, "when_all collects results");
+    co_return co_await detail::WhenAll<T>(std::move(tasks));
+}
+
+/* Block the calling thread until `task` completes. Never call it from a
+ * pool thread: the task may need that thread to finish. */
+template <typename T>
+T sync_wait(Task<T> task) {
+    detail::SyncState<T> state;
+    detail::sync_drive(task, state);
+    std::unique_lock<std::mutex> lock(state.mutex);
+    state.cv.wait(lock, [&state] { return state.done; });
+    if (state.error) std::rethrow_exception(state.error);
+    if constexpr (!std::is_void_v<T>) return std::move(*state.value);
+}
+
+} // namespace wsjtx
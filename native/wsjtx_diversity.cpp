@@ -0,0 +1,219 @@
+/**
+ * wsjtx_diversity.cpp - Maximal-ratio combining of several receivers
+ *
+ * Each receiver's slot is taken to the short-time spectrum (sqrt-Hann
+ * frames of 0.16 s, half overlap, so synthesis reconstructs exactly) and
+ * whitened by its median bin power. In every bin the receivers' spatial
+ * covariance is accumulated over neighbouring bins and about two seconds
+ * of frames (HF fading is slower than that); its principal eigenvector is
+ * the channel estimate, and projecting onto it co-phases the receivers and
+ * weights each by its own SNR there.
+ * The combined spectrum is resynthesized at the noise level of the inputs,
+ * so the decoder sees ordinary audio.
+ */
+
+#include "wsjtx_c_api.h"
+#include "wsjtx_fft.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <vector>
+
+namespace {
+
+typedef std::complex<float> cfloat;
+
+const double FRAME_SECONDS = 0.16;  /* one FT8 symbol: 6.25 Hz bins */
+const int SMOOTH_FRAMES = 12;       /* covariance over +-12 hops (~2 s) */
+const int SMOOTH_BINS = 4;          /* and +-25 Hz, an FT8 signal's width */
+const int POWER_ITERATIONS = 4;     /* per frame, warm-started from the last */
+const float ANCHOR_MIN = 1e-4f;     /* |v_ref|^2 below this leaves the phase as is */
+
+/* Short-time spectra of every channel: channel x frame x bin */
+struct Spectra {
+    int channels = 0, frames = 0, bins = 0;
+    std::vector<cfloat> data;
+    cfloat* row(int c, int f) { return &data[(static_cast<size_t>(c) * frames + f) * bins]; }
+};
+
+/* Frame f covers samples [(f - 1) * hop, (f + 1) * hop), so every sample
+ * lies in exactly two frames */
+bool analyze(const float* const* channels, int numChannels, int n, int frame,
+    const std::vector<float>& window, Spectra& s)
+{
+    const int hop = frame / 2;
+    fftwf_plan plan = wsjtx_core::r2c_plan(frame);
+    auto in = wsjtx_core::fftw_alloc<float>(frame);
+    auto out = wsjtx_core::fftw_alloc<fftwf_complex>(frame / 2 + 1);
+    if (!plan || !in || !out) return false;
+
+    s.channels = numChannels;
+    s.frames = (n - 1) / hop + 2;
+    s.bins = frame / 2 + 1;
+    s.data.assign(static_cast<size_t>(numChannels) * s.frames * s.bins, cfloat());
+    for (int c = 0; c < numChannels; c++) {
+        for (int f = 0; f < s.frames; f++) {
+            const int start = (f - 1) * hop;
+            for (int k = 0; k < frame; k++) {
+                const int t = start + k;
+                in.get()[k] = t >= 0 && t < n ? channels[c][t] * window[k] : 0.0f;
+            }
+            fftwf_execute_dft_r2c(plan, in.get(), out.get());
+            cfloat* row = s.row(c, f);
+            for (int b = 0; b < s.bins; b++) row[b] = cfloat(out.get()[b][0], out.get()[b][1]);
+        }
+    }
+    return true;
+}
+
+/* Noise amplitude of one channel: median bin power over the slot, which
+ * sparse signals barely move, rescaled from median to mean (ln 2) */
+float noise_floor(Spectra& s, int c) {
+    std::vector<float> power;
+    power.reserve(static_cast<size_t>(s.frames) * (s.bins - 1));
+    for (int f = 0; f < s.frames; f++) {
+        const cfloat* row = s.row(c, f);
+        for (int b = 1; b < s.bins; b++) power.push_back(std::norm(row[b]));
+    }
+    if (power.empty()) return 0.0f;
+    auto mid = power.begin() + power.size() / 2;
+    std::nth_element(power.begin(), mid, power.end());
+    return std::sqrt(*mid / 0.6931472f);
+}
+
+} // namespace
+
+WSJTX_API int wsjtx_combine_diversity(int mode, const float* const* channels, int num_channels,
+    int num_samples, float* out)
+{
+    if (!wsjtx_is_decoding_supported(mode) || mode == WSJTX_MODE_WSPR) return WSJTX_ERR_INVALID_MODE;
+    if (!channels || num_channels < 2 || num_channels > WSJTX_MAX_DIVERSITY ||
+        num_samples <= 0 || !out) return WSJTX_ERR_INVALID_ARG;
+    for (int c = 0; c < num_channels; c++)
+        if (!channels[c]) return WSJTX_ERR_INVALID_ARG;
+
+    try {
+        const int C = num_channels;
+        const int frame = 2 * static_cast<int>(std::lround(wsjtx_get_sample_rate(mode) * FRAME_SECONDS / 2));
+        const int hop = frame / 2;
+        const double PI = 3.14159265358979323846;
+        std::vector<float> window(frame);
+        for (int k = 0; k < frame; k++) window[k] = static_cast<float>(std::sin(PI * k / frame));
+
+        Spectra s;
+        if (!analyze(channels, C, num_samples, frame, window, s)) return WSJTX_ERR_EXCEPTION;
+
+        /* Whiten; a silent channel gets weight 0 rather than a division by 0.
+         * The receiver with the most power over its noise is the phase
+         * reference for the output. */
+        std::vector<float> sigma(C);
+        float level = 0.0f;
+        int live = 0, ref = 0;
+        double refEnergy = -1.0;
+        for (int c = 0; c < C; c++) {
+            sigma[c] = noise_floor(s, c);
+            const float g = sigma[c] > 0 ? 1.0f / sigma[c] : 0.0f;
+            double energy = 0.0;
+            for (int f = 0; f < s.frames; f++) {
+                cfloat* row = s.row(c, f);
+                for (int b = 0; b < s.bins; b++) {
+                    row[b] *= g;
+                    energy += std::norm(row[b]);
+                }
+            }
+            if (sigma[c] > 0) { level += sigma[c]; live++; }
+            if (energy > refEnergy) { refEnergy = energy; ref = c; }
+        }
+        if (live == 0) {
+            std::fill(out, out + num_samples, 0.0f);
+            return WSJTX_OK;
+        }
+        level /= live;
+
+        /* Per bin: covariance of the neighbouring bins, summed over a sliding
+         * window of frames through prefix sums, then its principal vector */
+        const size_t CC = static_cast<size_t>(C) * C;
+        std::vector<cfloat> combined(static_cast<size_t>(s.frames) * s.bins);
+        std::vector<cfloat> local(static_cast<size_t>(s.frames + 1) * CC);   /* prefix sums */
+        std::vector<cfloat> R(CC), v(C), w(C), prev(C);
+        for (int b = 0; b < s.bins; b++) {
+            const int b0 = std::max(0, b - SMOOTH_BINS), b1 = std::min(s.bins - 1, b + SMOOTH_BINS);
+            for (int f = 0; f < s.frames; f++) {
+                cfloat* acc = &local[(f + 1) * CC];
+                std::copy(&local[f * CC], &local[f * CC] + CC, acc);
+                for (int bb = b0; bb <= b1; bb++)
+                    for (int i = 0; i < C; i++) {
+                        const cfloat xi = s.row(i, f)[bb];
+                        for (int j = 0; j < C; j++) acc[i * C + j] += xi * std::conj(s.row(j, f)[bb]);
+                    }
+            }
+
+            std::fill(prev.begin(), prev.end(), cfloat());
+            for (int f = 0; f < s.frames; f++) {
+                const int f0 = std::max(0, f - SMOOTH_FRAMES), f1 = std::min(s.frames - 1, f + SMOOTH_FRAMES);
+                for (size_t k = 0; k < CC; k++) R[k] = local[(f1 + 1) * CC + k] - local[f0 * CC + k];
+
+                /* Start from the last frame's vector, or the strongest receiver */
+                if (f == 0) {
+                    int strongest = 0;
+                    for (int i = 1; i < C; i++)
+                        if (R[i * C + i].real() > R[strongest * C + strongest].real()) strongest = i;
+                    std::fill(v.begin(), v.end(), cfloat());
+                    v[strongest] = 1.0f;
+                } else {
+                    v = prev;
+                }
+                for (int it = 0; it < POWER_ITERATIONS; it++) {
+                    float norm = 0.0f;
+                    for (int i = 0; i < C; i++) {
+                        cfloat sum = 0.0f;
+                        for (int j = 0; j < C; j++) sum += R[i * C + j] * v[j];
+                        w[i] = sum;
+                        norm += std::norm(sum);
+                    }
+                    if (!(norm > 0)) break;
+                    const float scale = 1.0f / std::sqrt(norm);
+                    for (int i = 0; i < C; i++) v[i] = w[i] * scale;
+                }
+
+                /* The eigenvector's phase is arbitrary; pin it to the reference
+                 * receiver so every bin and frame shares one phase origin */
+                const cfloat anchor = std::norm(v[ref]) > ANCHOR_MIN ? v[ref] : cfloat();
+                if (std::abs(anchor) > 0) {
+                    const cfloat unit = std::conj(anchor) / std::abs(anchor);
+                    for (int i = 0; i < C; i++) v[i] *= unit;
+                }
+                prev = v;
+
+                cfloat y = 0.0f;
+                for (int i = 0; i < C; i++) y += std::conj(v[i]) * s.row(i, f)[b];
+                combined[static_cast<size_t>(f) * s.bins + b] = y;
+            }
+        }
+
+        /* Overlap-add synthesis back at the inputs' noise level */
+        fftwf_plan plan = wsjtx_core::c2r_plan(frame);
+        auto bins = wsjtx_core::fftw_alloc<fftwf_complex>(s.bins);
+        auto time = wsjtx_core::fftw_alloc<float>(frame);
+        if (!plan || !bins || !time) return WSJTX_ERR_EXCEPTION;
+        std::vector<float> sum(num_samples, 0.0f);
+        const float gain = level / frame;
+        for (int f = 0; f < s.frames; f++) {
+            for (int b = 0; b < s.bins; b++) {
+                const cfloat y = combined[static_cast<size_t>(f) * s.bins + b];
+                bins.get()[b][0] = y.real();
+                bins.get()[b][1] = y.imag();
+            }
+            fftwf_execute_dft_c2r(plan, bins.get(), time.get());
+            const int start = (f - 1) * hop;
+            for (int k = 0; k < frame; k++) {
+                const int t = start + k;
+                if (t >= 0 && t < num_samples) sum[t] += time.get()[k] * window[k] * gain;
+            }
+        }
+        std::copy(sum.begin(), sum.end(), out);
+        return WSJTX_OK;
+    } catch (...) {
+        return WSJTX_ERR_EXCEPTION;
+    }
+}
@@ -0,0 +1,49 @@
+/**
+ * wsjtx_fft.cpp - Process-wide FFTW plan cache
+ */
+
+#include "wsjtx_fft.h"
+#include <map>
+#include <mutex>
+
+namespace wsjtx_core {
+
+namespace {
+
+#ifdef WSJTX_FFTW_THREADS
+std::once_flag g_init;
+#endif
+std::mutex g_plan_mutex;        /* guards the caches; FFTW guards its planner */
+std::map<int, fftwf_plan> g_r2c;
+std::map<int, fftwf_plan> g_c2r;
+
+/* Plans are made on scratch arrays of the right alignment and size */
+fftwf_plan plan(std::map<int, fftwf_plan>& cache, int n, bool forward) {
+    if (n <= 0) return nullptr;
+    fft_init();
+    std::lock_guard<std::mutex> lock(g_plan_mutex);
+    auto it = cache.find(n);
+    if (it != cache.end()) return it->second;
+    auto real = fftw_alloc<float>(n);
+    auto bins = fftw_alloc<fftwf_complex>(n / 2 + 1);
+    if (!real || !bins) return nullptr;
+    fftwf_plan p = forward
+        ? fftwf_plan_dft_r2c_1d(n, real.get(), bins.get(), FFTW_ESTIMATE)
+        : fftwf_plan_dft_c2r_1d(n, bins.get(), real.get(), FFTW_ESTIMATE);
+    if (p) cache[n] = p;
+    return p;
+}
+
+} // namespace
+
+void fft_init() {
+#ifdef WSJTX_FFTW_THREADS
+    std::call_once(g_init, [] { fftwf_make_planner_thread_safe(); });
+#endif
+    /* Without fftw3f_threads only the plans made here are serialized */
+}
+
+fftwf_plan r2c_plan(int n) { return plan(g_r2c, n, true); }
+fftwf_plan c2r_plan(int n) { return plan(g_c2r, n, false); }
+
+} // namespace wsjtx_core
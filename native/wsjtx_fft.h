@@ -0,0 +1,46 @@
+/**
+ * wsjtx_fft.h - Internal FFTW helpers for wsjtx_core
+ *
+ * Single-precision plans shared by the native signal stages (candidate
+ * search, diversity combining), created once per size and kept for the
+ * life of the process. FFTW's planner is not thread-safe, and wsjtx_lib
+ * plans its own transforms on decoder threads, so fft_init() switches it
+ * to FFTW's thread-safe planner once (when fftw3f_threads is linked)
+ * before either plans. Callers execute the plans on their own arrays with
+ * fftwf_execute_dft_r2c / fftwf_execute_dft_c2r, which is thread-safe.
+ * Not part of the exported ABI.
+ */
+
+#ifndef WSJTX_FFT_H
+#define WSJTX_FFT_H
+
+#include <fftw3.h>
+#include <cstddef>
+#include <memory>
+
+namespace wsjtx_core {
+
+struct FftwDeleter {
+    void operator()(void* p) const { fftwf_free(p); }
+};
+
+/* SIMD-aligned buffer, as FFTW's new-array execute functions require */
+template <typename T>
+using FftwBuffer = std::unique_ptr<T, FftwDeleter>;
+
+template <typename T>
+FftwBuffer<T> fftw_alloc(size_t n) {
+    return FftwBuffer<T>(static_cast<T*>(fftwf_malloc(sizeof(T) * n)));
+}
+
+/* Make FFTW's planner thread-safe; idempotent, called from wsjtx_create */
+void fft_init();
+
+/* Real-to-complex (n real in, n/2 + 1 bins out) and the inverse, which is
+ * unnormalized and overwrites its input. Null if FFTW cannot plan n. */
+fftwf_plan r2c_plan(int n);
+fftwf_plan c2r_plan(int n);
+
+} // namespace wsjtx_core
+
+#endif /* WSJTX_FFT_H */
@@ -0,0 +1,55 @@
+/**
+ * wsjtx_fortran.h - Prototypes for the WSJT-X Fortran tone generators
+ *
+ * These routines are compiled into wsjtx_lib with the decoders, which use
+ * them for signal subtraction. gfortran appends one hidden length argument
+ * per CHARACTER dummy, in order, after the regular arguments; strings are
+ * blank-padded, not NUL-terminated. The routines keep SAVEd packing state,
+ * so callers must serialize them. Not part of the exported ABI.
+ */
+
+#ifndef WSJTX_FORTRAN_H
+#define WSJTX_FORTRAN_H
+
+#include <cstddef>
+#include <cstdint>
+
+typedef size_t fortran_charlen_t;   /* gfortran >= 8 */
+
+extern "C" {
+
+/* character*37 msg, msgsent; integer*1 msgbits(77); itone(79) */
+void genft8_(const char* msg, int* i3, int* n3, char* msgsent, int8_t* msgbits, int* itone,
+             fortran_charlen_t msg_len, fortran_charlen_t msgsent_len);
+
+/* character*37 msg0, msgsent; integer*1 msgbits(77); i4tone(103) */
+void genft4_(const char* msg0, const int* ichk, char* msgsent, int8_t* msgbits, int* i4tone,
+             fortran_charlen_t msg0_len, fortran_charlen_t msgsent_len);
+
+/* character*37 msg0, msgsent; itone(206) */
+void gen4_(const char* msg0, const int* ichk, char* msgsent, int* itone, int* itype,
+           fortran_charlen_t msg0_len, fortran_charlen_t msgsent_len);
+
+/* character*37 msg0, msgsent; itone(126), sync symbols are tone 0 */
+void gen65_(const char* msg0, const int* ichk, char* msgsent, int* itone, int* itype,
+            fortran_charlen_t msg0_len, fortran_charlen_t msgsent_len);
+
+/* character*37 msg0, msgsent; i4tone(85), sync symbols are tone 0 */
+void gen9_(const char* msg0, const int* ichk, char* msgsent, int* i4tone, int* itype,
+           fortran_charlen_t msg0_len, fortran_charlen_t msgsent_len);
+
+/* character*37 msg0, msgsent; integer*1 msgbits(101); i4tone(160); iwspr=1 for FST4W */
+void genfst4_(const char* msg0, const int* ichk, char* msgsent, int8_t* msgbits, int* i4tone,
+              const int* iwspr, fortran_charlen_t msg0_len, fortran_charlen_t msgsent_len);
+
+/* character*37 msg0, msgsent; itone(85), sync symbols are tone 0 */
+void genq65_(const char* msg0, const int* ichk, char* msgsent, int* itone, int* i3, int* n3,
+             fortran_charlen_t msg0_len, fortran_charlen_t msgsent_len);
+
+/* character*22 message, msgsent; itone(162) */
+void genwspr_(const char* message, char* msgsent, int* itone,
+              fortran_charlen_t message_len, fortran_charlen_t msgsent_len);
+
+}
+
+#endif /* WSJTX_FORTRAN_H */
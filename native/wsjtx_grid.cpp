@@ -0,0 +1,90 @@
+/**
+ * wsjtx_grid.cpp - Maidenhead locator geometry for the C API
+ *
+ * Batch great-circle distance / bearing from a home locator to many
+ * decoded locators. Home-side trigonometry is evaluated once per call so
+ * the per-grid cost is a handful of sin/cos/atan2 calls.
+ */
+
+#include "wsjtx_c_api.h"
+#include "wsjtx_text.h"
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <string_view>
+
+static const double EARTH_RADIUS_KM = 6371.0;
+static const double DEG2RAD = 3.14159265358979323846 / 180.0;
+
+/* Centre of a 4- or 6-character locator in degrees. Returns false if
+ * the text is not a locator. */
+static bool grid_to_latlon(const char* grid, double* lat, double* lon) {
+    if (!grid) return false;
+    std::string_view g(grid, strnlen(grid, 7));
+    if (!wsjtx_core::is_grid_token(g)) return false;
+
+    auto up = [](char c) { return (c >= 'a' && c <= 'z') ? static_cast<char>(c - 32) : c; };
+    double lo = (up(g[0]) - 'A') * 20.0 - 180.0 + (g[2] - '0') * 2.0;
+    double la = (up(g[1]) - 'A') * 10.0 - 90.0 + (g[3] - '0') * 1.0;
+    if (g.size() == 6) {
+        lo += (up(g[4]) - 'A') * (5.0 / 60.0) + 2.5 / 60.0;
+        la += (up(g[5]) - 'A') * (2.5 / 60.0) + 1.25 / 60.0;
+    } else {
+        lo += 1.0;
+        la += 0.5;
+    }
+    *lat = la;
+    *lon = lo;
+    return true;
+}
+
+WSJTX_API int wsjtx_grid_distance_bearing(const char* home_grid,
+    const char* const* grids, int count,
+    double* out_km, double* out_bearing)
+{
+    if (count < 0 || (count > 0 && (!grids || !out_km || !out_bearing)))
+        return WSJTX_ERR_INVALID_ARG;
+
+    double lat0, lon0;
+    if (!grid_to_latlon(home_grid, &lat0, &lon0)) return WSJTX_ERR_INVALID_GRID;
+
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const double phi1 = lat0 * DEG2RAD;
+    const double sin1 = std::sin(phi1), cos1 = std::cos(phi1);
+
+    int resolved = 0;
+    for (int i = 0; i < count; i++) {
+        double lat, lon;
+        if (!grid_to_latlon(grids[i], &lat, &lon)) {
+            out_km[i] = nan;
+            out_bearing[i] = nan;
+            continue;
+        }
+        double phi2 = lat * DEG2RAD;
+        double dl = (lon - lon0) * DEG2RAD;
+        double sin2 = std::sin(phi2), cos2 = std::cos(phi2);
+        double sdl = std::sin(dl), cdl = std::cos(dl);
+
+        /* Haversine for distance (well-conditioned at short range) */
+        double sdp = std::sin((phi2 - phi1) * 0.5);
+        double sdh = std::sin(dl * 0.5);
+        double a = sdp * sdp + cos1 * cos2 * sdh * sdh;
+        out_km[i] = 2.0 * EARTH_RADIUS_KM * std::asin(std::sqrt(std::fmin(1.0, a)));
+
+        double brg = std::atan2(sdl * cos2, cos1 * sin2 - sin1 * cos2 * cdl) / DEG2RAD;
+        out_bearing[i] = brg < 0.0 ? brg + 360.0 : brg;
+        resolved++;
+    }
+    return resolved;
+}
+
+WSJTX_API int wsjtx_message_grid(const char* message, char* out_grid, int out_size) {
+    if (!message || !out_grid || out_size <= 0) return 0;
+    std::string grid = wsjtx_core::extract_grid(message);
+    if (grid.empty() || static_cast<int>(grid.size()) >= out_size) {
+        out_grid[0] = '\0';
+        return 0;
+    }
+    memcpy(out_grid, grid.c_str(), grid.size() + 1);
+    return static_cast<int>(grid.size());
+}
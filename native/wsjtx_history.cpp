@@ -0,0 +1,139 @@
+/**
+ * wsjtx_history.cpp - Cross-slot message history for the C API
+ *
+ * A bounded LRU keyed by normalized message text and a coarse frequency
+ * bucket. Each observation reports whether the message is new and the
+ * first/last slot it was seen in; the least recently seen entry is evicted
+ * once the capacity is reached, so memory stays flat over long runs.
+ */
+
+#include "wsjtx_c_api.h"
+#include "wsjtx_text.h"
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace {
+
+struct HistoryEntry {
+    std::string key;
+    int64_t firstSlot;
+    int64_t lastSlot;
+    int count;
+};
+
+class MessageHistory {
+public:
+    MessageHistory(int capacity, int tolerance)
+        : capacity_(capacity), tolerance_(tolerance) {
+        index_.reserve(static_cast<size_t>(capacity));
+    }
+
+    void observe(const wsjtx_message_t& msg, int64_t slot, wsjtx_history_entry_t* out) {
+        std::string text = wsjtx_core::normalize_message(msg.msg);
+        int64_t bucket = floor_div(msg.freq, tolerance_);
+
+        /* Approximate frequency match: the same text within one bucket either side */
+        auto it = index_.end();
+        for (int64_t b = bucket - 1; b <= bucket + 1 && it == index_.end(); b++)
+            it = index_.find(make_key(text, b));
+
+        if (it != index_.end()) {
+            HistoryEntry& e = *it->second;
+            out->is_new = 0;
+            out->first_slot = e.firstSlot;
+            out->last_slot = e.lastSlot;
+            e.lastSlot = slot > e.lastSlot ? slot : e.lastSlot;
+            out->repeat_count = ++e.count;
+            lru_.splice(lru_.begin(), lru_, it->second);
+            return;
+        }
+
+        if (static_cast<int>(lru_.size()) >= capacity_) {
+            index_.erase(lru_.back().key);
+            lru_.pop_back();
+        }
+        lru_.push_front(HistoryEntry{make_key(text, bucket), slot, slot, 1});
+        index_.emplace(lru_.front().key, lru_.begin());
+
+        out->is_new = 1;
+        out->first_slot = slot;
+        out->last_slot = slot;
+        out->repeat_count = 1;
+    }
+
+    int size() const { return static_cast<int>(lru_.size()); }
+
+    void clear() {
+        index_.clear();
+        lru_.clear();
+    }
+
+    std::mutex mutex;
+
+private:
+    static int64_t floor_div(int64_t a, int64_t b) {
+        int64_t q = a / b;
+        return (a % b != 0 && ((a < 0) != (b < 0))) ? q - 1 : q;
+    }
+
+    static std::string make_key(const std::string& text, int64_t bucket) {
+        return text + '\x1f' + std::to_string(bucket);
+    }
+
+    int capacity_;
+    int tolerance_;
+    std::list<HistoryEntry> lru_;
+    std::unordered_map<std::string, std::list<HistoryEntry>::iterator> index_;
+};
+
+inline MessageHistory* to_history(wsjtx_history_t h) {
+    return static_cast<MessageHistory*>(h);
+}
+
+} // namespace
+
+WSJTX_API wsjtx_history_t wsjtx_history_create(int capacity, int freq_tolerance) {
+    if (capacity <= 0 || freq_tolerance <= 0) return nullptr;
+    try {
+        return static_cast<wsjtx_history_t>(new MessageHistory(capacity, freq_tolerance));
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+WSJTX_API void wsjtx_history_destroy(wsjtx_history_t history) {
+    delete to_history(history);
+}
+
+WSJTX_API int wsjtx_history_observe(wsjtx_history_t history,
+    const wsjtx_message_t* messages, int count, int64_t slot,
+    wsjtx_history_entry_t* out_entries)
+{
+    if (!history) return WSJTX_ERR_INVALID_HANDLE;
+    if (count < 0 || (count > 0 && (!messages || !out_entries))) return WSJTX_ERR_INVALID_ARG;
+
+    try {
+        MessageHistory* h = to_history(history);
+        std::lock_guard<std::mutex> lock(h->mutex);
+        for (int i = 0; i < count; i++) h->observe(messages[i], slot, &out_entries[i]);
+        return count;
+    } catch (...) {
+        return WSJTX_ERR_EXCEPTION;
+    }
+}
+
+WSJTX_API int wsjtx_history_size(wsjtx_history_t history) {
+    if (!history) return 0;
+    MessageHistory* h = to_history(history);
+    std::lock_guard<std::mutex> lock(h->mutex);
+    return h->size();
+}
+
+WSJTX_API void wsjtx_history_clear(wsjtx_history_t history) {
+    if (!history) return;
+    MessageHistory* h = to_history(history);
+    std::lock_guard<std::mutex> lock(h->mutex);
+    h->clear();
+}
@@ -0,0 +1,266 @@
+/**
+ * wsjtx_metrics.cpp - Latency histograms and job counters for the C API
+ *
+ * Each (receiver, operation, mode) series keeps two log-linear histograms
+ * (end-to-end and queue-wait latency, in microseconds) with 16 sub-buckets
+ * per power of two: bucket width is at most 1/16 of the value at any
+ * magnitude, in a fixed ~5 KB per histogram. Quantiles are read straight
+ * from the bucket counts and the registry renders as Prometheus text.
+ * Series also count the CPU time their jobs used.
+ */
+
+#include "wsjtx_c_api.h"
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+
+namespace {
+
+const int SUB_BITS = 4;
+const int SUB_COUNT = 1 << SUB_BITS;      /* sub-buckets per power of two */
+const int MAX_MAGNITUDE = 40;             /* up to 2^44 us, about 200 days */
+const int BUCKETS = (MAX_MAGNITUDE + 2) * SUB_COUNT;
+
+const char* const OP_NAMES[WSJTX_OP_COUNT] = { "decode", "encode", "wspr", "convert" };
+const char* const MODE_NAMES[] = {
+    "FT8", "FT4", "JT4", "JT65", "JT9", "FST4", "Q65", "FST4W", "JT65JT9", "WSPR",
+};
+const int MODE_COUNT = sizeof(MODE_NAMES) / sizeof(MODE_NAMES[0]);
+
+const double QUANTILES[] = { 0.5, 0.9, 0.99, 0.999 };
+
+inline int floor_log2(uint64_t v) {
+    int n = 0;
+    while (v >>= 1) n++;
+    return n;
+}
+
+class Histogram {
+public:
+    void record(int64_t us) {
+        uint64_t v = us < 0 ? 0 : static_cast<uint64_t>(us);
+        counts_[index(v)]++;
+        total_++;
+        sum_ += static_cast<double>(v);
+    }
+
+    /* Value (us) at quantile q, reported as the midpoint of its bucket */
+    double quantile(double q) const {
+        if (total_ == 0) return NAN;
+        uint64_t rank = static_cast<uint64_t>(std::ceil(q * static_cast<double>(total_)));
+        if (rank < 1) rank = 1;
+        uint64_t seen = 0;
+        for (int i = 0; i < BUCKETS; i++) {
+            seen += counts_[i];
+            if (seen >= rank) return midpoint(i);
+        }
+        return midpoint(BUCKETS - 1);
+    }
+
+    uint64_t count() const { return total_; }
+    double sum() const { return sum_; }
+
+private:
+    /* Values below 2*SUB_COUNT map 1:1; above, each power of two is split
+     * into SUB_COUNT equal buckets */
+    static int index(uint64_t v) {
+        if (v < static_cast<uint64_t>(2 * SUB_COUNT)) return static_cast<int>(v);
+        int m = floor_log2(v) - SUB_BITS;
+        if (m > MAX_MAGNITUDE) return BUCKETS - 1;
+        return (m + 1) * SUB_COUNT + static_cast<int>(v >> m) - SUB_COUNT;
+    }
+
+    static double midpoint(int i) {
+        if (i < 2 * SUB_COUNT) return i;
+        int m = i / SUB_COUNT - 1;
+        uint64_t lower = static_cast<uint64_t>(i % SUB_COUNT + SUB_COUNT) << m;
+        return static_cast<double>(lower) + static_cast<double>(uint64_t(1) << m) / 2.0;
+    }
+
+    uint64_t counts_[BUCKETS] = {};
+    uint64_t total_ = 0;
+    double sum_ = 0;
+};
+
+struct Series {
+    Histogram total;
+    Histogram queue;
+    uint64_t errors = 0;
+    int64_t cpuUs = 0;
+};
+
+struct Gauges {
+    int64_t queued = 0;
+    int64_t running = 0;
+};
+
+typedef std::tuple<std::string, int, int> SeriesKey;   /* receiver, op, mode */
+
+std::mutex g_mutex;
+std::map<SeriesKey, std::unique_ptr<Series>> g_series;
+std::map<std::string, Gauges> g_gauges;
+std::map<std::pair<std::string, int>, uint64_t> g_messages;
+
+inline std::string receiver_name(const char* r) {
+    return r ? std::string(r) : std::string();
+}
+
+/* Out-of-range modes (e.g. format conversion, which has none) share -1 */
+inline int normalize_mode(int mode) {
+    return mode >= 0 && mode < MODE_COUNT ? mode : -1;
+}
+
+inline const char* mode_name(int mode) {
+    return mode >= 0 && mode < MODE_COUNT ? MODE_NAMES[mode] : "none";
+}
+
+/* Prometheus label values: escape backslash, quote and newline */
+std::string escape_label(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        if (c == '\\' || c == '"') { out.push_back('\\'); out.push_back(c); }
+        else if (c == '\n') out += "\\n";
+        else out.push_back(c);
+    }
+    return out;
+}
+
+void append(std::string& out, const char* fmt, ...) {
+    char line[512];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(line, sizeof(line), fmt, ap);
+    va_end(ap);
+    if (n > 0) out.append(line, static_cast<size_t>(n < static_cast<int>(sizeof(line)) ? n : sizeof(line) - 1));
+}
+
+void render_summary(std::string& out, const char* name, const char* help, bool queue) {
+    append(out, "# HELP %s %s\n# TYPE %s summary\n", name, help, name);
+    for (const auto& [key, s] : g_series) {
+        const Histogram& h = queue ? s->queue : s->total;
+        if (h.count() == 0) continue;
+        std::string labels = "receiver=\"" + escape_label(std::get<0>(key)) + "\",op=\"" +
+            OP_NAMES[std::get<1>(key)] + "\",mode=\"" + mode_name(std::get<2>(key)) + "\"";
+        for (double q : QUANTILES) {
+            append(out, "%s{%s,quantile=\"%g\"} %.6f\n", name, labels.c_str(), q, h.quantile(q) / 1e6);
+        }
+        append(out, "%s_sum{%s} %.6f\n", name, labels.c_str(), h.sum() / 1e6);
+        append(out, "%s_count{%s} %llu\n", name, labels.c_str(), static_cast<unsigned long long>(h.count()));
+    }
+}
+
+} // namespace
+
+WSJTX_API void wsjtx_metrics_record(const char* receiver, int op, int mode,
+    int64_t queue_us, int64_t total_us, int ok)
+{
+    if (op < 0 || op >= WSJTX_OP_COUNT) return;
+    try {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        auto& s = g_series[SeriesKey(receiver_name(receiver), op, normalize_mode(mode))];
+        if (!s) s.reset(new Series());
+        s->total.record(total_us);
+        s->queue.record(queue_us);
+        if (!ok) s->errors++;
+    } catch (...) {
+    }
+}
+
+WSJTX_API void wsjtx_metrics_cpu(const char* receiver, int op, int mode, int64_t cpu_us) {
+    if (op < 0 || op >= WSJTX_OP_COUNT || cpu_us <= 0) return;
+    try {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        auto& s = g_series[SeriesKey(receiver_name(receiver), op, normalize_mode(mode))];
+        if (!s) s.reset(new Series());
+        s->cpuUs += cpu_us;
+    } catch (...) {
+    }
+}
+
+WSJTX_API void wsjtx_metrics_jobs(const char* receiver, int queued_delta, int running_delta) {
+    try {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        Gauges& g = g_gauges[receiver_name(receiver)];
+        g.queued += queued_delta;
+        g.running += running_delta;
+    } catch (...) {
+    }
+}
+
+WSJTX_API void wsjtx_metrics_messages(const char* receiver, int mode, int count) {
+    if (count <= 0) return;
+    try {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_messages[std::make_pair(receiver_name(receiver), normalize_mode(mode))] += static_cast<uint64_t>(count);
+    } catch (...) {
+    }
+}
+
+WSJTX_API double wsjtx_metrics_quantile(const char* receiver, int op, int mode, double q, int queue) {
+    if (op < 0 || op >= WSJTX_OP_COUNT || q < 0 || q > 1) return NAN;
+    std::lock_guard<std::mutex> lock(g_mutex);
+    auto it = g_series.find(SeriesKey(receiver_name(receiver), op, normalize_mode(mode)));
+    if (it == g_series.end()) return NAN;
+    const Histogram& h = queue ? it->second->queue : it->second->total;
+    return h.quantile(q) / 1e6;
+}
+
+WSJTX_API int64_t wsjtx_metrics_prometheus(char* buffer, int64_t size) {
+    std::string out;
+    try {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        render_summary(out, "wsjtx_operation_duration_seconds",
+            "Time from submission to completion, including queue wait.", false);
+        render_summary(out, "wsjtx_queue_wait_seconds",
+            "Time jobs spent queued before a worker thread picked them up.", true);
+
+        append(out, "# HELP wsjtx_operation_errors_total Operations that completed with an error.\n"
+                    "# TYPE wsjtx_operation_errors_total counter\n");
+        for (const auto& [key, s] : g_series) {
+            append(out, "wsjtx_operation_errors_total{receiver=\"%s\",op=\"%s\",mode=\"%s\"} %llu\n",
+                escape_label(std::get<0>(key)).c_str(), OP_NAMES[std::get<1>(key)],
+                mode_name(std::get<2>(key)), static_cast<unsigned long long>(s->errors));
+        }
+
+        append(out, "# HELP wsjtx_cpu_seconds_total CPU time used by operations on all their threads.\n"
+                    "# TYPE wsjtx_cpu_seconds_total counter\n");
+        for (const auto& [key, s] : g_series) {
+            append(out, "wsjtx_cpu_seconds_total{receiver=\"%s\",op=\"%s\",mode=\"%s\"} %.6f\n",
+                escape_label(std::get<0>(key)).c_str(), OP_NAMES[std::get<1>(key)],
+                mode_name(std::get<2>(key)), static_cast<double>(s->cpuUs) / 1e6);
+        }
+
+        append(out, "# HELP wsjtx_messages_decoded_total Messages returned by decode operations.\n"
+                    "# TYPE wsjtx_messages_decoded_total counter\n");
+        for (const auto& [key, n] : g_messages) {
+            append(out, "wsjtx_messages_decoded_total{receiver=\"%s\",mode=\"%s\"} %llu\n",
+                escape_label(key.first).c_str(), mode_name(key.second), static_cast<unsigned long long>(n));
+        }
+
+        append(out, "# HELP wsjtx_jobs_queued Jobs waiting for a worker thread.\n# TYPE wsjtx_jobs_queued gauge\n");
+        for (const auto& [r, g] : g_gauges)
+            append(out, "wsjtx_jobs_queued{receiver=\"%s\"} %lld\n", escape_label(r).c_str(), static_cast<long long>(g.queued));
+        append(out, "# HELP wsjtx_jobs_running Jobs started and not yet completed.\n# TYPE wsjtx_jobs_running gauge\n");
+        for (const auto& [r, g] : g_gauges)
+            append(out, "wsjtx_jobs_running{receiver=\"%s\"} %lld\n", escape_label(r).c_str(), static_cast<long long>(g.running));
+    } catch (...) {
+        return WSJTX_ERR_EXCEPTION;
+    }
+
+    int64_t len = static_cast<int64_t>(out.size());
+    if (buffer && size > len) memcpy(buffer, out.c_str(), out.size() + 1);
+    return len;
+}
+
+WSJTX_API void wsjtx_metrics_reset(void) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_series.clear();
+    g_messages.clear();
+    /* Gauges track live jobs, so they are left intact */
+}
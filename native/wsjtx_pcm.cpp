@@ -0,0 +1,80 @@
+/**
+ * wsjtx_pcm.cpp - Raw PCM to float conversion for the decoders
+ *
+ * Sound cards and files deliver unsigned 8-bit, packed 24-bit, 32-bit and
+ * double samples with several channels interleaved; the decoders want one
+ * float channel. Selecting the channel, decoding the sample and scaling
+ * happen in one strided pass. Multi-byte samples are read with memcpy, so
+ * buffers need no alignment (Node Buffers often have none).
+ */
+
+#include "wsjtx_c_api.h"
+#include <cstring>
+
+namespace {
+
+const int MAX_CHANNELS = 64;
+
+template <typename T>
+inline T load(const unsigned char* p) {
+    T v;
+    std::memcpy(&v, p, sizeof(T));
+    return v;
+}
+
+/* Little-endian hosts only, as the wire formats themselves */
+struct U8  { static float read(const unsigned char* p) { return (p[0] - 128) * (1.0f / 128.0f); } };
+struct S16 { static float read(const unsigned char* p) { return load<int16_t>(p) * (1.0f / 32768.0f); } };
+struct S24 {
+    static float read(const unsigned char* p) {
+        /* Assemble in the top three bytes so the shift sign-extends */
+        const int32_t v = static_cast<int32_t>((static_cast<uint32_t>(p[0]) << 8) |
+            (static_cast<uint32_t>(p[1]) << 16) | (static_cast<uint32_t>(p[2]) << 24)) >> 8;
+        return v * (1.0f / 8388608.0f);
+    }
+};
+struct S32 { static float read(const unsigned char* p) { return static_cast<float>(load<int32_t>(p) * (1.0 / 2147483648.0)); } };
+struct F32 { static float read(const unsigned char* p) { return load<float>(p); } };
+struct F64 { static float read(const unsigned char* p) { return static_cast<float>(load<double>(p)); } };
+
+template <typename Format>
+void convert(const unsigned char* src, size_t stride, int frames, float* out) {
+    for (int i = 0; i < frames; i++, src += stride) out[i] = Format::read(src);
+}
+
+} // namespace
+
+WSJTX_API int wsjtx_pcm_sample_bytes(int format) {
+    switch (format) {
+    case WSJTX_PCM_U8:  return 1;
+    case WSJTX_PCM_S16: return 2;
+    case WSJTX_PCM_S24: return 3;
+    case WSJTX_PCM_S32: return 4;
+    case WSJTX_PCM_F32: return 4;
+    case WSJTX_PCM_F64: return 8;
+    default:            return 0;
+    }
+}
+
+WSJTX_API int wsjtx_pcm_to_float(const void* data, size_t num_bytes, int format,
+    int channels, int channel, float* out, int out_size)
+{
+    const int bytes = wsjtx_pcm_sample_bytes(format);
+    if (bytes == 0 || !data || !out || out_size < 0 || channels < 1 || channels > MAX_CHANNELS ||
+        channel < 0 || channel >= channels) return WSJTX_ERR_INVALID_ARG;
+
+    const size_t stride = static_cast<size_t>(bytes) * channels;
+    const size_t available = num_bytes / stride;
+    const int frames = available < static_cast<size_t>(out_size) ? static_cast<int>(available) : out_size;
+    const unsigned char* src = static_cast<const unsigned char*>(data) + static_cast<size_t>(bytes) * channel;
+
+    switch (format) {
+    case WSJTX_PCM_U8:  convert<U8>(src, stride, frames, out); break;
+    case WSJTX_PCM_S16: convert<S16>(src, stride, frames, out); break;
+    case WSJTX_PCM_S24: convert<S24>(src, stride, frames, out); break;
+    case WSJTX_PCM_S32: convert<S32>(src, stride, frames, out); break;
+    case WSJTX_PCM_F32: convert<F32>(src, stride, frames, out); break;
+    case WSJTX_PCM_F64: convert<F64>(src, stride, frames, out); break;
+    }
+    return frames;
+}
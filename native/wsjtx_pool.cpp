@@ -0,0 +1,146 @@
+/**
+ * wsjtx_pool.cpp - Shared job pool of the C API
+ *
+ * A fixed set of worker threads draining one FIFO of C callbacks. It
+ * exists for embedders without an event loop of their own (the Node
+ * binding schedules on libuv's pool instead) and runs the decode
+ * watchdog's watched decodes. The pool is never torn down: its threads
+ * block on the queue for the life of the process, so nothing depends on
+ * static destruction order at exit.
+ */
+
+#include "wsjtx_c_api.h"
+#include "wsjtx_pool.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+namespace {
+
+const int MAX_THREADS = 256;
+
+struct Job {
+    void (*fn)(void*);
+    void* ctx;
+};
+
+struct Pool {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<Job> queue;
+    int target = 0;         /* threads the pool is sized to, 0 until first use */
+    int lent = 0;           /* extra threads standing in for held ones (pool_lend) */
+    int running = 0;        /* threads alive */
+};
+
+thread_local bool t_worker = false;
+thread_local bool t_retire = false;
+
+Pool& pool() {
+    static Pool* p = new Pool();   /* leaked on purpose, see above */
+    return *p;
+}
+
+int default_threads() {
+    unsigned n = std::thread::hardware_concurrency();
+    return n == 0 ? 1 : static_cast<int>(n < MAX_THREADS ? n : MAX_THREADS);
+}
+
+bool grow_locked(Pool& p);
+
+void worker() {
+    t_worker = true;
+    Pool& p = pool();
+    std::unique_lock<std::mutex> lock(p.mutex);
+    for (;;) {
+        p.cv.wait(lock, [&p] { return !p.queue.empty() || p.running > p.target + p.lent; });
+        if (p.running > p.target + p.lent) break;
+        Job job = p.queue.front();
+        p.queue.pop_front();
+        lock.unlock();
+        try {
+            job.fn(job.ctx);
+        } catch (...) {
+            /* a C callback should not throw; keep the thread either way */
+        }
+        lock.lock();
+        if (t_retire) break;
+    }
+    p.running--;
+    if (t_retire) grow_locked(p);   /* a replacement at normal priority */
+}
+
+/* Start threads up to the target; false if none are running afterwards */
+bool grow_locked(Pool& p) {
+    while (p.running < p.target + p.lent) {
+        try {
+            std::thread(worker).detach();
+        } catch (const std::system_error&) {
+            break;
+        }
+        p.running++;
+    }
+    return p.running > 0;
+}
+
+} // namespace
+
+namespace wsjtx_core {
+
+bool pool_thread() {
+    return t_worker;
+}
+
+void pool_lend(int n) {
+    Pool& p = pool();
+    {
+        std::lock_guard<std::mutex> lock(p.mutex);
+        if (p.target == 0) p.target = default_threads();
+        p.lent += n;
+        if (p.lent < 0) p.lent = 0;
+        grow_locked(p);
+    }
+    p.cv.notify_all();
+}
+
+void pool_retire_thread() {
+    if (t_worker) t_retire = true;
+}
+
+} // namespace wsjtx_core
+
+WSJTX_API int wsjtx_pool_submit(void (*fn)(void* ctx), void* ctx) {
+    if (!fn) return WSJTX_ERR_INVALID_ARG;
+    Pool& p = pool();
+    try {
+        std::lock_guard<std::mutex> lock(p.mutex);
+        if (p.target == 0) p.target = default_threads();
+        if (!grow_locked(p)) return WSJTX_ERR_EXCEPTION;
+        p.queue.push_back(Job{ fn, ctx });
+    } catch (...) {
+        return WSJTX_ERR_EXCEPTION;
+    }
+    p.cv.notify_one();
+    return WSJTX_OK;
+}
+
+WSJTX_API int wsjtx_pool_set_threads(int threads) {
+    if (threads < 0 || threads > MAX_THREADS) return WSJTX_ERR_INVALID_ARG;
+    Pool& p = pool();
+    {
+        std::lock_guard<std::mutex> lock(p.mutex);
+        p.target = threads == 0 ? default_threads() : threads;
+        grow_locked(p);
+    }
+    p.cv.notify_all();   /* surplus threads exit */
+    return WSJTX_OK;
+}
+
+WSJTX_API int wsjtx_pool_threads(void) {
+    Pool& p = pool();
+    std::lock_guard<std::mutex> lock(p.mutex);
+    return p.target == 0 ? default_threads() : p.target;
+}
@@ -0,0 +1,27 @@
+/**
+ * wsjtx_pool.h - Internal hooks into the core job pool
+ *
+ * For core code that runs its own work on the pool (the decode watchdog)
+ * and needs more from it than wsjtx_pool_submit. Not part of the exported
+ * ABI.
+ */
+
+#ifndef WSJTX_POOL_H
+#define WSJTX_POOL_H
+
+namespace wsjtx_core {
+
+/* True on one of the pool's threads */
+bool pool_thread();
+
+/* Run `n` threads more (negative: fewer) than the size set with
+ * wsjtx_pool_set_threads, to stand in for threads jobs hold indefinitely */
+void pool_lend(int n);
+
+/* Let the calling pool thread exit after its current job and start a fresh
+ * one in its place, e.g. once the job has lowered the thread's priority */
+void pool_retire_thread();
+
+} // namespace wsjtx_core
+
+#endif /* WSJTX_POOL_H */
@@ -0,0 +1,35 @@
+/**
+ * wsjtx_probes.h - USDT probe points for wsjtx_core
+ *
+ * With WSJTX_ENABLE_USDT (CMake option of the same name, Linux only) each
+ * probe compiles to a single nop plus an ELF note, so bpftrace, perf or
+ * SystemTap can attach to a running process; nothing is executed unless a
+ * tracer is attached. Without it the macros expand to nothing.
+ *
+ * Provider "wsjtx":
+ *   decode__start(mode, num_samples, frequency)   decode__done(mode, rc)
+ *   encode__start(mode, frequency)                encode__done(mode, num_samples)
+ *   wspr__start(num_iq_samples)                   wspr__done(count)
+ *   drain__start(max_messages)                    drain__done(count)
+ *
+ * Example:
+ *   bpftrace -e 'usdt:./libwsjtx_core.so:wsjtx:decode__start { @t[tid] = nsecs; }
+ *                usdt:./libwsjtx_core.so:wsjtx:decode__done /@t[tid]/ {
+ *                  @us[arg0] = hist((nsecs - @t[tid]) / 1000); delete(@t[tid]); }'
+ */
+
+#ifndef WSJTX_PROBES_H
+#define WSJTX_PROBES_H
+
+#if defined(WSJTX_ENABLE_USDT) && defined(__linux__)
+  #include <sys/sdt.h>
+  #define WSJTX_PROBE1(name, a)       DTRACE_PROBE1(wsjtx, name, a)
+  #define WSJTX_PROBE2(name, a, b)    DTRACE_PROBE2(wsjtx, name, a, b)
+  #define WSJTX_PROBE3(name, a, b, c) DTRACE_PROBE3(wsjtx, name, a, b, c)
+#else
+  #define WSJTX_PROBE1(name, a)       do {} while (0)
+  #define WSJTX_PROBE2(name, a, b)    do {} while (0)
+  #define WSJTX_PROBE3(name, a, b, c) do {} while (0)
+#endif
+
+#endif /* WSJTX_PROBES_H */
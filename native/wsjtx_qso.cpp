@@ -0,0 +1,485 @@
+/**
+ * wsjtx_qso.cpp - FT8/FT4 QSO sequencing with pre-encoded transmissions
+ *
+ * A state machine over the standard exchange (CQ, grid, report, R+report,
+ * RR73, 73) from both ends: calling CQ and answering a station. The
+ * messages of a QSO are fixed when it starts, as WSJT-X generates Tx1-Tx5
+ * once, so the sequencer knows every message it may send next and can
+ * encode them while the current one is on the air. The audio for the next
+ * transmission is then a copy when the decodes come in.
+ */
+
+#include "wsjtx_c_api.h"
+#include "wsjtx_text.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+
+const int REPORT_MIN = -30;
+const int REPORT_MAX = 30;
+const size_t MAX_TONES = 256;
+
+/* What a message addressed to us carries after the two calls */
+enum class Payload { None, Grid, Report, RogerReport, Roger, RR73, SeventyThree, Other };
+
+struct Reply {
+    std::string from;
+    Payload payload = Payload::Other;
+    int report = 0;
+    std::string grid;
+    int snr = 0;
+};
+
+std::vector<std::string> tokens(const std::string& text) {
+    std::vector<std::string> out;
+    size_t i = 0;
+    while (i < text.size()) {
+        size_t j = text.find(' ', i);
+        if (j == std::string::npos) j = text.size();
+        if (j > i) out.push_back(text.substr(i, j - i));
+        i = j + 1;
+    }
+    return out;
+}
+
+std::string strip_brackets(const std::string& call) {
+    if (call.size() > 2 && call.front() == '<' && call.back() == '>') return call.substr(1, call.size() - 2);
+    return call;
+}
+
+/* "-05", "+12" as sent in reports */
+bool parse_report(const std::string& tok, int* out) {
+    if (tok.size() != 3 || (tok[0] != '-' && tok[0] != '+') ||
+        !std::isdigit(static_cast<unsigned char>(tok[1])) || !std::isdigit(static_cast<unsigned char>(tok[2])))
+        return false;
+    const int v = (tok[1] - '0') * 10 + (tok[2] - '0');
+    *out = tok[0] == '-' ? -v : v;
+    return true;
+}
+
+/* A decode as a reply to `myCall`, if it is one */
+bool parse_reply(const wsjtx_message_t& msg, const std::string& myCall, Reply* out) {
+    const std::vector<std::string> t = tokens(wsjtx_core::normalize_message(msg.msg));
+    if (t.size() < 2 || strip_brackets(t[0]) != myCall) return false;
+    out->from = strip_brackets(t[1]);
+    out->snr = msg.snr;
+    if (t.size() == 2) {
+        out->payload = Payload::None;
+    } else {
+        const std::string& p = t[2];
+        if (wsjtx_core::is_message_grid(p)) { out->payload = Payload::Grid; out->grid = p.substr(0, 4); }
+        else if (p == "RRR") out->payload = Payload::Roger;
+        else if (p == "RR73") out->payload = Payload::RR73;
+        else if (p == "73") out->payload = Payload::SeventyThree;
+        else if (parse_report(p, &out->report)) out->payload = Payload::Report;
+        else if (p.size() == 4 && p[0] == 'R' && parse_report(p.substr(1), &out->report)) out->payload = Payload::RogerReport;
+        else out->payload = Payload::Other;
+    }
+    return out->payload != Payload::Other;
+}
+
+std::string format_report(int db) {
+    char buf[8];
+    std::snprintf(buf, sizeof(buf), "%+03d", std::max(REPORT_MIN, std::min(REPORT_MAX, db)));
+    return buf;
+}
+
+void copy_text(char* dst, size_t size, const std::string& src) {
+    std::strncpy(dst, src.c_str(), size - 1);
+    dst[size - 1] = '\0';
+}
+
+struct Encoded {
+    std::string text;
+    std::vector<float> audio;
+};
+
+class QsoSequencer {
+public:
+    QsoSequencer(int mode, std::string myCall, std::string myGrid, int txFreq, int maxRepeats)
+        : mode_(mode), myCall_(std::move(myCall)), myGrid_(std::move(myGrid)),
+          txFreq_(txFreq), maxRepeats_(maxRepeats) {}
+
+    void startCq() {
+        runningCq_ = true;
+        reset(WSJTX_QSO_CQ);
+    }
+
+    void call(const std::string& dx, const std::string& grid, int snr) {
+        runningCq_ = false;
+        reset(WSJTX_QSO_CALLING);
+        dxCall_ = dx;
+        dxGrid_ = grid;
+        reportSent_ = snr;
+    }
+
+    void stop() {
+        runningCq_ = false;
+        reset(WSJTX_QSO_IDLE);
+    }
+
+    /* One receive slot's decodes; true if the next message changed */
+    bool observe(const wsjtx_message_t* messages, int count) {
+        const std::string before = txMessage();
+        Reply reply;
+        const bool heard = state_ == WSJTX_QSO_CQ ? strongest_caller(messages, count, &reply)
+                                                  : reply_from_dx(messages, count, &reply);
+        if (!heard || !advance(reply)) {
+            if (state_ == WSJTX_QSO_ROGER || state_ == WSJTX_QSO_SIGNOFF) {
+                finish();   /* the last message went out once and was not asked for again */
+            } else if (state_ != WSJTX_QSO_IDLE && state_ != WSJTX_QSO_CQ && state_ != WSJTX_QSO_DONE &&
+                       ++repeats_ >= maxRepeats_) {
+                finish();   /* no reply: give up */
+            }
+        }
+        return txMessage() != before;
+    }
+
+    void status(wsjtx_qso_status_t* out) const {
+        std::memset(out, 0, sizeof(*out));
+        out->state = state_;
+        copy_text(out->dx_call, sizeof(out->dx_call), dxCall_);
+        copy_text(out->dx_grid, sizeof(out->dx_grid), dxGrid_);
+        out->report_sent = reportSent_;
+        out->report_received = reportReceived_;
+        out->repeats = repeats_;
+        out->logged = logged_ ? 1 : 0;
+        copy_text(out->tx_message, sizeof(out->tx_message), txMessage());
+        out->cache_hits = hits_;
+        out->cache_misses = misses_;
+    }
+
+    std::string txMessage() const { return message(state_); }
+
+    /* tx_message and what follows it under the expected replies */
+    std::vector<std::string> likely() const {
+        std::vector<int> states{ state_ };
+        switch (state_) {
+        case WSJTX_QSO_CALLING:      states.push_back(WSJTX_QSO_ROGER_REPORT); states.push_back(WSJTX_QSO_SIGNOFF); break;
+        case WSJTX_QSO_REPORT:       states.push_back(WSJTX_QSO_ROGER); break;
+        case WSJTX_QSO_ROGER_REPORT: states.push_back(WSJTX_QSO_SIGNOFF); break;
+        case WSJTX_QSO_ROGER:
+        case WSJTX_QSO_SIGNOFF:      if (runningCq_) states.push_back(WSJTX_QSO_CQ); break;
+        default: break;
+        }
+        std::vector<std::string> out;
+        for (int s : states) {
+            std::string m = message(s);
+            if (!m.empty()) out.push_back(std::move(m));
+        }
+        return out;
+    }
+
+    const Encoded* cached(const std::string& text) const {
+        for (const Encoded& e : cache_)
+            if (e.text == text) return &e;
+        return nullptr;
+    }
+
+    void store(Encoded&& e) {
+        if (!cached(e.text)) cache_.push_back(std::move(e));
+    }
+
+    /* Keep only the messages that may still be sent */
+    void prune(const std::vector<std::string>& keep) {
+        cache_.erase(std::remove_if(cache_.begin(), cache_.end(), [&](const Encoded& e) {
+            return std::find(keep.begin(), keep.end(), e.text) == keep.end();
+        }), cache_.end());
+    }
+
+    int encode(const std::string& text, Encoded* out) const {
+        int tones[MAX_TONES];
+        int numTones = 0;
+        int rc = wsjtx_encode_tones(mode_, text.c_str(), tones, MAX_TONES, &numTones, nullptr, 0);
+        if (rc != WSJTX_OK) return rc;
+        out->text = text;
+        out->audio.resize(static_cast<size_t>(wsjtx_get_waveform_samples(mode_)));
+        int n = 0;
+        rc = wsjtx_synthesize(mode_, tones, numTones, txFreq_, out->audio.data(),
+            static_cast<int>(out->audio.size()), &n);
+        if (rc != WSJTX_OK) return rc;
+        out->audio.resize(static_cast<size_t>(n));
+        return WSJTX_OK;
+    }
+
+    void count(bool hit) { (hit ? hits_ : misses_)++; }
+
+    std::mutex mutex;
+
+private:
+    std::string message(int state) const {
+        const std::string to = dxCall_ + " " + myCall_ + " ";
+        switch (state) {
+        case WSJTX_QSO_CQ:           return "CQ " + myCall_ + " " + myGrid_;
+        case WSJTX_QSO_CALLING:      return to + myGrid_;
+        case WSJTX_QSO_REPORT:       return to + format_report(reportSent_);
+        case WSJTX_QSO_ROGER_REPORT: return to + "R" + format_report(reportSent_);
+        case WSJTX_QSO_ROGER:        return to + "RR73";
+        case WSJTX_QSO_SIGNOFF:      return to + "73";
+        default:                     return std::string();
+        }
+    }
+
+    void reset(int state) {
+        state_ = state;
+        dxCall_.clear();
+        dxGrid_.clear();
+        reportSent_ = 0;
+        reportReceived_ = WSJTX_QSO_NO_REPORT;
+        repeats_ = 0;
+        logged_ = false;
+    }
+
+    void finish() {
+        if (runningCq_) reset(WSJTX_QSO_CQ);
+        else { state_ = state_ == WSJTX_QSO_CALLING ? WSJTX_QSO_IDLE : WSJTX_QSO_DONE; repeats_ = 0; }
+    }
+
+    void enter(int state) {
+        state_ = state;
+        repeats_ = 0;
+        if (state == WSJTX_QSO_ROGER || state == WSJTX_QSO_SIGNOFF) logged_ = true;
+    }
+
+    /* Asked for the same message again; false once that has gone on too long */
+    bool repeat() {
+        return ++repeats_ < maxRepeats_;
+    }
+
+    /* While calling CQ: the strongest station answering us */
+    bool strongest_caller(const wsjtx_message_t* messages, int count, Reply* out) const {
+        bool found = false;
+        for (int i = 0; i < count; i++) {
+            Reply r;
+            if (parse_reply(messages[i], myCall_, &r) && (!found || r.snr > out->snr)) {
+                *out = r;
+                found = true;
+            }
+        }
+        return found;
+    }
+
+    bool reply_from_dx(const wsjtx_message_t* messages, int count, Reply* out) const {
+        if (dxCall_.empty()) return false;
+        for (int i = 0; i < count; i++) {
+            Reply r;
+            if (parse_reply(messages[i], myCall_, &r) && r.from == dxCall_) {
+                *out = r;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /* Move on for a reply; false if it does not advance the QSO (a repeat) */
+    bool advance(const Reply& r) {
+        if (r.payload == Payload::Report || r.payload == Payload::RogerReport) reportReceived_ = r.report;
+        if (r.payload == Payload::Grid && dxGrid_.empty()) dxGrid_ = r.grid;
+        switch (state_) {
+        case WSJTX_QSO_CQ:
+            dxCall_ = r.from;
+            reportSent_ = r.snr;
+            switch (r.payload) {
+            case Payload::None:
+            case Payload::Grid:        enter(WSJTX_QSO_REPORT); return true;
+            case Payload::Report:      enter(WSJTX_QSO_ROGER_REPORT); return true;
+            case Payload::RogerReport: enter(WSJTX_QSO_ROGER); return true;
+            default: dxCall_.clear(); dxGrid_.clear(); return false;
+            }
+        case WSJTX_QSO_CALLING:
+            switch (r.payload) {
+            case Payload::Report:      enter(WSJTX_QSO_ROGER_REPORT); return true;
+            case Payload::RogerReport: enter(WSJTX_QSO_ROGER); return true;
+            case Payload::Roger:
+            case Payload::RR73:        enter(WSJTX_QSO_SIGNOFF); return true;
+            default: return false;
+            }
+        case WSJTX_QSO_REPORT:
+            switch (r.payload) {
+            case Payload::Report:      enter(WSJTX_QSO_ROGER_REPORT); return true;
+            case Payload::RogerReport: enter(WSJTX_QSO_ROGER); return true;
+            case Payload::Roger:
+            case Payload::RR73:        enter(WSJTX_QSO_SIGNOFF); return true;
+            default: return false;
+            }
+        case WSJTX_QSO_ROGER_REPORT:
+            switch (r.payload) {
+            case Payload::Roger:
+            case Payload::RR73:        enter(WSJTX_QSO_SIGNOFF); return true;
+            case Payload::SeventyThree: logged_ = true; finish(); return true;
+            default: return false;
+            }
+        case WSJTX_QSO_ROGER:
+            /* R+report again: our RR73 was missed, send it again */
+            if (r.payload == Payload::RogerReport) return repeat();
+            return false;
+        case WSJTX_QSO_SIGNOFF:
+            if (r.payload == Payload::Roger || r.payload == Payload::RR73) return repeat();
+            return false;
+        default:
+            return false;
+        }
+    }
+
+    int mode_;
+    std::string myCall_, myGrid_;
+    int txFreq_;
+    int maxRepeats_;
+
+    bool runningCq_ = false;
+    int state_ = WSJTX_QSO_IDLE;
+    std::string dxCall_, dxGrid_;
+    int reportSent_ = 0;
+    int reportReceived_ = WSJTX_QSO_NO_REPORT;
+    int repeats_ = 0;
+    bool logged_ = false;
+
+    std::vector<Encoded> cache_;
+    int hits_ = 0, misses_ = 0;
+};
+
+inline QsoSequencer* to_qso(wsjtx_qso_t q) {
+    return static_cast<QsoSequencer*>(q);
+}
+
+std::string upper_token(const char* s) {
+    std::string out = s ? s : "";
+    for (auto& c : out) c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    return out;
+}
+
+} // namespace
+
+WSJTX_API wsjtx_qso_t wsjtx_qso_create(int mode, const char* my_call, const char* my_grid,
+    int tx_freq, int max_repeats)
+{
+    if (mode != WSJTX_MODE_FT8 && mode != WSJTX_MODE_FT4) return nullptr;
+    const std::string call = upper_token(my_call), grid = upper_token(my_grid);
+    if (!wsjtx_core::is_call_token(call) || !wsjtx_core::is_grid_token(grid) ||
+        tx_freq < 0 || tx_freq > 5000 || max_repeats < 1) return nullptr;
+    try {
+        return static_cast<wsjtx_qso_t>(new QsoSequencer(mode, call, grid.substr(0, 4), tx_freq, max_repeats));
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+WSJTX_API void wsjtx_qso_destroy(wsjtx_qso_t qso) {
+    delete to_qso(qso);
+}
+
+WSJTX_API int wsjtx_qso_start_cq(wsjtx_qso_t qso) {
+    if (!qso) return WSJTX_ERR_INVALID_HANDLE;
+    QsoSequencer* q = to_qso(qso);
+    std::lock_guard<std::mutex> lock(q->mutex);
+    q->startCq();
+    return WSJTX_OK;
+}
+
+WSJTX_API int wsjtx_qso_call(wsjtx_qso_t qso, const char* dx_call, const char* dx_grid, int snr) {
+    if (!qso) return WSJTX_ERR_INVALID_HANDLE;
+    const std::string call = upper_token(dx_call), grid = upper_token(dx_grid);
+    if (!wsjtx_core::is_call_token(call)) return WSJTX_ERR_INVALID_ARG;
+    if (!grid.empty() && !wsjtx_core::is_grid_token(grid)) return WSJTX_ERR_INVALID_GRID;
+    try {
+        QsoSequencer* q = to_qso(qso);
+        std::lock_guard<std::mutex> lock(q->mutex);
+        q->call(strip_brackets(call), grid.substr(0, 4), snr);
+        return WSJTX_OK;
+    } catch (...) {
+        return WSJTX_ERR_EXCEPTION;
+    }
+}
+
+WSJTX_API void wsjtx_qso_stop(wsjtx_qso_t qso) {
+    if (!qso) return;
+    QsoSequencer* q = to_qso(qso);
+    std::lock_guard<std::mutex> lock(q->mutex);
+    q->stop();
+}
+
+WSJTX_API int wsjtx_qso_observe(wsjtx_qso_t qso, const wsjtx_message_t* messages, int count) {
+    if (!qso) return WSJTX_ERR_INVALID_HANDLE;
+    if (count < 0 || (count > 0 && !messages)) return WSJTX_ERR_INVALID_ARG;
+    try {
+        QsoSequencer* q = to_qso(qso);
+        std::lock_guard<std::mutex> lock(q->mutex);
+        return q->observe(messages, count) ? 1 : 0;
+    } catch (...) {
+        return WSJTX_ERR_EXCEPTION;
+    }
+}
+
+WSJTX_API int wsjtx_qso_status(wsjtx_qso_t qso, wsjtx_qso_status_t* out) {
+    if (!qso) return WSJTX_ERR_INVALID_HANDLE;
+    if (!out) return WSJTX_ERR_INVALID_ARG;
+    QsoSequencer* q = to_qso(qso);
+    std::lock_guard<std::mutex> lock(q->mutex);
+    q->status(out);
+    return WSJTX_OK;
+}
+
+WSJTX_API int wsjtx_qso_tx_audio(wsjtx_qso_t qso, float* out, int out_size) {
+    if (!qso) return WSJTX_ERR_INVALID_HANDLE;
+    if (!out || out_size < 0) return WSJTX_ERR_INVALID_ARG;
+    try {
+        QsoSequencer* q = to_qso(qso);
+        std::string text;
+        {
+            std::lock_guard<std::mutex> lock(q->mutex);
+            text = q->txMessage();
+            if (text.empty()) return 0;
+            if (const Encoded* e = q->cached(text)) {
+                q->count(true);
+                const int n = std::min(out_size, static_cast<int>(e->audio.size()));
+                std::copy(e->audio.begin(), e->audio.begin() + n, out);
+                return n;
+            }
+        }
+        /* Not pre-encoded: encode now, outside the lock */
+        Encoded e;
+        int rc = q->encode(text, &e);
+        if (rc != WSJTX_OK) return rc;
+        const int n = std::min(out_size, static_cast<int>(e.audio.size()));
+        std::copy(e.audio.begin(), e.audio.begin() + n, out);
+        std::lock_guard<std::mutex> lock(q->mutex);
+        q->count(false);
+        q->store(std::move(e));
+        return n;
+    } catch (...) {
+        return WSJTX_ERR_EXCEPTION;
+    }
+}
+
+WSJTX_API int wsjtx_qso_speculate(wsjtx_qso_t qso) {
+    if (!qso) return WSJTX_ERR_INVALID_HANDLE;
+    try {
+        QsoSequencer* q = to_qso(qso);
+        std::vector<std::string> todo;
+        {
+            std::lock_guard<std::mutex> lock(q->mutex);
+            const std::vector<std::string> keep = q->likely();
+            q->prune(keep);
+            for (const std::string& text : keep)
+                if (!q->cached(text)) todo.push_back(text);
+        }
+        int encoded = 0;
+        for (const std::string& text : todo) {
+            Encoded e;
+            int rc = q->encode(text, &e);
+            if (rc != WSJTX_OK) return rc;
+            std::lock_guard<std::mutex> lock(q->mutex);
+            q->store(std::move(e));
+            encoded++;
+        }
+        return encoded;
+    } catch (...) {
+        return WSJTX_ERR_EXCEPTION;
+    }
+}
@@ -0,0 +1,153 @@
+/**
+ * wsjtx_subtract.cpp - Residual audio after subtracting decoded signals
+ *
+ * Each decoded message is re-encoded, its waveform is aligned to the audio
+ * and its slowly varying complex amplitude is estimated with a low-pass
+ * filter, then the signal is removed; the same scheme as WSJT-X's
+ * subtractft8. The residual can then be handed to another decoder.
+ */
+
+#include "wsjtx_c_api.h"
+#include "wsjtx_text.h"
+#include "wsjtx_tones.h"
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace {
+
+const double PI = 3.14159265358979323846;
+
+/* Seconds into the slot at which a signal with DT = 0 starts */
+double dt_origin(int mode) {
+    switch (mode) {
+    case WSJTX_MODE_FT8:
+    case WSJTX_MODE_FT4: return 0.5;
+    default:             return -1.0;
+    }
+}
+
+/* Transmitted waveform of one message as cos/sin of its phase */
+struct Reference {
+    std::vector<float> cosine, sine;
+    int length = 0;
+};
+
+bool build_reference(int mode, const wsjtx_message_t& m, Reference& ref) {
+    const std::string text = wsjtx_core::normalize_message(m.msg);
+    int tones[256];
+    int numTones = 0;
+    if (text.empty() || wsjtx_encode_tones(mode, text.c_str(), tones, 256, &numTones, nullptr, 0) != WSJTX_OK)
+        return false;
+
+    const int size = wsjtx_get_waveform_samples(mode);
+    ref.sine.resize(size);
+    ref.length = wsjtx_core::tone_phases(mode, tones, numTones, m.freq, ref.sine.data(), size);
+    if (ref.length <= 0) return false;
+    ref.cosine.assign(ref.sine.begin(), ref.sine.begin() + ref.length);
+    const float HALF_PI_F = static_cast<float>(PI / 2), PI_F = static_cast<float>(PI);
+    for (float& v : ref.cosine) {
+        v += HALF_PI_F;
+        if (v >= PI_F) v -= 2.0f * PI_F;
+    }
+    wsjtx_core::fast_sin(ref.sine.data(), ref.length);
+    wsjtx_core::fast_sin(ref.cosine.data(), ref.length);
+    return true;
+}
+
+/* Non-coherent correlation with the reference starting at `start`: |<x, ref>|^2
+ * summed over `segment`-sample pieces, so a residual frequency error of a
+ * hertz or so does not cancel it out. Every 4th sample is used; the product
+ * is near baseband once aligned. */
+double correlation(const float* x, int n, const Reference& ref, int64_t start, int segment) {
+    double total = 0, re = 0, im = 0;
+    for (int k = 0; k < ref.length; k += 4) {
+        const int64_t i = start + k;
+        if (i >= n) break;
+        if (i >= 0) {
+            re += x[i] * ref.cosine[k];
+            im -= x[i] * ref.sine[k];
+        }
+        if ((k / 4 + 1) % (segment / 4) == 0) {
+            total += re * re + im * im;
+            re = im = 0;
+        }
+    }
+    return total + re * re + im * im;
+}
+
+/* Start sample maximizing the correlation within +-span of `guess` */
+int64_t align(const float* x, int n, const Reference& ref, int64_t guess, int span, int segment) {
+    int64_t best = guess;
+    double bestValue = -1;
+    for (int step = span / 16; step >= 1; step /= 4) {
+        const int64_t centre = best;
+        for (int64_t off = -span; off <= span; off += step) {
+            const double v = correlation(x, n, ref, centre + off, segment);
+            if (v > bestValue) { bestValue = v; best = centre + off; }
+        }
+        span = step;
+    }
+    return best;
+}
+
+/* Centred moving average of half-width `half`, normalized at the edges */
+void smooth(std::vector<std::complex<float>>& a, int half) {
+    const int n = static_cast<int>(a.size());
+    std::vector<std::complex<double>> prefix(n + 1);
+    for (int i = 0; i < n; i++) prefix[i + 1] = prefix[i] + std::complex<double>(a[i]);
+    for (int i = 0; i < n; i++) {
+        const int lo = i - half < 0 ? 0 : i - half;
+        const int hi = i + half + 1 > n ? n : i + half + 1;
+        a[i] = std::complex<float>((prefix[hi] - prefix[lo]) / static_cast<double>(hi - lo));
+    }
+}
+
+/* x -= 2 Re(lowpass(x * conj(ref)) * ref) over the overlap with the audio */
+void subtract(float* x, int n, const Reference& ref, int64_t start, int half) {
+    const int64_t first = start < 0 ? -start : 0;
+    const int64_t last = start + ref.length > n ? n - start : ref.length;
+    if (last <= first) return;
+    std::vector<std::complex<float>> amp(static_cast<size_t>(last - first));
+    for (int64_t k = first; k < last; k++)
+        amp[k - first] = std::complex<float>(x[start + k] * ref.cosine[k], -x[start + k] * ref.sine[k]);
+    /* Two box passes give a triangular window, like subtractft8's cos^2 one */
+    smooth(amp, half);
+    smooth(amp, half);
+    for (int64_t k = first; k < last; k++) {
+        const std::complex<float>& a = amp[k - first];
+        x[start + k] -= 2.0f * (a.real() * ref.cosine[k] - a.imag() * ref.sine[k]);
+    }
+}
+
+} // namespace
+
+WSJTX_API int wsjtx_subtract_messages(int mode, float* samples, int num_samples,
+    const wsjtx_message_t* messages, int num_messages)
+{
+    const double origin = dt_origin(mode);
+    if (origin < 0) return WSJTX_ERR_INVALID_MODE;
+    if (!samples || num_samples <= 0 || num_messages < 0 || (num_messages > 0 && !messages))
+        return WSJTX_ERR_INVALID_ARG;
+
+    try {
+        const int rate = wsjtx_get_sample_rate(mode);
+        const int nsps = wsjtx_get_samples_per_symbol(mode);
+        const int span = nsps > rate / 8 ? nsps : rate / 8;     /* DT is reported to 0.1 s */
+        const int half = rate / 12;
+        int count = 0;
+        Reference ref;
+        for (int i = 0; i < num_messages; i++) {
+            if (!build_reference(mode, messages[i], ref)) continue;
+            const int64_t guess = std::llround((messages[i].dt + origin) * rate);
+            const int64_t start = align(samples, num_samples, ref, guess, span, nsps);
+            subtract(samples, num_samples, ref, start, half);
+            count++;
+        }
+        return count;
+    } catch (...) {
+        return WSJTX_ERR_EXCEPTION;
+    }
+}
@@ -0,0 +1,124 @@
+/**
+ * wsjtx_text.cpp - Internal message-text helpers for wsjtx_core
+ */
+
+#include "wsjtx_text.h"
+#include <cctype>
+
+namespace wsjtx_core {
+
+static inline char upper(char c) {
+    return static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+}
+
+bool is_grid_token(std::string_view tok) {
+    if (tok.size() != 4 && tok.size() != 6) return false;
+    char a = upper(tok[0]), b = upper(tok[1]);
+    if (a < 'A' || a > 'R' || b < 'A' || b > 'R') return false;
+    if (!std::isdigit(static_cast<unsigned char>(tok[2])) ||
+        !std::isdigit(static_cast<unsigned char>(tok[3]))) return false;
+    if (tok.size() == 6) {
+        char c = upper(tok[4]), d = upper(tok[5]);
+        if (c < 'A' || c > 'X' || d < 'A' || d > 'X') return false;
+    }
+    return true;
+}
+
+bool is_message_grid(std::string_view tok) {
+    if (!is_grid_token(tok)) return false;
+    return !(tok.size() == 4 && upper(tok[0]) == 'R' && upper(tok[1]) == 'R' && tok[2] == '7' && tok[3] == '3');
+}
+
+std::string extract_grid(std::string_view message) {
+    std::string_view found;
+    size_t i = 0, index = 0;
+    while (i < message.size()) {
+        while (i < message.size() && message[i] == ' ') i++;
+        size_t start = i;
+        while (i < message.size() && message[i] != ' ') i++;
+        if (i == start) break;
+        std::string_view tok = message.substr(start, i - start);
+        if (index++ > 0 && is_message_grid(tok)) found = tok;
+    }
+    std::string out(found);
+    for (auto& c : out) c = upper(c);
+    return out;
+}
+
+std::string normalize_message(std::string_view message) {
+    std::string out;
+    out.reserve(message.size());
+    for (char c : message) {
+        if (c == ' ' || c == '\t') {
+            if (!out.empty() && out.back() != ' ') out.push_back(' ');
+        } else {
+            out.push_back(upper(c));
+        }
+    }
+    /* Strip trailing annotations appended by the decoder */
+    for (;;) {
+        while (!out.empty() && out.back() == ' ') out.pop_back();
+        size_t sp = out.rfind(' ');
+        if (sp == std::string::npos) break;
+        std::string_view last(out.data() + sp + 1, out.size() - sp - 1);
+        bool ap = last.size() == 2 && last[0] == 'A' && last[1] >= '1' && last[1] <= '7';
+        if (last != "?" && !ap) break;
+        out.resize(sp);
+    }
+    return out;
+}
+
+int ap_annotation(std::string_view message) {
+    size_t end = message.find_last_not_of(" \t");
+    if (end == std::string_view::npos) return 0;
+    message = message.substr(0, end + 1);
+    /* "?" (low confidence) may follow the AP marker */
+    if (message.back() == '?') {
+        end = message.find_last_not_of(" \t", message.size() - 2);
+        if (end == std::string_view::npos) return 0;
+        message = message.substr(0, end + 1);
+    }
+    size_t sp = message.find_last_of(" \t");
+    if (sp == std::string_view::npos) return 0;
+    std::string_view last = message.substr(sp + 1);
+    if (last.size() == 2 && upper(last[0]) == 'A' && last[1] >= '1' && last[1] <= '7') return last[1] - '0';
+    return 0;
+}
+
+static std::string_view strip_brackets(std::string_view tok) {
+    if (tok.size() >= 2 && tok.front() == '<' && tok.back() == '>') return tok.substr(1, tok.size() - 2);
+    return tok;
+}
+
+bool is_call_token(std::string_view tok) {
+    tok = strip_brackets(tok);
+    if (tok.size() < 3 || tok.size() > 11) return false;
+    bool digit = false, alpha = false;
+    for (char c : tok) {
+        if (std::isdigit(static_cast<unsigned char>(c))) digit = true;
+        else if (std::isalpha(static_cast<unsigned char>(c))) alpha = true;
+        else if (c != '/') return false;
+    }
+    if (!digit || !alpha || tok.front() == '/' || tok.back() == '/') return false;
+    if (is_grid_token(tok)) return false;
+    return !(tok.size() == 4 && upper(tok[0]) == 'R' && upper(tok[1]) == 'R' && tok[2] == '7' && tok[3] == '3');
+}
+
+std::vector<std::string> extract_calls(std::string_view message) {
+    std::vector<std::string> calls;
+    size_t i = 0;
+    while (i < message.size()) {
+        while (i < message.size() && message[i] == ' ') i++;
+        size_t start = i;
+        while (i < message.size() && message[i] != ' ') i++;
+        if (i == start) break;
+        std::string_view tok = message.substr(start, i - start);
+        if (!is_call_token(tok)) continue;
+        std::string c(strip_brackets(tok));
+        for (auto& ch : c) ch = upper(ch);
+        calls.push_back(std::move(c));
+    }
+    return calls;
+}
+
+} // namespace wsjtx_core
@@ -0,0 +1,47 @@
+/**
+ * wsjtx_text.h - Internal message-text helpers for wsjtx_core
+ *
+ * Small, allocation-light parsers for decoded message text (grid and
+ * callsign extraction, normalization). Shared by the C API translation
+ * units; not part of the exported ABI.
+ */
+
+#ifndef WSJTX_TEXT_H
+#define WSJTX_TEXT_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace wsjtx_core {
+
+/* True if `tok` is a 4- or 6-character Maidenhead locator (case-insensitive),
+ * the same check as the binding's GRID_RE. */
+bool is_grid_token(std::string_view tok);
+
+/* A locator as a message token: "RR73" is a sign-off there, not a grid. */
+bool is_message_grid(std::string_view tok);
+
+/* Find the locator carried by a decoded message ("CQ K1ABC FN20",
+ * "K1ABC W9XYZ EN37", WSPR "K1ABC FN20 37"). The first token is never a
+ * grid. Returns an empty string if the message carries none. */
+std::string extract_grid(std::string_view message);
+
+/* Canonical form used for message identity: upper-case, single spaces,
+ * trimmed, with trailing decoder annotations ("?", "a1".."a7") removed. */
+std::string normalize_message(std::string_view message);
+
+/* AP type from a trailing "a1".."a7" decoder annotation, 0 if absent. */
+int ap_annotation(std::string_view message);
+
+/* True if `tok` looks like a callsign (letters and digits, optional '/',
+ * at least one of each) and is not a grid or sign-off. Hashed
+ * calls in angle brackets are accepted without the brackets. */
+bool is_call_token(std::string_view tok);
+
+/* Callsigns mentioned in a decoded message, upper-cased, in order. */
+std::vector<std::string> extract_calls(std::string_view message);
+
+} // namespace wsjtx_core
+
+#endif /* WSJTX_TEXT_H */
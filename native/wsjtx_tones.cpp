@@ -0,0 +1,367 @@
+/**
+ * wsjtx_tones.cpp - Channel tone generation and FSK synthesis for the C API
+ *
+ * Tones come from the WSJT-X Fortran generators already linked into
+ * wsjtx_lib (see wsjtx_fortran.h); audio is synthesized here with
+ * continuous phase from the per-mode symbol length and tone spacing. FT8
+ * and FT4 are Gaussian-shaped exactly as gen_ft8wave/gen_ft4wave do it, from
+ * a frequency-pulse table built once per mode; the other modes are plain
+ * CPFSK. Phase is accumulated in double precision and the sine is a
+ * branch-free polynomial the compiler vectorizes.
+ */
+
+#include "wsjtx_c_api.h"
+#include "wsjtx_fortran.h"
+#include "wsjtx_tones.h"
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <vector>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace {
+
+/* Submode parameters for each wsjtx_mode_t, at wsjtx_get_sample_rate() */
+struct ToneParams {
+    int symbols;        /* channel symbols per transmission, 0 = not encodable */
+    int samplesPerSymbol;
+    int spacingFactor;  /* tone spacing in multiples of the symbol rate */
+    double baseTone;    /* tone index at `freq` (WSPR: centre of 0..3) */
+    int messageLength;  /* Fortran CHARACTER length of the message */
+    double bt;          /* Gaussian bandwidth-time product, 0 = unshaped */
+    int padSymbols;     /* extra symbols of pulse tail kept in the output */
+    int rampDivisor;    /* end ramps last samplesPerSymbol / rampDivisor */
+};
+
+const ToneParams TONE_PARAMS[] = {
+    /* FT8       */ {  79, 7680, 1, 0.0, 37, 2.0, 0, 8 },
+    /* FT4       */ { 103, 2304, 1, 0.0, 37, 1.0, 2, 1 },
+    /* JT4A      */ { 206, 2520, 1, 0.0, 37, 0.0, 0, 8 },
+    /* JT65A     */ { 126, 4096, 1, 0.0, 37, 0.0, 0, 8 },
+    /* JT9A      */ {  85, 6912, 1, 0.0, 37, 0.0, 0, 8 },
+    /* FST4-60   */ { 160, 3888, 1, 0.0, 37, 0.0, 0, 8 },
+    /* Q65-60A   */ {  85, 7200, 1, 0.0, 37, 0.0, 0, 8 },
+    /* FST4W-120 */ { 160, 8200, 1, 0.0, 37, 0.0, 0, 8 },
+    /* JT65JT9   */ {   0,    0, 0, 0.0,  0, 0.0, 0, 0 },
+    /* WSPR-2    */ { 162, 8192, 1, 1.5, 22, 0.0, 0, 8 },
+};
+
+const int MODE_SLOTS = sizeof(TONE_PARAMS) / sizeof(TONE_PARAMS[0]);
+const double PI = 3.14159265358979323846;
+const double TWO_PI = 2.0 * PI;
+
+/* Open DecoderScopes and the generator holding the Fortran state, if any.
+ * The generators keep SAVEd packing state that the decoders use too. */
+struct FortranGate {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<std::pair<std::thread::id, bool>> decoders;  /* thread, abandoned */
+    std::vector<std::thread::id> runaways;  /* abandoned threads, until reclaimed */
+    int live = 0;               /* open scopes not abandoned */
+    int generatorsWaiting = 0;
+    bool generating = false;
+};
+
+FortranGate g_gate;
+
+/* Exclusive use of the Fortran state for one generator call */
+class GeneratorLock {
+public:
+    GeneratorLock() {
+        std::unique_lock<std::mutex> lock(g_gate.mutex);
+        g_gate.generatorsWaiting++;
+        g_gate.cv.wait(lock, [] { return !g_gate.generating && g_gate.live == 0; });
+        g_gate.generatorsWaiting--;
+        g_gate.generating = true;
+    }
+    ~GeneratorLock() {
+        {
+            std::lock_guard<std::mutex> lock(g_gate.mutex);
+            g_gate.generating = false;
+        }
+        g_gate.cv.notify_all();
+    }
+    GeneratorLock(const GeneratorLock&) = delete;
+    GeneratorLock& operator=(const GeneratorLock&) = delete;
+};
+
+inline const ToneParams* params(int mode) {
+    if (mode < 0 || mode >= MODE_SLOTS || TONE_PARAMS[mode].symbols == 0) return nullptr;
+    return &TONE_PARAMS[mode];
+}
+
+/* Phase increment per unit tone over the 3-symbol Gaussian frequency pulse
+ * (gfsk_pulse in WSJT-X), built on first use and shared by all callers */
+struct PulseTable {
+    std::once_flag once;
+    std::vector<double> dphi;
+};
+
+PulseTable g_pulses[sizeof(TONE_PARAMS) / sizeof(TONE_PARAMS[0])];
+
+const std::vector<double>& pulse_table(int mode, const ToneParams& p) {
+    PulseTable& t = g_pulses[mode];
+    std::call_once(t.once, [&] {
+        const int nsps = p.samplesPerSymbol;
+        const double c = PI * std::sqrt(2.0 / std::log(2.0));
+        const double peak = TWO_PI * p.spacingFactor / nsps;
+        t.dphi.resize(static_cast<size_t>(3 * nsps));
+        for (int i = 0; i < 3 * nsps; i++) {
+            const double tt = (i + 1 - 1.5 * nsps) / nsps;
+            t.dphi[i] = peak * 0.5 * (std::erf(c * p.bt * (tt + 0.5)) - std::erf(c * p.bt * (tt - 0.5)));
+        }
+    });
+    return t.dphi;
+}
+
+/* Wraps an accumulated phase into [-pi, pi) */
+inline double wrap_phase(double phi) {
+    while (phi >= PI) phi -= TWO_PI;
+    while (phi < -PI) phi += TWO_PI;
+    return phi;
+}
+
+/* Blank-padded Fortran CHARACTER*n from a C string (truncated to n) */
+std::string to_fortran(const char* s, size_t n) {
+    std::string out(n, ' ');
+    size_t len = strnlen(s, n);
+    memcpy(&out[0], s, len);
+    return out;
+}
+
+std::string from_fortran(const char* s, size_t n) {
+    size_t len = n;
+    while (len > 0 && (s[len - 1] == ' ' || s[len - 1] == '\0')) len--;
+    return std::string(s, len);
+}
+
+/* Runs the generator for `mode`; returns the sent text or throws */
+std::string generate(int mode, const ToneParams& p, const char* message, int* tones) {
+    const std::string msg = to_fortran(message, static_cast<size_t>(p.messageLength));
+    char sent[38];
+    memset(sent, ' ', sizeof(sent));
+    int8_t bits[101] = {};
+    int ichk = 0, itype = 0, i3 = 0, n3 = 0, iwspr = 0;
+
+    GeneratorLock lock;
+    switch (mode) {
+    case WSJTX_MODE_FT8:   genft8_(msg.data(), &i3, &n3, sent, bits, tones, 37, 37); break;
+    case WSJTX_MODE_FT4:   genft4_(msg.data(), &ichk, sent, bits, tones, 37, 37); break;
+    case WSJTX_MODE_JT4:   gen4_(msg.data(), &ichk, sent, tones, &itype, 37, 37); break;
+    case WSJTX_MODE_JT65:  gen65_(msg.data(), &ichk, sent, tones, &itype, 37, 37); break;
+    case WSJTX_MODE_JT9:   gen9_(msg.data(), &ichk, sent, tones, &itype, 37, 37); break;
+    case WSJTX_MODE_FST4:  genfst4_(msg.data(), &ichk, sent, bits, tones, &iwspr, 37, 37); break;
+    case WSJTX_MODE_Q65:   genq65_(msg.data(), &ichk, sent, tones, &i3, &n3, 37, 37); break;
+    case WSJTX_MODE_FST4W:
+        iwspr = 1;
+        genfst4_(msg.data(), &ichk, sent, bits, tones, &iwspr, 37, 37);
+        break;
+    case WSJTX_MODE_WSPR:  genwspr_(msg.data(), sent, tones, 22, 22); break;
+    default: throw std::invalid_argument("mode");
+    }
+    return from_fortran(sent, static_cast<size_t>(p.messageLength));
+}
+
+} // namespace
+
+WSJTX_API int wsjtx_get_symbol_count(int mode) {
+    const ToneParams* p = params(mode);
+    return p ? p->symbols : 0;
+}
+
+WSJTX_API int wsjtx_get_samples_per_symbol(int mode) {
+    const ToneParams* p = params(mode);
+    return p ? p->samplesPerSymbol : 0;
+}
+
+WSJTX_API int wsjtx_get_waveform_samples(int mode) {
+    const ToneParams* p = params(mode);
+    return p ? (p->symbols + p->padSymbols) * p->samplesPerSymbol : 0;
+}
+
+WSJTX_API double wsjtx_get_tone_spacing(int mode) {
+    const ToneParams* p = params(mode);
+    if (!p) return 0.0;
+    return static_cast<double>(p->spacingFactor) * wsjtx_get_sample_rate(mode) / p->samplesPerSymbol;
+}
+
+WSJTX_API int wsjtx_encode_tones(int mode, const char* message,
+    int* out_tones, int max_tones, int* out_num_tones,
+    char* out_message_sent, int out_msg_buf_size)
+{
+    const ToneParams* p = params(mode);
+    if (!p) return WSJTX_ERR_INVALID_MODE;
+    if (!message || !message[0] || !out_tones || !out_num_tones) return WSJTX_ERR_INVALID_ARG;
+    if (max_tones < p->symbols) return WSJTX_ERR_BUFFER_TOO_SMALL;
+
+    try {
+        int tones[206] = {};
+        std::string sent = generate(mode, *p, message, tones);
+        if (sent.empty()) return WSJTX_ERR_ENCODE_FAILED;
+        memcpy(out_tones, tones, static_cast<size_t>(p->symbols) * sizeof(int));
+        *out_num_tones = p->symbols;
+        if (out_message_sent && out_msg_buf_size > 0) {
+            strncpy(out_message_sent, sent.c_str(), out_msg_buf_size - 1);
+            out_message_sent[out_msg_buf_size - 1] = '\0';
+        }
+        return WSJTX_OK;
+    } catch (...) {
+        return WSJTX_ERR_EXCEPTION;
+    }
+}
+
+namespace wsjtx_core {
+
+DecoderScope::DecoderScope() {
+    std::unique_lock<std::mutex> lock(g_gate.mutex);
+    g_gate.cv.wait(lock, [] { return !g_gate.generating && g_gate.generatorsWaiting == 0; });
+    /* A runaway opening another scope (core_decode -> ap_decode) is still abandoned */
+    const std::thread::id self = std::this_thread::get_id();
+    const auto& r = g_gate.runaways;
+    const bool abandoned = std::find(r.begin(), r.end(), self) != r.end();
+    g_gate.decoders.emplace_back(self, abandoned);
+    if (!abandoned) g_gate.live++;
+}
+
+DecoderScope::~DecoderScope() {
+    {
+        std::lock_guard<std::mutex> lock(g_gate.mutex);
+        auto& d = g_gate.decoders;
+        auto it = std::find_if(d.rbegin(), d.rend(),
+            [](const auto& e) { return e.first == std::this_thread::get_id(); });
+        if (it != d.rend()) {
+            if (!it->second) g_gate.live--;
+            d.erase(std::next(it).base());
+        }
+    }
+    g_gate.cv.notify_all();
+}
+
+void abandon_decoder(std::thread::id thread) {
+    {
+        std::lock_guard<std::mutex> lock(g_gate.mutex);
+        g_gate.runaways.push_back(thread);
+        for (auto& e : g_gate.decoders) {
+            if (e.first == thread && !e.second) {
+                e.second = true;
+                g_gate.live--;
+            }
+        }
+    }
+    g_gate.cv.notify_all();
+}
+
+void reclaim_decoder(std::thread::id thread) {
+    std::lock_guard<std::mutex> lock(g_gate.mutex);
+    auto& r = g_gate.runaways;
+    auto it = std::find(r.begin(), r.end(), thread);
+    if (it != r.end()) r.erase(it);
+}
+
+/* Fold to [-pi/2, pi/2] and apply the degree-11 Taylor polynomial (error
+ * below 6e-8, i.e. float precision) */
+void fast_sin(float* x, size_t n) {
+    const float PI_F = static_cast<float>(PI);
+    const float HALF_PI_F = static_cast<float>(PI / 2);
+    for (size_t i = 0; i < n; i++) {
+        float v = x[i];
+        v = v > HALF_PI_F ? PI_F - v : v;
+        v = v < -HALF_PI_F ? -PI_F - v : v;
+        const float v2 = v * v;
+        float y = -2.5052108e-8f;
+        y = y * v2 + 2.7557319e-6f;
+        y = y * v2 - 1.9841270e-4f;
+        y = y * v2 + 8.3333333e-3f;
+        y = y * v2 - 1.6666667e-1f;
+        x[i] = v + v * v2 * y;
+    }
+}
+
+int tone_phases(int mode, const int* tones, int num_tones, double freq,
+    float* out_phases, int out_buf_size)
+{
+    const ToneParams* p = params(mode);
+    if (!p) return WSJTX_ERR_INVALID_MODE;
+    if (!tones || num_tones <= 0 || !out_phases) return WSJTX_ERR_INVALID_ARG;
+
+    const int nsps = p->samplesPerSymbol;
+    const int64_t total = static_cast<int64_t>(num_tones + p->padSymbols) * nsps;
+    if (total > out_buf_size) return WSJTX_ERR_BUFFER_TOO_SMALL;
+
+    const double rate = wsjtx_get_sample_rate(mode);
+    const double spacing = wsjtx_get_tone_spacing(mode);
+    const double carrier = TWO_PI * (freq - p->baseTone * spacing) / rate;
+    double phase = 0.0;
+    int64_t k = 0;
+
+    if (p->bt > 0.0) {
+        /* Symbol s shapes samples [s*nsps, (s+3)*nsps) of a frame of
+         * num_tones + 2 blocks. FT8 (gen_ft8wave) repeats the first and
+         * last tones as dummy symbols at s = -1 and s = num_tones and keeps
+         * blocks 1..num_tones; FT4 (gen_ft4wave) has no dummy symbols and
+         * keeps all of them. */
+        try {
+            const std::vector<double>& pulse = pulse_table(mode, *p);
+            auto tone = [&](int s) -> double {
+                if (s >= 0 && s < num_tones) return tones[s];
+                if (p->padSymbols != 0 || s < -1 || s > num_tones) return 0.0;
+                return tones[s < 0 ? 0 : num_tones - 1];
+            };
+            const int firstBlock = 1 - p->padSymbols / 2;
+            const int lastBlock = num_tones + p->padSymbols / 2;
+            for (int b = firstBlock; b <= lastBlock; b++) {
+                const double t0 = tone(b), t1 = tone(b - 1), t2 = tone(b - 2);
+                const double* p0 = &pulse[0];
+                const double* p1 = &pulse[nsps];
+                const double* p2 = &pulse[2 * nsps];
+                for (int j = 0; j < nsps; j++, k++) {
+                    out_phases[k] = static_cast<float>(phase);
+                    phase = wrap_phase(phase + carrier + t0 * p0[j] + t1 * p1[j] + t2 * p2[j]);
+                }
+            }
+        } catch (...) {
+            return WSJTX_ERR_EXCEPTION;
+        }
+    } else {
+        for (int i = 0; i < num_tones; i++) {
+            const double dphi = carrier + TWO_PI * tones[i] * spacing / rate;
+            for (int j = 0; j < nsps; j++, k++) {
+                out_phases[k] = static_cast<float>(phase);
+                phase = wrap_phase(phase + dphi);
+            }
+        }
+    }
+
+    return static_cast<int>(total);
+}
+
+} // namespace wsjtx_core
+
+WSJTX_API int wsjtx_synthesize(int mode, const int* tones, int num_tones, double freq,
+    float* out_samples, int out_buf_size, int* out_num_samples)
+{
+    if (!out_num_samples) return WSJTX_ERR_INVALID_ARG;
+
+    /* Pass 1: phase per sample, in the output buffer; pass 2: vectorized sine */
+    const int total = wsjtx_core::tone_phases(mode, tones, num_tones, freq, out_samples, out_buf_size);
+    if (total < 0) return total;
+    wsjtx_core::fast_sin(out_samples, static_cast<size_t>(total));
+
+    /* Raised-cosine ramps at both ends avoid key clicks. As in the Fortran,
+     * the rise starts at 0 and the fall ends one step short of it. */
+    const ToneParams* p = params(mode);
+    const int ramp = p->samplesPerSymbol / p->rampDivisor;
+    float* tail = out_samples + total - ramp;
+    for (int j = 0; j < ramp; j++) {
+        const double c = std::cos(TWO_PI * j / (2.0 * ramp));
+        out_samples[j] *= static_cast<float>(0.5 * (1.0 - c));
+        tail[j] *= static_cast<float>(0.5 * (1.0 + c));
+    }
+
+    *out_num_samples = total;
+    return WSJTX_OK;
+}
@@ -0,0 +1,49 @@
+/**
+ * wsjtx_tones.h - Internal waveform helpers for wsjtx_core
+ *
+ * The two passes behind wsjtx_synthesize, for translation units that need
+ * the transmitted phase rather than finished audio (signal subtraction),
+ * and the gate that keeps the tone generators off the decoders' Fortran
+ * state. Not part of the exported ABI.
+ */
+
+#ifndef WSJTX_TONES_H
+#define WSJTX_TONES_H
+
+#include <cstddef>
+#include <thread>
+
+namespace wsjtx_core {
+
+/* Instantaneous phase in [-pi, pi) of every sample wsjtx_synthesize would
+ * write for `tones` (same shaping and length, no end ramps), starting at 0.
+ * Returns the sample count or a negative WSJTX_ERR_* code. */
+int tone_phases(int mode, const int* tones, int num_tones, double freq,
+    float* out_phases, int out_buf_size);
+
+/* In-place sin() of phases in [-pi, pi), float precision, vectorizable */
+void fast_sin(float* x, size_t n);
+
+/* The Fortran decoders share SAVEd state with the tone generators (the
+ * pack77 call-hash tables among it). Every decoder call runs inside a
+ * DecoderScope; the generators wait until none is open, except on threads
+ * the watchdog has abandoned, and hold new decoders back while they run.
+ * A thread must not encode while it holds a scope. */
+class DecoderScope {
+public:
+    DecoderScope();
+    ~DecoderScope();
+    DecoderScope(const DecoderScope&) = delete;
+    DecoderScope& operator=(const DecoderScope&) = delete;
+};
+
+/* Stop waiting for the decoder open on `thread`, a runaway that may never
+ * return, and for any scope it opens until reclaim_decoder */
+void abandon_decoder(std::thread::id thread);
+
+/* The abandoned call on `thread` has returned; its scopes count again */
+void reclaim_decoder(std::thread::id thread);
+
+} // namespace wsjtx_core
+
+#endif /* WSJTX_TONES_H */
@@ -0,0 +1,145 @@
+/**
+ * wsjtx_trace.cpp - Process-wide trace-event ring buffer for the C API
+ *
+ * Spans from the addon and the core land in one fixed-size ring (oldest
+ * overwritten first) and are dumped in the Chrome trace-event JSON format,
+ * which chrome://tracing and Perfetto load directly. Each thread gets a
+ * small sequential id so worker threads line up as separate tracks.
+ */
+
+#include "wsjtx_c_api.h"
+#include "wsjtx_trace.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct TraceEvent {
+    char name[32];
+    int64_t ts;
+    int64_t dur;
+    int64_t job;
+    uint32_t tid;
+};
+
+std::atomic<bool> g_enabled{false};
+std::atomic<uint32_t> g_next_tid{1};
+std::mutex g_mutex;
+std::vector<TraceEvent> g_ring;
+uint64_t g_written = 0;
+
+thread_local uint32_t t_tid = 0;
+thread_local int64_t t_job = -1;
+
+uint32_t current_tid() {
+    if (t_tid == 0) t_tid = g_next_tid.fetch_add(1, std::memory_order_relaxed);
+    return t_tid;
+}
+
+void append_json_string(std::string& out, const char* s) {
+    out.push_back('"');
+    for (; *s; s++) {
+        unsigned char c = static_cast<unsigned char>(*s);
+        if (c == '"' || c == '\\') { out.push_back('\\'); out.push_back(static_cast<char>(c)); }
+        else if (c < 0x20) { char esc[8]; snprintf(esc, sizeof(esc), "\\u%04x", c); out += esc; }
+        else out.push_back(static_cast<char>(c));
+    }
+    out.push_back('"');
+}
+
+} // namespace
+
+namespace wsjtx_core {
+
+bool trace_enabled() {
+    return g_enabled.load(std::memory_order_relaxed);
+}
+
+} // namespace wsjtx_core
+
+WSJTX_API void wsjtx_trace_start(int capacity) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    try {
+        g_ring.assign(static_cast<size_t>(capacity > 0 ? capacity : 65536), TraceEvent());
+    } catch (...) {
+        g_ring.clear();
+        g_enabled.store(false, std::memory_order_relaxed);
+        return;
+    }
+    g_written = 0;
+    g_enabled.store(true, std::memory_order_relaxed);
+}
+
+WSJTX_API void wsjtx_trace_stop(void) {
+    g_enabled.store(false, std::memory_order_relaxed);
+}
+
+WSJTX_API int wsjtx_trace_enabled(void) {
+    return wsjtx_core::trace_enabled() ? 1 : 0;
+}
+
+WSJTX_API int64_t wsjtx_trace_now_us(void) {
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+WSJTX_API void wsjtx_trace_set_job(int64_t job) {
+    t_job = job;
+}
+
+WSJTX_API void wsjtx_trace_record(const char* name, int64_t start_us, int64_t dur_us, int64_t job) {
+    if (!wsjtx_core::trace_enabled() || !name) return;
+    TraceEvent e;
+    strncpy(e.name, name, sizeof(e.name) - 1);
+    e.name[sizeof(e.name) - 1] = '\0';
+    e.ts = start_us;
+    e.dur = dur_us < 0 ? 0 : dur_us;
+    e.job = job >= 0 ? job : t_job;
+    e.tid = current_tid();
+
+    std::lock_guard<std::mutex> lock(g_mutex);
+    if (g_ring.empty()) return;
+    g_ring[g_written % g_ring.size()] = e;
+    g_written++;
+}
+
+WSJTX_API int64_t wsjtx_trace_dump(char* buffer, int64_t size) {
+    std::string out;
+    try {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        size_t n = g_written < g_ring.size() ? static_cast<size_t>(g_written) : g_ring.size();
+        size_t first = static_cast<size_t>(g_written - n);
+        out.reserve(64 + n * 112);
+        out += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        for (size_t i = 0; i < n; i++) {
+            const TraceEvent& e = g_ring[(first + i) % g_ring.size()];
+            if (i) out.push_back(',');
+            out += "{\"name\":";
+            append_json_string(out, e.name);
+            char tail[160];
+            if (e.job >= 0) {
+                snprintf(tail, sizeof(tail),
+                    ",\"cat\":\"wsjtx\",\"ph\":\"X\",\"ts\":%lld,\"dur\":%lld,\"pid\":1,\"tid\":%u,\"args\":{\"job\":%lld}}",
+                    static_cast<long long>(e.ts), static_cast<long long>(e.dur), e.tid,
+                    static_cast<long long>(e.job));
+            } else {
+                snprintf(tail, sizeof(tail),
+                    ",\"cat\":\"wsjtx\",\"ph\":\"X\",\"ts\":%lld,\"dur\":%lld,\"pid\":1,\"tid\":%u}",
+                    static_cast<long long>(e.ts), static_cast<long long>(e.dur), e.tid);
+            }
+            out += tail;
+        }
+        out += "]}";
+    } catch (...) {
+        return WSJTX_ERR_EXCEPTION;
+    }
+
+    int64_t len = static_cast<int64_t>(out.size());
+    if (buffer && size > len) memcpy(buffer, out.c_str(), out.size() + 1);
+    return len;
+}
@@ -0,0 +1,40 @@
+/**
+ * wsjtx_trace.h - Internal span recording for wsjtx_core
+ *
+ * Thin RAII helper over the wsjtx_trace_* C API so core code can mark
+ * spans with one line. When tracing is off a span costs one relaxed
+ * atomic load. Not part of the exported ABI.
+ */
+
+#ifndef WSJTX_TRACE_H
+#define WSJTX_TRACE_H
+
+#include "wsjtx_c_api.h"
+
+namespace wsjtx_core {
+
+bool trace_enabled();
+
+/* Records [construction, destruction) as a complete event named `name`
+ * (must outlive the span; string literals in practice). */
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name)
+        : name_(trace_enabled() ? name : nullptr),
+          start_(name_ ? wsjtx_trace_now_us() : 0) {}
+
+    ~TraceSpan() {
+        if (name_) wsjtx_trace_record(name_, start_, wsjtx_trace_now_us() - start_, -1);
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* name_;
+    int64_t start_;
+};
+
+} // namespace wsjtx_core
+
+#endif /* WSJTX_TRACE_H */
@@ -0,0 +1,238 @@
+/**
+ * wsjtx_tuning.cpp - Thread-scaling autotune for the decode thread hint
+ *
+ * Decodes one synthetic slot per mode at each (threads, concurrency) pair
+ * and keeps the best pair per mode in a process-wide table that callers
+ * consult for their defaults. Decoders run on separate handles, one per
+ * concurrent job, exactly as independent WSJTXLib instances would.
+ */
+
+#include "wsjtx_c_api.h"
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const int MODE_SLOTS = 10;              /* wsjtx_mode_t values */
+const int THREADS_LIMIT = 16;
+const int CONCURRENCY_LIMIT = 64;
+const double NEAR_TIE = 0.05;           /* throughput within 5% counts as a tie */
+const double PI = 3.14159265358979323846;
+
+std::mutex g_mutex;
+wsjtx_tuning_t g_table[MODE_SLOTS];
+bool g_tuned[MODE_SLOTS] = {};
+
+/* Deterministic Gaussian noise (xorshift64 + Box-Muller) so every run and
+ * every host decodes the same slot */
+class Noise {
+public:
+    double next() {
+        if (haveSpare_) { haveSpare_ = false; return spare_; }
+        double u1 = uniform(), u2 = uniform();
+        double r = std::sqrt(-2.0 * std::log(u1));
+        spare_ = r * std::sin(2.0 * PI * u2);
+        haveSpare_ = true;
+        return r * std::cos(2.0 * PI * u2);
+    }
+
+private:
+    double uniform() {
+        state_ ^= state_ << 13;
+        state_ ^= state_ >> 7;
+        state_ ^= state_ << 17;
+        return (static_cast<double>(state_ >> 11) + 1.0) / 9007199254740993.0;
+    }
+
+    uint64_t state_ = 0x9E3779B97F4A7C15ull;
+    double spare_ = 0;
+    bool haveSpare_ = false;
+};
+
+/* One T/R period of audio at the mode's sample rate: a few signals 0.5 s in,
+ * on top of noise */
+int synth_slot(wsjtx_handle_t h, int mode, std::vector<float>& out) {
+    const int rate = wsjtx_get_sample_rate(mode);
+    out.assign(static_cast<size_t>(wsjtx_get_slot_period(mode) * rate), 0.0f);
+
+    if (wsjtx_is_encoding_supported(mode)) {
+        static const char* const MESSAGES[] = { "CQ K1ABC FN42", "W9XYZ K1ABC -11", "K1ABC W9XYZ RR73" };
+        static const char* const BEACONS[] = { "K1ABC FN42 37", "W9XYZ EN37 30", "G4ABC IO91 23" };
+        static const int FREQS[] = { 700, 1400, 2100 };
+        const char* const* texts = mode == WSJTX_MODE_FST4W ? BEACONS : MESSAGES;
+        const int capacity = wsjtx_get_waveform_samples(mode);
+        std::vector<float> tx(static_cast<size_t>(capacity));
+        const size_t start = static_cast<size_t>(rate / 2);
+        for (int i = 0; i < 3; i++) {
+            int n = 0;
+            int rc = wsjtx_encode(h, mode, FREQS[i], texts[i], tx.data(), &n, capacity, nullptr, 0);
+            if (rc != WSJTX_OK) return rc;
+            for (int k = 0; k < n && start + k < out.size(); k++) out[start + k] += 0.2f * tx[k];
+        }
+    }
+
+    Noise noise;
+    for (float& v : out) v += static_cast<float>(0.05 * noise.next());
+    return WSJTX_OK;
+}
+
+/* Decoder handles for the run, destroyed on every exit path */
+struct HandleSet {
+    std::vector<wsjtx_handle_t> handles;
+    ~HandleSet() { for (auto h : handles) wsjtx_destroy(h); }
+};
+
+struct Measurement {
+    int rc = WSJTX_OK;
+    double latencyMs = 0;
+    double throughput = 0;
+};
+
+/* `concurrency` decoders each decode the slot `repeats` times in parallel */
+Measurement measure(const std::vector<wsjtx_handle_t>& handles, int mode, const std::vector<float>& slot,
+    int threads, int concurrency, int repeats)
+{
+    using clock = std::chrono::steady_clock;
+    std::vector<double> busyMs(concurrency, 0.0);
+    std::vector<int> rcs(concurrency, WSJTX_OK);
+
+    auto run = [&](int j) {
+        wsjtx_decode_options_t opts = {};
+        opts.frequency = 1500;
+        opts.threads = threads;
+        opts.low_freq = 200;
+        opts.high_freq = 4000;
+        opts.tolerance = 20;
+        wsjtx_message_t msgs[64];
+        for (int r = 0; r < repeats; r++) {
+            auto t0 = clock::now();
+            int rc = wsjtx_decode_float_v2(handles[j], mode, slot.data(),
+                static_cast<int>(slot.size()), &opts);
+            while (wsjtx_pull_messages(handles[j], msgs, 64) > 0) {}
+            busyMs[j] += std::chrono::duration<double, std::milli>(clock::now() - t0).count();
+            if (rc != WSJTX_OK) { rcs[j] = rc; return; }
+        }
+    };
+
+    Measurement m;
+    auto start = clock::now();
+    std::vector<std::thread> workers;
+    try {
+        for (int j = 1; j < concurrency; j++) workers.emplace_back(run, j);
+    } catch (...) {
+        for (auto& w : workers) w.join();
+        throw;
+    }
+    run(0);
+    for (auto& w : workers) w.join();
+    double wallMs = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+
+    for (int j = 0; j < concurrency; j++) {
+        if (rcs[j] != WSJTX_OK) m.rc = rcs[j];
+        m.latencyMs += busyMs[j];
+    }
+    m.latencyMs /= static_cast<double>(concurrency) * repeats;
+    m.throughput = wallMs > 0 ? concurrency * repeats * 1000.0 / wallMs : 0;
+    return m;
+}
+
+/* True if `a` should replace the current best `b` for a slot budget in ms */
+bool better(const wsjtx_tuning_t& a, const wsjtx_tuning_t& b, double budgetMs) {
+    bool aFits = a.latency_ms <= budgetMs, bFits = b.latency_ms <= budgetMs;
+    if (aFits != bFits) return aFits;
+    if (!aFits) return a.latency_ms < b.latency_ms;
+    if (a.throughput > b.throughput * (1.0 + NEAR_TIE)) return true;
+    if (b.throughput > a.throughput * (1.0 + NEAR_TIE)) return false;
+    return a.threads * a.concurrency < b.threads * b.concurrency;
+}
+
+bool valid_levels(const int* levels, int count, int limit) {
+    if (!levels || count <= 0) return false;
+    for (int i = 0; i < count; i++)
+        if (levels[i] < 1 || levels[i] > limit) return false;
+    return true;
+}
+
+} // namespace
+
+WSJTX_API int wsjtx_autotune(const int* modes, int num_modes,
+    const int* thread_counts, int num_thread_counts,
+    const int* concurrency, int num_concurrency,
+    int repeats, wsjtx_tuning_t* out_results)
+{
+    if (!modes || num_modes <= 0 || !out_results || repeats < 1) return WSJTX_ERR_INVALID_ARG;
+    if (!valid_levels(thread_counts, num_thread_counts, THREADS_LIMIT) ||
+        !valid_levels(concurrency, num_concurrency, CONCURRENCY_LIMIT)) return WSJTX_ERR_INVALID_ARG;
+    for (int i = 0; i < num_modes; i++) {
+        if (!wsjtx_is_decoding_supported(modes[i]) || modes[i] == WSJTX_MODE_WSPR) return WSJTX_ERR_INVALID_MODE;
+    }
+
+    int maxConcurrency = 0;
+    for (int i = 0; i < num_concurrency; i++)
+        if (concurrency[i] > maxConcurrency) maxConcurrency = concurrency[i];
+
+    try {
+        HandleSet set;
+        for (int j = 0; j < maxConcurrency; j++) {
+            wsjtx_handle_t h = wsjtx_create();
+            if (!h) return WSJTX_ERR_EXCEPTION;
+            set.handles.push_back(h);
+        }
+        const std::vector<wsjtx_handle_t>& handles = set.handles;
+
+        for (int i = 0; i < num_modes; i++) {
+            const int mode = modes[i];
+            std::vector<float> slot;
+            int rc = synth_slot(handles[0], mode, slot);
+            if (rc != WSJTX_OK) return rc;
+
+            /* Warm every decoder once (FFT plans, tables) outside the timing */
+            Measurement warm = measure(handles, mode, slot, 1, maxConcurrency, 1);
+            if (warm.rc != WSJTX_OK) return warm.rc;
+
+            const double budgetMs = wsjtx_get_slot_period(mode) * 1000.0;
+            wsjtx_tuning_t best = {};
+            bool found = false;
+            for (int t = 0; t < num_thread_counts; t++) {
+                for (int c = 0; c < num_concurrency; c++) {
+                    Measurement m = measure(handles, mode, slot, thread_counts[t], concurrency[c], repeats);
+                    if (m.rc != WSJTX_OK) return m.rc;
+                    wsjtx_tuning_t candidate = { mode, thread_counts[t], concurrency[c], m.latencyMs, m.throughput };
+                    if (!found || better(candidate, best, budgetMs)) best = candidate;
+                    found = true;
+                }
+            }
+            out_results[i] = best;
+            wsjtx_tuning_set(&best);
+        }
+    } catch (...) {
+        return WSJTX_ERR_EXCEPTION;
+    }
+    return WSJTX_OK;
+}
+
+WSJTX_API int wsjtx_tuning_set(const wsjtx_tuning_t* tuning) {
+    if (!tuning || tuning->mode < 0 || tuning->mode >= MODE_SLOTS) return WSJTX_ERR_INVALID_MODE;
+    if (tuning->threads > THREADS_LIMIT || tuning->concurrency > CONCURRENCY_LIMIT) return WSJTX_ERR_INVALID_ARG;
+    std::lock_guard<std::mutex> lock(g_mutex);
+    if (tuning->threads <= 0) {
+        g_tuned[tuning->mode] = false;
+        return WSJTX_OK;
+    }
+    g_table[tuning->mode] = *tuning;
+    if (g_table[tuning->mode].concurrency < 1) g_table[tuning->mode].concurrency = 1;
+    g_tuned[tuning->mode] = true;
+    return WSJTX_OK;
+}
+
+WSJTX_API int wsjtx_tuning_get(int mode, wsjtx_tuning_t* out) {
+    if (mode < 0 || mode >= MODE_SLOTS || !out) return 0;
+    std::lock_guard<std::mutex> lock(g_mutex);
+    if (!g_tuned[mode]) return 0;
+    *out = g_table[mode];
+    return 1;
+}
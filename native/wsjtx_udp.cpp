@@ -0,0 +1,305 @@
+/**
+ * wsjtx_udp.cpp - WSJT-X UDP protocol emitter for the C API
+ *
+ * Serializes Heartbeat / Status / Decode / WSPRDecode messages in the
+ * WSJT-X NetworkMessage format (QDataStream, big-endian, schema 2) straight
+ * from the C structs into a datagram buffer owned by the emitter, then
+ * sends them to a unicast or multicast destination. No per-message heap
+ * allocation happens on the send path.
+ */
+
+#include "wsjtx_c_api.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+
+#ifdef _WIN32
+  #include <winsock2.h>
+  #include <ws2tcpip.h>
+  typedef SOCKET socket_t;
+  #define WSJTX_INVALID_SOCKET INVALID_SOCKET
+  #define wsjtx_close_socket closesocket
+#else
+  #include <netdb.h>
+  #include <netinet/in.h>
+  #include <sys/socket.h>
+  #include <unistd.h>
+  typedef int socket_t;
+  #define WSJTX_INVALID_SOCKET (-1)
+  #define wsjtx_close_socket close
+#endif
+
+namespace {
+
+const uint32_t MAGIC = 0xadbccbda;
+const uint32_t SCHEMA = 2;
+
+enum MessageType : uint32_t {
+    MSG_HEARTBEAT   = 0,
+    MSG_STATUS      = 1,
+    MSG_DECODE      = 2,
+    MSG_WSPR_DECODE = 10,
+};
+
+/* Single-character mode tags used in Decode messages (as WSJT-X sends them) */
+const char* const MODE_TAGS[] = {
+    /* FT8 */ "~", /* FT4 */ "+", /* JT4 */ "$", /* JT65 */ "#", /* JT9 */ "@",
+    /* FST4 */ "`", /* Q65 */ ":", /* FST4W */ "`", /* JT65JT9 */ "#", /* WSPR */ "",
+};
+
+/* QDataStream writer over a fixed buffer; sets `overflow` instead of growing */
+class DatagramWriter {
+public:
+    DatagramWriter(uint8_t* buf, size_t cap) : buf_(buf), cap_(cap) {}
+
+    void u8(uint8_t v) { if (reserve(1)) buf_[len_++] = v; }
+    void boolean(bool v) { u8(v ? 1 : 0); }
+    void u32(uint32_t v) {
+        if (!reserve(4)) return;
+        buf_[len_++] = static_cast<uint8_t>(v >> 24);
+        buf_[len_++] = static_cast<uint8_t>(v >> 16);
+        buf_[len_++] = static_cast<uint8_t>(v >> 8);
+        buf_[len_++] = static_cast<uint8_t>(v);
+    }
+    void i32(int32_t v) { u32(static_cast<uint32_t>(v)); }
+    void u64(uint64_t v) { u32(static_cast<uint32_t>(v >> 32)); u32(static_cast<uint32_t>(v)); }
+    void f64(double v) { uint64_t bits; memcpy(&bits, &v, sizeof(bits)); u64(bits); }
+
+    /* QByteArray (utf8) : quint32 length followed by the bytes */
+    void utf8(const char* s, size_t max) {
+        size_t n = s ? strnlen(s, max) : 0;
+        /* Trim trailing padding the Fortran side leaves in fixed fields */
+        while (n > 0 && s[n - 1] == ' ') n--;
+        u32(static_cast<uint32_t>(n));
+        if (n && reserve(n)) { memcpy(buf_ + len_, s, n); len_ += n; }
+    }
+
+    void header(MessageType type, const std::string& id) {
+        len_ = 0;
+        overflow = false;
+        u32(MAGIC);
+        u32(SCHEMA);
+        u32(type);
+        utf8(id.c_str(), id.size());
+    }
+
+    size_t size() const { return len_; }
+    bool overflow = false;
+
+private:
+    bool reserve(size_t n) {
+        if (len_ + n > cap_) { overflow = true; return false; }
+        return true;
+    }
+
+    uint8_t* buf_;
+    size_t cap_;
+    size_t len_ = 0;
+};
+
+#ifdef _WIN32
+std::once_flag g_wsa_once;
+#endif
+
+class UdpEmitter {
+public:
+    UdpEmitter(socket_t sock, const sockaddr_storage& addr, socklen_t addrLen, std::string id)
+        : sock_(sock), addr_(addr), addrLen_(addrLen), id_(std::move(id)),
+          writer_(buffer_, sizeof(buffer_)) {}
+
+    ~UdpEmitter() { wsjtx_close_socket(sock_); }
+
+    DatagramWriter& begin(MessageType type) {
+        writer_.header(type, id_);
+        return writer_;
+    }
+
+    /* Returns 1 if a datagram was sent, or a negative error code */
+    int send() {
+        if (writer_.overflow) return WSJTX_ERR_BUFFER_TOO_SMALL;
+        int n = static_cast<int>(sendto(sock_, reinterpret_cast<const char*>(buffer_),
+            static_cast<int>(writer_.size()), 0,
+            reinterpret_cast<const sockaddr*>(&addr_), addrLen_));
+        return n < 0 ? WSJTX_ERR_IO : 1;
+    }
+
+    std::mutex mutex;
+
+private:
+    socket_t sock_;
+    sockaddr_storage addr_;
+    socklen_t addrLen_;
+    std::string id_;
+    uint8_t buffer_[2048];   /* largest message (Status) is well under 1 KB */
+    DatagramWriter writer_;
+};
+
+inline UdpEmitter* to_udp(wsjtx_udp_t h) {
+    return static_cast<UdpEmitter*>(h);
+}
+
+inline uint32_t message_time_ms(const wsjtx_message_t& m) {
+    return static_cast<uint32_t>(((m.hh * 60 + m.min) * 60 + m.sec) * 1000);
+}
+
+} // namespace
+
+WSJTX_API wsjtx_udp_t wsjtx_udp_create(const char* host, int port,
+    const char* client_id, int multicast_ttl)
+{
+    if (!host || port <= 0 || port > 65535) return nullptr;
+
+#ifdef _WIN32
+    std::call_once(g_wsa_once, [] { WSADATA d; WSAStartup(MAKEWORD(2, 2), &d); });
+#endif
+
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo* res = nullptr;
+    std::string portStr = std::to_string(port);
+    if (getaddrinfo(host, portStr.c_str(), &hints, &res) != 0 || !res) return nullptr;
+
+    sockaddr_storage addr;
+    memset(&addr, 0, sizeof(addr));
+    memcpy(&addr, res->ai_addr, res->ai_addrlen);
+    socklen_t addrLen = static_cast<socklen_t>(res->ai_addrlen);
+    int family = res->ai_family;
+    freeaddrinfo(res);
+
+    socket_t sock = socket(family, SOCK_DGRAM, 0);
+    if (sock == WSJTX_INVALID_SOCKET) return nullptr;
+
+    if (multicast_ttl > 0) {
+        if (family == AF_INET) {
+            unsigned char ttl = static_cast<unsigned char>(multicast_ttl > 255 ? 255 : multicast_ttl);
+            setsockopt(sock, IPPROTO_IP, IP_MULTICAST_TTL, reinterpret_cast<const char*>(&ttl), sizeof(ttl));
+        } else if (family == AF_INET6) {
+            int hops = multicast_ttl;
+            setsockopt(sock, IPPROTO_IPV6, IPV6_MULTICAST_HOPS, reinterpret_cast<const char*>(&hops), sizeof(hops));
+        }
+    }
+
+    try {
+        return static_cast<wsjtx_udp_t>(new UdpEmitter(sock, addr, addrLen,
+            client_id && client_id[0] ? client_id : "WSJT-X"));
+    } catch (...) {
+        wsjtx_close_socket(sock);
+        return nullptr;
+    }
+}
+
+WSJTX_API void wsjtx_udp_destroy(wsjtx_udp_t udp) {
+    delete to_udp(udp);
+}
+
+WSJTX_API int wsjtx_udp_send_heartbeat(wsjtx_udp_t udp, const char* version, const char* revision) {
+    if (!udp) return WSJTX_ERR_INVALID_HANDLE;
+    UdpEmitter* e = to_udp(udp);
+    std::lock_guard<std::mutex> lock(e->mutex);
+    DatagramWriter& w = e->begin(MSG_HEARTBEAT);
+    w.u32(3);   /* maximum schema number understood */
+    w.utf8(version, 64);
+    w.utf8(revision, 64);
+    return e->send();
+}
+
+WSJTX_API int wsjtx_udp_send_status(wsjtx_udp_t udp, const wsjtx_udp_status_t* st) {
+    if (!udp) return WSJTX_ERR_INVALID_HANDLE;
+    if (!st) return WSJTX_ERR_INVALID_ARG;
+    UdpEmitter* e = to_udp(udp);
+    std::lock_guard<std::mutex> lock(e->mutex);
+    DatagramWriter& w = e->begin(MSG_STATUS);
+    w.u64(st->dial_frequency);
+    w.utf8(st->mode, sizeof(st->mode));
+    w.utf8(st->dx_call, sizeof(st->dx_call));
+    w.utf8(st->report, sizeof(st->report));
+    w.utf8(st->tx_mode, sizeof(st->tx_mode));
+    w.boolean(st->tx_enabled);
+    w.boolean(st->transmitting);
+    w.boolean(st->decoding);
+    w.u32(st->rx_df);
+    w.u32(st->tx_df);
+    w.utf8(st->de_call, sizeof(st->de_call));
+    w.utf8(st->de_grid, sizeof(st->de_grid));
+    w.utf8(st->dx_grid, sizeof(st->dx_grid));
+    w.boolean(st->tx_watchdog);
+    w.utf8(st->sub_mode, sizeof(st->sub_mode));
+    w.boolean(st->fast_mode);
+    w.u8(static_cast<uint8_t>(st->special_op_mode));
+    w.u32(st->freq_tolerance);
+    w.u32(st->tr_period);
+    w.utf8(st->config_name, sizeof(st->config_name));
+    w.utf8(st->tx_message, sizeof(st->tx_message));
+    return e->send();
+}
+
+WSJTX_API int wsjtx_udp_send_decodes(wsjtx_udp_t udp, int mode,
+    const wsjtx_message_t* messages, int count, const int* is_new)
+{
+    if (!udp) return WSJTX_ERR_INVALID_HANDLE;
+    if (mode < 0 || mode > WSJTX_MODE_WSPR) return WSJTX_ERR_INVALID_MODE;
+    if (count < 0 || (count > 0 && !messages)) return WSJTX_ERR_INVALID_ARG;
+
+    UdpEmitter* e = to_udp(udp);
+    std::lock_guard<std::mutex> lock(e->mutex);
+    int sent = 0;
+    for (int i = 0; i < count; i++) {
+        const wsjtx_message_t& m = messages[i];
+        DatagramWriter& w = e->begin(MSG_DECODE);
+        w.boolean(is_new ? is_new[i] != 0 : true);
+        w.u32(message_time_ms(m));
+        w.i32(m.snr);
+        w.f64(m.dt);
+        w.u32(static_cast<uint32_t>(m.freq));
+        w.utf8(MODE_TAGS[mode], 4);
+        w.utf8(m.msg, sizeof(m.msg));
+        w.boolean(false);   /* low confidence */
+        w.boolean(false);   /* off air */
+        int rc = e->send();
+        if (rc < 0) return sent > 0 ? sent : rc;
+        sent++;
+    }
+    return sent;
+}
+
+WSJTX_API int wsjtx_udp_send_wspr_decodes(wsjtx_udp_t udp,
+    const wsjtx_decoder_result_t* results, int count,
+    uint32_t time_ms, uint64_t dial_frequency)
+{
+    if (!udp) return WSJTX_ERR_INVALID_HANDLE;
+    if (count < 0 || (count > 0 && !results)) return WSJTX_ERR_INVALID_ARG;
+
+    UdpEmitter* e = to_udp(udp);
+    std::lock_guard<std::mutex> lock(e->mutex);
+    int sent = 0;
+    for (int i = 0; i < count; i++) {
+        const wsjtx_decoder_result_t& r = results[i];
+        /* wsprd reports the spot frequency in MHz; absolute values pass through */
+        uint64_t freq = r.freq < 1e5 ? static_cast<uint64_t>(std::llround(r.freq * 1e6))
+                                     : static_cast<uint64_t>(std::llround(r.freq));
+        if (freq == 0) freq = dial_frequency;
+
+        char pwr[sizeof(r.pwr) + 1] = {0};
+        memcpy(pwr, r.pwr, sizeof(r.pwr));
+
+        DatagramWriter& w = e->begin(MSG_WSPR_DECODE);
+        w.boolean(true);
+        w.u32(time_ms);
+        w.i32(static_cast<int32_t>(std::lround(r.snr)));
+        w.f64(r.dt);
+        w.u64(freq);
+        w.i32(static_cast<int32_t>(std::lround(r.drift)));
+        w.utf8(r.call, sizeof(r.call));
+        w.utf8(r.loc, sizeof(r.loc));
+        w.i32(atoi(pwr));
+        w.boolean(false);   /* off air */
+        int rc = e->send();
+        if (rc < 0) return sent > 0 ? sent : rc;
+        sent++;
+    }
+    return sent;
+}
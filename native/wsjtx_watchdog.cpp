@@ -0,0 +1,239 @@
+/**
+ * wsjtx_watchdog.cpp - Wall-time limits for decodes and handle quarantine
+ *
+ * The Fortran decoders cannot be interrupted, and a rare input can keep
+ * one spinning for far longer than a slot. A watched decode therefore runs
+ * on a thread of the core job pool while the caller waits with a deadline
+ * from the moment it starts; past it the caller returns an error and is
+ * free again, the runaway is left to finish (or not) on that thread, the
+ * pool is lent a thread in its place, and its handle is quarantined so no
+ * more work queues up behind it. Runaways share the decoders' Fortran state
+ * with everything else, so only a few may be left running at once; past
+ * that new watched decodes are refused. Handles are reference counted by
+ * the jobs that use them, so an owner can retire a quarantined handle at
+ * once and it is destroyed only when the runaway lets go of it.
+ */
+
+#include "wsjtx_c_api.h"
+#include "wsjtx_pool.h"
+#include "wsjtx_tones.h"
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+
+const int MODE_SLOTS = 10;              /* wsjtx_mode_t values */
+const double DEFAULT_PERIODS = 2.0;     /* default limit in T/R periods */
+const int MAX_RUNAWAYS = 4;             /* left running before watched decodes are refused */
+
+struct HandleState {
+    int holds = 0;
+    bool quarantined = false;
+    bool retired = false;
+};
+
+/* One watched call, shared by the caller and the pool thread running it */
+struct Call {
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool started = false;
+    bool done = false;
+    bool abandoned = false;
+    int rc = 0;
+    int (*fn)(void*) = nullptr;
+    void (*abandon)(void*) = nullptr;
+    void* ctx = nullptr;
+    wsjtx_handle_t handle = nullptr;
+    std::thread::id runner;
+    std::chrono::steady_clock::time_point start;
+    std::shared_ptr<Call> self;   /* the pool job's reference, dropped when it ends */
+};
+
+std::mutex g_mutex;
+std::unordered_map<wsjtx_handle_t, HandleState> g_handles;
+double g_limits[MODE_SLOTS];
+bool g_limitSet[MODE_SLOTS] = {};
+int64_t g_watched = 0;
+int64_t g_timeouts = 0;
+int g_runaways = 0;
+
+inline bool valid_mode(int mode) {
+    return mode >= 0 && mode < MODE_SLOTS;
+}
+
+double limit_locked(int mode) {
+    return g_limitSet[mode] ? g_limits[mode] : DEFAULT_PERIODS * wsjtx_get_slot_period(mode);
+}
+
+/* Drop one reference; true if the handle is now to be destroyed */
+bool release_locked(wsjtx_handle_t handle) {
+    auto it = g_handles.find(handle);
+    if (it == g_handles.end()) return false;
+    HandleState& s = it->second;
+    if (s.holds > 0) s.holds--;
+    if (s.holds > 0) return false;
+    const bool destroy = s.retired;
+    if (destroy || !s.quarantined) g_handles.erase(it);
+    return destroy;
+}
+
+/* Pool job: run the call, and clean up after it if the caller gave up */
+void run_call(void* p) {
+    std::shared_ptr<Call> call = std::move(static_cast<Call*>(p)->self);
+    {
+        std::lock_guard<std::mutex> lock(call->mutex);
+        call->runner = std::this_thread::get_id();
+        call->start = std::chrono::steady_clock::now();
+        call->started = true;
+    }
+    call->cv.notify_one();
+    const int rc = call->fn(call->ctx);
+    bool abandoned;
+    {
+        std::lock_guard<std::mutex> lock(call->mutex);
+        call->rc = rc;
+        call->done = true;
+        abandoned = call->abandoned;
+    }
+    call->cv.notify_one();
+    if (abandoned) {
+        wsjtx_core::reclaim_decoder(std::this_thread::get_id());
+        call->abandon(call->ctx);
+    }
+    bool destroy;
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        if (abandoned) g_runaways--;
+        destroy = release_locked(call->handle);
+    }
+    if (destroy) wsjtx_destroy(call->handle);
+    if (abandoned) wsjtx_core::pool_lend(-1);   /* this thread is the pool's again */
+}
+
+} // namespace
+
+WSJTX_API int wsjtx_watchdog_set_limit(int mode, double seconds) {
+    if (!valid_mode(mode)) return WSJTX_ERR_INVALID_MODE;
+    if (!(seconds >= 0.0)) return WSJTX_ERR_INVALID_ARG;
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_limits[mode] = seconds;
+    g_limitSet[mode] = true;
+    return WSJTX_OK;
+}
+
+WSJTX_API double wsjtx_watchdog_get_limit(int mode) {
+    if (!valid_mode(mode)) return 0.0;
+    std::lock_guard<std::mutex> lock(g_mutex);
+    return limit_locked(mode);
+}
+
+WSJTX_API int wsjtx_watchdog_run(wsjtx_handle_t handle, int mode,
+    int (*fn)(void* ctx), void (*abandon)(void* ctx), void* ctx)
+{
+    if (!handle) return WSJTX_ERR_INVALID_HANDLE;
+    if (!valid_mode(mode)) return WSJTX_ERR_INVALID_MODE;
+    if (!fn || !abandon) return WSJTX_ERR_INVALID_ARG;
+
+    /* A pool thread waiting on the pool could wait for itself */
+    const bool inline_only = wsjtx_core::pool_thread();
+    double limit;
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        auto it = g_handles.find(handle);
+        if (it != g_handles.end() && it->second.quarantined) return WSJTX_ERR_QUARANTINED;
+        limit = inline_only ? 0.0 : limit_locked(mode);
+        if (limit > 0.0) {
+            if (g_runaways >= MAX_RUNAWAYS) return WSJTX_ERR_BUSY;
+            g_watched++;
+            g_handles[handle].holds++;   /* the pool job's reference */
+        }
+    }
+    if (limit <= 0.0) return fn(ctx);
+
+    auto call = std::make_shared<Call>();
+    call->fn = fn;
+    call->abandon = abandon;
+    call->ctx = ctx;
+    call->handle = handle;
+    call->self = call;
+    if (wsjtx_pool_submit(&run_call, call.get()) != WSJTX_OK) {
+        /* No thread to spare: run unwatched rather than fail */
+        call->self.reset();
+        {
+            std::lock_guard<std::mutex> lock(g_mutex);
+            g_watched--;
+        }
+        wsjtx_watchdog_release(handle);
+        return fn(ctx);
+    }
+
+    /* The limit counts from the start, not from time queued behind other jobs */
+    std::unique_lock<std::mutex> lock(call->mutex);
+    call->cv.wait(lock, [&call] { return call->started; });
+    const auto deadline = call->start +
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(limit));
+    if (call->cv.wait_until(lock, deadline, [&call] { return call->done; }))
+        return call->rc;
+    call->abandoned = true;
+    /* Encoders no longer wait for this decoder's Fortran state */
+    wsjtx_core::abandon_decoder(call->runner);
+    {
+        std::lock_guard<std::mutex> glock(g_mutex);
+        g_timeouts++;
+        g_runaways++;
+        g_handles[handle].quarantined = true;
+    }
+    wsjtx_core::pool_lend(1);   /* the runaway holds its pool thread */
+    return WSJTX_ERR_TIMEOUT;
+}
+
+WSJTX_API int wsjtx_watchdog_quarantined(wsjtx_handle_t handle) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    auto it = g_handles.find(handle);
+    return it != g_handles.end() && it->second.quarantined ? 1 : 0;
+}
+
+WSJTX_API void wsjtx_watchdog_hold(wsjtx_handle_t handle) {
+    if (!handle) return;
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_handles[handle].holds++;
+}
+
+WSJTX_API void wsjtx_watchdog_release(wsjtx_handle_t handle) {
+    if (!handle) return;
+    bool destroy;
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        destroy = release_locked(handle);
+    }
+    if (destroy) wsjtx_destroy(handle);
+}
+
+WSJTX_API void wsjtx_watchdog_retire(wsjtx_handle_t handle) {
+    if (!handle) return;
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        auto it = g_handles.find(handle);
+        if (it != g_handles.end() && it->second.holds > 0) {
+            it->second.retired = true;
+            return;
+        }
+        if (it != g_handles.end()) g_handles.erase(it);
+    }
+    wsjtx_destroy(handle);
+}
+
+WSJTX_API void wsjtx_watchdog_stats(wsjtx_watchdog_stats_t* out) {
+    if (!out) return;
+    std::lock_guard<std::mutex> lock(g_mutex);
+    out->watched = g_watched;
+    out->timeouts = g_timeouts;
+    out->runaways = g_runaways;
+    out->quarantined = 0;
+    for (const auto& h : g_handles)
+        if (h.second.quarantined) out->quarantined++;
+}
@@ -1,14 +1,528 @@
 #include "wsjtx_wrapper.h"
 #include <algorithm>
+#include <atomic>
+#include <cstdlib>
 #include <cmath>
 #include <cstring>
 #include <stdexcept>
 #include <string>
+#include <system_error>
+#include <thread>
 #include <vector>
 
 namespace wsjtx_nodejs
 {
 
+    // ---- Tracing ----
+
+    static std::atomic<int64_t> g_traceJobs{0};
+
+    // Records [construction, destruction) as a span when tracing is on
+    class TraceScope {
+    public:
+        TraceScope(const char *name, int64_t job)
+            : name_(wsjtx_trace_enabled() ? name : nullptr), job_(job),
+              start_(name_ ? wsjtx_trace_now_us() : 0) {}
+        ~TraceScope() {
+            if (name_) wsjtx_trace_record(name_, start_, wsjtx_trace_now_us() - start_, job_);
+        }
+    private:
+        const char *name_;
+        int64_t job_;
+        int64_t start_;
+    };
+
+    static Napi::Value StartTrace(const Napi::CallbackInfo &info)
+    {
+        int capacity = info.Length() > 0 && info[0].IsNumber() ? info[0].As<Napi::Number>().Int32Value() : 0;
+        wsjtx_trace_start(capacity);
+        return info.Env().Undefined();
+    }
+
+    static Napi::Value StopTrace(const Napi::CallbackInfo &info)
+    {
+        wsjtx_trace_stop();
+        return info.Env().Undefined();
+    }
+
+    static Napi::Value DumpTrace(const Napi::CallbackInfo &info)
+    {
+        Napi::Env env = info.Env();
+        // Spans may land between sizing and rendering; retry until the text fits
+        std::string json;
+        int64_t len = wsjtx_trace_dump(nullptr, 0);
+        while (len >= 0) {
+            json.resize(static_cast<size_t>(len) + 1);
+            int64_t n = wsjtx_trace_dump(&json[0], static_cast<int64_t>(json.size()));
+            if (n < 0) { len = n; break; }
+            if (n <= len) { json.resize(static_cast<size_t>(n)); break; }
+            len = n;
+        }
+        if (len < 0) {
+            Napi::Error::New(env, "Trace dump failed").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        return Napi::String::New(env, json);
+    }
+
+    // ---- Metrics ----
+
+    static Napi::Value GetMetrics(const Napi::CallbackInfo &info)
+    {
+        Napi::Env env = info.Env();
+        std::string text;
+        int64_t len = wsjtx_metrics_prometheus(nullptr, 0);
+        while (len >= 0) {
+            text.resize(static_cast<size_t>(len) + 1);
+            int64_t n = wsjtx_metrics_prometheus(&text[0], static_cast<int64_t>(text.size()));
+            if (n < 0) { len = n; break; }
+            if (n <= len) { text.resize(static_cast<size_t>(n)); break; }
+            len = n;
+        }
+        if (len < 0) {
+            Napi::Error::New(env, "Metrics export failed").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        return Napi::String::New(env, text);
+    }
+
+    static Napi::Value LatencyQuantile(const Napi::CallbackInfo &info)
+    {
+        Napi::Env env = info.Env();
+        if (info.Length() < 4 || !info[0].IsString() || !info[1].IsNumber() ||
+            !info[2].IsNumber() || !info[3].IsNumber()) {
+            Napi::TypeError::New(env, "Expected: receiver, op, mode, quantile[, queue]").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        std::string receiver = info[0].As<Napi::String>().Utf8Value();
+        bool queue = info.Length() > 4 && info[4].ToBoolean();
+        return Napi::Number::New(env, wsjtx_metrics_quantile(receiver.c_str(),
+            info[1].As<Napi::Number>().Int32Value(), info[2].As<Napi::Number>().Int32Value(),
+            info[3].As<Napi::Number>().DoubleValue(), queue ? 1 : 0));
+    }
+
+    static Napi::Value ResetMetrics(const Napi::CallbackInfo &info)
+    {
+        wsjtx_metrics_reset();
+        return info.Env().Undefined();
+    }
+
+    // ---- Autotune ----
+
+    static Napi::Object CreateTuningObject(Napi::Env env, const wsjtx_tuning_t &t)
+    {
+        Napi::Object o = Napi::Object::New(env);
+        o.Set("mode", Napi::Number::New(env, t.mode));
+        o.Set("threads", Napi::Number::New(env, t.threads));
+        o.Set("concurrency", Napi::Number::New(env, t.concurrency));
+        o.Set("latencyMs", Napi::Number::New(env, t.latency_ms));
+        o.Set("throughput", Napi::Number::New(env, t.throughput));
+        return o;
+    }
+
+    static std::vector<int> ReadIntArray(Napi::Value value)
+    {
+        Napi::Array arr = value.As<Napi::Array>();
+        std::vector<int> out(arr.Length());
+        for (uint32_t i = 0; i < arr.Length(); i++) out[i] = arr.Get(i).As<Napi::Number>().Int32Value();
+        return out;
+    }
+
+    static Napi::Value Autotune(const Napi::CallbackInfo &info)
+    {
+        Napi::Env env = info.Env();
+        if (info.Length() < 5 || !info[0].IsArray() || !info[1].IsArray() || !info[2].IsArray() ||
+            !info[3].IsNumber() || !info[4].IsFunction()) {
+            Napi::TypeError::New(env, "Expected: modes, threadCounts, concurrency, repeats, callback")
+                .ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        Napi::Function callback = info[4].As<Napi::Function>();
+        auto worker = new AutotuneWorker(callback, ReadIntArray(info[0]), ReadIntArray(info[1]),
+            ReadIntArray(info[2]), info[3].As<Napi::Number>().Int32Value());
+        worker->Queue();
+        return env.Undefined();
+    }
+
+    static Napi::Value GetTuning(const Napi::CallbackInfo &info)
+    {
+        Napi::Env env = info.Env();
+        wsjtx_tuning_t t;
+        if (info.Length() < 1 || !info[0].IsNumber() ||
+            !wsjtx_tuning_get(info[0].As<Napi::Number>().Int32Value(), &t)) return env.Null();
+        return CreateTuningObject(env, t);
+    }
+
+    static Napi::Value SetTuning(const Napi::CallbackInfo &info)
+    {
+        Napi::Env env = info.Env();
+        if (info.Length() < 1 || !info[0].IsObject()) {
+            Napi::TypeError::New(env, "Expected a tuning object").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        Napi::Object o = info[0].As<Napi::Object>();
+        auto num = [&o](const char *key) {
+            return o.Has(key) && o.Get(key).IsNumber() ? o.Get(key).As<Napi::Number>().DoubleValue() : 0.0;
+        };
+        wsjtx_tuning_t t = {};
+        t.mode = static_cast<int>(num("mode"));
+        t.threads = static_cast<int>(num("threads"));
+        t.concurrency = static_cast<int>(num("concurrency"));
+        t.latency_ms = num("latencyMs");
+        t.throughput = num("throughput");
+        if (wsjtx_tuning_set(&t) != WSJTX_OK) {
+            Napi::RangeError::New(env, "Invalid tuning").ThrowAsJavaScriptException();
+        }
+        return env.Undefined();
+    }
+
+    // ---- Watchdog ----
+
+    static Napi::Value SetDecodeTimeLimit(const Napi::CallbackInfo &info)
+    {
+        Napi::Env env = info.Env();
+        if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsNumber()) {
+            Napi::TypeError::New(env, "Expected 2 arguments: mode, seconds").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        if (wsjtx_watchdog_set_limit(info[0].As<Napi::Number>().Int32Value(),
+                info[1].As<Napi::Number>().DoubleValue()) != WSJTX_OK) {
+            Napi::RangeError::New(env, "Invalid decode time limit").ThrowAsJavaScriptException();
+        }
+        return env.Undefined();
+    }
+
+    static Napi::Value GetDecodeTimeLimit(const Napi::CallbackInfo &info)
+    {
+        Napi::Env env = info.Env();
+        int mode = info.Length() > 0 && info[0].IsNumber() ? info[0].As<Napi::Number>().Int32Value() : -1;
+        return Napi::Number::New(env, wsjtx_watchdog_get_limit(mode));
+    }
+
+    static Napi::Value WatchdogStats(const Napi::CallbackInfo &info)
+    {
+        Napi::Env env = info.Env();
+        wsjtx_watchdog_stats_t s;
+        wsjtx_watchdog_stats(&s);
+        Napi::Object o = Napi::Object::New(env);
+        o.Set("watched", Napi::Number::New(env, static_cast<double>(s.watched)));
+        o.Set("timeouts", Napi::Number::New(env, static_cast<double>(s.timeouts)));
+        o.Set("runaways", Napi::Number::New(env, s.runaways));
+        o.Set("quarantined", Napi::Number::New(env, s.quarantined));
+        return o;
+    }
+
+    // ---- Quotas ----
+
+    static Napi::Value SetQuota(const Napi::CallbackInfo &info)
+    {
+        Napi::Env env = info.Env();
+        if (info.Length() < 3 || !info[0].IsString() || !info[1].IsNumber() || !info[2].IsNumber()) {
+            Napi::TypeError::New(env, "Expected 3 arguments: receiver, cpuShare, action").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        if (wsjtx_quota_set(info[0].As<Napi::String>().Utf8Value().c_str(),
+                info[1].As<Napi::Number>().DoubleValue(), info[2].As<Napi::Number>().Int32Value()) != WSJTX_OK) {
+            Napi::RangeError::New(env, "Invalid quota").ThrowAsJavaScriptException();
+        }
+        return env.Undefined();
+    }
+
+    static Napi::Value GetAccounting(const Napi::CallbackInfo &info)
+    {
+        Napi::Env env = info.Env();
+        std::string receiver = info.Length() > 0 && info[0].IsString() ? info[0].As<Napi::String>().Utf8Value() : "";
+        wsjtx_account_t a;
+        if (!wsjtx_account_get(receiver.c_str(), &a)) return env.Undefined();
+        Napi::Object o = Napi::Object::New(env);
+        o.Set("jobs", Napi::Number::New(env, static_cast<double>(a.jobs)));
+        o.Set("deprioritized", Napi::Number::New(env, static_cast<double>(a.deprioritized)));
+        o.Set("rejected", Napi::Number::New(env, static_cast<double>(a.rejected)));
+        o.Set("cpuSeconds", Napi::Number::New(env, a.cpu_seconds));
+        o.Set("queueSeconds", Napi::Number::New(env, a.queue_seconds));
+        o.Set("cpuShare", Napi::Number::New(env, a.cpu_share));
+        o.Set("quotaShare", Napi::Number::New(env, a.quota_share));
+        o.Set("quotaAction", Napi::Number::New(env, a.quota_action));
+        return o;
+    }
+
+    // ---- Candidates ----
+
+    // Int16 samples scaled to [-1, 1), for the float-only stages
+    static std::vector<float> ScaleToFloat(const std::vector<short int> &samples)
+    {
+        std::vector<float> out(samples.size());
+        for (size_t i = 0; i < samples.size(); i++) out[i] = samples[i] / 32768.0f;
+        return out;
+    }
+
+    static Napi::Object CreateCandidateObject(Napi::Env env, const wsjtx_candidate_t &c)
+    {
+        Napi::Object o = Napi::Object::New(env);
+        o.Set("frequency", Napi::Number::New(env, c.freq));
+        o.Set("deltaTime", Napi::Number::New(env, c.dt));
+        o.Set("score", Napi::Number::New(env, c.score));
+        return o;
+    }
+
+    static std::vector<wsjtx_candidate_t> ReadCandidates(Napi::Array arr)
+    {
+        std::vector<wsjtx_candidate_t> out(arr.Length());
+        for (uint32_t i = 0; i < arr.Length(); i++) {
+            Napi::Object o = arr.Get(i).As<Napi::Object>();
+            out[i].freq = o.Get("frequency").As<Napi::Number>().FloatValue();
+            out[i].dt = o.Has("deltaTime") ? o.Get("deltaTime").As<Napi::Number>().FloatValue() : 0.0f;
+            out[i].score = o.Has("score") ? o.Get("score").As<Napi::Number>().FloatValue() : 0.0f;
+        }
+        return out;
+    }
+
+    // ---- Slot window ----
+
+    static SlotWindow ReadSlotWindow(Napi::Object optObj, int mode)
+    {
+        SlotWindow w;
+        if (optObj.Has("offset") && optObj.Get("offset").IsNumber())
+            w.offset = static_cast<size_t>(std::max<int64_t>(0, optObj.Get("offset").As<Napi::Number>().Int64Value()));
+        if (optObj.Has("length") && optObj.Get("length").IsNumber())
+            w.length = static_cast<size_t>(std::max<int64_t>(0, optObj.Get("length").As<Napi::Number>().Int64Value()));
+        if (optObj.Has("slotStartOffset") && optObj.Get("slotStartOffset").IsNumber()) {
+            const double rate = wsjtx_get_sample_rate(mode);
+            w.fit = true;
+            w.lead = std::llround(optObj.Get("slotStartOffset").As<Napi::Number>().DoubleValue() * rate);
+            w.slotLength = static_cast<size_t>(std::llround(wsjtx_get_slot_period(mode) * rate));
+        }
+        return w;
+    }
+
+    // Copies the window of a `frames`-long input into `out` in one pass;
+    // read(first, n, dst) converts input frames [first, first + n) to dst
+    template <typename T, typename Read>
+    static void FillSlot(const SlotWindow &w, size_t frames, std::vector<T> &out, Read read)
+    {
+        const size_t first = std::min(w.offset, frames);
+        const size_t count = std::min(w.length, frames - first);
+        if (!w.fit) {
+            out.resize(count);
+            if (count > 0) read(first, count, out.data());
+            return;
+        }
+        out.assign(w.slotLength, T());
+        const size_t skip = w.lead < 0 ? static_cast<size_t>(-w.lead) : 0;
+        const size_t at = w.lead > 0 ? static_cast<size_t>(w.lead) : 0;
+        if (skip >= count || at >= w.slotLength) return;
+        read(first + skip, std::min(count - skip, w.slotLength - at), out.data() + at);
+    }
+
+    // ---- PCM input ----
+
+    static int PcmFormatCode(const std::string &format)
+    {
+        static const char *const NAMES[] = { "u8", "s16", "s24", "s32", "f32", "f64" };
+        for (int i = 0; i < 6; i++)
+            if (format == NAMES[i]) return i;   // wsjtx_pcm_format_t order
+        return -1;
+    }
+
+    // The bytes behind PCM `data`. Returns false after throwing.
+    static bool PcmBytes(Napi::Env env, Napi::Value data, const uint8_t *&bytes, size_t &length)
+    {
+        if (data.IsTypedArray()) {
+            Napi::TypedArray ta = data.As<Napi::TypedArray>();
+            bytes = static_cast<const uint8_t *>(ta.ArrayBuffer().Data()) + ta.ByteOffset();
+            length = ta.ByteLength();
+        } else if (data.IsDataView()) {
+            Napi::DataView dv = data.As<Napi::DataView>();
+            bytes = static_cast<const uint8_t *>(dv.ArrayBuffer().Data()) + dv.ByteOffset();
+            length = dv.ByteLength();
+        } else if (data.IsArrayBuffer()) {
+            Napi::ArrayBuffer ab = data.As<Napi::ArrayBuffer>();
+            bytes = static_cast<const uint8_t *>(ab.Data());
+            length = ab.ByteLength();
+        } else {
+            Napi::TypeError::New(env, "PCM data must be a TypedArray, DataView or ArrayBuffer").ThrowAsJavaScriptException();
+            return false;
+        }
+        return true;
+    }
+
+    // { data, format, channels?, channel? } to float in one native pass,
+    // only the frames `window` selects. Returns false after throwing.
+    static bool ReadPcm(Napi::Env env, Napi::Object pcm, std::vector<float> &out,
+                        const SlotWindow &window = SlotWindow())
+    {
+        const uint8_t *bytes = nullptr;
+        size_t length = 0;
+        if (!PcmBytes(env, pcm.Get("data"), bytes, length)) return false;
+
+        const int format = pcm.Get("format").IsString() ? PcmFormatCode(pcm.Get("format").As<Napi::String>().Utf8Value()) : -1;
+        const int channels = pcm.Has("channels") ? pcm.Get("channels").ToNumber().Int32Value() : 1;
+        const int channel = pcm.Has("channel") ? pcm.Get("channel").ToNumber().Int32Value() : 0;
+        const int sampleBytes = wsjtx_pcm_sample_bytes(format);
+        const size_t stride = sampleBytes > 0 && channels > 0 ? static_cast<size_t>(sampleBytes) * channels : 0;
+        const size_t frames = stride ? length / stride : 0;
+        int rc = frames > 0 && channel >= 0 && channel < channels ? WSJTX_OK : WSJTX_ERR_INVALID_ARG;
+        if (rc == WSJTX_OK) {
+            FillSlot(window, frames, out, [&](size_t first, size_t n, float *dst) {
+                rc = wsjtx_pcm_to_float(bytes + first * stride, n * stride, format, channels, channel,
+                    dst, static_cast<int>(n));
+            });
+        }
+        if (rc < 0) {
+            Napi::TypeError::New(env, "Invalid PCM audio: format, channels or channel out of range, or no whole frame")
+                .ThrowAsJavaScriptException();
+            return false;
+        }
+        return true;
+    }
+
+    // Float32Array, Int16Array (scaled to [-1, 1)) or PCM audio as float,
+    // only the frames `window` selects. Returns false after throwing.
+    static bool ReadFloatAudio(Napi::Env env, Napi::Value audio, std::vector<float> &out,
+                               const SlotWindow &window = SlotWindow())
+    {
+        if (audio.IsTypedArray()) {
+            Napi::TypedArray ta = audio.As<Napi::TypedArray>();
+            if (ta.TypedArrayType() == napi_float32_array) {
+                const float *f = audio.As<Napi::Float32Array>().Data();
+                FillSlot(window, ta.ElementLength(), out, [f](size_t first, size_t n, float *dst) {
+                    std::copy(f + first, f + first + n, dst);
+                });
+                return true;
+            }
+            if (ta.TypedArrayType() == napi_int16_array) {
+                const int16_t *i = audio.As<Napi::Int16Array>().Data();
+                FillSlot(window, ta.ElementLength(), out, [i](size_t first, size_t n, float *dst) {
+                    for (size_t k = 0; k < n; k++) dst[k] = i[first + k] / 32768.0f;
+                });
+                return true;
+            }
+        } else if (audio.IsObject()) {
+            return ReadPcm(env, audio.As<Napi::Object>(), out, window);
+        }
+        Napi::TypeError::New(env, "Audio data must be Float32Array, Int16Array or PCM audio").ThrowAsJavaScriptException();
+        return false;
+    }
+
+    // ---- Decode options ----
+
+    // The native object behind an option value, or nullptr after throwing a
+    // TypeError when the value is not an instance of the wrapped class.
+    // Unwrap alone accepts any wrapped object, so check the class first.
+    template <typename T>
+    static T *UnwrapOption(Napi::Env env, Napi::Object obj, const char *option, const char *className)
+    {
+        T *wrapper = obj.InstanceOf(T::constructor.Value()) ? T::Unwrap(obj) : nullptr;
+        if (!wrapper && !env.IsExceptionPending()) {
+            Napi::TypeError::New(env, std::string(option) + " must be a " + className).ThrowAsJavaScriptException();
+        }
+        return wrapper;
+    }
+
+    // DecodeOptions to the C options plus the wrapper-side extras; `retain`
+    // gets the JS objects whose handles the extras borrow. Diversity audio
+    // is cut to `window` like the main input. Returns false after throwing.
+    static bool ReadDecodeOptions(Napi::Env env, Napi::Object optObj, const SlotWindow &window,
+                                  wsjtx_decode_options_t &opts, DecodeExtras &extras,
+                                  std::vector<Napi::Object> &retain)
+    {
+        opts = {};
+        opts.frequency = optObj.Get("frequency").As<Napi::Number>().Int32Value();
+        opts.threads   = optObj.Has("threads") ? optObj.Get("threads").As<Napi::Number>().Int32Value() : 4;
+        opts.low_freq  = optObj.Has("lowFreq") ? optObj.Get("lowFreq").As<Napi::Number>().Int32Value() : 200;
+        opts.high_freq = optObj.Has("highFreq") ? optObj.Get("highFreq").As<Napi::Number>().Int32Value() : 4000;
+        opts.tolerance = optObj.Has("tolerance") ? optObj.Get("tolerance").As<Napi::Number>().Int32Value() : 20;
+        if (optObj.Has("dxCall")) { auto s = optObj.Get("dxCall").As<Napi::String>().Utf8Value(); strncpy(opts.hiscall, s.c_str(), 12); }
+        if (optObj.Has("dxGrid")) { auto s = optObj.Get("dxGrid").As<Napi::String>().Utf8Value(); strncpy(opts.hisgrid, s.c_str(), 6); }
+
+        if (optObj.Has("homeGrid")) extras.homeGrid = optObj.Get("homeGrid").As<Napi::String>().Utf8Value();
+        if (optObj.Has("history") && optObj.Get("history").IsObject()) {
+            Napi::Object historyObj = optObj.Get("history").As<Napi::Object>();
+            auto *history = UnwrapOption<MessageHistoryWrapper>(env, historyObj, "history", "MessageHistory");
+            if (!history) return false;
+            extras.history = history->Handle();
+            retain.push_back(historyObj);
+            extras.slot = optObj.Has("slot") ? optObj.Get("slot").As<Napi::Number>().Int64Value() : 0;
+        }
+        if (optObj.Has("activity") && optObj.Get("activity").IsObject()) {
+            Napi::Object activityObj = optObj.Get("activity").As<Napi::Object>();
+            auto *activity = UnwrapOption<ActivityAggregatorWrapper>(env, activityObj, "activity", "ActivityAggregator");
+            if (!activity) return false;
+            extras.activity = activity->Handle();
+            retain.push_back(activityObj);
+            extras.band = optObj.Has("band") ? optObj.Get("band").As<Napi::String>().Utf8Value() : "";
+            extras.activityTime = optObj.Has("activityTime") ? optObj.Get("activityTime").As<Napi::Number>().Int64Value() : 0;
+        }
+        if (optObj.Has("clock") && optObj.Get("clock").IsObject()) {
+            Napi::Object clockObj = optObj.Get("clock").As<Napi::Object>();
+            auto *clock = UnwrapOption<ClockEstimatorWrapper>(env, clockObj, "clock", "ClockEstimator");
+            if (!clock) return false;
+            extras.clock = clock->Handle();
+            retain.push_back(clockObj);
+            extras.clockTime = optObj.Has("clockTime") ? optObj.Get("clockTime").As<Napi::Number>().DoubleValue() : 0;
+        }
+        if (optObj.Has("sampleRatePpm") && optObj.Get("sampleRatePpm").IsNumber()) {
+            extras.correctRate = true;
+            extras.ratePpm = optObj.Get("sampleRatePpm").As<Napi::Number>().DoubleValue();
+        }
+        if (optObj.Has("qso") && optObj.Get("qso").IsObject()) {
+            Napi::Object qsoObj = optObj.Get("qso").As<Napi::Object>();
+            auto *qso = UnwrapOption<QsoSequencerWrapper>(env, qsoObj, "qso", "QsoSequencer");
+            if (!qso) return false;
+            extras.qso = qso->Handle();
+            retain.push_back(qsoObj);
+        }
+        if (optObj.Has("udp") && optObj.Get("udp").IsObject()) {
+            Napi::Object udpObj = optObj.Get("udp").As<Napi::Object>();
+            auto *emitter = UnwrapOption<UdpEmitterWrapper>(env, udpObj, "udp", "UdpEmitter");
+            if (!emitter) return false;
+            extras.udp = emitter->Handle();
+            retain.push_back(udpObj);
+        }
+        extras.columnar = optObj.Has("columnar") && optObj.Get("columnar").ToBoolean();
+        extras.residual = optObj.Has("residual") && optObj.Get("residual").ToBoolean();
+        if (optObj.Has("partition") && optObj.Get("partition").IsArray()) {
+            extras.usePartition = true;
+            extras.partition = ReadCandidates(optObj.Get("partition").As<Napi::Array>());
+        }
+        if (optObj.Has("diversity") && optObj.Get("diversity").IsArray()) {
+            Napi::Array arr = optObj.Get("diversity").As<Napi::Array>();
+            for (uint32_t i = 0; i < arr.Length(); i++) {
+                std::vector<float> channel;
+                if (!ReadFloatAudio(env, arr.Get(i), channel, window)) return false;
+                extras.diversity.push_back(std::move(channel));
+            }
+        }
+        if (optObj.Has("apTargets") && optObj.Get("apTargets").IsArray()) {
+            Napi::Array arr = optObj.Get("apTargets").As<Napi::Array>();
+            for (uint32_t i = 0; i < arr.Length() && i < WSJTX_MAX_AP_TARGETS; i++) {
+                Napi::Object t = arr.Get(i).As<Napi::Object>();
+                wsjtx_ap_target_t target = {};
+                auto call = t.Get("call").As<Napi::String>().Utf8Value();
+                strncpy(target.call, call.c_str(), sizeof(target.call) - 1);
+                if (t.Get("grid").IsString()) {
+                    auto grid = t.Get("grid").As<Napi::String>().Utf8Value();
+                    strncpy(target.grid, grid.c_str(), sizeof(target.grid) - 1);
+                }
+                extras.apTargets.push_back(target);
+            }
+        }
+        return true;
+    }
+
+    // ---- Build features ----
+
+    static Napi::Value BuildFeatures(const Napi::CallbackInfo &info)
+    {
+        Napi::Env env = info.Env();
+        int features = wsjtx_build_features();
+        Napi::Object o = Napi::Object::New(env);
+        o.Set("openmp", Napi::Boolean::New(env, (features & WSJTX_FEATURE_OPENMP) != 0));
+        o.Set("usdt", Napi::Boolean::New(env, (features & WSJTX_FEATURE_USDT) != 0));
+        o.Set("openmpMaxThreads", Napi::Number::New(env, wsjtx_openmp_max_threads()));
+        return o;
+    }
+
     // ---- WSJTXLibWrapper ----
 
     Napi::Object WSJTXLibWrapper::Init(Napi::Env env, Napi::Object exports)
@@ -22,7 +536,12 @@ namespace wsjtx_nodejs
             InstanceMethod("isDecodingSupported", &WSJTXLibWrapper::IsDecodingSupported),
             InstanceMethod("getSampleRate", &WSJTXLibWrapper::GetSampleRate),
             InstanceMethod("getTransmissionDuration", &WSJTXLibWrapper::GetTransmissionDuration),
-            InstanceMethod("convertAudioFormat", &WSJTXLibWrapper::ConvertAudioFormat)
+            InstanceMethod("getSlotPeriod", &WSJTXLibWrapper::GetSlotPeriod),
+            InstanceMethod("convertAudioFormat", &WSJTXLibWrapper::ConvertAudioFormat),
+            InstanceMethod("gridDistances", &WSJTXLibWrapper::GridDistances),
+            InstanceMethod("toColumnar", &WSJTXLibWrapper::ToColumnar),
+            InstanceMethod("findCandidates", &WSJTXLibWrapper::FindCandidates),
+            InstanceMethod("decodeChannels", &WSJTXLibWrapper::DecodeChannels)
         });
 
         exports.Set("WSJTXLib", func);
@@ -32,6 +551,7 @@ namespace wsjtx_nodejs
     WSJTXLibWrapper::WSJTXLibWrapper(const Napi::CallbackInfo &info)
         : Napi::ObjectWrap<WSJTXLibWrapper>(info)
     {
+        if (info.Length() > 0 && info[0].IsString()) receiver_ = info[0].As<Napi::String>().Utf8Value();
         handle_ = wsjtx_create();
         if (!handle_) {
             Napi::Error::New(info.Env(), "Failed to create wsjtx_lib instance")
@@ -41,10 +561,39 @@ namespace wsjtx_nodejs
 
     WSJTXLibWrapper::~WSJTXLibWrapper()
     {
+        // Retired rather than destroyed: queued jobs or a runaway decode may still hold them
         if (handle_) {
-            wsjtx_destroy(handle_);
+            wsjtx_watchdog_retire(handle_);
             handle_ = nullptr;
         }
+        for (auto h : channelHandles_) wsjtx_watchdog_retire(h);
+    }
+
+    // Swap a decoder the watchdog quarantined for a fresh one, so new work
+    // does not queue behind a hung decode. Returns false after throwing.
+    static bool RenewQuarantined(Napi::Env env, wsjtx_handle_t &handle)
+    {
+        if (!wsjtx_watchdog_quarantined(handle)) return true;
+        wsjtx_handle_t fresh = wsjtx_create();
+        if (!fresh) {
+            Napi::Error::New(env, "Failed to create wsjtx_lib instance").ThrowAsJavaScriptException();
+            return false;
+        }
+        wsjtx_watchdog_retire(handle);
+        handle = fresh;
+        return true;
+    }
+
+    // Admit a job under its receiver's CPU quota: 1 to run it at lower
+    // priority, 0 to run it normally, -1 after throwing (code QUOTA_EXCEEDED)
+    static int Admit(Napi::Env env, const std::string &receiver)
+    {
+        int rc = wsjtx_account_admit(receiver.c_str());
+        if (rc != WSJTX_ERR_QUOTA) return rc == 1 ? 1 : 0;
+        Napi::Error e = Napi::Error::New(env, "Receiver '" + receiver + "' is over its CPU quota");
+        e.Set("code", Napi::String::New(env, "QUOTA_EXCEEDED"));
+        e.ThrowAsJavaScriptException();
+        return -1;
     }
 
     // ---- Decode ----
@@ -52,6 +601,7 @@ namespace wsjtx_nodejs
     Napi::Value WSJTXLibWrapper::Decode(const Napi::CallbackInfo &info)
     {
         Napi::Env env = info.Env();
+        int64_t entry = wsjtx_trace_enabled() ? wsjtx_trace_now_us() : 0;
 
         if (info.Length() < 4) {
             Napi::TypeError::New(env, "Expected: mode, audioData, options, callback").ThrowAsJavaScriptException();
@@ -61,26 +611,47 @@ namespace wsjtx_nodejs
         Napi::Object optObj = info[2].As<Napi::Object>();
         Napi::Function callback = info[3].As<Napi::Function>();
 
-        wsjtx_decode_options_t opts = {};
-        opts.frequency = optObj.Get("frequency").As<Napi::Number>().Int32Value();
-        opts.threads   = optObj.Has("threads") ? optObj.Get("threads").As<Napi::Number>().Int32Value() : 4;
-        opts.low_freq  = optObj.Has("lowFreq") ? optObj.Get("lowFreq").As<Napi::Number>().Int32Value() : 200;
-        opts.high_freq = optObj.Has("highFreq") ? optObj.Get("highFreq").As<Napi::Number>().Int32Value() : 4000;
-        opts.tolerance = optObj.Has("tolerance") ? optObj.Get("tolerance").As<Napi::Number>().Int32Value() : 20;
-        if (optObj.Has("dxCall")) { auto s = optObj.Get("dxCall").As<Napi::String>().Utf8Value(); strncpy(opts.hiscall, s.c_str(), 12); }
-        if (optObj.Has("dxGrid")) { auto s = optObj.Get("dxGrid").As<Napi::String>().Utf8Value(); strncpy(opts.hisgrid, s.c_str(), 6); }
+        const SlotWindow window = ReadSlotWindow(optObj, mode);
+        wsjtx_decode_options_t opts;
+        DecodeExtras extras;
+        std::vector<Napi::Object> retain;
+        if (!ReadDecodeOptions(env, optObj, window, opts, extras, retain)) return env.Null();
 
+        // Float32 and Int16 go to the decoder as they are; raw PCM is converted
+        // here. Only the window is copied, straight into a slot-sized buffer.
         Napi::Value audioData = info[1];
-        Napi::TypedArray typedArray = audioData.As<Napi::TypedArray>();
-        if (typedArray.TypedArrayType() == napi_float32_array) {
-            auto floatData = ConvertToFloatArray(env, audioData);
-            auto worker = new DecodeWorker(callback, handle_, mode, floatData, opts); worker->Queue();
-        } else if (typedArray.TypedArrayType() == napi_int16_array) {
-            auto intData = ConvertToIntArray(env, audioData);
-            auto worker = new DecodeWorker(callback, handle_, mode, intData, opts); worker->Queue();
-        } else {
-            Napi::TypeError::New(env, "Audio data must be Float32Array or Int16Array").ThrowAsJavaScriptException();
+        std::vector<float> floatData;
+        std::vector<short int> intData;
+        bool isInt = false;
+        if (audioData.IsTypedArray() && audioData.As<Napi::TypedArray>().TypedArrayType() == napi_int16_array) {
+            Napi::Int16Array i = audioData.As<Napi::Int16Array>();
+            const int16_t *src = i.Data();
+            FillSlot(window, i.ElementLength(), intData, [src](size_t first, size_t n, short int *dst) {
+                std::copy(src + first, src + first + n, dst);
+            });
+            isInt = true;
+        } else if (!ReadFloatAudio(env, audioData, floatData, window)) {
+            return env.Null();
+        }
+        const size_t frames = isInt ? intData.size() : floatData.size();
+        for (const auto& channel : extras.diversity) {
+            if (channel.size() != frames) {
+                Napi::TypeError::New(env, "diversity entries must have the audio's length").ThrowAsJavaScriptException();
+                return env.Null();
+            }
         }
+
+        if (!RenewQuarantined(env, handle_)) return env.Null();
+        const int admit = Admit(env, receiver_);
+        if (admit < 0) return env.Null();
+        extras.lowPriority = admit == 1;
+        auto worker = isInt ? new DecodeWorker(callback, handle_, mode, std::move(intData), opts, extras)
+                            : new DecodeWorker(callback, handle_, mode, std::move(floatData), opts, extras);
+        worker->Track(WSJTX_OP_DECODE, mode, receiver_);
+        for (auto &obj : retain) worker->Retain(obj);
+        int64_t job = worker->TraceJob();
+        worker->QueueAfter(decodes_);
+        if (entry) wsjtx_trace_record("js_decode", entry, wsjtx_trace_now_us() - entry, job);
         return env.Undefined();
     }
 
@@ -126,7 +697,10 @@ namespace wsjtx_nodejs
             return env.Null();
         }
 
+        if (!RenewQuarantined(env, handle_)) return env.Null();
+        if (Admit(env, receiver_) < 0) return env.Null();
         auto worker = new EncodeWorker(callback, handle_, mode, message, frequency, threads);
+        worker->Track(WSJTX_OP_ENCODE, mode, receiver_);
         worker->Queue();
 
         return env.Undefined();
@@ -197,7 +771,23 @@ namespace wsjtx_nodejs
 
         Napi::Function callback = info[2].As<Napi::Function>();
 
-        auto worker = new WSPRDecodeWorker(callback, handle_, iqInterleaved, options);
+        wsjtx_udp_t udp = nullptr;
+        uint32_t udpTimeMs = 0;
+        Napi::Object udpObj;
+        if (optObj.Has("udp") && optObj.Get("udp").IsObject()) {
+            udpObj = optObj.Get("udp").As<Napi::Object>();
+            auto *emitter = UnwrapOption<UdpEmitterWrapper>(env, udpObj, "udp", "UdpEmitter");
+            if (!emitter) return env.Null();
+            udp = emitter->Handle();
+            if (optObj.Has("udpTimeMs"))
+                udpTimeMs = optObj.Get("udpTimeMs").As<Napi::Number>().Uint32Value();
+        }
+
+        if (!RenewQuarantined(env, handle_)) return env.Null();
+        if (Admit(env, receiver_) < 0) return env.Null();
+        auto worker = new WSPRDecodeWorker(callback, handle_, iqInterleaved, options, udp, udpTimeMs);
+        worker->Track(WSJTX_OP_WSPR, WSJTX_MODE_WSPR, receiver_);
+        if (udp) worker->Retain(udpObj);
         worker->Queue();
 
         return env.Undefined();
@@ -267,6 +857,17 @@ namespace wsjtx_nodejs
         return Napi::Number::New(env, wsjtx_get_transmission_duration(mode));
     }
 
+    Napi::Value WSJTXLibWrapper::GetSlotPeriod(const Napi::CallbackInfo &info)
+    {
+        Napi::Env env = info.Env();
+        if (info.Length() < 1 || !info[0].IsNumber()) {
+            Napi::TypeError::New(env, "Expected mode number").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        int mode = info[0].As<Napi::Number>().Int32Value();
+        return Napi::Number::New(env, wsjtx_get_slot_period(mode));
+    }
+
     // ---- Audio Format Conversion ----
 
     Napi::Value WSJTXLibWrapper::ConvertAudioFormat(const Napi::CallbackInfo& info)
@@ -279,7 +880,7 @@ namespace wsjtx_nodejs
             return env.Null();
         }
 
-        if (!info[0].IsTypedArray() || !info[1].IsString() || !info[2].IsFunction()) {
+        if (!info[0].IsObject() || !info[1].IsString() || !info[2].IsFunction()) {
             Napi::TypeError::New(env, "Invalid argument types").ThrowAsJavaScriptException();
             return env.Null();
         }
@@ -295,15 +896,26 @@ namespace wsjtx_nodejs
         }
 
         Napi::Function callback = info[2].As<Napi::Function>();
+        if (!info[0].IsTypedArray()) {
+            // Raw PCM: converted to float here, then to the target on the worker
+            std::vector<float> input;
+            if (!ReadPcm(env, info[0].As<Napi::Object>(), input)) return env.Null();
+            auto* worker = new AudioConvertWorker(callback, input, tgt);
+            worker->Track(WSJTX_OP_CONVERT, -1, receiver_);
+            worker->Queue();
+            return env.Undefined();
+        }
         Napi::TypedArray ta = info[0].As<Napi::TypedArray>();
 
         if (ta.TypedArrayType() == napi_float32_array) {
             auto input = ConvertToFloatArray(env, info[0]);
             auto* worker = new AudioConvertWorker(callback, input, tgt);
+            worker->Track(WSJTX_OP_CONVERT, -1, receiver_);
             worker->Queue();
         } else if (ta.TypedArrayType() == napi_int16_array) {
             auto input = ConvertToIntArray(env, info[0]);
             auto* worker = new AudioConvertWorker(callback, input, tgt);
+            worker->Track(WSJTX_OP_CONVERT, -1, receiver_);
             worker->Queue();
         } else {
             Napi::TypeError::New(env, "audioData must be Float32Array or Int16Array")
@@ -314,103 +926,1262 @@ namespace wsjtx_nodejs
         return env.Undefined();
     }
 
-    // ---- Helpers ----
+    // ---- Grid geometry ----
 
-    void WSJTXLibWrapper::ValidateMode(Napi::Env env, int mode) {
-        if (mode < 0 || mode > WSJTX_MODE_WSPR)
-            throw std::invalid_argument("Invalid mode value");
-    }
+    Napi::Value WSJTXLibWrapper::GridDistances(const Napi::CallbackInfo& info)
+    {
+        Napi::Env env = info.Env();
 
-    void WSJTXLibWrapper::ValidateFrequency(Napi::Env env, int frequency) {
-        if (frequency < 0 || frequency > 30000000)
-            throw std::invalid_argument("Invalid frequency value");
-    }
+        if (info.Length() < 2 || !info[0].IsString() || !info[1].IsArray()) {
+            Napi::TypeError::New(env, "Expected 2 arguments: homeGrid, grids[]").ThrowAsJavaScriptException();
+            return env.Null();
+        }
 
-    void WSJTXLibWrapper::ValidateThreads(Napi::Env env, int threads) {
-        if (threads < 1 || threads > 16)
-            throw std::invalid_argument("Thread count must be between 1 and 16");
-    }
+        std::string home = info[0].As<Napi::String>().Utf8Value();
+        Napi::Array arr = info[1].As<Napi::Array>();
+        uint32_t n = arr.Length();
 
-    void WSJTXLibWrapper::ValidateMessage(Napi::Env env, int mode, const std::string &message) {
-        if (message.empty()) {
-            throw std::invalid_argument("Message must not be empty");
+        std::vector<std::string> grids(n);
+        std::vector<const char*> ptrs(n);
+        for (uint32_t i = 0; i < n; i++) {
+            Napi::Value v = arr.Get(i);
+            if (v.IsString()) grids[i] = v.As<Napi::String>().Utf8Value();
+            ptrs[i] = grids[i].c_str();
         }
 
-        const size_t maxLength = (mode == WSJTX_MODE_FT8 || mode == WSJTX_MODE_FT4) ? 37 : 22;
-        if (message.length() > maxLength) {
-            throw std::invalid_argument("Message must be 1-" + std::to_string(maxLength) + " characters long");
+        Napi::Float64Array km = Napi::Float64Array::New(env, n);
+        Napi::Float64Array bearing = Napi::Float64Array::New(env, n);
+        int rc = wsjtx_grid_distance_bearing(home.c_str(), ptrs.data(), static_cast<int>(n),
+            km.Data(), bearing.Data());
+        if (rc < 0) {
+            Napi::Error::New(env, "Invalid home grid locator").ThrowAsJavaScriptException();
+            return env.Null();
         }
-    }
 
-    std::vector<float> WSJTXLibWrapper::ConvertToFloatArray(Napi::Env env, const Napi::Value& value) {
-        Napi::Float32Array array = value.As<Napi::Float32Array>();
-        float *data = array.Data();
-        return std::vector<float>(data, data + array.ElementLength());
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("distanceKm", km);
+        result.Set("bearing", bearing);
+        return result;
     }
 
-    std::vector<short int> WSJTXLibWrapper::ConvertToIntArray(Napi::Env env, const Napi::Value& value) {
-        Napi::Int16Array array = value.As<Napi::Int16Array>();
-        int16_t *data = array.Data();
-        return std::vector<short int>(data, data + array.ElementLength());
-    }
+    // ---- Columnar export ----
 
-    Napi::Object WSJTXLibWrapper::CreateMessageObject(Napi::Env env, const wsjtx_message_t &msg)
+    // Export messages into a malloc'd buffer (ownership passes to the caller)
+    static uint8_t* BuildColumns(const wsjtx_message_t *msgs, int count, wsjtx_columnar_layout_t *layout)
     {
-        Napi::Object result = Napi::Object::New(env);
-        result.Set("text", Napi::String::New(env, msg.msg));
-        result.Set("snr", Napi::Number::New(env, msg.snr));
-        result.Set("deltaTime", Napi::Number::New(env, msg.dt));
-        result.Set("deltaFrequency", Napi::Number::New(env, msg.freq));
-        result.Set("timestamp", Napi::Number::New(env, msg.hh * 3600 + msg.min * 60 + msg.sec));
-        result.Set("sync", Napi::Number::New(env, msg.sync));
-        return result;
+        int64_t size = wsjtx_columnar_size(msgs, count);
+        if (size < 0) return nullptr;
+        uint8_t *buf = static_cast<uint8_t*>(malloc(static_cast<size_t>(size)));
+        if (buf && wsjtx_columnar_export(msgs, count, buf, size, layout) < 0) {
+            free(buf);
+            buf = nullptr;
+        }
+        return buf;
     }
 
-    // ---- Async Workers ----
+    // Wrap an exported buffer as typed-array views over one external ArrayBuffer (takes ownership)
+    static Napi::Object CreateColumnsObject(Napi::Env env, uint8_t *data, const wsjtx_columnar_layout_t &l)
+    {
+        int64_t total = l.time.offset + l.time.length;
+        Napi::ArrayBuffer ab = Napi::ArrayBuffer::New(env, data, static_cast<size_t>(total),
+            [](Napi::Env, void *p) { free(p); });
+        auto i32 = [&](const wsjtx_buffer_span_t &s) {
+            return Napi::Int32Array::New(env, static_cast<size_t>(s.length / 4), ab, static_cast<size_t>(s.offset));
+        };
+        auto f32 = [&](const wsjtx_buffer_span_t &s) {
+            return Napi::Float32Array::New(env, static_cast<size_t>(s.length / 4), ab, static_cast<size_t>(s.offset));
+        };
+        auto u8 = [&](const wsjtx_buffer_span_t &s) {
+            return Napi::Uint8Array::New(env, static_cast<size_t>(s.length), ab, static_cast<size_t>(s.offset));
+        };
+
+        Napi::Object text = Napi::Object::New(env);
+        text.Set("validity", u8(l.text_validity));
+        text.Set("offsets", i32(l.text_offsets));
+        text.Set("data", u8(l.text_data));
+
+        Napi::Object o = Napi::Object::New(env);
+        o.Set("length", Napi::Number::New(env, static_cast<double>(l.length)));
+        o.Set("nullCount", Napi::Number::New(env, static_cast<double>(l.null_count)));
+        o.Set("buffer", ab);
+        o.Set("text", text);
+        o.Set("snr", i32(l.snr));
+        o.Set("deltaTime", f32(l.dt));
+        o.Set("deltaFrequency", i32(l.freq));
+        o.Set("sync", f32(l.sync));
+        o.Set("timestamp", i32(l.time));
+        return o;
+    }
 
-    AsyncWorkerBase::AsyncWorkerBase(Napi::Function &callback, wsjtx_handle_t handle)
-        : Napi::AsyncWorker(callback), handle_(handle) {}
+    static std::vector<wsjtx_message_t> ReadMessages(Napi::Array arr);
 
-    // DecodeWorker (float)
-    DecodeWorker::DecodeWorker(Napi::Function &cb, wsjtx_handle_t h,
-                               int mode, const std::vector<float> &d,
-                               const wsjtx_decode_options_t& o)
-        : AsyncWorkerBase(cb, h), mode_(mode), floatData_(d),
-          options_(o), useFloat_(true) {}
+    Napi::Value WSJTXLibWrapper::ToColumnar(const Napi::CallbackInfo& info)
+    {
+        Napi::Env env = info.Env();
 
-    // DecodeWorker (int16)
-    DecodeWorker::DecodeWorker(Napi::Function &cb, wsjtx_handle_t h,
-                               int mode, const std::vector<short int> &d,
-                               const wsjtx_decode_options_t& o)
-        : AsyncWorkerBase(cb, h), mode_(mode), intData_(d),
-          options_(o), useFloat_(false) {}
+        if (info.Length() < 1 || !info[0].IsArray()) {
+            Napi::TypeError::New(env, "Expected messages[]").ThrowAsJavaScriptException();
+            return env.Null();
+        }
 
-    void DecodeWorker::Execute()
+        std::vector<wsjtx_message_t> msgs = ReadMessages(info[0].As<Napi::Array>());
+        wsjtx_columnar_layout_t layout;
+        uint8_t *data = BuildColumns(msgs.data(), static_cast<int>(msgs.size()), &layout);
+        if (!data) {
+            Napi::Error::New(env, "Columnar export failed").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        return CreateColumnsObject(env, data, layout);
+    }
+
+    Napi::Value WSJTXLibWrapper::FindCandidates(const Napi::CallbackInfo& info)
+    {
+        Napi::Env env = info.Env();
+        if (info.Length() < 4 || !info[0].IsNumber() || !info[1].IsObject() ||
+            !info[2].IsObject() || !info[3].IsFunction()) {
+            Napi::TypeError::New(env, "Expected: mode, audioData, options, callback").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        std::vector<float> samples;
+        if (!ReadFloatAudio(env, info[1], samples)) return env.Null();
+        Napi::Object opts = info[2].As<Napi::Object>();
+        auto num = [&opts](const char *key, double fallback) {
+            return opts.Has(key) && opts.Get(key).IsNumber() ? opts.Get(key).As<Napi::Number>().DoubleValue() : fallback;
+        };
+        Napi::Function callback = info[3].As<Napi::Function>();
+        auto worker = new FindCandidatesWorker(callback, info[0].As<Napi::Number>().Int32Value(),
+            std::move(samples),
+            static_cast<int>(num("lowFreq", 200)), static_cast<int>(num("highFreq", 4000)),
+            static_cast<float>(num("minScore", 1.5)), static_cast<int>(num("maxCandidates", 300)));
+        worker->Queue();
+        return env.Undefined();
+    }
+
+    // ---- Multi-channel decode ----
+
+    static const int MAX_DECODE_CHANNELS = 16;
+
+    Napi::Value WSJTXLibWrapper::DecodeChannels(const Napi::CallbackInfo& info)
+    {
+        Napi::Env env = info.Env();
+        if (info.Length() < 4 || !info[0].IsNumber() || !info[1].IsObject() ||
+            !info[2].IsArray() || !info[3].IsFunction()) {
+            Napi::TypeError::New(env, "Expected: mode, pcmAudio, channelOptions, callback").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        int mode = info[0].As<Napi::Number>().Int32Value();
+        Napi::Object pcm = info[1].As<Napi::Object>();
+        Napi::Array optArr = info[2].As<Napi::Array>();
+        Napi::Function callback = info[3].As<Napi::Function>();
+
+        const int format = pcm.Get("format").IsString() ? PcmFormatCode(pcm.Get("format").As<Napi::String>().Utf8Value()) : -1;
+        const int channels = pcm.Has("channels") ? pcm.Get("channels").ToNumber().Int32Value() : 1;
+        const int sampleBytes = wsjtx_pcm_sample_bytes(format);
+        if (sampleBytes == 0 || channels < 1 || channels > MAX_DECODE_CHANNELS ||
+            optArr.Length() != static_cast<uint32_t>(channels)) {
+            Napi::TypeError::New(env, "Invalid PCM audio, or channel options not one per channel").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        const uint8_t *bytes = nullptr;
+        size_t length = 0;
+        if (!PcmBytes(env, pcm.Get("data"), bytes, length)) return env.Null();
+        if (length < static_cast<size_t>(sampleBytes) * channels) {
+            Napi::TypeError::New(env, "PCM audio holds no whole frame").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+
+        std::vector<std::unique_ptr<DecodeJob>> jobs;
+        std::vector<SlotWindow> windows;
+        std::vector<Napi::Object> retain;
+        for (int c = 0; c < channels; c++) {
+            Napi::Object optObj = optArr.Get(c).As<Napi::Object>();
+            windows.push_back(ReadSlotWindow(optObj, mode));
+            wsjtx_decode_options_t opts;
+            DecodeExtras extras;
+            if (!ReadDecodeOptions(env, optObj, windows.back(), opts, extras, retain)) return env.Null();
+            if (!extras.diversity.empty()) {
+                Napi::TypeError::New(env, "diversity is not available per channel").ThrowAsJavaScriptException();
+                return env.Null();
+            }
+            jobs.emplace_back(new DecodeJob(mode, opts, extras));
+        }
+
+        // Channel 0 decodes on this instance's handle, the rest on handles
+        // kept for the purpose
+        while (channelHandles_.size() < static_cast<size_t>(channels - 1)) {
+            wsjtx_handle_t h = wsjtx_create();
+            if (!h) {
+                Napi::Error::New(env, "Failed to create wsjtx_lib instance").ThrowAsJavaScriptException();
+                return env.Null();
+            }
+            channelHandles_.push_back(h);
+        }
+        if (!RenewQuarantined(env, handle_)) return env.Null();
+        for (auto &h : channelHandles_)
+            if (!RenewQuarantined(env, h)) return env.Null();
+        const int admit = Admit(env, receiver_);
+        if (admit < 0) return env.Null();
+        for (auto &job : jobs) job->SetLowPriority(admit == 1);
+        std::vector<wsjtx_handle_t> handles(1, handle_);
+        handles.insert(handles.end(), channelHandles_.begin(), channelHandles_.begin() + (channels - 1));
+
+        // Copy only the frames some channel's window covers
+        const size_t stride = static_cast<size_t>(sampleBytes) * channels;
+        const size_t frames = length / stride;
+        size_t lo = frames, hi = 0;
+        for (const SlotWindow &w : windows) {
+            const size_t first = std::min(w.offset, frames);
+            lo = std::min(lo, first);
+            hi = std::max(hi, first + std::min(w.length, frames - first));
+        }
+        if (hi < lo) hi = lo;
+        for (SlotWindow &w : windows) w.offset -= std::min(w.offset, lo);
+
+        auto worker = new DecodeChannelsWorker(callback, handles, mode,
+            std::vector<uint8_t>(bytes + lo * stride, bytes + hi * stride), format, channels, std::move(jobs), windows);
+        worker->Track(WSJTX_OP_DECODE, mode, receiver_);
+        for (auto &obj : retain) worker->Retain(obj);
+        worker->QueueAfter(decodes_);
+        return env.Undefined();
+    }
+
+    // ---- Helpers ----
+
+    void WSJTXLibWrapper::ValidateMode(Napi::Env env, int mode) {
+        if (mode < 0 || mode > WSJTX_MODE_WSPR)
+            throw std::invalid_argument("Invalid mode value");
+    }
+
+    void WSJTXLibWrapper::ValidateFrequency(Napi::Env env, int frequency) {
+        if (frequency < 0 || frequency > 30000000)
+            throw std::invalid_argument("Invalid frequency value");
+    }
+
+    void WSJTXLibWrapper::ValidateThreads(Napi::Env env, int threads) {
+        if (threads < 1 || threads > 16)
+            throw std::invalid_argument("Thread count must be between 1 and 16");
+    }
+
+    void WSJTXLibWrapper::ValidateMessage(Napi::Env env, int mode, const std::string &message) {
+        if (message.empty()) {
+            throw std::invalid_argument("Message must not be empty");
+        }
+
+        // 77-bit modes carry up to 37 characters; JT4/JT9/JT65 and WSPR-style messages 22
+        const bool longMessages = mode == WSJTX_MODE_FT8 || mode == WSJTX_MODE_FT4 ||
+            mode == WSJTX_MODE_FST4 || mode == WSJTX_MODE_Q65;
+        const size_t maxLength = longMessages ? 37 : 22;
+        if (message.length() > maxLength) {
+            throw std::invalid_argument("Message must be 1-" + std::to_string(maxLength) + " characters long");
+        }
+    }
+
+    std::vector<float> WSJTXLibWrapper::ConvertToFloatArray(Napi::Env env, const Napi::Value& value) {
+        Napi::Float32Array array = value.As<Napi::Float32Array>();
+        float *data = array.Data();
+        return std::vector<float>(data, data + array.ElementLength());
+    }
+
+    std::vector<short int> WSJTXLibWrapper::ConvertToIntArray(Napi::Env env, const Napi::Value& value) {
+        Napi::Int16Array array = value.As<Napi::Int16Array>();
+        int16_t *data = array.Data();
+        return std::vector<short int>(data, data + array.ElementLength());
+    }
+
+    // Decoder bookkeeping; an unknown AP type (-1) is omitted
+    static void SetDecodeInfo(Napi::Env env, Napi::Object obj, const wsjtx_message_t &msg)
+    {
+        if (msg.ap_type >= 0) obj.Set("apType", Napi::Number::New(env, msg.ap_type));
+    }
+
+    Napi::Object WSJTXLibWrapper::CreateMessageObject(Napi::Env env, const wsjtx_message_t &msg)
+    {
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("text", Napi::String::New(env, msg.msg));
+        result.Set("snr", Napi::Number::New(env, msg.snr));
+        result.Set("deltaTime", Napi::Number::New(env, msg.dt));
+        result.Set("deltaFrequency", Napi::Number::New(env, msg.freq));
+        result.Set("timestamp", Napi::Number::New(env, msg.hh * 3600 + msg.min * 60 + msg.sec));
+        result.Set("sync", Napi::Number::New(env, msg.sync));
+        SetDecodeInfo(env, result, msg);
+        return result;
+    }
+
+    // Read an array of WSJTXMessage-shaped objects back into C structs
+    static std::vector<wsjtx_message_t> ReadMessages(Napi::Array arr)
+    {
+        uint32_t n = arr.Length();
+        std::vector<wsjtx_message_t> msgs(n);
+        for (uint32_t i = 0; i < n; i++) {
+            Napi::Object o = arr.Get(i).As<Napi::Object>();
+            wsjtx_message_t &m = msgs[i];
+            memset(&m, 0, sizeof(m));
+            std::string text = o.Get("text").As<Napi::String>().Utf8Value();
+            strncpy(m.msg, text.c_str(), sizeof(m.msg) - 1);
+            if (o.Has("snr")) m.snr = o.Get("snr").As<Napi::Number>().Int32Value();
+            if (o.Has("deltaFrequency")) m.freq = o.Get("deltaFrequency").As<Napi::Number>().Int32Value();
+            if (o.Has("deltaTime")) m.dt = o.Get("deltaTime").As<Napi::Number>().FloatValue();
+            if (o.Has("sync")) m.sync = o.Get("sync").As<Napi::Number>().FloatValue();
+            if (o.Has("timestamp")) {
+                int ts = o.Get("timestamp").As<Napi::Number>().Int32Value();
+                m.hh = ts / 3600; m.min = (ts / 60) % 60; m.sec = ts % 60;
+            }
+            m.ap_type = o.Has("apType") ? o.Get("apType").As<Napi::Number>().Int32Value() : -1;
+        }
+        return msgs;
+    }
+
+    static void SetHistoryFields(Napi::Env env, Napi::Object obj, const wsjtx_history_entry_t &e)
+    {
+        obj.Set("isNew", Napi::Boolean::New(env, e.is_new != 0));
+        obj.Set("repeatCount", Napi::Number::New(env, e.repeat_count));
+        obj.Set("firstSeenSlot", Napi::Number::New(env, static_cast<double>(e.first_slot)));
+        obj.Set("lastSeenSlot", Napi::Number::New(env, static_cast<double>(e.last_slot)));
+    }
+
+    // ---- MessageHistoryWrapper ----
+
+    Napi::FunctionReference MessageHistoryWrapper::constructor;
+
+    Napi::Object MessageHistoryWrapper::Init(Napi::Env env, Napi::Object exports)
+    {
+        Napi::Function func = DefineClass(env, "MessageHistory", {
+            InstanceMethod("observe", &MessageHistoryWrapper::Observe),
+            InstanceMethod("size", &MessageHistoryWrapper::Size),
+            InstanceMethod("clear", &MessageHistoryWrapper::Clear)
+        });
+
+        constructor = Napi::Persistent(func);
+        constructor.SuppressDestruct();
+        exports.Set("MessageHistory", func);
+        return exports;
+    }
+
+    MessageHistoryWrapper::MessageHistoryWrapper(const Napi::CallbackInfo &info)
+        : Napi::ObjectWrap<MessageHistoryWrapper>(info)
+    {
+        Napi::Env env = info.Env();
+        if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsNumber()) {
+            Napi::TypeError::New(env, "Expected 2 arguments: capacity, frequencyTolerance")
+                .ThrowAsJavaScriptException();
+            return;
+        }
+        history_ = wsjtx_history_create(info[0].As<Napi::Number>().Int32Value(),
+                                        info[1].As<Napi::Number>().Int32Value());
+        if (!history_) {
+            Napi::Error::New(env, "Failed to create message history").ThrowAsJavaScriptException();
+        }
+    }
+
+    MessageHistoryWrapper::~MessageHistoryWrapper()
+    {
+        if (history_) {
+            wsjtx_history_destroy(history_);
+            history_ = nullptr;
+        }
+    }
+
+    Napi::Value MessageHistoryWrapper::Observe(const Napi::CallbackInfo &info)
+    {
+        Napi::Env env = info.Env();
+
+        if (info.Length() < 2 || !info[0].IsArray() || !info[1].IsNumber()) {
+            Napi::TypeError::New(env, "Expected 2 arguments: messages[], slot").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+
+        std::vector<wsjtx_message_t> msgs = ReadMessages(info[0].As<Napi::Array>());
+        int64_t slot = info[1].As<Napi::Number>().Int64Value();
+        uint32_t n = static_cast<uint32_t>(msgs.size());
+
+        std::vector<wsjtx_history_entry_t> entries(n);
+        int rc = wsjtx_history_observe(history_, msgs.data(), static_cast<int>(n), slot, entries.data());
+        if (rc < 0) {
+            Napi::Error::New(env, "History observe failed with error code " + std::to_string(rc))
+                .ThrowAsJavaScriptException();
+            return env.Null();
+        }
+
+        Napi::Array results = Napi::Array::New(env, n);
+        for (uint32_t i = 0; i < n; i++) {
+            Napi::Object o = Napi::Object::New(env);
+            SetHistoryFields(env, o, entries[i]);
+            results[i] = o;
+        }
+        return results;
+    }
+
+    Napi::Value MessageHistoryWrapper::Size(const Napi::CallbackInfo &info)
+    {
+        return Napi::Number::New(info.Env(), wsjtx_history_size(history_));
+    }
+
+    Napi::Value MessageHistoryWrapper::Clear(const Napi::CallbackInfo &info)
+    {
+        wsjtx_history_clear(history_);
+        return info.Env().Undefined();
+    }
+
+    // ---- ActivityAggregatorWrapper ----
+
+    Napi::FunctionReference ActivityAggregatorWrapper::constructor;
+
+    Napi::Object ActivityAggregatorWrapper::Init(Napi::Env env, Napi::Object exports)
+    {
+        Napi::Function func = DefineClass(env, "ActivityAggregator", {
+            InstanceMethod("add", &ActivityAggregatorWrapper::Add),
+            InstanceMethod("query", &ActivityAggregatorWrapper::Query)
+        });
+
+        constructor = Napi::Persistent(func);
+        constructor.SuppressDestruct();
+        exports.Set("ActivityAggregator", func);
+        return exports;
+    }
+
+    ActivityAggregatorWrapper::ActivityAggregatorWrapper(const Napi::CallbackInfo &info)
+        : Napi::ObjectWrap<ActivityAggregatorWrapper>(info)
+    {
+        Napi::Env env = info.Env();
+        if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsNumber()) {
+            Napi::TypeError::New(env, "Expected 2 arguments: bucketSeconds, buckets")
+                .ThrowAsJavaScriptException();
+            return;
+        }
+        buckets_ = info[1].As<Napi::Number>().Int32Value();
+        activity_ = wsjtx_activity_create(info[0].As<Napi::Number>().Int32Value(), buckets_);
+        if (!activity_) {
+            Napi::Error::New(env, "Failed to create activity aggregator").ThrowAsJavaScriptException();
+        }
+    }
+
+    ActivityAggregatorWrapper::~ActivityAggregatorWrapper()
+    {
+        if (activity_) {
+            wsjtx_activity_destroy(activity_);
+            activity_ = nullptr;
+        }
+    }
+
+    Napi::Value ActivityAggregatorWrapper::Add(const Napi::CallbackInfo &info)
+    {
+        Napi::Env env = info.Env();
+
+        if (info.Length() < 4 || !info[0].IsString() || !info[1].IsNumber() ||
+            !info[2].IsNumber() || !info[3].IsArray()) {
+            Napi::TypeError::New(env, "Expected 4 arguments: band, mode, timeSeconds, messages[]")
+                .ThrowAsJavaScriptException();
+            return env.Null();
+        }
+
+        std::string band = info[0].As<Napi::String>().Utf8Value();
+        int mode = info[1].As<Napi::Number>().Int32Value();
+        int64_t time = info[2].As<Napi::Number>().Int64Value();
+        std::vector<wsjtx_message_t> msgs = ReadMessages(info[3].As<Napi::Array>());
+
+        int rc = wsjtx_activity_add(activity_, band.c_str(), mode, time,
+            msgs.data(), static_cast<int>(msgs.size()));
+        if (rc != WSJTX_OK) {
+            Napi::Error::New(env, "Activity add failed with error code " + std::to_string(rc))
+                .ThrowAsJavaScriptException();
+        }
+        return env.Undefined();
+    }
+
+    static Napi::Object CreateActivityObject(Napi::Env env, const wsjtx_activity_stats_t &st)
+    {
+        Napi::Object o = Napi::Object::New(env);
+        o.Set("bucketStart", Napi::Number::New(env, static_cast<double>(st.bucket_start)));
+        o.Set("decodes", Napi::Number::New(env, st.decodes));
+        o.Set("uniqueCalls", Napi::Number::New(env, st.unique_calls));
+        Napi::Int32Array snr = Napi::Int32Array::New(env, WSJTX_ACTIVITY_SNR_BINS);
+        std::copy(st.snr_histogram, st.snr_histogram + WSJTX_ACTIVITY_SNR_BINS, snr.Data());
+        o.Set("snrHistogram", snr);
+        Napi::Int32Array audio = Napi::Int32Array::New(env, WSJTX_ACTIVITY_AUDIO_BINS);
+        std::copy(st.audio_occupancy, st.audio_occupancy + WSJTX_ACTIVITY_AUDIO_BINS, audio.Data());
+        o.Set("audioOccupancy", audio);
+        return o;
+    }
+
+    Napi::Value ActivityAggregatorWrapper::Query(const Napi::CallbackInfo &info)
+    {
+        Napi::Env env = info.Env();
+
+        if (info.Length() < 4 || !info[0].IsString() || !info[1].IsNumber() ||
+            !info[2].IsNumber() || !info[3].IsNumber()) {
+            Napi::TypeError::New(env, "Expected 4 arguments: band, mode, fromSeconds, toSeconds")
+                .ThrowAsJavaScriptException();
+            return env.Null();
+        }
+
+        std::string band = info[0].As<Napi::String>().Utf8Value();
+        int mode = info[1].As<Napi::Number>().Int32Value();
+        int64_t from = info[2].As<Napi::Number>().Int64Value();
+        int64_t to = info[3].As<Napi::Number>().Int64Value();
+        bool withBuckets = info.Length() > 4 && info[4].ToBoolean();
+
+        // A query never yields more rows than the ring holds
+        wsjtx_activity_stats_t total;
+        std::vector<wsjtx_activity_stats_t> rows(withBuckets ? buckets_ : 0);
+        int n = wsjtx_activity_query(activity_, band.c_str(), mode, from, to, &total,
+            withBuckets ? rows.data() : nullptr, static_cast<int>(rows.size()));
+        if (n < 0) {
+            Napi::Error::New(env, "Activity query failed with error code " + std::to_string(n))
+                .ThrowAsJavaScriptException();
+            return env.Null();
+        }
+
+        Napi::Object result = CreateActivityObject(env, total);
+        if (withBuckets) {
+            Napi::Array buckets = Napi::Array::New(env, n);
+            for (int i = 0; i < n; i++) buckets[static_cast<uint32_t>(i)] = CreateActivityObject(env, rows[i]);
+            result.Set("buckets", buckets);
+        }
+        return result;
+    }
+
+    // ---- ClockEstimatorWrapper ----
+
+    Napi::FunctionReference ClockEstimatorWrapper::constructor;
+
+    Napi::Object ClockEstimatorWrapper::Init(Napi::Env env, Napi::Object exports)
+    {
+        Napi::Function func = DefineClass(env, "ClockEstimator", {
+            InstanceMethod("observe", &ClockEstimatorWrapper::Observe),
+            InstanceMethod("estimate", &ClockEstimatorWrapper::Estimate),
+            InstanceMethod("clear", &ClockEstimatorWrapper::Clear)
+        });
+
+        constructor = Napi::Persistent(func);
+        constructor.SuppressDestruct();
+        exports.Set("ClockEstimator", func);
+        return exports;
+    }
+
+    ClockEstimatorWrapper::ClockEstimatorWrapper(const Napi::CallbackInfo &info)
+        : Napi::ObjectWrap<ClockEstimatorWrapper>(info)
+    {
+        Napi::Env env = info.Env();
+        if (info.Length() < 1 || !info[0].IsNumber()) {
+            Napi::TypeError::New(env, "Expected 1 argument: windowSeconds").ThrowAsJavaScriptException();
+            return;
+        }
+        clock_ = wsjtx_clock_create(info[0].As<Napi::Number>().DoubleValue());
+        if (!clock_) {
+            Napi::Error::New(env, "Failed to create clock estimator").ThrowAsJavaScriptException();
+        }
+    }
+
+    ClockEstimatorWrapper::~ClockEstimatorWrapper()
+    {
+        if (clock_) {
+            wsjtx_clock_destroy(clock_);
+            clock_ = nullptr;
+        }
+    }
+
+    Napi::Value ClockEstimatorWrapper::Observe(const Napi::CallbackInfo &info)
+    {
+        Napi::Env env = info.Env();
+        if (info.Length() < 2 || !info[0].IsArray() || !info[1].IsNumber()) {
+            Napi::TypeError::New(env, "Expected 2 arguments: messages[], slotTime").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        std::vector<wsjtx_message_t> msgs = ReadMessages(info[0].As<Napi::Array>());
+        int rc = wsjtx_clock_observe(clock_, info[1].As<Napi::Number>().DoubleValue(),
+            msgs.data(), static_cast<int>(msgs.size()));
+        if (rc < 0) {
+            Napi::Error::New(env, "Clock observe failed with error code " + std::to_string(rc))
+                .ThrowAsJavaScriptException();
+        }
+        return env.Undefined();
+    }
+
+    Napi::Value ClockEstimatorWrapper::Estimate(const Napi::CallbackInfo &info)
+    {
+        Napi::Env env = info.Env();
+        wsjtx_clock_estimate_t est = {};
+        if (wsjtx_clock_estimate(clock_, &est) != 1) return env.Null();
+        Napi::Object o = Napi::Object::New(env);
+        o.Set("ppm", Napi::Number::New(env, est.ppm));
+        o.Set("ppmError", Napi::Number::New(env, est.ppm_error));
+        o.Set("dtOffset", Napi::Number::New(env, est.dt_offset));
+        o.Set("slots", Napi::Number::New(env, est.slots));
+        return o;
+    }
+
+    Napi::Value ClockEstimatorWrapper::Clear(const Napi::CallbackInfo &info)
+    {
+        wsjtx_clock_clear(clock_);
+        return info.Env().Undefined();
+    }
+
+    // ---- QsoSequencerWrapper ----
+
+    Napi::FunctionReference QsoSequencerWrapper::constructor;
+
+    Napi::Object QsoSequencerWrapper::Init(Napi::Env env, Napi::Object exports)
+    {
+        Napi::Function func = DefineClass(env, "QsoSequencer", {
+            InstanceMethod("startCq", &QsoSequencerWrapper::StartCq),
+            InstanceMethod("call", &QsoSequencerWrapper::Call),
+            InstanceMethod("stop", &QsoSequencerWrapper::Stop),
+            InstanceMethod("observe", &QsoSequencerWrapper::Observe),
+            InstanceMethod("status", &QsoSequencerWrapper::Status),
+            InstanceMethod("txAudio", &QsoSequencerWrapper::TxAudio),
+            InstanceMethod("speculate", &QsoSequencerWrapper::Speculate)
+        });
+
+        constructor = Napi::Persistent(func);
+        constructor.SuppressDestruct();
+        exports.Set("QsoSequencer", func);
+        return exports;
+    }
+
+    QsoSequencerWrapper::QsoSequencerWrapper(const Napi::CallbackInfo &info)
+        : Napi::ObjectWrap<QsoSequencerWrapper>(info)
+    {
+        Napi::Env env = info.Env();
+        if (info.Length() < 5 || !info[0].IsNumber() || !info[1].IsString() || !info[2].IsString() ||
+            !info[3].IsNumber() || !info[4].IsNumber()) {
+            Napi::TypeError::New(env, "Expected 5 arguments: mode, myCall, myGrid, txFrequency, maxRepeats")
+                .ThrowAsJavaScriptException();
+            return;
+        }
+        std::string call = info[1].As<Napi::String>().Utf8Value();
+        std::string grid = info[2].As<Napi::String>().Utf8Value();
+        qso_ = wsjtx_qso_create(info[0].As<Napi::Number>().Int32Value(), call.c_str(), grid.c_str(),
+            info[3].As<Napi::Number>().Int32Value(), info[4].As<Napi::Number>().Int32Value());
+        if (!qso_) {
+            Napi::Error::New(env, "Failed to create QSO sequencer").ThrowAsJavaScriptException();
+        }
+    }
+
+    QsoSequencerWrapper::~QsoSequencerWrapper()
+    {
+        if (qso_) {
+            wsjtx_qso_destroy(qso_);
+            qso_ = nullptr;
+        }
+    }
+
+    // Room for either mode's transmission; the sequencer's mode is not exposed
+    static int QsoAudioSamples()
+    {
+        return std::max(wsjtx_get_waveform_samples(WSJTX_MODE_FT8), wsjtx_get_waveform_samples(WSJTX_MODE_FT4));
+    }
+
+    static Napi::Object CreateQsoStatusObject(Napi::Env env, const wsjtx_qso_status_t &s)
+    {
+        Napi::Object o = Napi::Object::New(env);
+        o.Set("state", Napi::Number::New(env, s.state));
+        o.Set("dxCall", Napi::String::New(env, s.dx_call));
+        o.Set("dxGrid", Napi::String::New(env, s.dx_grid));
+        o.Set("reportSent", Napi::Number::New(env, s.report_sent));
+        o.Set("reportReceived", s.report_received == WSJTX_QSO_NO_REPORT
+            ? env.Null() : Napi::Number::New(env, s.report_received));
+        o.Set("repeats", Napi::Number::New(env, s.repeats));
+        o.Set("logged", Napi::Boolean::New(env, s.logged != 0));
+        o.Set("txMessage", Napi::String::New(env, s.tx_message));
+        o.Set("cacheHits", Napi::Number::New(env, s.cache_hits));
+        o.Set("cacheMisses", Napi::Number::New(env, s.cache_misses));
+        return o;
+    }
+
+    Napi::Value QsoSequencerWrapper::StartCq(const Napi::CallbackInfo &info)
+    {
+        wsjtx_qso_start_cq(qso_);
+        return info.Env().Undefined();
+    }
+
+    Napi::Value QsoSequencerWrapper::Call(const Napi::CallbackInfo &info)
     {
-        int rc;
-        if (useFloat_) {
-            rc = wsjtx_decode_float_v2(handle_, mode_,
-                floatData_.data(), static_cast<int>(floatData_.size()),
-                &options_);
+        Napi::Env env = info.Env();
+        if (info.Length() < 3 || !info[0].IsString() || !info[2].IsNumber()) {
+            Napi::TypeError::New(env, "Expected 3 arguments: dxCall, dxGrid, snr").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        std::string call = info[0].As<Napi::String>().Utf8Value();
+        std::string grid = info[1].IsString() ? info[1].As<Napi::String>().Utf8Value() : "";
+        int rc = wsjtx_qso_call(qso_, call.c_str(), grid.c_str(), info[2].As<Napi::Number>().Int32Value());
+        if (rc < 0) {
+            Napi::Error::New(env, "QSO call failed with error code " + std::to_string(rc))
+                .ThrowAsJavaScriptException();
+        }
+        return env.Undefined();
+    }
+
+    Napi::Value QsoSequencerWrapper::Stop(const Napi::CallbackInfo &info)
+    {
+        wsjtx_qso_stop(qso_);
+        return info.Env().Undefined();
+    }
+
+    Napi::Value QsoSequencerWrapper::Observe(const Napi::CallbackInfo &info)
+    {
+        Napi::Env env = info.Env();
+        if (info.Length() < 1 || !info[0].IsArray()) {
+            Napi::TypeError::New(env, "Expected 1 argument: messages[]").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        std::vector<wsjtx_message_t> msgs = ReadMessages(info[0].As<Napi::Array>());
+        int rc = wsjtx_qso_observe(qso_, msgs.data(), static_cast<int>(msgs.size()));
+        if (rc < 0) {
+            Napi::Error::New(env, "QSO observe failed with error code " + std::to_string(rc))
+                .ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        return Napi::Boolean::New(env, rc == 1);
+    }
+
+    Napi::Value QsoSequencerWrapper::Status(const Napi::CallbackInfo &info)
+    {
+        wsjtx_qso_status_t s;
+        wsjtx_qso_status(qso_, &s);
+        return CreateQsoStatusObject(info.Env(), s);
+    }
+
+    Napi::Value QsoSequencerWrapper::TxAudio(const Napi::CallbackInfo &info)
+    {
+        Napi::Env env = info.Env();
+        if (info.Length() < 1 || !info[0].IsFunction()) {
+            Napi::TypeError::New(env, "Expected callback").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        Napi::Function callback = info[0].As<Napi::Function>();
+        auto worker = new QsoWorker(callback, qso_, false);
+        worker->Retain(info.This().As<Napi::Object>());
+        worker->Queue();
+        return env.Undefined();
+    }
+
+    Napi::Value QsoSequencerWrapper::Speculate(const Napi::CallbackInfo &info)
+    {
+        Napi::Env env = info.Env();
+        if (info.Length() < 1 || !info[0].IsFunction()) {
+            Napi::TypeError::New(env, "Expected callback").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        Napi::Function callback = info[0].As<Napi::Function>();
+        auto worker = new QsoWorker(callback, qso_, true);
+        worker->Retain(info.This().As<Napi::Object>());
+        worker->Queue();
+        return env.Undefined();
+    }
+
+    // ---- UdpEmitterWrapper ----
+
+    Napi::FunctionReference UdpEmitterWrapper::constructor;
+
+    Napi::Object UdpEmitterWrapper::Init(Napi::Env env, Napi::Object exports)
+    {
+        Napi::Function func = DefineClass(env, "UdpEmitter", {
+            InstanceMethod("sendHeartbeat", &UdpEmitterWrapper::SendHeartbeat),
+            InstanceMethod("sendStatus", &UdpEmitterWrapper::SendStatus),
+            InstanceMethod("sendDecodes", &UdpEmitterWrapper::SendDecodes),
+            InstanceMethod("sendWSPR", &UdpEmitterWrapper::SendWSPR)
+        });
+
+        constructor = Napi::Persistent(func);
+        constructor.SuppressDestruct();
+        exports.Set("UdpEmitter", func);
+        return exports;
+    }
+
+    UdpEmitterWrapper::UdpEmitterWrapper(const Napi::CallbackInfo &info)
+        : Napi::ObjectWrap<UdpEmitterWrapper>(info)
+    {
+        Napi::Env env = info.Env();
+        if (info.Length() < 4 || !info[0].IsString() || !info[1].IsNumber() ||
+            !info[2].IsString() || !info[3].IsNumber()) {
+            Napi::TypeError::New(env, "Expected 4 arguments: host, port, clientId, multicastTtl")
+                .ThrowAsJavaScriptException();
+            return;
+        }
+        std::string host = info[0].As<Napi::String>().Utf8Value();
+        std::string id = info[2].As<Napi::String>().Utf8Value();
+        udp_ = wsjtx_udp_create(host.c_str(), info[1].As<Napi::Number>().Int32Value(),
+                                id.c_str(), info[3].As<Napi::Number>().Int32Value());
+        if (!udp_) {
+            Napi::Error::New(env, "Failed to create UDP emitter for " + host).ThrowAsJavaScriptException();
+        }
+    }
+
+    UdpEmitterWrapper::~UdpEmitterWrapper()
+    {
+        if (udp_) {
+            wsjtx_udp_destroy(udp_);
+            udp_ = nullptr;
+        }
+    }
+
+    static Napi::Value SendResult(Napi::Env env, int rc, const char *what)
+    {
+        if (rc < 0) {
+            Napi::Error::New(env, std::string(what) + " failed with error code " + std::to_string(rc))
+                .ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        return Napi::Number::New(env, rc);
+    }
+
+    static void CopyString(Napi::Object obj, const char *key, char *dst, size_t size)
+    {
+        if (!obj.Has(key) || !obj.Get(key).IsString()) return;
+        std::string s = obj.Get(key).As<Napi::String>().Utf8Value();
+        strncpy(dst, s.c_str(), size - 1);
+    }
+
+    static uint32_t GetUint(Napi::Object obj, const char *key)
+    {
+        return obj.Has(key) && obj.Get(key).IsNumber() ? obj.Get(key).As<Napi::Number>().Uint32Value() : 0;
+    }
+
+    static int GetFlag(Napi::Object obj, const char *key)
+    {
+        return obj.Has(key) && obj.Get(key).ToBoolean() ? 1 : 0;
+    }
+
+    Napi::Value UdpEmitterWrapper::SendHeartbeat(const Napi::CallbackInfo &info)
+    {
+        Napi::Env env = info.Env();
+        std::string version = info.Length() > 0 && info[0].IsString() ? info[0].As<Napi::String>().Utf8Value() : "";
+        std::string revision = info.Length() > 1 && info[1].IsString() ? info[1].As<Napi::String>().Utf8Value() : "";
+        return SendResult(env, wsjtx_udp_send_heartbeat(udp_, version.c_str(), revision.c_str()), "Heartbeat");
+    }
+
+    Napi::Value UdpEmitterWrapper::SendStatus(const Napi::CallbackInfo &info)
+    {
+        Napi::Env env = info.Env();
+
+        if (info.Length() < 1 || !info[0].IsObject()) {
+            Napi::TypeError::New(env, "Expected status object").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+
+        Napi::Object o = info[0].As<Napi::Object>();
+        wsjtx_udp_status_t st;
+        memset(&st, 0, sizeof(st));
+        if (o.Has("dialFrequency") && o.Get("dialFrequency").IsNumber())
+            st.dial_frequency = static_cast<uint64_t>(o.Get("dialFrequency").As<Napi::Number>().Int64Value());
+        CopyString(o, "mode", st.mode, sizeof(st.mode));
+        CopyString(o, "dxCall", st.dx_call, sizeof(st.dx_call));
+        CopyString(o, "report", st.report, sizeof(st.report));
+        CopyString(o, "txMode", st.tx_mode, sizeof(st.tx_mode));
+        st.tx_enabled = GetFlag(o, "txEnabled");
+        st.transmitting = GetFlag(o, "transmitting");
+        st.decoding = GetFlag(o, "decoding");
+        st.rx_df = GetUint(o, "rxDF");
+        st.tx_df = GetUint(o, "txDF");
+        CopyString(o, "deCall", st.de_call, sizeof(st.de_call));
+        CopyString(o, "deGrid", st.de_grid, sizeof(st.de_grid));
+        CopyString(o, "dxGrid", st.dx_grid, sizeof(st.dx_grid));
+        st.tx_watchdog = GetFlag(o, "txWatchdog");
+        CopyString(o, "subMode", st.sub_mode, sizeof(st.sub_mode));
+        st.fast_mode = GetFlag(o, "fastMode");
+        st.special_op_mode = static_cast<int>(GetUint(o, "specialOperationMode"));
+        st.freq_tolerance = GetUint(o, "frequencyTolerance");
+        st.tr_period = GetUint(o, "trPeriod");
+        CopyString(o, "configurationName", st.config_name, sizeof(st.config_name));
+        CopyString(o, "txMessage", st.tx_message, sizeof(st.tx_message));
+        return SendResult(env, wsjtx_udp_send_status(udp_, &st), "Status");
+    }
+
+    Napi::Value UdpEmitterWrapper::SendDecodes(const Napi::CallbackInfo &info)
+    {
+        Napi::Env env = info.Env();
+
+        if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsArray()) {
+            Napi::TypeError::New(env, "Expected 2 arguments: mode, messages[]").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+
+        int mode = info[0].As<Napi::Number>().Int32Value();
+        Napi::Array arr = info[1].As<Napi::Array>();
+        std::vector<wsjtx_message_t> msgs = ReadMessages(arr);
+        // Messages carrying an isNew flag (from a MessageHistory) keep it on the wire
+        std::vector<int> isNew(msgs.size(), 1);
+        for (uint32_t i = 0; i < msgs.size(); i++) {
+            Napi::Object o = arr.Get(i).As<Napi::Object>();
+            if (o.Has("isNew")) isNew[i] = o.Get("isNew").ToBoolean() ? 1 : 0;
+        }
+        return SendResult(env, wsjtx_udp_send_decodes(udp_, mode, msgs.data(),
+            static_cast<int>(msgs.size()), isNew.data()), "Decode");
+    }
+
+    Napi::Value UdpEmitterWrapper::SendWSPR(const Napi::CallbackInfo &info)
+    {
+        Napi::Env env = info.Env();
+
+        if (info.Length() < 3 || !info[0].IsArray() || !info[1].IsNumber() || !info[2].IsNumber()) {
+            Napi::TypeError::New(env, "Expected 3 arguments: results[], timeMs, dialFrequency")
+                .ThrowAsJavaScriptException();
+            return env.Null();
+        }
+
+        Napi::Array arr = info[0].As<Napi::Array>();
+        uint32_t n = arr.Length();
+        std::vector<wsjtx_decoder_result_t> results(n);
+        for (uint32_t i = 0; i < n; i++) {
+            Napi::Object o = arr.Get(i).As<Napi::Object>();
+            wsjtx_decoder_result_t &r = results[i];
+            memset(&r, 0, sizeof(r));
+            if (o.Has("frequency")) r.freq = o.Get("frequency").As<Napi::Number>().DoubleValue();
+            if (o.Has("snr")) r.snr = o.Get("snr").As<Napi::Number>().FloatValue();
+            if (o.Has("deltaTime")) r.dt = o.Get("deltaTime").As<Napi::Number>().FloatValue();
+            if (o.Has("drift")) r.drift = o.Get("drift").As<Napi::Number>().FloatValue();
+            CopyString(o, "callsign", r.call, sizeof(r.call));
+            CopyString(o, "locator", r.loc, sizeof(r.loc));
+            // pwr is a fixed 3-char field without a terminator
+            if (o.Has("power") && o.Get("power").IsString()) {
+                std::string p = o.Get("power").As<Napi::String>().Utf8Value();
+                memcpy(r.pwr, p.c_str(), std::min(p.size(), sizeof(r.pwr)));
+            }
+        }
+
+        uint32_t timeMs = info[1].As<Napi::Number>().Uint32Value();
+        uint64_t dial = static_cast<uint64_t>(info[2].As<Napi::Number>().Int64Value());
+        return SendResult(env, wsjtx_udp_send_wspr_decodes(udp_, results.data(), static_cast<int>(n),
+            timeMs, dial), "WSPRDecode");
+    }
+
+    // ---- Async Workers ----
+
+    AsyncWorkerBase::AsyncWorkerBase(Napi::Function &callback, wsjtx_handle_t handle)
+        : Napi::AsyncWorker(callback), handle_(handle)
+    {
+        wsjtx_watchdog_hold(handle_);   // a retired handle lives until its jobs are done
+        if (wsjtx_trace_enabled()) {
+            traceJob_ = ++g_traceJobs;
+            traceCreated_ = wsjtx_trace_now_us();
+        }
+    }
+
+    AsyncWorkerBase::~AsyncWorkerBase()
+    {
+        wsjtx_watchdog_release(handle_);
+        if (serial_) serial_->Done();
+        // Runs after OnOK/OnError, so the total includes result marshaling
+        if (op_ < 0) return;
+        int64_t now = wsjtx_trace_now_us();
+        if (started_) {
+            wsjtx_metrics_jobs(receiver_.c_str(), 0, -1);
+            wsjtx_metrics_record(receiver_.c_str(), op_, opMode_, started_ - created_, now - created_, !failed_);
+            wsjtx_metrics_cpu(receiver_.c_str(), op_, opMode_, cpuUs_);
+            wsjtx_account_charge(receiver_.c_str(), cpuUs_, started_ - created_);
         } else {
-            rc = wsjtx_decode_int16_v2(handle_, mode_,
-                reinterpret_cast<int16_t*>(intData_.data()),
-                static_cast<int>(intData_.size()),
-                &options_);
+            wsjtx_metrics_jobs(receiver_.c_str(), -1, 0);   // cancelled before it ran
+        }
+    }
+
+    void AsyncWorkerBase::Track(int op, int mode, const std::string &receiver)
+    {
+        op_ = op;
+        opMode_ = mode;
+        receiver_ = receiver;
+        created_ = wsjtx_trace_now_us();
+        wsjtx_metrics_jobs(receiver_.c_str(), 1, 0);
+    }
+
+    void AsyncWorkerBase::QueueAfter(const std::shared_ptr<DecodeSerializer> &serial)
+    {
+        serial_ = serial;
+        serial_->Submit(this);
+    }
+
+    // DecodeSerializer: workers are destroyed on the JS thread, after their
+    // OnOK/OnError, so all of this runs there
+    void DecodeSerializer::Submit(AsyncWorkerBase *worker)
+    {
+        if (busy_) {
+            waiting_.push_back(worker);
+            return;
+        }
+        busy_ = true;
+        worker->Queue();
+    }
+
+    void DecodeSerializer::Done()
+    {
+        if (waiting_.empty()) {
+            busy_ = false;
+            return;
+        }
+        AsyncWorkerBase *next = waiting_.front();
+        waiting_.pop_front();
+        next->Queue();
+    }
+
+    AsyncWorkerBase::ExecuteScope AsyncWorkerBase::BeginExecute()
+    {
+        wsjtx_trace_set_job(traceJob_);
+        if (traceJob_ >= 0)
+            wsjtx_trace_record("queue_wait", traceCreated_, wsjtx_trace_now_us() - traceCreated_, traceJob_);
+        if (op_ >= 0) {
+            started_ = wsjtx_trace_now_us();
+            wsjtx_metrics_jobs(receiver_.c_str(), -1, 1);
+        }
+        return ExecuteScope(this);
+    }
+
+    void AsyncWorkerBase::OnError(const Napi::Error &e)
+    {
+        failed_ = true;
+        Napi::AsyncWorker::OnError(e);
+    }
+
+    // The decoder call of a DecodeJob. It owns everything it touches besides
+    // the handle, so when the watchdog abandons it the job can complete
+    // (and its JS-side objects go away) while this runs on.
+    struct CoreDecode {
+        wsjtx_handle_t handle = nullptr;
+        int mode = 0;
+        wsjtx_decode_options_t options = {};
+        std::vector<float> floatData;
+        std::vector<short int> intData;
+        bool useFloat = true;
+        std::vector<wsjtx_ap_target_t> targets;
+        bool usePartition = false;
+        std::vector<wsjtx_candidate_t> partition;
+        std::vector<wsjtx_message_t> messages;
+        int numMessages = 0;
+        int64_t traceJob = -1;
+        std::string receiver;
+        bool lowPriority = false;
+        std::thread::id caller = std::this_thread::get_id();
+        int64_t cpuUs = 0;      // measured only on a thread of the watchdog's
+
+        static int Run(void *p) { return static_cast<CoreDecode*>(p)->Watched(); }
+        static void Abandon(void *p)
+        {
+            // The job is long gone, so the runaway charges its receiver itself
+            CoreDecode *core = static_cast<CoreDecode*>(p);
+            wsjtx_metrics_cpu(core->receiver.c_str(), WSJTX_OP_DECODE, core->mode, core->cpuUs);
+            wsjtx_account_charge(core->receiver.c_str(), core->cpuUs, 0);
+            delete core;
+        }
+
+        int Watched()
+        {
+            if (std::this_thread::get_id() == caller) return Decode();
+            // A pool thread of the watchdog's, replaced after this decode if
+            // its priority is dropped for a receiver over its quota
+            if (lowPriority && wsjtx_thread_lower_priority() == WSJTX_OK)
+                wsjtx_account_deprioritized(receiver.c_str());
+            const int64_t start = wsjtx_thread_cpu_us();
+            const int rc = Decode();
+            cpuUs = wsjtx_thread_cpu_us() - start;
+            return rc;
+        }
+
+        int Decode()
+        {
+            wsjtx_trace_set_job(traceJob);   // may be a thread of the watchdog's
+            const int maxMsgs = static_cast<int>(messages.size());
+            const int numTargets = static_cast<int>(targets.size());
+            int rc;
+            if (usePartition) {
+                // Only the band this partition of the candidates spans
+                const std::vector<float> samples = useFloat ? floatData : ScaleToFloat(intData);
+                rc = wsjtx_decode_partition(handle, mode, samples.data(), static_cast<int>(samples.size()),
+                    &options, partition.data(), static_cast<int>(partition.size()),
+                    messages.data(), maxMsgs);
+                if (rc < 0) return rc;
+                numMessages = rc;
+                return WSJTX_OK;
+            }
+            if (numTargets > 0) {
+                // Merged multi-target decode writes the messages itself
+                rc = useFloat
+                    ? wsjtx_decode_float_targets(handle, mode,
+                          floatData.data(), static_cast<int>(floatData.size()),
+                          &options, targets.data(), numTargets, messages.data(), maxMsgs)
+                    : wsjtx_decode_int16_targets(handle, mode,
+                          reinterpret_cast<int16_t*>(intData.data()), static_cast<int>(intData.size()),
+                          &options, targets.data(), numTargets, messages.data(), maxMsgs);
+                if (rc < 0) return rc;
+                numMessages = rc;
+                return WSJTX_OK;
+            }
+            rc = useFloat
+                ? wsjtx_decode_float_v2(handle, mode,
+                      floatData.data(), static_cast<int>(floatData.size()), &options)
+                : wsjtx_decode_int16_v2(handle, mode,
+                      reinterpret_cast<int16_t*>(intData.data()), static_cast<int>(intData.size()), &options);
+            if (rc != WSJTX_OK) return rc;
+            numMessages = wsjtx_pull_messages(handle, messages.data(), maxMsgs);
+            return WSJTX_OK;
+        }
+    };
+
+    // DecodeJob
+    DecodeJob::~DecodeJob()
+    {
+        free(columns_);   // only set if ToResult never took ownership
+    }
+
+    bool DecodeJob::Run(wsjtx_handle_t handle, int64_t traceJob, const std::string &receiver)
+    {
+        int rc;
+        messages_.resize(MAX_MSGS);
+        if (!extras_.diversity.empty()) {
+            // Combine the receivers first; everything below sees one channel
+            TraceScope sub("combine", traceJob);
+            PromoteToFloat();
+            std::vector<const float*> channels(1, floatData_.data());
+            for (const auto& d : extras_.diversity) channels.push_back(d.data());
+            rc = wsjtx_combine_diversity(mode_, channels.data(), static_cast<int>(channels.size()),
+                static_cast<int>(floatData_.size()), floatData_.data());
+            if (rc != WSJTX_OK) return Fail("Diversity combining failed with error code " + std::to_string(rc));
+        }
+        double ppm = extras_.ratePpm;
+        bool correct = extras_.correctRate;
+        if (!correct && extras_.clock) {
+            // Only an estimate clear of its own noise is worth resampling for
+            wsjtx_clock_estimate_t est;
+            correct = wsjtx_clock_estimate(extras_.clock, &est) == 1 && std::fabs(est.ppm) > 2.0 * est.ppm_error;
+            ppm = est.ppm;
+        }
+        if (correct && ppm != 0.0) {
+            TraceScope sub("resample", traceJob);
+            PromoteToFloat();
+            std::vector<float> corrected(floatData_.size(), 0.0f);
+            rc = wsjtx_resample(floatData_.data(), static_cast<int>(floatData_.size()), 1.0 / (1.0 + ppm * 1e-6),
+                corrected.data(), static_cast<int>(corrected.size()));
+            if (rc < 0) return Fail("Resampling failed with error code " + std::to_string(rc));
+            floatData_.swap(corrected);
+        }
+        // The decoder call itself runs under the watchdog, on buffers of its own
+        std::unique_ptr<CoreDecode> core(new CoreDecode());
+        core->handle = handle;
+        core->mode = mode_;
+        core->options = options_;
+        core->floatData = std::move(floatData_);
+        core->intData = std::move(intData_);
+        core->useFloat = useFloat_;
+        core->targets = extras_.apTargets;
+        core->usePartition = extras_.usePartition;
+        core->partition = extras_.partition;
+        core->messages = std::move(messages_);
+        core->traceJob = traceJob;
+        core->receiver = receiver;
+        core->lowPriority = extras_.lowPriority;
+        rc = wsjtx_watchdog_run(handle, mode_, &CoreDecode::Run, &CoreDecode::Abandon, core.get());
+        if (rc == WSJTX_ERR_TIMEOUT) {
+            core.release();   // now the runaway thread's to free
+            char limit[32];
+            snprintf(limit, sizeof(limit), "%g", wsjtx_watchdog_get_limit(mode_));
+            return Fail(std::string("Decode exceeded the ") + limit + " s watchdog limit; decoder quarantined");
         }
+        if (rc == WSJTX_ERR_QUARANTINED) return Fail("Decoder quarantined by the watchdog after a hung decode");
+        if (rc == WSJTX_ERR_BUSY) {
+            wsjtx_watchdog_stats_t stats;
+            wsjtx_watchdog_stats(&stats);
+            return Fail("Decode refused: " + std::to_string(stats.runaways) +
+                " decodes that overran the watchdog limit are still running");
+        }
+        floatData_ = std::move(core->floatData);
+        intData_ = std::move(core->intData);
+        messages_ = std::move(core->messages);
+        numMessages_ = core->numMessages;
+        cpuUs_ += core->cpuUs;
+        core.reset();
         if (rc == WSJTX_OK) {
-            messages_.resize(MAX_MSGS);
-            numMessages_ = wsjtx_pull_messages(handle_, messages_.data(), MAX_MSGS);
-        } else {
-            SetError("Decode failed with error code " + std::to_string(rc));
+            wsjtx_metrics_messages(receiver.c_str(), mode_, numMessages_);
+            if (!extras_.homeGrid.empty()) ComputeGeo();
+            if (extras_.history) {
+                history_.resize(numMessages_);
+                if (wsjtx_history_observe(extras_.history, messages_.data(), numMessages_,
+                        extras_.slot, history_.data()) < 0) history_.clear();
+            }
+            if (extras_.clock) wsjtx_clock_observe(extras_.clock, extras_.clockTime, messages_.data(), numMessages_);
+            if (extras_.qso) {
+                // The next transmission is ready when the result is, pre-encoded if speculate() ran
+                TraceScope sub("qso", traceJob);
+                rc = wsjtx_qso_observe(extras_.qso, messages_.data(), numMessages_);
+                if (rc < 0) return Fail("QSO observe failed with error code " + std::to_string(rc));
+                txAudio_.resize(static_cast<size_t>(QsoAudioSamples()));
+                rc = wsjtx_qso_tx_audio(extras_.qso, txAudio_.data(), static_cast<int>(txAudio_.size()));
+                if (rc < 0) return Fail("QSO encode failed with error code " + std::to_string(rc));
+                txAudio_.resize(static_cast<size_t>(rc));
+                wsjtx_qso_status(extras_.qso, &qsoStatus_);
+                qsoRan_ = true;
+            }
+            if (extras_.activity) {
+                wsjtx_activity_add(extras_.activity, extras_.band.c_str(), mode_,
+                    extras_.activityTime, messages_.data(), numMessages_);
+            }
+            if (extras_.udp && numMessages_ > 0) {
+                // Repeats seen by the history go out with New = false, as WSJT-X does on replay
+                std::vector<int> isNew;
+                if (!history_.empty()) {
+                    isNew.resize(numMessages_);
+                    for (int i = 0; i < numMessages_; i++) isNew[i] = history_[i].is_new;
+                }
+                wsjtx_udp_send_decodes(extras_.udp, mode_, messages_.data(), numMessages_,
+                    isNew.empty() ? nullptr : isNew.data());
+            }
+            if (extras_.columnar) {
+                columns_ = BuildColumns(messages_.data(), numMessages_, &layout_);
+                if (!columns_) return Fail("Columnar export failed");
+            }
+            if (extras_.residual) {
+                // Float audio in, float residual out; Int16 is rescaled to [-1, 1)
+                residual_ = useFloat_ ? floatData_ : ScaleToFloat(intData_);
+                TraceScope sub("subtract", traceJob);
+                int n = wsjtx_subtract_messages(mode_, residual_.data(), static_cast<int>(residual_.size()),
+                    messages_.data(), numMessages_);
+                if (n < 0) return Fail("Residual failed with error code " + std::to_string(n));
+            }
+            return true;
         }
+        return Fail("Decode failed with error code " + std::to_string(rc));
     }
 
-    void DecodeWorker::OnOK()
+    bool DecodeJob::Fail(const std::string &error)
     {
-        Napi::Env env = Env();
-        auto msgs = Napi::Array::New(env, numMessages_);
+        error_ = error;
+        return false;
+    }
+
+    // The native stages (combining, resampling) work on float audio
+    void DecodeJob::PromoteToFloat()
+    {
+        if (useFloat_) return;
+        floatData_ = ScaleToFloat(intData_);
+        intData_.clear();
+        useFloat_ = true;
+    }
+
+    void DecodeJob::ComputeGeo()
+    {
+        grids_.assign(numMessages_, std::string());
+        std::vector<const char*> ptrs(numMessages_);
+        char grid[8];
         for (int i = 0; i < numMessages_; i++) {
+            if (wsjtx_message_grid(messages_[i].msg, grid, sizeof(grid)) > 0) grids_[i] = grid;
+            ptrs[i] = grids_[i].c_str();
+        }
+        distanceKm_.resize(numMessages_);
+        bearing_.resize(numMessages_);
+        if (wsjtx_grid_distance_bearing(extras_.homeGrid.c_str(), ptrs.data(), numMessages_,
+                distanceKm_.data(), bearing_.data()) < 0) {
+            distanceKm_.clear();
+            bearing_.clear();
+        }
+    }
+
+    Napi::Object DecodeJob::ToResult(Napi::Env env)
+    {
+        auto result = Napi::Object::New(env);
+        if (columns_) {
+            result.Set("columns", CreateColumnsObject(env, columns_, layout_));
+            columns_ = nullptr;
+        }
+        // In columnar mode the columns replace the per-message objects
+        int numObjects = extras_.columnar ? 0 : numMessages_;
+        auto msgs = Napi::Array::New(env, numObjects);
+        for (int i = 0; i < numObjects; i++) {
             auto o = Napi::Object::New(env);
             o.Set("text", Napi::String::New(env, messages_[i].msg));
             o.Set("snr", Napi::Number::New(env, messages_[i].snr));
@@ -418,12 +2189,119 @@ namespace wsjtx_nodejs
             o.Set("deltaFrequency", Napi::Number::New(env, messages_[i].freq));
             o.Set("timestamp", Napi::Number::New(env, messages_[i].hh * 3600 + messages_[i].min * 60 + messages_[i].sec));
             o.Set("sync", Napi::Number::New(env, messages_[i].sync));
+            SetDecodeInfo(env, o, messages_[i]);
+            if (!distanceKm_.empty() && !std::isnan(distanceKm_[i])) {
+                o.Set("grid", Napi::String::New(env, grids_[i]));
+                o.Set("distanceKm", Napi::Number::New(env, distanceKm_[i]));
+                o.Set("bearing", Napi::Number::New(env, bearing_[i]));
+            }
+            if (!history_.empty()) SetHistoryFields(env, o, history_[i]);
             msgs[i] = o;
         }
-        auto result = Napi::Object::New(env);
         result.Set("messages", msgs);
+        if (extras_.residual) {
+            Napi::Float32Array residual = Napi::Float32Array::New(env, residual_.size());
+            std::copy(residual_.begin(), residual_.end(), residual.Data());
+            result.Set("residual", residual);
+        }
+        if (qsoRan_) {
+            Napi::Object qso = CreateQsoStatusObject(env, qsoStatus_);
+            Napi::Float32Array audio = Napi::Float32Array::New(env, txAudio_.size());
+            std::copy(txAudio_.begin(), txAudio_.end(), audio.Data());
+            qso.Set("txAudio", audio);
+            result.Set("qso", qso);
+        }
         result.Set("success", Napi::Boolean::New(env, true));
-        Callback().Call({env.Null(), result});
+        return result;
+    }
+
+    // DecodeWorker (float)
+    DecodeWorker::DecodeWorker(Napi::Function &cb, wsjtx_handle_t h,
+                               int mode, std::vector<float> &&d,
+                               const wsjtx_decode_options_t& o,
+                               const DecodeExtras& x)
+        : AsyncWorkerBase(cb, h), job_(mode, o, x)
+    {
+        job_.SetAudio(std::move(d));
+    }
+
+    // DecodeWorker (int16)
+    DecodeWorker::DecodeWorker(Napi::Function &cb, wsjtx_handle_t h,
+                               int mode, std::vector<short int> &&d,
+                               const wsjtx_decode_options_t& o,
+                               const DecodeExtras& x)
+        : AsyncWorkerBase(cb, h), job_(mode, o, x)
+    {
+        job_.SetAudio(std::move(d));
+    }
+
+    void DecodeWorker::Execute()
+    {
+        auto scope = BeginExecute();
+        TraceScope span("execute_decode", traceJob_);
+        if (!job_.Run(handle_, traceJob_, receiver_)) SetError(job_.Error());
+        ChargeCpu(job_.CpuUs());
+    }
+
+    void DecodeWorker::OnOK()
+    {
+        TraceScope span("on_ok_decode", traceJob_);
+        Napi::Env env = Env();
+        Callback().Call({env.Null(), job_.ToResult(env)});
+    }
+
+    // DecodeChannelsWorker
+    void DecodeChannelsWorker::Execute()
+    {
+        auto scope = BeginExecute();
+        TraceScope span("execute_decode_channels", traceJob_);
+        const size_t stride = static_cast<size_t>(wsjtx_pcm_sample_bytes(format_)) * channels_;
+        // Channels on threads of their own count their CPU time themselves
+        auto run = [this, stride](int c, bool ownThread) {
+            const int64_t start = ownThread ? wsjtx_thread_cpu_us() : 0;
+            wsjtx_trace_set_job(traceJob_);
+            std::vector<float> samples;
+            {
+                TraceScope sub("deinterleave", traceJob_);
+                FillSlot(windows_[c], pcm_.size() / stride, samples, [&](size_t first, size_t n, float *dst) {
+                    wsjtx_pcm_to_float(pcm_.data() + first * stride, n * stride, format_, channels_, c,
+                        dst, static_cast<int>(n));
+                });
+            }
+            jobs_[c]->SetAudio(std::move(samples));
+            jobs_[c]->Run(handles_[c], traceJob_, receiver_);
+            ChargeCpu(jobs_[c]->CpuUs());
+            if (ownThread) ChargeCpu(wsjtx_thread_cpu_us() - start);
+        };
+        // One thread per channel besides this one; a channel whose thread
+        // cannot be started runs here afterwards
+        std::vector<std::thread> threads;
+        std::vector<int> deferred;
+        for (int c = 1; c < channels_; c++) {
+            try {
+                threads.emplace_back(run, c, true);
+            } catch (const std::system_error &) {
+                deferred.push_back(c);
+            }
+        }
+        run(0, false);
+        for (int c : deferred) run(c, false);
+        for (auto &t : threads) t.join();
+        for (int c = 0; c < channels_; c++) {
+            if (!jobs_[c]->Error().empty()) {
+                SetError("Channel " + std::to_string(c) + ": " + jobs_[c]->Error());
+                return;
+            }
+        }
+    }
+
+    void DecodeChannelsWorker::OnOK()
+    {
+        TraceScope span("on_ok_decode", traceJob_);
+        Napi::Env env = Env();
+        auto results = Napi::Array::New(env, jobs_.size());
+        for (size_t c = 0; c < jobs_.size(); c++) results[c] = jobs_[c]->ToResult(env);
+        Callback().Call({env.Null(), results});
     }
 
     // EncodeWorker
@@ -435,15 +2313,17 @@ namespace wsjtx_nodejs
 
     void EncodeWorker::Execute()
     {
-        // FT8 at 48kHz for 12.64s = ~607,000 samples; 1M buffer is plenty
-        static const int MAX_SAMPLES = 1024 * 1024;
-        audioData_.resize(MAX_SAMPLES);
+        auto scope = BeginExecute();
+        TraceScope span("execute_encode", traceJob_);
+        // Exactly one transmission: FT8 at 48kHz = 606,720 samples, WSPR ~1.33M
+        const int maxSamples = std::max(1, wsjtx_get_waveform_samples(mode_));
+        audioData_.resize(maxSamples);
         int numSamples = 0;
         char msgSent[256] = {0};
 
         int rc = wsjtx_encode(handle_, mode_, frequency_,
             message_.c_str(),
-            audioData_.data(), &numSamples, MAX_SAMPLES,
+            audioData_.data(), &numSamples, maxSamples,
             msgSent, sizeof(msgSent));
 
         if (rc != WSJTX_OK) {
@@ -457,6 +2337,7 @@ namespace wsjtx_nodejs
 
     void EncodeWorker::OnOK()
     {
+        TraceScope span("on_ok_encode", traceJob_);
         Napi::Env env = Env();
 
         Napi::Float32Array audioArray = Napi::Float32Array::New(env, audioData_.size());
@@ -472,11 +2353,15 @@ namespace wsjtx_nodejs
     // WSPRDecodeWorker
     WSPRDecodeWorker::WSPRDecodeWorker(Napi::Function &callback, wsjtx_handle_t handle,
                                        const std::vector<float> &iqInterleaved,
-                                       const wsjtx_decoder_options_t &options)
-        : AsyncWorkerBase(callback, handle), iqInterleaved_(iqInterleaved), options_(options) {}
+                                       const wsjtx_decoder_options_t &options,
+                                       wsjtx_udp_t udp, uint32_t udpTimeMs)
+        : AsyncWorkerBase(callback, handle), iqInterleaved_(iqInterleaved), options_(options),
+          udp_(udp), udpTimeMs_(udpTimeMs) {}
 
     void WSPRDecodeWorker::Execute()
     {
+        auto scope = BeginExecute();
+        TraceScope span("execute_wspr", traceJob_);
         static const int MAX_RESULTS = 256;
         results_.resize(MAX_RESULTS);
 
@@ -492,10 +2377,16 @@ namespace wsjtx_nodejs
         }
 
         results_.resize(count);
+        wsjtx_metrics_messages(receiver_.c_str(), WSJTX_MODE_WSPR, count);
+        if (udp_ && count > 0) {
+            wsjtx_udp_send_wspr_decodes(udp_, results_.data(), count, udpTimeMs_,
+                static_cast<uint64_t>(options_.freq));
+        }
     }
 
     void WSPRDecodeWorker::OnOK()
     {
+        TraceScope span("on_ok_wspr", traceJob_);
         Napi::Env env = Env();
         Napi::Array resultsArray = Napi::Array::New(env, results_.size());
 
@@ -525,6 +2416,7 @@ namespace wsjtx_nodejs
     // AudioConvertWorker
     void AudioConvertWorker::Execute()
     {
+        auto scope = BeginExecute();
         if (fromFloat_) {
             if (target_ == Target::Float32) {
                 floatOut_ = floatInput_;
@@ -563,10 +2455,103 @@ namespace wsjtx_nodejs
         }
     }
 
+    // AutotuneWorker
+    void AutotuneWorker::Execute()
+    {
+        auto scope = BeginExecute();
+        results_.resize(modes_.size());
+        int rc = wsjtx_autotune(modes_.data(), static_cast<int>(modes_.size()),
+            threadCounts_.data(), static_cast<int>(threadCounts_.size()),
+            concurrency_.data(), static_cast<int>(concurrency_.size()),
+            repeats_, results_.data());
+        if (rc != WSJTX_OK) SetError("Autotune failed with error code " + std::to_string(rc));
+    }
+
+    void AutotuneWorker::OnOK()
+    {
+        Napi::Env env = Env();
+        Napi::Array out = Napi::Array::New(env, results_.size());
+        for (size_t i = 0; i < results_.size(); i++) out[i] = CreateTuningObject(env, results_[i]);
+        Callback().Call({env.Null(), out});
+    }
+
+    // FindCandidatesWorker
+    void FindCandidatesWorker::Execute()
+    {
+        auto scope = BeginExecute();
+        candidates_.resize(maxCandidates_ > 0 ? maxCandidates_ : 1);
+        int n = wsjtx_find_candidates(mode_, samples_.data(), static_cast<int>(samples_.size()),
+            lowFreq_, highFreq_, minScore_, candidates_.data(), static_cast<int>(candidates_.size()));
+        if (n < 0) {
+            SetError("Candidate search failed with error code " + std::to_string(n));
+            return;
+        }
+        candidates_.resize(n);
+    }
+
+    void FindCandidatesWorker::OnOK()
+    {
+        Napi::Env env = Env();
+        Napi::Array out = Napi::Array::New(env, candidates_.size());
+        for (size_t i = 0; i < candidates_.size(); i++) out[i] = CreateCandidateObject(env, candidates_[i]);
+        Callback().Call({env.Null(), out});
+    }
+
+    // QsoWorker
+    void QsoWorker::Execute()
+    {
+        auto scope = BeginExecute();
+        if (speculate_) {
+            result_ = wsjtx_qso_speculate(qso_);
+            if (result_ < 0) SetError("QSO pre-encoding failed with error code " + std::to_string(result_));
+            return;
+        }
+        audio_.resize(static_cast<size_t>(QsoAudioSamples()));
+        int n = wsjtx_qso_tx_audio(qso_, audio_.data(), static_cast<int>(audio_.size()));
+        if (n < 0) {
+            SetError("QSO encode failed with error code " + std::to_string(n));
+            return;
+        }
+        audio_.resize(static_cast<size_t>(n));
+    }
+
+    void QsoWorker::OnOK()
+    {
+        Napi::Env env = Env();
+        if (speculate_) {
+            Callback().Call({env.Null(), Napi::Number::New(env, result_)});
+            return;
+        }
+        Napi::Float32Array out = Napi::Float32Array::New(env, audio_.size());
+        std::copy(audio_.begin(), audio_.end(), out.Data());
+        Callback().Call({env.Null(), out});
+    }
+
     // Module initialization
     Napi::Object Init(Napi::Env env, Napi::Object exports)
     {
-        return WSJTXLibWrapper::Init(env, exports);
+        WSJTXLibWrapper::Init(env, exports);
+        MessageHistoryWrapper::Init(env, exports);
+        ActivityAggregatorWrapper::Init(env, exports);
+        ClockEstimatorWrapper::Init(env, exports);
+        QsoSequencerWrapper::Init(env, exports);
+        UdpEmitterWrapper::Init(env, exports);
+        exports.Set("startTrace", Napi::Function::New(env, StartTrace, "startTrace"));
+        exports.Set("stopTrace", Napi::Function::New(env, StopTrace, "stopTrace"));
+        exports.Set("dumpTrace", Napi::Function::New(env, DumpTrace, "dumpTrace"));
+        exports.Set("getMetrics", Napi::Function::New(env, GetMetrics, "getMetrics"));
+        exports.Set("latencyQuantile", Napi::Function::New(env, LatencyQuantile, "latencyQuantile"));
+        exports.Set("resetMetrics", Napi::Function::New(env, ResetMetrics, "resetMetrics"));
+        exports.Set("autotune", Napi::Function::New(env, Autotune, "autotune"));
+        exports.Set("getTuning", Napi::Function::New(env, GetTuning, "getTuning"));
+        exports.Set("setTuning", Napi::Function::New(env, SetTuning, "setTuning"));
+        exports.Set("setDecodeTimeLimit", Napi::Function::New(env, SetDecodeTimeLimit, "setDecodeTimeLimit"));
+        exports.Set("getDecodeTimeLimit", Napi::Function::New(env, GetDecodeTimeLimit, "getDecodeTimeLimit"));
+        exports.Set("watchdogStats", Napi::Function::New(env, WatchdogStats, "watchdogStats"));
+        exports.Set("setQuota", Napi::Function::New(env, SetQuota, "setQuota"));
+        exports.Set("getAccounting", Napi::Function::New(env, GetAccounting, "getAccounting"));
+        exports.Set("buildFeatures", Napi::Function::New(env, BuildFeatures, "buildFeatures"));
+        return exports;
     }
 
     NODE_API_MODULE(wsjtx_lib, Init)
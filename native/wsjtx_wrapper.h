@@ -1,12 +1,32 @@
 #pragma once
 
 #include <napi.h>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
 #include <vector>
 #include <string>
 #include "wsjtx_c_api.h"
 
 namespace wsjtx_nodejs {
 
+class AsyncWorkerBase;
+
+/**
+ * Queues one instance's decodes one at a time, on the JS thread. A decode
+ * called while another is in flight has its input copied at once and waits
+ * here, not on a libuv thread, until that one's worker is gone.
+ */
+class DecodeSerializer {
+public:
+    void Submit(AsyncWorkerBase* worker);
+    void Done();   // the running decode's worker is being destroyed
+private:
+    bool busy_ = false;
+    std::deque<AsyncWorkerBase*> waiting_;
+};
+
 /**
  * Native WSJTX library wrapper class.
  * Uses the pure C API (wsjtx_c_api.h) for all interactions with the core library.
@@ -26,7 +46,12 @@ private:
     Napi::Value IsDecodingSupported(const Napi::CallbackInfo& info);
     Napi::Value GetSampleRate(const Napi::CallbackInfo& info);
     Napi::Value GetTransmissionDuration(const Napi::CallbackInfo& info);
+    Napi::Value GetSlotPeriod(const Napi::CallbackInfo& info);
     Napi::Value ConvertAudioFormat(const Napi::CallbackInfo& info);
+    Napi::Value GridDistances(const Napi::CallbackInfo& info);
+    Napi::Value ToColumnar(const Napi::CallbackInfo& info);
+    Napi::Value FindCandidates(const Napi::CallbackInfo& info);
+    Napi::Value DecodeChannels(const Napi::CallbackInfo& info);
 
     Napi::Object CreateMessageObject(Napi::Env env, const wsjtx_message_t& msg);
 
@@ -39,6 +64,162 @@ private:
     std::vector<short int> ConvertToIntArray(Napi::Env env, const Napi::Value& audioData);
 
     wsjtx_handle_t handle_;
+    std::vector<wsjtx_handle_t> channelHandles_;  // decoders for decodeChannels channels 1.., created on demand
+    std::string receiver_;   // metrics label given at construction
+    // decode and decodeChannels share handle_ (and channelHandles_), so they run one at a time
+    std::shared_ptr<DecodeSerializer> decodes_ = std::make_shared<DecodeSerializer>();
+};
+
+/**
+ * Cross-slot message history (bounded LRU), exported as MessageHistory.
+ * Can be passed to decode() so repeats are marked on the worker thread.
+ */
+class MessageHistoryWrapper : public Napi::ObjectWrap<MessageHistoryWrapper> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    static Napi::FunctionReference constructor;  // set in Init; checked before Unwrap
+    MessageHistoryWrapper(const Napi::CallbackInfo& info);
+    ~MessageHistoryWrapper();
+
+    wsjtx_history_t Handle() const { return history_; }
+
+private:
+    Napi::Value Observe(const Napi::CallbackInfo& info);
+    Napi::Value Size(const Napi::CallbackInfo& info);
+    Napi::Value Clear(const Napi::CallbackInfo& info);
+
+    wsjtx_history_t history_ = nullptr;
+};
+
+/**
+ * Rolling band-activity statistics, exported as ActivityAggregator.
+ * Can be passed to decode() so results are folded in on the worker thread.
+ */
+class ActivityAggregatorWrapper : public Napi::ObjectWrap<ActivityAggregatorWrapper> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    static Napi::FunctionReference constructor;  // set in Init; checked before Unwrap
+    ActivityAggregatorWrapper(const Napi::CallbackInfo& info);
+    ~ActivityAggregatorWrapper();
+
+    wsjtx_activity_t Handle() const { return activity_; }
+
+private:
+    Napi::Value Add(const Napi::CallbackInfo& info);
+    Napi::Value Query(const Napi::CallbackInfo& info);
+
+    wsjtx_activity_t activity_ = nullptr;
+    int buckets_ = 0;
+};
+
+/**
+ * Sound-card sample-rate error estimator, exported as ClockEstimator.
+ * Can be passed to decode() to correct the input by its estimate and feed
+ * it the results on the worker thread.
+ */
+class ClockEstimatorWrapper : public Napi::ObjectWrap<ClockEstimatorWrapper> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    static Napi::FunctionReference constructor;  // set in Init; checked before Unwrap
+    ClockEstimatorWrapper(const Napi::CallbackInfo& info);
+    ~ClockEstimatorWrapper();
+
+    wsjtx_clock_t Handle() const { return clock_; }
+
+private:
+    Napi::Value Observe(const Napi::CallbackInfo& info);
+    Napi::Value Estimate(const Napi::CallbackInfo& info);
+    Napi::Value Clear(const Napi::CallbackInfo& info);
+
+    wsjtx_clock_t clock_ = nullptr;
+};
+
+/**
+ * FT8/FT4 QSO sequencer, exported as QsoSequencer. Can be passed to
+ * decode() to advance on the results and return the next transmission's
+ * audio from the worker thread.
+ */
+class QsoSequencerWrapper : public Napi::ObjectWrap<QsoSequencerWrapper> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    static Napi::FunctionReference constructor;  // set in Init; checked before Unwrap
+    QsoSequencerWrapper(const Napi::CallbackInfo& info);
+    ~QsoSequencerWrapper();
+
+    wsjtx_qso_t Handle() const { return qso_; }
+
+private:
+    Napi::Value StartCq(const Napi::CallbackInfo& info);
+    Napi::Value Call(const Napi::CallbackInfo& info);
+    Napi::Value Stop(const Napi::CallbackInfo& info);
+    Napi::Value Observe(const Napi::CallbackInfo& info);
+    Napi::Value Status(const Napi::CallbackInfo& info);
+    Napi::Value TxAudio(const Napi::CallbackInfo& info);
+    Napi::Value Speculate(const Napi::CallbackInfo& info);
+
+    wsjtx_qso_t qso_ = nullptr;
+};
+
+/**
+ * WSJT-X UDP protocol emitter bound to one destination, exported as UdpEmitter.
+ * Can be passed to decode()/decodeWSPR() so results are sent from the worker thread.
+ */
+class UdpEmitterWrapper : public Napi::ObjectWrap<UdpEmitterWrapper> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    static Napi::FunctionReference constructor;  // set in Init; checked before Unwrap
+    UdpEmitterWrapper(const Napi::CallbackInfo& info);
+    ~UdpEmitterWrapper();
+
+    wsjtx_udp_t Handle() const { return udp_; }
+
+private:
+    Napi::Value SendHeartbeat(const Napi::CallbackInfo& info);
+    Napi::Value SendStatus(const Napi::CallbackInfo& info);
+    Napi::Value SendDecodes(const Napi::CallbackInfo& info);
+    Napi::Value SendWSPR(const Napi::CallbackInfo& info);
+
+    wsjtx_udp_t udp_ = nullptr;
+};
+
+/**
+ * Wrapper-side decode options. These post-process results on the worker
+ * thread and are not part of the C ABI decode options.
+ */
+struct DecodeExtras {
+    std::string homeGrid;   // non-empty: attach grid/distanceKm/bearing to messages
+    wsjtx_history_t history = nullptr;  // non-null: mark new/repeat per message
+    int64_t slot = 0;                   // slot index passed to the history
+    wsjtx_activity_t activity = nullptr; // non-null: fold results into the aggregator
+    std::string band;                   // series key for the aggregator
+    int64_t activityTime = 0;           // unix seconds the results are attributed to
+    wsjtx_udp_t udp = nullptr;          // non-null: emit a Decode datagram per message
+    bool columnar = false;              // return Arrow-layout columns instead of message objects
+    std::vector<wsjtx_ap_target_t> apTargets;  // non-empty: one merged decode with AP per target
+    bool residual = false;              // return the audio with decoded signals subtracted
+    bool usePartition = false;          // decode only the band `partition` spans
+    std::vector<wsjtx_candidate_t> partition;
+    std::vector<std::vector<float>> diversity;  // other receivers' audio, combined with this one first
+    wsjtx_clock_t clock = nullptr;      // non-null: correct by its estimate, then observe the results
+    double clockTime = 0;               // slot start in seconds, for the clock
+    bool correctRate = false;           // resample by ratePpm (overrides the clock's estimate)
+    double ratePpm = 0;
+    wsjtx_qso_t qso = nullptr;          // non-null: advance on the results, then render its next message
+    bool lowPriority = false;           // over the receiver's quota: lower the decoder thread's priority
+};
+
+/**
+ * The frames of an input that make up the slot: [offset, offset + length),
+ * and with `fit`, placed `lead` samples into a zeroed slot of `slotLength`
+ * samples (a negative lead drops the first -lead frames; anything past the
+ * slot end is dropped too). Applied while copying out of the JS buffer.
+ */
+struct SlotWindow {
+    size_t offset = 0;
+    size_t length = SIZE_MAX;
+    bool fit = false;
+    int64_t lead = 0;
+    size_t slotLength = 0;
 };
 
 /**
@@ -47,10 +228,92 @@ private:
 class AsyncWorkerBase : public Napi::AsyncWorker {
 public:
     AsyncWorkerBase(Napi::Function& callback, wsjtx_handle_t handle);
-    virtual ~AsyncWorkerBase() = default;
+    virtual ~AsyncWorkerBase();
+    // Keep a JS object (e.g. the MessageHistory backing a handle) alive until the worker completes
+    void Retain(Napi::Object obj) { retained_.push_back(Napi::Persistent(obj)); }
+    // Trace job id tagging this worker's spans (-1 when tracing was off at creation)
+    int64_t TraceJob() const { return traceJob_; }
+    // Attribute this job to a metrics series; call before Queue()
+    void Track(int op, int mode, const std::string& receiver);
+    // Queue() once the jobs queued on `serial` before this one are done
+    void QueueAfter(const std::shared_ptr<DecodeSerializer>& serial);
 
 protected:
+    // Charges the CPU time of the thread running Execute() while it lives
+    class ExecuteScope {
+    public:
+        explicit ExecuteScope(AsyncWorkerBase* worker) : worker_(worker), start_(wsjtx_thread_cpu_us()) {}
+        ~ExecuteScope() { worker_->ChargeCpu(wsjtx_thread_cpu_us() - start_); }
+        ExecuteScope(const ExecuteScope&) = delete;
+        ExecuteScope& operator=(const ExecuteScope&) = delete;
+    private:
+        AsyncWorkerBase* worker_;
+        int64_t start_;
+    };
+
+    // Call first in Execute() and keep the scope to its end: records the
+    // queue wait, tags the worker thread with the trace job, moves the job
+    // from queued to running and measures its CPU time
+    [[nodiscard]] ExecuteScope BeginExecute();
+    // Add CPU time spent on this job by a thread other than Execute()'s
+    void ChargeCpu(int64_t us) { if (us > 0) cpuUs_ += us; }
+    void OnError(const Napi::Error& e) override;
+
     wsjtx_handle_t handle_;
+    int64_t traceJob_ = -1;
+    int64_t traceCreated_ = 0;
+    std::string receiver_;
+
+private:
+    std::vector<Napi::ObjectReference> retained_;
+    int op_ = -1;            // WSJTX_OP_*, -1 if untracked
+    int opMode_ = -1;
+    int64_t created_ = 0;    // wsjtx_trace_now_us() at Track()
+    int64_t started_ = 0;    // wsjtx_trace_now_us() at BeginExecute(), 0 if never run
+    std::atomic<int64_t> cpuUs_{0};
+    bool failed_ = false;
+    std::shared_ptr<DecodeSerializer> serial_;   // told when this job is gone, if queued through one
+};
+
+/**
+ * One decode of one channel with its wrapper-side post-processing, apart
+ * from how it is scheduled: DecodeWorker runs one, DecodeChannelsWorker
+ * one per channel on its own thread and decoder handle.
+ */
+class DecodeJob {
+public:
+    DecodeJob(int mode, const wsjtx_decode_options_t& o, const DecodeExtras& x)
+        : mode_(mode), options_(o), extras_(x) {}
+    ~DecodeJob();
+    DecodeJob(const DecodeJob&) = delete;
+    DecodeJob& operator=(const DecodeJob&) = delete;
+
+    void SetAudio(std::vector<float>&& d) { floatData_ = std::move(d); intData_.clear(); useFloat_ = true; }
+    void SetAudio(std::vector<short int>&& d) { intData_ = std::move(d); floatData_.clear(); useFloat_ = false; }
+    void SetLowPriority(bool low) { extras_.lowPriority = low; }
+    // Worker thread: decode and post-process; false with Error() set on failure
+    bool Run(wsjtx_handle_t handle, int64_t traceJob, const std::string& receiver);
+    // JS thread: the DecodeResult object (takes ownership of the columns)
+    Napi::Object ToResult(Napi::Env env);
+    const std::string& Error() const { return error_; }
+    // CPU time the decoder spent on a watchdog thread; the calling thread's is the caller's to count
+    int64_t CpuUs() const { return cpuUs_; }
+
+private:
+    static constexpr int MAX_MSGS = 200;
+    bool Fail(const std::string& error);
+    void ComputeGeo();
+    void PromoteToFloat();
+    int mode_; std::vector<float> floatData_; std::vector<short int> intData_; bool useFloat_ = true;
+    wsjtx_decode_options_t options_; std::vector<wsjtx_message_t> messages_; int numMessages_ = 0;
+    DecodeExtras extras_;
+    std::vector<std::string> grids_; std::vector<double> distanceKm_, bearing_;
+    std::vector<wsjtx_history_entry_t> history_;
+    uint8_t* columns_ = nullptr; wsjtx_columnar_layout_t layout_ = {};
+    std::vector<float> residual_;
+    bool qsoRan_ = false; wsjtx_qso_status_t qsoStatus_ = {}; std::vector<float> txAudio_;
+    int64_t cpuUs_ = 0;
+    std::string error_;
 };
 
 /**
@@ -58,14 +321,39 @@ protected:
  */
 class DecodeWorker : public AsyncWorkerBase {
 public:
-    DecodeWorker(Napi::Function& cb, wsjtx_handle_t h, int mode, const std::vector<float>& d, const wsjtx_decode_options_t& o);
-    DecodeWorker(Napi::Function& cb, wsjtx_handle_t h, int mode, const std::vector<short int>& d, const wsjtx_decode_options_t& o);
+    DecodeWorker(Napi::Function& cb, wsjtx_handle_t h, int mode, std::vector<float>&& d, const wsjtx_decode_options_t& o, const DecodeExtras& x);
+    DecodeWorker(Napi::Function& cb, wsjtx_handle_t h, int mode, std::vector<short int>&& d, const wsjtx_decode_options_t& o, const DecodeExtras& x);
 protected:
     void Execute() override; void OnOK() override;
 private:
-    static constexpr int MAX_MSGS = 200;
-    int mode_; std::vector<float> floatData_; std::vector<short int> intData_; bool useFloat_;
-    wsjtx_decode_options_t options_; std::vector<wsjtx_message_t> messages_; int numMessages_ = 0;
+    DecodeJob job_;
+};
+
+/**
+ * Async worker decoding every channel of one interleaved PCM buffer in
+ * parallel, one decoder handle per channel
+ */
+class DecodeChannelsWorker : public AsyncWorkerBase {
+public:
+    DecodeChannelsWorker(Napi::Function& cb, const std::vector<wsjtx_handle_t>& handles, int mode,
+                         std::vector<uint8_t>&& pcm, int format, int channels,
+                         std::vector<std::unique_ptr<DecodeJob>>&& jobs, const std::vector<SlotWindow>& windows)
+        : AsyncWorkerBase(cb, handles.front()), handles_(handles), mode_(mode), pcm_(std::move(pcm)),
+          format_(format), channels_(channels), jobs_(std::move(jobs)), windows_(windows) {
+        for (size_t c = 1; c < handles_.size(); c++) wsjtx_watchdog_hold(handles_[c]);
+    }
+    ~DecodeChannelsWorker() {
+        for (size_t c = 1; c < handles_.size(); c++) wsjtx_watchdog_release(handles_[c]);
+    }
+protected:
+    void Execute() override; void OnOK() override;
+private:
+    std::vector<wsjtx_handle_t> handles_;
+    int mode_;
+    std::vector<uint8_t> pcm_;   // the interleaved bytes, copied once
+    int format_, channels_;
+    std::vector<std::unique_ptr<DecodeJob>> jobs_;
+    std::vector<SlotWindow> windows_;   // per channel
 };
 
 /**
@@ -97,7 +385,8 @@ class WSPRDecodeWorker : public AsyncWorkerBase {
 public:
     WSPRDecodeWorker(Napi::Function& callback, wsjtx_handle_t handle,
                      const std::vector<float>& iqInterleaved,
-                     const wsjtx_decoder_options_t& options);
+                     const wsjtx_decoder_options_t& options,
+                     wsjtx_udp_t udp = nullptr, uint32_t udpTimeMs = 0);
 
 protected:
     void Execute() override;
@@ -106,23 +395,25 @@ protected:
 private:
     std::vector<float> iqInterleaved_;
     wsjtx_decoder_options_t options_;
+    wsjtx_udp_t udp_;
+    uint32_t udpTimeMs_;
     std::vector<wsjtx_decoder_result_t> results_;
 };
 
 /**
  * Async worker for audio format conversion (no library handle needed)
  */
-class AudioConvertWorker : public Napi::AsyncWorker {
+class AudioConvertWorker : public AsyncWorkerBase {
 public:
     enum class Target { Float32, Int16 };
 
     AudioConvertWorker(Napi::Function& callback,
                        const std::vector<float>& input, Target target)
-        : Napi::AsyncWorker(callback), floatInput_(input), target_(target), fromFloat_(true) {}
+        : AsyncWorkerBase(callback, nullptr), floatInput_(input), target_(target), fromFloat_(true) {}
 
     AudioConvertWorker(Napi::Function& callback,
                        const std::vector<short int>& input, Target target)
-        : Napi::AsyncWorker(callback), intInput_(input), target_(target), fromFloat_(false) {}
+        : AsyncWorkerBase(callback, nullptr), intInput_(input), target_(target), fromFloat_(false) {}
 
 protected:
     void Execute() override;
@@ -137,4 +428,69 @@ private:
     bool fromFloat_;
 };
 
+/**
+ * Async worker for the thread-scaling autotune (no library handle needed)
+ */
+class AutotuneWorker : public AsyncWorkerBase {
+public:
+    AutotuneWorker(Napi::Function& callback, const std::vector<int>& modes,
+                   const std::vector<int>& threadCounts, const std::vector<int>& concurrency, int repeats)
+        : AsyncWorkerBase(callback, nullptr), modes_(modes), threadCounts_(threadCounts),
+          concurrency_(concurrency), repeats_(repeats) {}
+
+protected:
+    void Execute() override;
+    void OnOK() override;
+
+private:
+    std::vector<int> modes_;
+    std::vector<int> threadCounts_;
+    std::vector<int> concurrency_;
+    int repeats_;
+    std::vector<wsjtx_tuning_t> results_;
+};
+
+/**
+ * Async worker for a QSO sequencer's TX audio or pre-encoding (no library
+ * handle needed; the sequencer encodes statelessly)
+ */
+class QsoWorker : public AsyncWorkerBase {
+public:
+    QsoWorker(Napi::Function& callback, wsjtx_qso_t qso, bool speculate)
+        : AsyncWorkerBase(callback, nullptr), qso_(qso), speculate_(speculate) {}
+
+protected:
+    void Execute() override;
+    void OnOK() override;
+
+private:
+    wsjtx_qso_t qso_;
+    bool speculate_;
+    int result_ = 0;
+    std::vector<float> audio_;
+};
+
+/**
+ * Async worker for the FT8/FT4 sync candidate search (pipelined decode stage 1)
+ */
+class FindCandidatesWorker : public AsyncWorkerBase {
+public:
+    FindCandidatesWorker(Napi::Function& callback, int mode, std::vector<float>&& samples,
+                         int lowFreq, int highFreq, float minScore, int maxCandidates)
+        : AsyncWorkerBase(callback, nullptr), mode_(mode), samples_(std::move(samples)),
+          lowFreq_(lowFreq), highFreq_(highFreq), minScore_(minScore), maxCandidates_(maxCandidates) {}
+
+protected:
+    void Execute() override;
+    void OnOK() override;
+
+private:
+    int mode_;
+    std::vector<float> samples_;
+    int lowFreq_, highFreq_;
+    float minScore_;
+    int maxCandidates_;
+    std::vector<wsjtx_candidate_t> candidates_;
+};
+
 } // namespace wsjtx_nodejs
@@ -4,8 +4,23 @@
  * Public surface:
  *   - WSJTXLib.encode(mode, message, frequency)
  *   - WSJTXLib.decode(mode, audio, options)
+ *   - WSJTXLib.decodeChannels(mode, interleaved, channels, options[])
  *   - WSJTXLib.decodeWSPR(audio, options)
  *   - WSJTXLib.convertAudioFormat(audio, target)
+ *   - WSJTXLib.gridDistances(homeGrid, grids)
+ *   - WSJTXLib.toColumnar(messages) (Arrow-layout export)
+ *   - WSJTXLib.findCandidates / partitionCandidates (pipelined FT8/FT4 decode)
+ *   - MessageHistory (cross-slot repeat suppression)
+ *   - ActivityAggregator (rolling band statistics)
+ *   - ClockEstimator (sound-card sample-rate error, corrected in decode)
+ *   - QsoSequencer (FT8/FT4 auto-sequencing with pre-encoded TX audio)
+ *   - UdpEmitter (WSJT-X UDP protocol output)
+ *   - startTrace / stopTrace / dumpTrace (Chrome trace-event spans)
+ *   - getMetrics / resetMetrics (Prometheus latency histograms and counters)
+ *   - autotune / loadTuning / getTuning (per-host decode thread defaults)
+ *   - setDecodeTimeLimit / watchdogStats (hung-decode watchdog)
+ *   - setQuota / getAccounting (per-receiver CPU accounting and quotas)
+ *   - buildFeatures (OpenMP / USDT build options)
  *   - capability/sample-rate query helpers
  */
 
@@ -17,20 +32,79 @@ import {
   type WSPRDecodeOptions,
   type WSJTXMessage,
   type AudioData,
+  type AudioInput,
+  type PcmAudio,
+  type PcmFormat,
   WSJTXError,
   type WSJTXConfig,
   type ModeCapabilities,
   type DecodeOptions,
+  type APTarget,
+  type DecodeColumns,
+  type Candidate,
+  type FindCandidatesOptions,
+  type GridDistances,
+  type HistoryInfo,
+  type MessageHistoryOptions,
+  type ActivityAggregatorOptions,
+  type ClockEstimatorOptions,
+  type ClockEstimate,
+  type QsoSequencerOptions,
+  type QsoState,
+  type QsoStatus,
+  type QsoDecodeStatus,
+  type ActivityQuery,
+  type ActivityReport,
+  type ActivityStats,
+  type MetricsOperation,
+  type TuningResult,
+  type AutotuneOptions,
+  type BuildFeatures,
+  type WatchdogStats,
+  type ReceiverQuota,
+  type ReceiverAccounting,
+  type UdpEmitterOptions,
+  type UdpStatus,
+  ACTIVITY_BINS,
 } from './types.js';
 import { createRequire } from 'node:module';
 import { fileURLToPath } from 'node:url';
+import fs from 'node:fs';
+import os from 'node:os';
 import path from 'node:path';
 
 const require = createRequire(import.meta.url);
 const __dirname = path.dirname(fileURLToPath(import.meta.url));
 
 interface NativeBinding {
-  WSJTXLib: new () => NativeWSJTXLib;
+  WSJTXLib: new (receiver: string) => NativeWSJTXLib;
+  MessageHistory: new (capacity: number, frequencyTolerance: number) => NativeMessageHistory;
+  ActivityAggregator: new (bucketSeconds: number, buckets: number) => NativeActivityAggregator;
+  ClockEstimator: new (windowSeconds: number) => NativeClockEstimator;
+  QsoSequencer: new (mode: number, myCall: string, myGrid: string, txFrequency: number,
+    maxRepeats: number) => NativeQsoSequencer;
+  UdpEmitter: new (host: string, port: number, id: string, multicastTtl: number) => NativeUdpEmitter;
+  startTrace(capacity: number): void;
+  stopTrace(): void;
+  dumpTrace(): string;
+  getMetrics(): string;
+  latencyQuantile(receiver: string, op: number, mode: number, q: number, queue: boolean): number;
+  resetMetrics(): void;
+  autotune(modes: number[], threadCounts: number[], concurrency: number[], repeats: number,
+    cb: (e: Error | null, r: TuningResult[]) => void): void;
+  getTuning(mode: number): TuningResult | null;
+  setTuning(tuning: TuningResult): void;
+  setDecodeTimeLimit(mode: number, seconds: number): void;
+  getDecodeTimeLimit(mode: number): number;
+  watchdogStats(): WatchdogStats;
+  setQuota(receiver: string, cpuShare: number, action: number): void;
+  getAccounting(receiver: string): NativeAccounting | undefined;
+  buildFeatures(): BuildFeatures;
+}
+
+interface NativeAccounting extends Omit<ReceiverAccounting, 'quota'> {
+  quotaShare: number;
+  quotaAction: number;
 }
 
 interface NativeDecodeOptions {
@@ -41,10 +115,29 @@ interface NativeDecodeOptions {
   tolerance: number;
   dxCall: string;
   dxGrid: string;
+  homeGrid?: string;
+  history?: NativeMessageHistory;
+  slot?: number;
+  activity?: NativeActivityAggregator;
+  band?: string;
+  activityTime?: number;
+  udp?: NativeUdpEmitter;
+  columnar?: boolean;
+  apTargets?: APTarget[];
+  residual?: boolean;
+  partition?: Candidate[];
+  diversity?: AudioInput[];
+  clock?: NativeClockEstimator;
+  clockTime?: number;
+  sampleRatePpm?: number;
+  qso?: NativeQsoSequencer;
+  offset?: number;
+  length?: number;
+  slotStartOffset?: number;
 }
 
 interface NativeWSJTXLib {
-  decode(mode: number, audio: AudioData, opts: NativeDecodeOptions, cb: (e: Error | null, r: DecodeResult) => void): void;
+  decode(mode: number, audio: AudioInput, opts: NativeDecodeOptions, cb: (e: Error | null, r: DecodeResult) => void): void;
   encode(mode: number, message: string, frequency: number, threads: number, cb: (e: Error | null, r: EncodeResult) => void): void;
   decodeWSPR(audio: Float32Array, opts: Record<string, unknown>, cb: (e: Error | null, r: WSPRResult[]) => void): void;
   pullMessages(): WSJTXMessage[];
@@ -52,15 +145,59 @@ interface NativeWSJTXLib {
   isDecodingSupported(mode: number): boolean;
   getSampleRate(mode: number): number;
   getTransmissionDuration(mode: number): number;
-  convertAudioFormat(audio: AudioData, target: 'float32' | 'int16', cb: (e: Error | null, r: AudioData) => void): void;
+  getSlotPeriod(mode: number): number;
+  convertAudioFormat(audio: AudioInput, target: 'float32' | 'int16', cb: (e: Error | null, r: AudioData) => void): void;
+  gridDistances(homeGrid: string, grids: string[]): GridDistances;
+  toColumnar(messages: WSJTXMessage[]): DecodeColumns;
+  findCandidates(mode: number, audio: AudioInput, opts: FindCandidatesOptions,
+    cb: (e: Error | null, r: Candidate[]) => void): void;
+  decodeChannels(mode: number, audio: PcmAudio, opts: NativeDecodeOptions[],
+    cb: (e: Error | null, r: DecodeResult[]) => void): void;
+}
+
+interface NativeMessageHistory {
+  observe(messages: WSJTXMessage[], slot: number): HistoryInfo[];
+  size(): number;
+  clear(): void;
+}
+
+interface NativeActivityAggregator {
+  add(band: string, mode: number, timeSeconds: number, messages: WSJTXMessage[]): void;
+  query(band: string, mode: number, fromSeconds: number, toSeconds: number, withBuckets: boolean): ActivityReport;
+}
+
+interface NativeClockEstimator {
+  observe(messages: WSJTXMessage[], slotTime: number): void;
+  estimate(): ClockEstimate | null;
+  clear(): void;
+}
+
+/** Status as returned natively: `state` is a wsjtx_qso_state_t. */
+type NativeQsoStatus = Omit<QsoStatus, 'state' | 'speculateError'> & { state: number };
+
+interface NativeQsoSequencer {
+  startCq(): void;
+  call(dxCall: string, dxGrid: string, snr: number): void;
+  stop(): void;
+  observe(messages: WSJTXMessage[]): boolean;
+  status(): NativeQsoStatus;
+  txAudio(cb: (e: Error | null, r: Float32Array) => void): void;
+  speculate(cb: (e: Error | null, r: number) => void): void;
 }
 
-function loadNativeBinding(): NativeBinding['WSJTXLib'] {
-  const binding = require('node-gyp-build')(path.resolve(__dirname, '..', '..')) as NativeBinding;
-  return binding.WSJTXLib;
+interface NativeUdpEmitter {
+  sendHeartbeat(version: string, revision: string): number;
+  sendStatus(status: UdpStatus): number;
+  sendDecodes(mode: number, messages: WSJTXMessage[]): number;
+  sendWSPR(results: WSPRResult[], timeMs: number, dialFrequency: number): number;
 }
 
-const NativeWSJTXLib = loadNativeBinding();
+function loadNativeBinding(): NativeBinding {
+  return require('node-gyp-build')(path.resolve(__dirname, '..', '..')) as NativeBinding;
+}
+
+const binding = loadNativeBinding();
+const NativeWSJTXLib = binding.WSJTXLib;
 
 const DEFAULT_CONFIG: Required<WSJTXConfig> = {
   maxThreads: 4,
@@ -68,24 +205,68 @@ const DEFAULT_CONFIG: Required<WSJTXConfig> = {
   defaultLowFreq: 200,
   defaultHighFreq: 4000,
   defaultTolerance: 20,
+  receiver: '',
 };
 
+/** Native operation ids (wsjtx_op_t). */
+const METRICS_OPS: Record<MetricsOperation, number> = { decode: 0, encode: 1, wspr: 2, convert: 3 };
+
 const FREQ_MIN = 0;
 const FREQ_MAX = 30_000_000;
 const THREADS_MIN = 1;
 const THREADS_MAX = 16;
 const MESSAGE_MAX_LEN = 37;
+/** Same check as the native is_grid_token: any 4- or 6-character locator, "RR73" included */
+const GRID_RE = /^[A-R]{2}[0-9]{2}([A-X]{2})?$/i;
+const MAX_AP_TARGETS = 16;
+const MAX_DIVERSITY = 8;
+const MAX_DECODE_CHANNELS = 16;
+
+/** wsjtx_qso_state_t order. */
+const QSO_STATES: readonly QsoState[] = ['idle', 'cq', 'calling', 'report', 'rogerReport', 'roger', 'signoff', 'done'];
+const CALL_RE = /^[A-Z0-9/]{3,11}$/i;
+
+const PCM_FORMATS = ['u8', 's16', 's24', 's32', 'f32', 'f64'] as const;
+const PCM_SAMPLE_BYTES: Record<PcmFormat, number> = { u8: 1, s16: 2, s24: 3, s32: 4, f32: 4, f64: 8 };
+
+/**
+ * Name the sequencer state of a decode result and start pre-encoding the
+ * messages that may follow while this one is on the air. Nobody awaits that
+ * encode: a failure shows in the next status as `speculateError`.
+ */
+function finishQso(result: DecodeResult, qso: QsoSequencer | undefined): DecodeResult {
+  if (qso === undefined || result.qso === undefined) return result;
+  result.qso.state = QSO_STATES[result.qso.state as unknown as number];
+  result.qso.speculateError = qso.speculateError;
+  qso.speculate().catch(() => {});   // recorded as speculateError by speculate() itself
+  return result;
+}
+
+/** A native call that refused its job up front, e.g. with code 'QUOTA_EXCEEDED'. */
+function nativeError(e: unknown, code: string): WSJTXError {
+  const err = e as Error & { code?: string };
+  return new WSJTXError(err.message, err.code ?? code);
+}
+
+/** Samples per channel in `audio`. */
+function audioFrames(audio: AudioInput): number {
+  if (audio instanceof Float32Array || audio instanceof Int16Array) return audio.length;
+  return Math.floor(audio.data.byteLength / (PCM_SAMPLE_BYTES[audio.format] * (audio.channels ?? 1)));
+}
 
 export class WSJTXLib {
   private readonly native: NativeWSJTXLib;
   private readonly config: Required<WSJTXConfig>;
+  /** maxThreads given explicitly; autotuned defaults do not apply */
+  private readonly threadsPinned: boolean;
 
   constructor(config: WSJTXConfig = {}) {
     this.config = { ...DEFAULT_CONFIG, ...config };
-    this.native = new NativeWSJTXLib();
+    this.threadsPinned = config.maxThreads !== undefined;
+    this.native = new NativeWSJTXLib(this.config.receiver);
   }
 
-  async decode(mode: WSJTXMode, audioData: AudioData, options: DecodeOptions): Promise<DecodeResult> {
+  async decode(mode: WSJTXMode, audioData: AudioInput, options: DecodeOptions): Promise<DecodeResult> {
     this.validateMode(mode);
     this.validateAudio(audioData);
     this.validateFrequency(options.frequency);
@@ -93,21 +274,33 @@ export class WSJTXLib {
       throw new WSJTXError('Decoding not supported for this mode', 'UNSUPPORTED');
     }
 
-    const opts: NativeDecodeOptions = {
-      frequency: options.frequency,
-      threads: options.threads ?? this.config.maxThreads,
-      lowFreq: options.lowFreq ?? this.config.defaultLowFreq,
-      highFreq: options.highFreq ?? this.config.defaultHighFreq,
-      tolerance: options.tolerance ?? this.config.defaultTolerance,
-      dxCall: options.dxCall ?? '',
-      dxGrid: options.dxGrid ?? '',
-    };
+    const opts = this.nativeDecodeOptions(mode, options);
+    this.applySlotWindow(mode, options, audioFrames(audioData), opts);
+    if (options.diversity !== undefined) {
+      if (!Array.isArray(options.diversity) || options.diversity.length > MAX_DIVERSITY - 1) {
+        throw new WSJTXError(`diversity must be an array of at most ${MAX_DIVERSITY - 1} channels`, 'INVALID');
+      }
+      for (const channel of options.diversity) {
+        this.validateAudio(channel);
+        if (audioFrames(channel) !== audioFrames(audioData)) {
+          throw new WSJTXError('diversity channels must match the audio length', 'INVALID');
+        }
+      }
+      if (mode === WSJTXMode.WSPR) {
+        throw new WSJTXError('diversity is not available for WSPR', 'UNSUPPORTED');
+      }
+      if (options.diversity.length > 0) opts.diversity = options.diversity;
+    }
 
     return new Promise((resolve, reject) => {
-      this.native.decode(mode, audioData, opts, (err, result) => {
-        if (err) reject(new WSJTXError(err.message, 'DECODE_ERROR'));
-        else resolve(result);
-      });
+      try {
+        this.native.decode(mode, audioData, opts, (err, result) => {
+          if (err) reject(new WSJTXError(err.message, 'DECODE_ERROR'));
+          else resolve(finishQso(result, options.qso));
+        });
+      } catch (e) {
+        reject(nativeError(e, 'DECODE_ERROR'));
+      }
     });
   }
 
@@ -126,10 +319,14 @@ export class WSJTXLib {
     }
 
     return new Promise((resolve, reject) => {
-      this.native.encode(mode, message, frequency, threads, (err, result) => {
-        if (err) reject(new WSJTXError(err.message, 'ENCODE_ERROR'));
-        else resolve(result);
-      });
+      try {
+        this.native.encode(mode, message, frequency, threads, (err, result) => {
+          if (err) reject(new WSJTXError(err.message, 'ENCODE_ERROR'));
+          else resolve(result);
+        });
+      } catch (e) {
+        reject(nativeError(e, 'ENCODE_ERROR'));
+      }
     });
   }
 
@@ -138,7 +335,8 @@ export class WSJTXLib {
       throw new WSJTXError('audioData must be a non-empty Int16Array', 'INVALID');
     }
 
-    const opts = {
+    const { udp, periodStartMs, ...decoderOptions } = options;
+    const opts: Record<string, unknown> = {
       dialFrequency: 14_095_600,
       callsign: '',
       locator: '',
@@ -146,14 +344,25 @@ export class WSJTXLib {
       useHashTable: true,
       passes: 2,
       subtraction: true,
-      ...options,
+      ...decoderOptions,
     };
+    if (udp !== undefined) {
+      if (!(udp instanceof UdpEmitter)) {
+        throw new WSJTXError('udp must be a UdpEmitter', 'INVALID');
+      }
+      opts.udp = udp.native;
+      opts.udpTimeMs = msSinceMidnight(periodStartMs ?? wsprPeriodStart(Date.now()));
+    }
 
     return new Promise((resolve, reject) => {
-      this.native.decodeWSPR(audioData as unknown as Float32Array, opts, (err, results) => {
-        if (err) reject(new WSJTXError(err.message, 'WSPR_ERROR'));
-        else resolve(results);
-      });
+      try {
+        this.native.decodeWSPR(audioData as unknown as Float32Array, opts, (err, results) => {
+          if (err) reject(new WSJTXError(err.message, 'WSPR_ERROR'));
+          else resolve(results);
+        });
+      } catch (e) {
+        reject(nativeError(e, 'WSPR_ERROR'));
+      }
     });
   }
 
@@ -177,6 +386,27 @@ export class WSJTXLib {
     return this.native.getTransmissionDuration(mode);
   }
 
+  /** T/R period (slot length) in seconds, e.g. 15 for FT8. */
+  getSlotPeriod(mode: WSJTXMode): number {
+    return this.native.getSlotPeriod(mode);
+  }
+
+  /** Index of the T/R period containing `timeMs` (default: now). */
+  currentSlot(mode: WSJTXMode, timeMs: number = Date.now()): number {
+    return Math.floor(timeMs / (this.getSlotPeriod(mode) * 1000));
+  }
+
+  /**
+   * Latency quantile in seconds for this instance's `op` in `mode`, from the
+   * native histograms behind `getMetrics`. With `queue`, the queue-wait
+   * part only. NaN until such an operation has completed.
+   */
+  latencyQuantile(op: MetricsOperation, mode: WSJTXMode | null, q: number, queue = false): number {
+    if (!(op in METRICS_OPS)) throw new WSJTXError('Unknown operation', 'INVALID');
+    if (!(q >= 0 && q <= 1)) throw new WSJTXError('q must be in 0..1', 'INVALID');
+    return binding.latencyQuantile(this.config.receiver, METRICS_OPS[op], mode ?? -1, q, queue);
+  }
+
   getAllModeCapabilities(): ModeCapabilities[] {
     const numericModes = Object.values(WSJTXMode).filter((v): v is number => typeof v === 'number');
     return numericModes.map((mode) => ({
@@ -188,7 +418,7 @@ export class WSJTXLib {
     }));
   }
 
-  async convertAudioFormat(audioData: AudioData, targetFormat: 'float32' | 'int16'): Promise<AudioData> {
+  async convertAudioFormat(audioData: AudioInput, targetFormat: 'float32' | 'int16'): Promise<AudioData> {
     return new Promise((resolve, reject) => {
       this.native.convertAudioFormat(audioData, targetFormat, (err, result) => {
         if (err) reject(err);
@@ -197,6 +427,221 @@ export class WSJTXLib {
     });
   }
 
+  /**
+   * Distance (km) and bearing (degrees) from `homeGrid` to each locator in
+   * `grids`, computed natively in one call. Unparseable grids yield NaN.
+   */
+  gridDistances(homeGrid: string, grids: string[]): GridDistances {
+    this.validateGrid(homeGrid);
+    return this.native.gridDistances(homeGrid, grids);
+  }
+
+  /**
+   * Lay `messages` out as Arrow-compatible columns in one native buffer.
+   * Use `DecodeOptions.columnar` to get this directly from decode.
+   */
+  toColumnar(messages: WSJTXMessage[]): DecodeColumns {
+    return this.native.toColumnar(messages);
+  }
+
+  /**
+   * Stage 1 of a pipelined FT8/FT4 decode: the Costas sync search alone,
+   * best candidates first. It holds no decoder, so it can run while this
+   * instance is decoding; pass the bands from `partitionCandidates` as
+   * `DecodeOptions.partition` to instances with idle threads.
+   */
+  async findCandidates(mode: WSJTXMode, audioData: AudioInput, options: FindCandidatesOptions = {}): Promise<Candidate[]> {
+    this.validateAudio(audioData);
+    if (mode !== WSJTXMode.FT8 && mode !== WSJTXMode.FT4) {
+      throw new WSJTXError('Candidate search is only available for FT8 and FT4', 'UNSUPPORTED');
+    }
+    return new Promise((resolve, reject) => {
+      this.native.findCandidates(mode, audioData, options, (err, result) => {
+        if (err) reject(new WSJTXError(err.message, 'DECODE_ERROR'));
+        else resolve(result);
+      });
+    });
+  }
+
+  /**
+   * Decode every channel of one interleaved buffer (several receivers on
+   * one sound card) with its own options. The channels are separated
+   * natively and decoded in parallel, each on its own decoder, so the
+   * results match `channels` separate `decode` calls. Float32Array and
+   * Int16Array input is taken as interleaved float / 16-bit samples.
+   */
+  async decodeChannels(
+    mode: WSJTXMode,
+    audioData: AudioData | PcmAudio,
+    channels: number,
+    options: DecodeOptions[],
+  ): Promise<DecodeResult[]> {
+    this.validateMode(mode);
+    if (!Number.isInteger(channels) || channels < 1 || channels > MAX_DECODE_CHANNELS) {
+      throw new WSJTXError(`channels must be an integer in 1..${MAX_DECODE_CHANNELS}`, 'INVALID');
+    }
+    if (!Array.isArray(options) || options.length !== channels) {
+      throw new WSJTXError('options must hold one DecodeOptions per channel', 'INVALID');
+    }
+    let pcm: PcmAudio;
+    if (audioData instanceof Float32Array) pcm = { data: audioData, format: 'f32', channels };
+    else if (audioData instanceof Int16Array) pcm = { data: audioData, format: 's16', channels };
+    else {
+      if (audioData?.channels !== undefined && audioData.channels !== channels) {
+        throw new WSJTXError('audioData.channels does not match channels', 'INVALID');
+      }
+      pcm = { data: audioData?.data, format: audioData?.format, channels };
+    }
+    this.validateAudio(pcm);
+    if (!this.isDecodingSupported(mode) || mode === WSJTXMode.WSPR) {
+      throw new WSJTXError('Multi-channel decoding not supported for this mode', 'UNSUPPORTED');
+    }
+    const opts = options.map((o) => {
+      this.validateFrequency(o?.frequency);
+      if (o.diversity !== undefined) {
+        throw new WSJTXError('diversity is not available per channel', 'UNSUPPORTED');
+      }
+      const native = this.nativeDecodeOptions(mode, o);
+      this.applySlotWindow(mode, o, audioFrames(pcm), native);
+      return native;
+    });
+
+    return new Promise((resolve, reject) => {
+      try {
+        this.native.decodeChannels(mode, pcm, opts, (err, results) => {
+          if (err) reject(new WSJTXError(err.message, 'DECODE_ERROR'));
+          else resolve(results.map((r, i) => finishQso(r, options[i].qso)));
+        });
+      } catch (e) {
+        reject(nativeError(e, 'DECODE_ERROR'));
+      }
+    });
+  }
+
+  /**
+   * Validate `offset` / `length` against an input of `frames` frames and
+   * `slotStartOffset` against the slot period, and pass them on.
+   */
+  private applySlotWindow(mode: WSJTXMode, options: DecodeOptions, frames: number, opts: NativeDecodeOptions): void {
+    const offset = options.offset ?? 0;
+    if (!Number.isInteger(offset) || offset < 0 || offset > frames) {
+      throw new WSJTXError(`offset must be an integer in 0..${frames}`, 'INVALID');
+    }
+    const length = options.length ?? frames - offset;
+    if (!Number.isInteger(length) || length < 0 || offset + length > frames) {
+      throw new WSJTXError(`length must be an integer in 0..${frames - offset}`, 'INVALID');
+    }
+    if (options.slotStartOffset !== undefined) {
+      const period = this.getSlotPeriod(mode);
+      if (!Number.isFinite(options.slotStartOffset) || Math.abs(options.slotStartOffset) >= period) {
+        throw new WSJTXError(`slotStartOffset must be a number of seconds within +-${period}`, 'INVALID');
+      }
+      opts.slotStartOffset = options.slotStartOffset;
+    } else if (length === 0) {
+      throw new WSJTXError('offset/length select no audio', 'INVALID');
+    }
+    if (options.offset !== undefined) opts.offset = offset;
+    if (options.length !== undefined) opts.length = length;
+  }
+
+  /** Validated DecodeOptions for the native layer, all but `diversity`. */
+  private nativeDecodeOptions(mode: WSJTXMode, options: DecodeOptions): NativeDecodeOptions {
+    const opts: NativeDecodeOptions = {
+      frequency: options.frequency,
+      threads: options.threads ?? this.defaultThreads(mode),
+      lowFreq: options.lowFreq ?? this.config.defaultLowFreq,
+      highFreq: options.highFreq ?? this.config.defaultHighFreq,
+      tolerance: options.tolerance ?? this.config.defaultTolerance,
+      dxCall: options.dxCall ?? '',
+      dxGrid: options.dxGrid ?? '',
+    };
+    if (options.homeGrid !== undefined) {
+      this.validateGrid(options.homeGrid);
+      opts.homeGrid = options.homeGrid;
+    }
+    if (options.history !== undefined) {
+      if (!(options.history instanceof MessageHistory)) {
+        throw new WSJTXError('history must be a MessageHistory', 'INVALID');
+      }
+      opts.history = options.history.native;
+      opts.slot = options.slot ?? this.currentSlot(mode);
+    }
+    if (options.activity !== undefined) {
+      if (!(options.activity instanceof ActivityAggregator)) {
+        throw new WSJTXError('activity must be an ActivityAggregator', 'INVALID');
+      }
+      opts.activity = options.activity.native;
+      opts.band = options.band ?? '';
+      opts.activityTime = Math.floor(Date.now() / 1000);
+    }
+    if (options.udp !== undefined) {
+      if (!(options.udp instanceof UdpEmitter)) {
+        throw new WSJTXError('udp must be a UdpEmitter', 'INVALID');
+      }
+      opts.udp = options.udp.native;
+    }
+    if (options.columnar) opts.columnar = true;
+    if (options.partition !== undefined) {
+      if (mode !== WSJTXMode.FT8 && mode !== WSJTXMode.FT4) {
+        throw new WSJTXError('partition is only available for FT8 and FT4', 'UNSUPPORTED');
+      }
+      if (!Array.isArray(options.partition)) {
+        throw new WSJTXError('partition must be an array of candidates', 'INVALID');
+      }
+      if (options.apTargets !== undefined) {
+        throw new WSJTXError('partition and apTargets cannot be combined', 'INVALID');
+      }
+      opts.partition = options.partition;
+    }
+    if (options.clock !== undefined) {
+      if (!(options.clock instanceof ClockEstimator)) {
+        throw new WSJTXError('clock must be a ClockEstimator', 'INVALID');
+      }
+      opts.clock = options.clock.native;
+      opts.clockTime = (options.slot ?? this.currentSlot(mode)) * this.getSlotPeriod(mode);
+    }
+    if (options.qso !== undefined) {
+      if (!(options.qso instanceof QsoSequencer)) {
+        throw new WSJTXError('qso must be a QsoSequencer', 'INVALID');
+      }
+      if (options.qso.mode !== mode) {
+        throw new WSJTXError('qso was created for another mode', 'INVALID');
+      }
+      opts.qso = options.qso.native;
+    }
+    if (options.sampleRatePpm !== undefined) {
+      if (!Number.isFinite(options.sampleRatePpm) || Math.abs(options.sampleRatePpm) > 10_000) {
+        throw new WSJTXError('sampleRatePpm must be a number within +-10000', 'INVALID');
+      }
+      opts.sampleRatePpm = options.sampleRatePpm;
+    }
+    if (options.residual) {
+      if (mode !== WSJTXMode.FT8 && mode !== WSJTXMode.FT4) {
+        throw new WSJTXError('residual is only available for FT8 and FT4', 'UNSUPPORTED');
+      }
+      opts.residual = true;
+    }
+    if (options.apTargets !== undefined) {
+      if (!Array.isArray(options.apTargets) || options.apTargets.length > MAX_AP_TARGETS) {
+        throw new WSJTXError(`apTargets must be an array of at most ${MAX_AP_TARGETS} stations`, 'INVALID');
+      }
+      for (const t of options.apTargets) {
+        if (typeof t?.call !== 'string' || t.call.length === 0 || t.call.length > 12) {
+          throw new WSJTXError('apTargets call must be 1..12 characters', 'INVALID');
+        }
+        if (t.grid !== undefined) this.validateGrid(t.grid);
+      }
+      opts.apTargets = options.apTargets.map((t) => ({ call: t.call, grid: t.grid?.slice(0, 4) }));
+    }
+
+    return opts;
+  }
+
+  private defaultThreads(mode: WSJTXMode): number {
+    if (this.threadsPinned) return this.config.maxThreads;
+    return binding.getTuning(mode)?.threads ?? this.config.maxThreads;
+  }
+
   private validateMode(mode: WSJTXMode): void {
     if (!Object.values(WSJTXMode).includes(mode)) {
       throw new WSJTXError('Invalid mode', 'INVALID');
@@ -221,15 +666,536 @@ export class WSJTXLib {
     }
   }
 
-  private validateAudio(audio: AudioData): void {
-    const isTyped = audio instanceof Float32Array || audio instanceof Int16Array;
-    if (!isTyped || audio.length === 0) {
-      throw new WSJTXError('audioData must be a non-empty Float32Array or Int16Array', 'INVALID');
+  private validateGrid(grid: string): void {
+    if (typeof grid !== 'string' || !GRID_RE.test(grid)) {
+      throw new WSJTXError('Grid must be a 4- or 6-character Maidenhead locator', 'INVALID');
+    }
+  }
+
+  private validateAudio(audio: AudioInput): void {
+    if (audio instanceof Float32Array || audio instanceof Int16Array) {
+      if (audio.length === 0) throw new WSJTXError('audioData must not be empty', 'INVALID');
+      return;
+    }
+    if (typeof audio !== 'object' || audio === null || !(PCM_FORMATS as readonly string[]).includes(audio.format)) {
+      throw new WSJTXError(`audioData must be a Float32Array, Int16Array or PCM audio (${PCM_FORMATS.join(', ')})`, 'INVALID');
+    }
+    if (!ArrayBuffer.isView(audio.data) && !(audio.data instanceof ArrayBuffer)) {
+      throw new WSJTXError('PCM data must be a TypedArray, DataView or ArrayBuffer', 'INVALID');
+    }
+    const channels = audio.channels ?? 1;
+    const channel = audio.channel ?? 0;
+    if (!Number.isInteger(channels) || channels < 1 || channels > 64) {
+      throw new WSJTXError('PCM channels must be an integer 1..64', 'INVALID');
+    }
+    if (!Number.isInteger(channel) || channel < 0 || channel >= channels) {
+      throw new WSJTXError(`PCM channel must be an integer 0..${channels - 1}`, 'INVALID');
+    }
+    if (audioFrames(audio) === 0) throw new WSJTXError('PCM data holds no whole frame', 'INVALID');
+  }
+}
+
+/**
+ * Bounded, native cross-slot message history for one receiver.
+ *
+ * Messages are keyed by normalized text and approximate frequency; each
+ * observation reports whether it is new and when it was first/last seen.
+ * Pass it as `DecodeOptions.history` to annotate decode results directly.
+ */
+export class MessageHistory {
+  /** @internal */
+  readonly native: NativeMessageHistory;
+
+  constructor(options: MessageHistoryOptions = {}) {
+    const capacity = options.capacity ?? 10_000;
+    const tolerance = options.frequencyTolerance ?? 10;
+    if (!Number.isInteger(capacity) || capacity < 1) {
+      throw new WSJTXError('capacity must be a positive integer', 'INVALID');
+    }
+    if (!Number.isInteger(tolerance) || tolerance < 1) {
+      throw new WSJTXError('frequencyTolerance must be a positive integer', 'INVALID');
+    }
+    this.native = new binding.MessageHistory(capacity, tolerance);
+  }
+
+  /** Record messages decoded in `slot` and report new/repeat status for each. */
+  observe(messages: WSJTXMessage[], slot: number): HistoryInfo[] {
+    if (!Number.isInteger(slot)) {
+      throw new WSJTXError('slot must be an integer', 'INVALID');
+    }
+    return this.native.observe(messages, slot);
+  }
+
+  /** Number of distinct messages currently retained. */
+  get size(): number {
+    return this.native.size();
+  }
+
+  clear(): void {
+    this.native.clear();
+  }
+}
+
+/**
+ * Rolling band-activity statistics maintained natively.
+ *
+ * Decodes are folded into fixed-size per-(band, mode) rings of time
+ * buckets, so queries cost the same however much history has been seen.
+ * Pass it as `DecodeOptions.activity` to feed it straight from decode.
+ */
+export class ActivityAggregator {
+  /** @internal */
+  readonly native: NativeActivityAggregator;
+
+  constructor(options: ActivityAggregatorOptions = {}) {
+    const bucketSeconds = options.bucketSeconds ?? 60;
+    const buckets = options.buckets ?? 60;
+    if (!Number.isInteger(bucketSeconds) || bucketSeconds < 1) {
+      throw new WSJTXError('bucketSeconds must be a positive integer', 'INVALID');
+    }
+    if (!Number.isInteger(buckets) || buckets < 1) {
+      throw new WSJTXError('buckets must be a positive integer', 'INVALID');
+    }
+    this.native = new binding.ActivityAggregator(bucketSeconds, buckets);
+  }
+
+  /** Fold decodes observed at `timeMs` (default: now) into the (band, mode) series. */
+  add(band: string, mode: WSJTXMode, messages: WSJTXMessage[], timeMs: number = Date.now()): void {
+    this.native.add(band, mode, Math.floor(timeMs / 1000), messages);
+  }
+
+  /** Aggregate statistics over a time range, optionally with per-bucket rows. */
+  query(query: ActivityQuery = {}): ActivityReport {
+    const r = this.native.query(
+      query.band ?? '',
+      query.mode ?? -1,
+      Math.floor((query.fromMs ?? 0) / 1000),
+      Math.floor((query.toMs ?? Date.now()) / 1000),
+      query.buckets ?? false,
+    );
+    const toMs = (s: ActivityStats): ActivityStats => ({ ...s, bucketStart: s.bucketStart * 1000 });
+    const report: ActivityReport = toMs(r);
+    if (r.buckets) report.buckets = r.buckets.map(toMs);
+    return report;
+  }
+}
+
+/**
+ * Sound-card sample-rate error estimated from decodes.
+ *
+ * A capture that cuts slots by counting samples drifts against the real
+ * slot boundaries at the card's rate error, so the DT of decodes grows
+ * slot after slot. The per-slot median DT is fitted with a robust line over
+ * a time window. Pass it as `DecodeOptions.clock` to feed it from decode
+ * and have the input resampled to the nominal rate once the fit is clear.
+ */
+export class ClockEstimator {
+  /** @internal */
+  readonly native: NativeClockEstimator;
+
+  constructor(options: ClockEstimatorOptions = {}) {
+    const windowSeconds = options.windowSeconds ?? 3600;
+    if (!Number.isFinite(windowSeconds) || windowSeconds < 60) {
+      throw new WSJTXError('windowSeconds must be at least 60', 'INVALID');
+    }
+    this.native = new binding.ClockEstimator(windowSeconds);
+  }
+
+  /** Record the decodes of the slot that started at `slotTimeMs`. */
+  observe(messages: WSJTXMessage[], slotTimeMs: number): void {
+    this.native.observe(messages, slotTimeMs / 1000);
+  }
+
+  /** The current fit, or null until 4 slots spanning a minute have decodes. */
+  estimate(): ClockEstimate | null {
+    return this.native.estimate();
+  }
+
+  clear(): void {
+    this.native.clear();
+  }
+}
+
+/**
+ * FT8/FT4 QSO auto-sequencer.
+ *
+ * Follows the standard exchange from either end, calling CQ or answering
+ * a station, and decides the next message from each slot's decodes. The
+ * messages of a QSO are fixed when it starts, so the ones that may follow
+ * the current transmission are encoded ahead of time (`speculate`) and the
+ * next TX audio is ready when the decodes are. Pass it as
+ * `DecodeOptions.qso` to advance it and get that audio from decode itself.
+ */
+export class QsoSequencer {
+  /** @internal */
+  readonly native: NativeQsoSequencer;
+  readonly mode: WSJTXMode;
+  /** See `QsoStatus.speculateError`. */
+  speculateError: string | null = null;
+
+  constructor(mode: WSJTXMode, options: QsoSequencerOptions) {
+    if (mode !== WSJTXMode.FT8 && mode !== WSJTXMode.FT4) {
+      throw new WSJTXError('QSO sequencing is only available for FT8 and FT4', 'UNSUPPORTED');
+    }
+    if (typeof options?.myCall !== 'string' || !CALL_RE.test(options.myCall)) {
+      throw new WSJTXError('myCall must be a callsign', 'INVALID');
+    }
+    if (typeof options.myGrid !== 'string' || !GRID_RE.test(options.myGrid)) {
+      throw new WSJTXError('myGrid must be a 4- or 6-character Maidenhead locator', 'INVALID');
+    }
+    const txFrequency = options.txFrequency ?? 1500;
+    if (!Number.isInteger(txFrequency) || txFrequency < 0 || txFrequency > 5000) {
+      throw new WSJTXError('txFrequency must be an integer 0..5000 Hz', 'INVALID');
+    }
+    const maxRepeats = options.maxRepeats ?? 5;
+    if (!Number.isInteger(maxRepeats) || maxRepeats < 1) {
+      throw new WSJTXError('maxRepeats must be a positive integer', 'INVALID');
+    }
+    this.mode = mode;
+    this.native = new binding.QsoSequencer(mode, options.myCall, options.myGrid, txFrequency, maxRepeats);
+  }
+
+  /** Call CQ, answer the strongest reply and return to CQ after each QSO. */
+  startCq(): void {
+    this.native.startCq();
+  }
+
+  /** Answer `dxCall`, heard at `snr` dB; the report sent is that SNR. */
+  call(dxCall: string, snr: number, dxGrid?: string): void {
+    if (typeof dxCall !== 'string' || !CALL_RE.test(dxCall.replace(/^<(.*)>$/, '$1'))) {
+      throw new WSJTXError('dxCall must be a callsign', 'INVALID');
+    }
+    if (!Number.isFinite(snr)) throw new WSJTXError('snr must be a number', 'INVALID');
+    if (dxGrid !== undefined && (typeof dxGrid !== 'string' || !GRID_RE.test(dxGrid))) {
+      throw new WSJTXError('dxGrid must be a 4- or 6-character Maidenhead locator', 'INVALID');
     }
+    this.native.call(dxCall, dxGrid ?? '', Math.round(snr));
+  }
+
+  stop(): void {
+    this.native.stop();
+  }
+
+  /**
+   * Advance on one receive slot's decodes; call every slot, also when
+   * nothing decoded. Returns true if the next message changed.
+   */
+  observe(messages: WSJTXMessage[]): boolean {
+    return this.native.observe(messages);
+  }
+
+  status(): QsoStatus {
+    const s = this.native.status();
+    return { ...s, state: QSO_STATES[s.state], speculateError: this.speculateError };
+  }
+
+  /** Audio for the next message (empty when there is none), pre-encoded if available. */
+  txAudio(): Promise<Float32Array> {
+    return new Promise((resolve, reject) => {
+      this.native.txAudio((err, audio) => {
+        if (err) reject(new WSJTXError(err.message, 'ENCODE_ERROR'));
+        else resolve(audio);
+      });
+    });
+  }
+
+  /**
+   * Encode the next message and those that may follow it, dropping any
+   * others held. Resolves to the number newly encoded.
+   */
+  speculate(): Promise<number> {
+    return new Promise((resolve, reject) => {
+      this.native.speculate((err, n) => {
+        this.speculateError = err ? err.message : null;
+        if (err) reject(new WSJTXError(err.message, 'ENCODE_ERROR'));
+        else resolve(n);
+      });
+    });
+  }
+}
+
+/**
+ * Start recording pipeline spans (JS call, queue wait, input copy, option
+ * apply, core decode, message drain, result marshaling) from every thread
+ * into a native ring of `capacity` events. Restarting discards earlier spans.
+ */
+export function startTrace(capacity: number = 65_536): void {
+  if (!Number.isInteger(capacity) || capacity < 1) {
+    throw new WSJTXError('capacity must be a positive integer', 'INVALID');
+  }
+  binding.startTrace(capacity);
+}
+
+/** Stop recording; spans recorded so far remain available to `dumpTrace`. */
+export function stopTrace(): void {
+  binding.stopTrace();
+}
+
+/**
+ * Recorded spans as Chrome trace-event JSON, loadable in chrome://tracing
+ * or ui.perfetto.dev. Spans of one decode share an `args.job` id.
+ */
+export function dumpTrace(): string {
+  return binding.dumpTrace();
+}
+
+/**
+ * Process-wide metrics in the Prometheus text exposition format: latency
+ * summaries (p50/p90/p99/p99.9) per receiver, operation and mode for both
+ * end-to-end time and queue wait, error and decoded-message counters, and
+ * queued/running job gauges.
+ */
+export function getMetrics(): string {
+  return binding.getMetrics();
+}
+
+/** Clear latency histograms and counters; live job gauges are kept. */
+export function resetMetrics(): void {
+  binding.resetMetrics();
+}
+
+/**
+ * Optional features compiled into the native core. Without `openmp`, the
+ * decode `threads` hint is passed to wsjtx_lib but no OpenMP team is sized
+ * from it.
+ */
+export function buildFeatures(): BuildFeatures {
+  return binding.buildFeatures();
+}
+
+/**
+ * Wall-time limit for decodes of `mode`; 0 turns the watchdog off for it.
+ * The default is two T/R periods, counted from when the decode starts on
+ * the core pool. A decode past its limit is rejected and its thread
+ * released at once; the hung decoder runs on by itself and is quarantined,
+ * and the instance switches to a fresh one for later calls. While 4 such
+ * runaways are running, new decodes are rejected at once.
+ */
+export function setDecodeTimeLimit(mode: WSJTXMode, seconds: number): void {
+  if (!Object.values(WSJTXMode).includes(mode)) throw new WSJTXError('Invalid mode', 'INVALID');
+  if (!Number.isFinite(seconds) || seconds < 0) {
+    throw new WSJTXError('seconds must be a non-negative number', 'INVALID');
+  }
+  binding.setDecodeTimeLimit(mode, seconds);
+}
+
+export function getDecodeTimeLimit(mode: WSJTXMode): number {
+  return binding.getDecodeTimeLimit(mode);
+}
+
+export function watchdogStats(): WatchdogStats {
+  return binding.watchdogStats();
+}
+
+/** wsjtx_quota_action_t values */
+const QUOTA_ACTIONS = { deprioritize: 1, reject: 2 } as const;
+
+/**
+ * Hold every instance created with `receiver` as its label to a share of
+ * the host's CPUs, or lift its quota with null. Over it, new decodes run
+ * at lower priority (on the watchdog's pool thread, replaced afterwards)
+ * or every new job is rejected, until the last minute's usage drops back.
+ */
+export function setQuota(receiver: string, quota: ReceiverQuota | null): void {
+  if (typeof receiver !== 'string') throw new WSJTXError('receiver must be a string', 'INVALID');
+  if (quota === null) {
+    binding.setQuota(receiver, 0, 0);
+    return;
+  }
+  const action = QUOTA_ACTIONS[quota.action ?? 'deprioritize'];
+  if (action === undefined) throw new WSJTXError("action must be 'deprioritize' or 'reject'", 'INVALID');
+  if (!(quota.cpuShare > 0 && quota.cpuShare <= 1)) {
+    throw new WSJTXError('cpuShare must be in (0, 1]', 'INVALID');
+  }
+  binding.setQuota(receiver, quota.cpuShare, action);
+}
+
+/** Accounting for `receiver`, or undefined before its first job or quota. */
+export function getAccounting(receiver = ''): ReceiverAccounting | undefined {
+  const a = binding.getAccounting(receiver);
+  if (!a) return undefined;
+  const { quotaShare, quotaAction, ...totals } = a;
+  const action = quotaAction === QUOTA_ACTIONS.reject ? 'reject' : 'deprioritize';
+  return { ...totals, quota: quotaAction ? { cpuShare: quotaShare, action } : null };
+}
+
+/**
+ * Split candidates into at most `parts` contiguous frequency bands with
+ * near-equal counts, for `DecodeOptions.partition` on separate instances.
+ * Each band is decoded over its own span, so compact bands cost least.
+ */
+export function partitionCandidates(candidates: Candidate[], parts: number): Candidate[][] {
+  const sorted = [...candidates].sort((a, b) => a.frequency - b.frequency);
+  const count = Math.max(1, Math.min(Math.floor(parts), sorted.length));
+  const out: Candidate[][] = [];
+  for (let i = 0; i < count; i++) {
+    const group = sorted.slice(Math.round((i * sorted.length) / count), Math.round(((i + 1) * sorted.length) / count));
+    if (group.length > 0) out.push(group);
+  }
+  return out;
+}
+
+/** Format tag of files written by `autotune({ file })`. */
+const TUNING_FILE_VERSION = 1;
+
+/** 1, 2, 4, ... up to `limit` (always including 1). */
+function powersOfTwo(limit: number): number[] {
+  const out: number[] = [];
+  for (let n = 1; n <= Math.max(1, limit); n *= 2) out.push(n);
+  return out;
+}
+
+/**
+ * Benchmark decoding of a bundled synthetic slot for each mode at several
+ * decoder thread hints and concurrency levels, and keep the best setting
+ * per mode: the highest throughput whose latency fits in the T/R period.
+ * The results become the default `DecodeOptions.threads` of every
+ * WSJTXLib created without `maxThreads`; `concurrency` is the number of
+ * simultaneous decodes to run (size UV_THREADPOOL_SIZE to match).
+ *
+ * Runs on a worker thread and takes seconds to minutes, depending on the
+ * host and the grid of settings. WSPR takes no thread hint and is rejected.
+ */
+export async function autotune(modes: WSJTXMode[], options: AutotuneOptions = {}): Promise<TuningResult[]> {
+  const cpus = Math.max(1, os.cpus().length);
+  const threadCounts = options.threadCounts ?? powersOfTwo(Math.min(THREADS_MAX, cpus));
+  const concurrency = options.concurrency ?? powersOfTwo(Math.min(16, cpus));
+  const repeats = options.repeats ?? 2;
+  if (!Array.isArray(modes) || modes.length === 0) {
+    throw new WSJTXError('modes must be a non-empty array', 'INVALID');
+  }
+  for (const mode of modes) {
+    if (!Object.values(WSJTXMode).includes(mode) || mode === WSJTXMode.WSPR) {
+      throw new WSJTXError(`Mode ${mode} cannot be autotuned`, 'INVALID');
+    }
+  }
+  const levels = (v: number[], max: number) =>
+    Array.isArray(v) && v.length > 0 && v.every((n) => Number.isInteger(n) && n >= 1 && n <= max);
+  if (!levels(threadCounts, THREADS_MAX)) {
+    throw new WSJTXError(`threadCounts must be integers in ${THREADS_MIN}..${THREADS_MAX}`, 'INVALID');
+  }
+  if (!levels(concurrency, 64)) {
+    throw new WSJTXError('concurrency must be integers in 1..64', 'INVALID');
+  }
+  if (!Number.isInteger(repeats) || repeats < 1) {
+    throw new WSJTXError('repeats must be a positive integer', 'INVALID');
+  }
+
+  const results = await new Promise<TuningResult[]>((resolve, reject) => {
+    binding.autotune(modes, threadCounts, concurrency, repeats, (err, r) => {
+      if (err) reject(new WSJTXError(err.message, 'AUTOTUNE_ERROR'));
+      else resolve(r);
+    });
+  });
+  if (options.file !== undefined) {
+    const doc = { version: TUNING_FILE_VERSION, host: os.hostname(), cpus, results };
+    fs.writeFileSync(options.file, JSON.stringify(doc, null, 2));
+  }
+  return results;
+}
+
+/**
+ * Apply results saved by `autotune({ file })`. Files measured on a host
+ * with a different CPU count are ignored (returns []), so one config image
+ * can be shared across a mixed fleet with a file per host class. An entry
+ * with an unknown mode or out-of-range threads/concurrency fails the whole
+ * file with INVALID before anything is applied.
+ */
+export function loadTuning(file: string): TuningResult[] {
+  let doc: { version?: number; cpus?: number; results?: TuningResult[] };
+  try {
+    doc = JSON.parse(fs.readFileSync(file, 'utf8'));
+  } catch (e) {
+    throw new WSJTXError(`Cannot read tuning file: ${(e as Error).message}`, 'INVALID');
+  }
+  if (doc.version !== TUNING_FILE_VERSION || !Array.isArray(doc.results)) {
+    throw new WSJTXError('Unrecognized tuning file', 'INVALID');
+  }
+  if (doc.cpus !== Math.max(1, os.cpus().length)) return [];
+  // Check every entry before applying any, so a bad file changes nothing
+  doc.results.forEach(validateTuning);
+  for (const r of doc.results) binding.setTuning(r);
+  return doc.results;
+}
+
+function validateTuning(r: TuningResult, index: number): void {
+  const at = `Tuning entry ${index}`;
+  if (typeof r !== 'object' || r === null) {
+    throw new WSJTXError(`${at} is not an object`, 'INVALID');
+  }
+  if (!Object.values(WSJTXMode).includes(r.mode) || r.mode === WSJTXMode.WSPR) {
+    throw new WSJTXError(`${at}: mode ${r.mode} cannot be tuned`, 'INVALID');
+  }
+  if (!Number.isInteger(r.threads) || r.threads < THREADS_MIN || r.threads > THREADS_MAX) {
+    throw new WSJTXError(`${at}: threads must be an integer in ${THREADS_MIN}..${THREADS_MAX}`, 'INVALID');
+  }
+  if (!Number.isInteger(r.concurrency) || r.concurrency < 1 || r.concurrency > 64) {
+    throw new WSJTXError(`${at}: concurrency must be an integer in 1..64`, 'INVALID');
+  }
+}
+
+/** Tuned configuration in effect for `mode`, if any. */
+export function getTuning(mode: WSJTXMode): TuningResult | undefined {
+  return binding.getTuning(mode) ?? undefined;
+}
+
+/** Milliseconds since midnight UTC, as carried in WSJT-X message times. */
+function msSinceMidnight(timeMs: number): number {
+  return ((timeMs % 86_400_000) + 86_400_000) % 86_400_000;
+}
+
+/** Start of the two-minute WSPR period containing `timeMs`. */
+function wsprPeriodStart(timeMs: number): number {
+  return Math.floor(timeMs / 120_000) * 120_000;
+}
+
+/**
+ * Native emitter for the WSJT-X UDP protocol (the format JTAlert,
+ * GridTracker and loggers listen for). Messages are serialized straight
+ * from the native structs into a preallocated datagram buffer. Pass it as
+ * `DecodeOptions.udp` / `WSPRDecodeOptions.udp` to send results from the
+ * decode worker without building JS objects first.
+ *
+ * The socket is closed when the emitter is garbage collected.
+ */
+export class UdpEmitter {
+  /** @internal */
+  readonly native: NativeUdpEmitter;
+
+  constructor(options: UdpEmitterOptions = {}) {
+    const port = options.port ?? 2237;
+    const ttl = options.multicastTtl ?? 0;
+    if (!Number.isInteger(port) || port < 1 || port > 65535) {
+      throw new WSJTXError('port must be an integer in 1..65535', 'INVALID');
+    }
+    if (!Number.isInteger(ttl) || ttl < 0 || ttl > 255) {
+      throw new WSJTXError('multicastTtl must be an integer in 0..255', 'INVALID');
+    }
+    this.native = new binding.UdpEmitter(options.host ?? '127.0.0.1', port, options.id ?? 'WSJT-X', ttl);
+  }
+
+  /** Send a Heartbeat (type 0). Returns the number of datagrams sent. */
+  sendHeartbeat(version = '', revision = ''): number {
+    return this.native.sendHeartbeat(version, revision);
+  }
+
+  /** Send a Status (type 1). */
+  sendStatus(status: UdpStatus): number {
+    return this.native.sendStatus(status);
+  }
+
+  /** Send one Decode (type 2) per message; `isNew` on a message is honoured. */
+  sendDecodes(mode: WSJTXMode, messages: WSJTXMessage[]): number {
+    return this.native.sendDecodes(mode, messages);
+  }
+
+  /** Send one WSPRDecode (type 10) per result for the period starting at `periodStartMs`. */
+  sendWSPR(results: WSPRResult[], dialFrequency: number, periodStartMs: number = wsprPeriodStart(Date.now())): number {
+    return this.native.sendWSPR(results, msSinceMidnight(periodStartMs), dialFrequency);
   }
 }
 
-export { WSJTXMode, WSJTXError };
+export { WSJTXMode, WSJTXError, ACTIVITY_BINS };
 export type {
   DecodeResult,
   EncodeResult,
@@ -237,7 +1203,36 @@ export type {
   WSPRDecodeOptions,
   WSJTXMessage,
   AudioData,
+  AudioInput,
+  PcmAudio,
+  PcmFormat,
   WSJTXConfig,
   DecodeOptions,
+  APTarget,
+  DecodeColumns,
+  Candidate,
+  FindCandidatesOptions,
   ModeCapabilities,
+  GridDistances,
+  HistoryInfo,
+  MessageHistoryOptions,
+  ActivityAggregatorOptions,
+  ClockEstimatorOptions,
+  ClockEstimate,
+  QsoSequencerOptions,
+  QsoState,
+  QsoStatus,
+  QsoDecodeStatus,
+  ActivityQuery,
+  ActivityReport,
+  ActivityStats,
+  UdpEmitterOptions,
+  UdpStatus,
+  MetricsOperation,
+  TuningResult,
+  AutotuneOptions,
+  BuildFeatures,
+  WatchdogStats,
+  ReceiverQuota,
+  ReceiverAccounting,
 };
@@ -2,6 +2,8 @@
  * Public types and enums for the wsjtx-lib Node.js binding.
  */
 
+import type { MessageHistory, ActivityAggregator, ClockEstimator, QsoSequencer, UdpEmitter } from './index.js';
+
 export enum WSJTXMode {
   FT8 = 0,
   FT4 = 1,
@@ -17,6 +19,25 @@ export enum WSJTXMode {
 
 export type AudioData = Float32Array | Int16Array;
 
+/** Raw PCM sample formats: unsigned 8-bit, signed 16/24 (packed)/32-bit, float, double. */
+export type PcmFormat = 'u8' | 's16' | 's24' | 's32' | 'f32' | 'f64';
+
+/**
+ * Raw PCM as captured, little-endian with channels interleaved. The selected
+ * channel is converted to float natively in one pass, without a JS copy.
+ */
+export interface PcmAudio {
+  data: ArrayBufferView | ArrayBuffer;
+  format: PcmFormat;
+  /** Interleaved channels, 1..64. Default 1. */
+  channels?: number;
+  /** Channel to use. Default 0. */
+  channel?: number;
+}
+
+/** Audio accepted by decode and findCandidates: typed samples or raw PCM. */
+export type AudioInput = AudioData | PcmAudio;
+
 export interface WSJTXTime {
   hour: number;
   minute: number;
@@ -31,17 +52,90 @@ export interface WSJTXMessage {
   /** seconds-of-day reported by the decoder (hh*3600 + mm*60 + ss) */
   timestamp: number;
   sync: number;
+  /**
+   * 0 = decoded without a-priori information, 1..7 = FT8/FT4 AP type, from
+   * the decoder's "a1".."a7" text marker. Set on every decoded message.
+   */
+  apType?: number;
+  /** Locator carried by the message; set only when `DecodeOptions.homeGrid` is given. */
+  grid?: string;
+  /** Great-circle distance from `homeGrid` in km; set alongside `grid`. */
+  distanceKm?: number;
+  /** Initial bearing from `homeGrid` in degrees (0..360); set alongside `grid`. */
+  bearing?: number;
+  /** Set when `DecodeOptions.history` is given; see `HistoryInfo`. */
+  isNew?: boolean;
+  repeatCount?: number;
+  firstSeenSlot?: number;
+  lastSeenSlot?: number;
+}
+
+/**
+ * Per-message result of a `MessageHistory` observation.
+ *
+ * - isNew:         true if the message was not in the history.
+ * - repeatCount:   observations so far, including this one.
+ * - firstSeenSlot: slot the message was first seen in.
+ * - lastSeenSlot:  slot it was last seen in before this observation.
+ */
+export interface HistoryInfo {
+  isNew: boolean;
+  repeatCount: number;
+  firstSeenSlot: number;
+  lastSeenSlot: number;
+}
+
+export interface MessageHistoryOptions {
+  /** Maximum distinct messages retained; least recently seen are evicted. Default 10000. */
+  capacity?: number;
+  /** Frequencies within this many Hz count as the same signal. Default 10. */
+  frequencyTolerance?: number;
 }
 
 /**
  * Options accepted by `WSJTXLib.decode`.
  *
  * - frequency: nominal QSO frequency in Hz (decoder uses this as nfqso).
- * - threads:   thread hint forwarded to the decoder. Defaults to maxThreads.
+ * - threads:   thread hint forwarded to the decoder. Defaults to maxThreads,
+ *   or to the autotuned value for the mode when maxThreads is not set.
  * - dxCall / dxGrid: enables A8 list / AP decode for the named station.
  * - lowFreq / highFreq / tolerance: scan window and tone tolerance in Hz
  *   (defaults: 200 / 4000 / 20). These are forwarded to the decoder via
  *   `setDecodeRange` and *do* take effect.
+ * - homeGrid: station locator; messages carrying a grid get `grid`,
+ *   `distanceKm` and `bearing` computed natively.
+ * - history / slot: mark each message new/repeat against a native
+ *   `MessageHistory`. `slot` defaults to the current T/R period index.
+ * - activity / band: fold results into a native `ActivityAggregator`
+ *   under the given band label, timestamped at decode time.
+ * - udp: send each result as a WSJT-X Decode datagram from the worker
+ *   thread. With `history`, repeats go out with New = false.
+ * - columnar: return results as Arrow-layout `columns` instead of
+ *   per-message objects (`messages` is then empty).
+ * - apTargets: up to 16 DX stations to try AP decoding for in one call
+ *   (replaces dxCall/dxGrid). FT8/FT4 decode the slot once, then give each
+ *   target not already heard an AP decode of the residual where sync
+ *   candidates remain; other modes decode once per target. The results are
+ *   merged without duplicates.
+ * - partition: FT8/FT4 only. Decode just the frequency band these
+ *   candidates span (one part of `partitionCandidates`), so several
+ *   instances can share a slot. The band is decoded in full, not candidate
+ *   by candidate. Cannot be combined with apTargets.
+ * - residual: FT8/FT4 only. Also return the input audio with every decoded
+ *   signal subtracted (`result.residual`, Float32 at the mode's rate), to
+ *   feed another decoder without repeating the strong signals.
+ * - clock: a ClockEstimator for the sound card. Once its estimate stands
+ *   clear of its own error the input is resampled to the nominal rate before
+ *   decoding, and the results are fed back to it as the slot starting at
+ *   `slot` (default: the current slot) times the mode's period.
+ * - sampleRatePpm: resample by this sound-card error instead (positive =
+ *   card runs fast); overrides the clock's estimate.
+ * - diversity: the same slot, time-aligned and of equal length, from up to
+ *   7 more receivers. They are combined with `audioData` per frequency bin
+ *   (maximal-ratio) and the combination is decoded once.
+ * - qso: a QsoSequencer of the same mode (FT8/FT4). It is advanced on the
+ *   results, `result.qso` carries the next transmission ready to play, and
+ *   the messages that may follow it are pre-encoded in the background.
  */
 export interface DecodeOptions {
   frequency: number;
@@ -51,19 +145,185 @@ export interface DecodeOptions {
   lowFreq?: number;
   highFreq?: number;
   tolerance?: number;
+  homeGrid?: string;
+  history?: MessageHistory;
+  slot?: number;
+  activity?: ActivityAggregator;
+  band?: string;
+  udp?: UdpEmitter;
+  columnar?: boolean;
+  apTargets?: APTarget[];
+  residual?: boolean;
+  partition?: Candidate[];
+  diversity?: AudioInput[];
+  clock?: ClockEstimator;
+  sampleRatePpm?: number;
+  qso?: QsoSequencer;
+  offset?: number;
+  length?: number;
+  slotStartOffset?: number;
+}
+
+/** A DX station for multi-target AP decoding. */
+export interface APTarget {
+  call: string;
+  /** 4-character grid, if known. */
+  grid?: string;
 }
 
 export interface DecodeResult {
   success: boolean;
   messages: WSJTXMessage[];
+  /** Set when `DecodeOptions.columnar` is true. */
+  columns?: DecodeColumns;
+  /** Set when `DecodeOptions.residual` is true. Int16 input comes back scaled to [-1, 1). */
+  residual?: Float32Array;
+  /** Set when `DecodeOptions.qso` is given: its status after these decodes. */
+  qso?: QsoDecodeStatus;
   error?: string;
 }
 
+/**
+ * Decode results in the Apache Arrow columnar layout. All arrays are views
+ * over `buffer`, each starting on a 64-byte boundary, so they can be passed
+ * to an Arrow builder (e.g. `makeData`) without copying:
+ *
+ * - text: utf8 column (validity bitmap, int32 offsets, utf8 data)
+ * - snr / deltaFrequency / timestamp: int32 columns
+ * - deltaTime / sync: float32 columns
+ *
+ * Numeric columns have no nulls and carry no validity bitmap.
+ */
+export interface DecodeColumns {
+  length: number;
+  nullCount: number;
+  buffer: ArrayBuffer;
+  text: { validity: Uint8Array; offsets: Int32Array; data: Uint8Array };
+  snr: Int32Array;
+  deltaTime: Float32Array;
+  deltaFrequency: Int32Array;
+  sync: Float32Array;
+  timestamp: Int32Array;
+}
+
 export interface EncodeResult {
   audioData: Float32Array;
   messageSent: string;
 }
 
+/** Result of `WSJTXLib.gridDistances`; NaN where a grid did not parse. */
+export interface GridDistances {
+  distanceKm: Float64Array;
+  bearing: Float64Array;
+}
+
+export interface ActivityAggregatorOptions {
+  /** Width of each time bucket in seconds. Default 60. */
+  bucketSeconds?: number;
+  /** Buckets retained per (band, mode) series. Default 60 (one hour at 60 s). */
+  buckets?: number;
+}
+
+export interface ClockEstimatorOptions {
+  /** Seconds of slots the fit covers. Default 3600, minimum 60. */
+  windowSeconds?: number;
+}
+
+/** A sound card's sample-rate error, fitted from the DT drift of decodes. */
+export interface ClockEstimate {
+  /** Parts per million; positive when the card runs faster than nominal. */
+  ppm: number;
+  /** Standard error of `ppm`. */
+  ppmError: number;
+  /** Fitted DT at the newest slot in seconds: how far slot cutting has drifted. */
+  dtOffset: number;
+  /** Slots in the fit. */
+  slots: number;
+}
+
+export interface QsoSequencerOptions {
+  myCall: string;
+  /** 4- or 6-character locator; 4 characters are sent. */
+  myGrid: string;
+  /** Audio frequency of the transmissions in Hz. Default 1500. */
+  txFrequency?: number;
+  /** Slots a message is sent without a reply before the QSO is dropped. Default 5. */
+  maxRepeats?: number;
+}
+
+/**
+ * What a QsoSequencer transmits next, in the standard FT8/FT4 order:
+ * CQ, grid (Tx1), report (Tx2), R+report (Tx3), RR73 (Tx4), 73 (Tx5).
+ * `done` follows a QSO started with `call()`; `idle` sends nothing.
+ */
+export type QsoState = 'idle' | 'cq' | 'calling' | 'report' | 'rogerReport' | 'roger' | 'signoff' | 'done';
+
+export interface QsoStatus {
+  state: QsoState;
+  /** Empty while calling CQ or idle. */
+  dxCall: string;
+  dxGrid: string;
+  /** Report sent in dB, fixed when the QSO starts. */
+  reportSent: number;
+  /** Report received in dB, null until heard. */
+  reportReceived: number | null;
+  /** Slots the current message has gone without progress. */
+  repeats: number;
+  /** True once reports are confirmed both ways: the QSO can be logged. */
+  logged: boolean;
+  /** Next transmission, empty when there is none. */
+  txMessage: string;
+  /** TX audio requests served from pre-encoded messages / encoded on demand. */
+  cacheHits: number;
+  cacheMisses: number;
+  /** Why the last `speculate` (also run after each decode with `qso`) failed; null once one succeeds. */
+  speculateError: string | null;
+}
+
+export interface QsoDecodeStatus extends QsoStatus {
+  /** `txMessage` at the mode's sample rate; empty when there is none. */
+  txAudio: Float32Array;
+}
+
+/** Histogram bin layout used by `ActivityStats`. */
+export const ACTIVITY_BINS = {
+  /** Lower edge of SNR bin 0 in dB; values below land in bin 0. */
+  snrMin: -30,
+  /** SNR bin width in dB. */
+  snrStep: 2,
+  snrBins: 32,
+  /** Audio occupancy bin width in Hz, starting at 0 Hz. */
+  audioStep: 50,
+  audioBins: 80,
+} as const;
+
+export interface ActivityStats {
+  /** Start of the first covered bucket, unix ms. */
+  bucketStart: number;
+  decodes: number;
+  /** Estimated number of distinct callsigns. */
+  uniqueCalls: number;
+  snrHistogram: Int32Array;
+  audioOccupancy: Int32Array;
+}
+
+export interface ActivityQuery {
+  /** Band label to match; omit for all bands. */
+  band?: string;
+  /** Mode to match; omit for all modes. */
+  mode?: WSJTXMode;
+  /** Range start, unix ms. Default: start of the retained window. */
+  fromMs?: number;
+  /** Range end, unix ms. Default: now. */
+  toMs?: number;
+  /** Also return per-bucket rows (oldest first). */
+  buckets?: boolean;
+}
+
+export interface ActivityReport extends ActivityStats {
+  buckets?: ActivityStats[];
+}
+
 export interface WSPRResult {
   frequency: number;
   sync: number;
@@ -86,6 +346,46 @@ export interface WSPRDecodeOptions {
   useHashTable?: boolean;
   passes?: number;
   subtraction?: boolean;
+  /** Send each spot as a WSJT-X WSPRDecode datagram from the worker thread. */
+  udp?: UdpEmitter;
+  /** Start of the decoded period, unix ms (for `udp`). Default: the current even minute. */
+  periodStartMs?: number;
+}
+
+export interface UdpEmitterOptions {
+  /** Destination address (IPv4/IPv6 literal or host name). Default '127.0.0.1'. */
+  host?: string;
+  /** Destination port. Default 2237, the WSJT-X default. */
+  port?: number;
+  /** Client id carried in every message. Default 'WSJT-X'. */
+  id?: string;
+  /** TTL / hop limit for multicast destinations. Default: system default. */
+  multicastTtl?: number;
+}
+
+/** Fields of a WSJT-X Status (type 1) message; omitted fields are sent empty/zero. */
+export interface UdpStatus {
+  dialFrequency?: number;
+  mode?: string;
+  dxCall?: string;
+  report?: string;
+  txMode?: string;
+  txEnabled?: boolean;
+  transmitting?: boolean;
+  decoding?: boolean;
+  rxDF?: number;
+  txDF?: number;
+  deCall?: string;
+  deGrid?: string;
+  dxGrid?: string;
+  txWatchdog?: boolean;
+  subMode?: string;
+  fastMode?: boolean;
+  specialOperationMode?: number;
+  frequencyTolerance?: number;
+  trPeriod?: number;
+  configurationName?: string;
+  txMessage?: string;
 }
 
 export class WSJTXError extends Error {
@@ -96,7 +396,10 @@ export class WSJTXError extends Error {
 }
 
 export interface WSJTXConfig {
-  /** Maximum threads used per decode call. Default 4. */
+  /**
+   * Maximum threads used per decode call. Default 4, or the `autotune`
+   * result for the mode when one is loaded and this is not set.
+   */
   maxThreads?: number;
   /** Reserved for future use; currently has no runtime effect. */
   debug?: boolean;
@@ -106,6 +409,105 @@ export interface WSJTXConfig {
   defaultHighFreq?: number;
   /** Default tone tolerance in Hz, used when DecodeOptions.tolerance is omitted. */
   defaultTolerance?: number;
+  /** `receiver` label on this instance's metrics (see `getMetrics`). Default ''. */
+  receiver?: string;
+}
+
+/** Operations tracked by the latency histograms. */
+export type MetricsOperation = 'decode' | 'encode' | 'wspr' | 'convert';
+
+/** Best decode configuration measured by `autotune` for one mode. */
+export interface TuningResult {
+  mode: WSJTXMode;
+  /** Decoder thread hint; used as the default `DecodeOptions.threads`. */
+  threads: number;
+  /** Simultaneous decodes (one WSJTXLib each) that gave the best throughput. */
+  concurrency: number;
+  /** Mean wall time of one decode at this setting. */
+  latencyMs: number;
+  /** Decodes per second across all concurrent decoders. */
+  throughput: number;
+}
+
+/** Optional features compiled into the native core. */
+export interface BuildFeatures {
+  /** Decoders built with OpenMP (WSJTX_ENABLE_OPENMP); `threads` sets the team size. */
+  openmp: boolean;
+  /** USDT probes compiled in (WSJTX_ENABLE_USDT). */
+  usdt: boolean;
+  /** OpenMP threads available to a decode on this host; 1 without OpenMP. */
+  openmpMaxThreads: number;
+}
+
+/** Decode watchdog counters since process start. */
+export interface WatchdogStats {
+  /** Decodes run under a time limit. */
+  watched: number;
+  /** Of those, decodes that overran it and were rejected. */
+  timeouts: number;
+  /** Overrun decodes whose decoder has not returned yet. */
+  runaways: number;
+  /** Quarantined decoders not yet freed. */
+  quarantined: number;
+}
+
+/** CPU quota for one receiver label (`WSJTXConfig.receiver`). */
+export interface ReceiverQuota {
+  /** Share of all the host's CPUs, in (0, 1], averaged over the last minute. */
+  cpuShare: number;
+  /**
+   * What happens to new jobs while over it: 'deprioritize' (default) runs
+   * their decoder at lower OS priority, 'reject' fails them with code
+   * 'QUOTA_EXCEEDED'.
+   */
+  action?: 'deprioritize' | 'reject';
+}
+
+/** Jobs and CPU charged to one receiver label since process start. */
+export interface ReceiverAccounting {
+  /** Jobs admitted, including deprioritized ones. */
+  jobs: number;
+  /** Decodes run at lowered priority; encodes, WSPR and unwatched decodes never are. */
+  deprioritized: number;
+  rejected: number;
+  /** CPU time of every thread that worked on its jobs. */
+  cpuSeconds: number;
+  /** Time its jobs waited for a worker thread. */
+  queueSeconds: number;
+  /** Share of the host's CPUs used over the last minute. */
+  cpuShare: number;
+  quota: ReceiverQuota | null;
+}
+
+export interface AutotuneOptions {
+  /** Thread hints to try. Default: powers of two up to min(16, CPUs). */
+  threadCounts?: number[];
+  /** Concurrency levels to try. Default: powers of two up to min(16, CPUs). */
+  concurrency?: number[];
+  /** Timed decodes per decoder and setting. Default 2. */
+  repeats?: number;
+  /** Write the results here as JSON, for `loadTuning` on later starts. */
+  file?: string;
+}
+
+/** An FT8/FT4 sync candidate from `WSJTXLib.findCandidates`. */
+export interface Candidate {
+  /** Lowest tone in Hz. */
+  frequency: number;
+  /** Seconds from the nominal start, as decodes report DT. */
+  deltaTime: number;
+  /** Costas sync relative to the band's 40th percentile. */
+  score: number;
+}
+
+export interface FindCandidatesOptions {
+  /** Search band in Hz. Defaults 200 / 4000. */
+  lowFreq?: number;
+  highFreq?: number;
+  /** Minimum score to report. Default 1.5, as WSJT-X. */
+  minScore?: number;
+  /** Default 300. */
+  maxCandidates?: number;
 }
 
 export interface VersionInfo {
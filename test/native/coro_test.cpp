@@ -0,0 +1,177 @@
+/**
+ * coro_test.cpp - wsjtx_coro.hpp and the core job pool
+ *
+ * Instantiates every awaitable for each sample type and runs them on the
+ * pool through Task, when_all and sync_wait, then resizes the pool under
+ * load. Registered with ctest; exits non-zero on the first failed check.
+ */
+
+#include "wsjtx_coro.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define CHECK(cond)                                                              \
+    do {                                                                         \
+        if (!(cond)) {                                                           \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            std::exit(1);                                                        \
+        }                                                                        \
+    } while (0)
+
+namespace {
+
+const int RATE = 48000;             /* FT8 encoder output and decoder input */
+
+/* A 15 s FT8 slot: `audio` 0.5 s in at 0.1 peak over seeded uniform noise
+ * of 0.1 peak, as the Node tests' ft8Slot builds it */
+std::vector<float> ft8_slot(const std::vector<float>& audio, uint32_t seed = 1) {
+    std::vector<float> slot(static_cast<size_t>(15 * RATE));
+    const size_t start = RATE / 2;
+    for (size_t i = 0; i < audio.size() && start + i < slot.size(); i++) slot[start + i] = 0.1f * audio[i];
+    for (float& s : slot) {
+        seed = seed * 1664525u + 1013904223u;
+        s += static_cast<float>((seed / 4294967296.0 - 0.5) * 2 * 0.1);
+    }
+    return slot;
+}
+
+bool has_text(const std::vector<wsjtx_message_t>& messages, const char* text) {
+    for (const auto& m : messages) {
+        std::string t(m.msg);
+        t.erase(t.find_last_not_of(' ') + 1);
+        if (t == text) return true;
+    }
+    return false;
+}
+
+wsjtx::Task<wsjtx::Encoded> encode_cq(wsjtx_handle_t h) {
+    co_return co_await wsjtx::encode(h, WSJTX_MODE_FT8, "CQ K1ABC FN42", 1500);
+}
+
+wsjtx::Task<std::vector<wsjtx_message_t>> decode_float(wsjtx_handle_t h, std::vector<float> audio,
+                                                       int mode = WSJTX_MODE_FT8) {
+    co_return co_await wsjtx::decode(h, mode, std::move(audio), wsjtx::decode_options(1500));
+}
+
+wsjtx::Task<std::vector<wsjtx_message_t>> decode_int16(wsjtx_handle_t h, std::vector<int16_t> audio) {
+    co_return co_await wsjtx::decode(h, WSJTX_MODE_FT8, std::move(audio), wsjtx::decode_options(1500));
+}
+
+wsjtx::Task<std::vector<wsjtx_decoder_result_t>> decode_wspr(wsjtx_handle_t h, std::vector<float> iq) {
+    wsjtx_decoder_options_t o = {};
+    o.freq = 14095600;
+    o.quickmode = 1;
+    o.npasses = 1;
+    co_return co_await wsjtx::decode_wspr(h, std::move(iq), o);
+}
+
+wsjtx::Task<void> encode_into(wsjtx_handle_t h, std::string* sent) {
+    wsjtx::Encoded e = co_await wsjtx::encode(h, WSJTX_MODE_FT8, "CQ K1ABC FN42", 1500);
+    *sent = e.message_sent;
+}
+
+wsjtx::Task<int> rc_of_encode(wsjtx_handle_t h, int mode) {
+    try {
+        co_await wsjtx::encode(h, mode, "CQ K1ABC FN42", 1500);
+        co_return 0;
+    } catch (const wsjtx::Error& e) {
+        co_return e.code();
+    }
+}
+
+void test_operations(wsjtx_handle_t h) {
+    const wsjtx::Encoded cq = wsjtx::sync_wait(encode_cq(h));
+    CHECK(!cq.audio.empty());
+    CHECK(cq.message_sent.find("CQ K1ABC FN42") == 0);
+
+    const std::vector<float> slot = ft8_slot(cq.audio);
+    CHECK(has_text(wsjtx::sync_wait(decode_float(h, slot)), "CQ K1ABC FN42"));
+
+    std::vector<int16_t> pcm(slot.size());
+    for (size_t i = 0; i < slot.size(); i++) pcm[i] = static_cast<int16_t>(slot[i] * 32767.0f);
+    CHECK(has_text(wsjtx::sync_wait(decode_int16(h, std::move(pcm))), "CQ K1ABC FN42"));
+
+    /* Two minutes of silent IQ at 375 samples/s */
+    CHECK(wsjtx::sync_wait(decode_wspr(h, std::vector<float>(2 * 120 * 375))).empty());
+}
+
+void test_sync_wait_void(wsjtx_handle_t h) {
+    std::string sent;
+    wsjtx::sync_wait(encode_into(h, &sent));
+    CHECK(sent.find("CQ K1ABC FN42") == 0);
+}
+
+void test_when_all(const std::vector<wsjtx_handle_t>& handles) {
+    CHECK(wsjtx::sync_wait(wsjtx::when_all(std::vector<wsjtx::Task<wsjtx::Encoded>>())).empty());
+
+    std::vector<wsjtx::Task<wsjtx::Encoded>> tasks;
+    for (wsjtx_handle_t h : handles) tasks.push_back(encode_cq(h));
+    const std::vector<wsjtx::Encoded> all = wsjtx::sync_wait(wsjtx::when_all(std::move(tasks)));
+    CHECK(all.size() == handles.size());
+    for (const auto& e : all) CHECK(!e.audio.empty());
+
+    /* One failing task fails the lot with its error */
+    std::vector<wsjtx::Task<std::vector<wsjtx_message_t>>> mixed;
+    mixed.push_back(decode_float(handles[0], std::vector<float>(static_cast<size_t>(15 * RATE))));
+    mixed.push_back(decode_float(handles[1], std::vector<float>(static_cast<size_t>(15 * RATE)), 99));
+    bool threw = false;
+    try {
+        wsjtx::sync_wait(wsjtx::when_all(std::move(mixed)));
+    } catch (const wsjtx::Error& e) {
+        threw = true;
+        CHECK(e.code() == WSJTX_ERR_INVALID_MODE);
+        CHECK(std::strstr(e.what(), "Decode failed") != nullptr);
+    }
+    CHECK(threw);
+
+    /* Errors thrown inside a Task reach its awaiter, not the pool thread */
+    CHECK(wsjtx::sync_wait(rc_of_encode(handles[0], 99)) == WSJTX_ERR_INVALID_MODE);
+}
+
+void test_pool_resize(const std::vector<wsjtx_handle_t>& handles) {
+    CHECK(wsjtx_pool_set_threads(-1) == WSJTX_ERR_INVALID_ARG);
+    CHECK(wsjtx_pool_set_threads(4) == WSJTX_OK);
+    CHECK(wsjtx_pool_threads() == 4);
+
+    /* Shrink while jobs run: surplus threads leave after their job and
+     * everything queued still runs */
+    std::vector<wsjtx::Task<wsjtx::Encoded>> tasks;
+    for (wsjtx_handle_t h : handles) tasks.push_back(encode_cq(h));
+    std::vector<wsjtx::Encoded> done;
+    std::thread waiter([&] { done = wsjtx::sync_wait(wsjtx::when_all(std::move(tasks))); });
+    CHECK(wsjtx_pool_set_threads(1) == WSJTX_OK);
+    CHECK(wsjtx_pool_threads() == 1);
+    waiter.join();
+    CHECK(done.size() == handles.size());
+    for (const auto& e : done) CHECK(!e.audio.empty());
+
+    /* A single thread still serves jobs */
+    CHECK(!wsjtx::sync_wait(encode_cq(handles[0])).audio.empty());
+    CHECK(wsjtx_pool_set_threads(0) == WSJTX_OK);
+}
+
+} // namespace
+
+int main() {
+    /* A handle runs one call at a time: one per concurrent task */
+    std::vector<wsjtx_handle_t> handles;
+    for (int i = 0; i < 3; i++) {
+        wsjtx_handle_t h = wsjtx_create();
+        CHECK(h != nullptr);
+        handles.push_back(h);
+    }
+
+    test_operations(handles[0]);
+    test_sync_wait_void(handles[0]);
+    test_when_all(handles);
+    test_pool_resize(handles);
+
+    for (wsjtx_handle_t h : handles) wsjtx_destroy(h);
+    std::printf("coro_test: ok\n");
+    return 0;
+}
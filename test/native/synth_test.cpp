@@ -0,0 +1,110 @@
+/**
+ * synth_test.cpp - wsjtx_synthesize against gen_ft8wave / gen_ft4wave
+ *
+ * Encodes a message to tones, synthesizes it, and compares every sample
+ * with a direct double-precision port of the WSJT-X waveform generators.
+ * The ends, where the pulse tails and ramps differ between the two modes,
+ * are reported separately. Registered with ctest; exits non-zero on the
+ * first failed check.
+ */
+
+#include "wsjtx_c_api.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#define CHECK(cond)                                                              \
+    do {                                                                         \
+        if (!(cond)) {                                                           \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            std::exit(1);                                                        \
+        }                                                                        \
+    } while (0)
+
+namespace {
+
+const double TWO_PI = 8.0 * std::atan(1.0);
+
+double gfsk_pulse(double bt, double t) {
+    const double c = TWO_PI / 2 * std::sqrt(2.0 / std::log(2.0));
+    return 0.5 * (std::erf(c * bt * (t + 0.5)) - std::erf(c * bt * (t - 0.5)));
+}
+
+/* gen_ft8wave (dummy = true) or gen_ft4wave (dummy = false) for a real
+ * wave: `keep` output samples from `first` on, ramps of `nramp` samples */
+std::vector<double> reference(const std::vector<int>& itone, int nsps, double bt, bool dummy,
+                              int first, int keep, int nramp, double f0, double fsample) {
+    const int nsym = static_cast<int>(itone.size());
+    const double dphi_peak = TWO_PI / nsps;
+    std::vector<double> pulse(3 * nsps), dphi(static_cast<size_t>((nsym + 2) * nsps), 0.0);
+    for (int i = 1; i <= 3 * nsps; i++) pulse[i - 1] = gfsk_pulse(bt, (i - 1.5 * nsps) / nsps);
+    for (int j = 1; j <= nsym; j++) {
+        const int ib = (j - 1) * nsps;
+        for (int i = 0; i < 3 * nsps; i++) dphi[ib + i] += dphi_peak * pulse[i] * itone[j - 1];
+    }
+    if (dummy) {
+        for (int i = 0; i < 2 * nsps; i++) {
+            dphi[i] += dphi_peak * itone[0] * pulse[nsps + i];
+            dphi[nsym * nsps + i] += dphi_peak * itone[nsym - 1] * pulse[i];
+        }
+    }
+    for (double& d : dphi) d += TWO_PI * f0 / fsample;
+
+    std::vector<double> wave;
+    double phi = 0.0;
+    for (int j = first; j < first + keep; j++) {
+        wave.push_back(std::sin(phi));
+        phi = std::fmod(phi + dphi[j], TWO_PI);
+    }
+    const int k1 = keep - nramp;
+    for (int i = 0; i < nramp; i++) {
+        wave[i] *= (1.0 - std::cos(TWO_PI * i / (2.0 * nramp))) / 2.0;
+        wave[k1 + i] *= (1.0 + std::cos(TWO_PI * i / (2.0 * nramp))) / 2.0;
+    }
+    return wave;
+}
+
+double max_error(const std::vector<float>& a, const std::vector<double>& b, size_t from, size_t to) {
+    double e = 0.0;
+    for (size_t i = from; i < to; i++) e = std::max(e, std::fabs(a[i] - b[i]));
+    return e;
+}
+
+void check_mode(int mode, const char* name, const char* message, double bt, bool dummy, int nramp_div) {
+    int tones[256];
+    int num_tones = 0;
+    CHECK(wsjtx_encode_tones(mode, message, tones, 256, &num_tones, nullptr, 0) == WSJTX_OK);
+    const std::vector<int> itone(tones, tones + num_tones);
+
+    const double f0 = 1234.5;
+    std::vector<float> out(static_cast<size_t>(wsjtx_get_waveform_samples(mode)));
+    int n = 0;
+    CHECK(wsjtx_synthesize(mode, tones, num_tones, f0, out.data(), static_cast<int>(out.size()), &n) == WSJTX_OK);
+    CHECK(n == static_cast<int>(out.size()));
+
+    const double fsample = wsjtx_get_sample_rate(mode);
+    const int nsps = static_cast<int>(std::lround(fsample / wsjtx_get_tone_spacing(mode)));
+    const std::vector<double> ref = reference(itone, nsps, bt, dummy, dummy ? nsps : 0, n,
+                                              nsps / nramp_div, f0, fsample);
+
+    /* The first and last two symbols: ramps plus the pulse tails around them */
+    const size_t edge = static_cast<size_t>(2 * nsps);
+    const double head = max_error(out, ref, 0, edge);
+    const double tail = max_error(out, ref, out.size() - edge, out.size());
+    const double all = max_error(out, ref, 0, out.size());
+    std::printf("%s: max error head %.2g, tail %.2g, overall %.2g\n", name, head, tail, all);
+    CHECK(head < 1e-5);
+    CHECK(tail < 1e-5);
+    CHECK(all < 1e-5);
+}
+
+} // namespace
+
+int main() {
+    check_mode(WSJTX_MODE_FT8, "FT8", "CQ K1ABC FN42", 2.0, true, 8);
+    check_mode(WSJTX_MODE_FT4, "FT4", "K1ABC W9XYZ RR73", 1.0, false, 1);
+    std::printf("synth_test: ok\n");
+    return 0;
+}
@@ -20,11 +20,19 @@
 
 import { describe, it, beforeEach, after, before } from 'node:test';
 import assert from 'node:assert';
+import dgram from 'node:dgram';
 import fs from 'node:fs';
+import os from 'node:os';
 import path from 'node:path';
 import { fileURLToPath } from 'node:url';
-import { WSJTXLib, WSJTXMode, WSJTXError } from '../src/index.js';
-import type { DecodeOptions, DecodeResult, EncodeResult } from '../src/index.js';
+import {
+  WSJTXLib, WSJTXMode, WSJTXError, MessageHistory, ActivityAggregator, ClockEstimator, QsoSequencer, UdpEmitter,
+  ACTIVITY_BINS,
+  startTrace, stopTrace, dumpTrace, getMetrics, resetMetrics, autotune, loadTuning, getTuning,
+  buildFeatures, partitionCandidates, setDecodeTimeLimit, getDecodeTimeLimit, watchdogStats,
+  setQuota, getAccounting,
+} from '../src/index.js';
+import type { DecodeOptions, DecodeResult, EncodeResult, WSJTXMessage } from '../src/index.js';
 
 const __dirname = path.dirname(fileURLToPath(import.meta.url));
 const OUTPUT_DIR = path.join(__dirname, '..', 'test', 'output');
@@ -59,6 +67,64 @@ function toInt16(audio: Float32Array): Int16Array {
   return out;
 }
 
+/** Deterministic white noise, uniform in ±amplitude. */
+function noiseSource(seed: number, amplitude: number): () => number {
+  let state = seed >>> 0;
+  return () => {
+    state = (Math.imul(state, 1664525) + 1013904223) >>> 0;
+    return (state / 4294967296 - 0.5) * 2 * amplitude;
+  };
+}
+
+interface SlotSignal {
+  message: string;
+  frequency: number;
+  /** Peak level; default 0.1. */
+  amplitude?: number;
+}
+
+const CQ_K1ABC: SlotSignal = { message: 'CQ TEST K1ABC FN20', frequency: 1500 };
+
+interface SlotOptions {
+  /** Slot length in seconds; default the mode's T/R period. */
+  period?: number;
+  /** Seconds from slot start to each signal (DT = 0); default 0.5. */
+  leadIn?: number;
+  /** Peak noise level; default 0.1. */
+  noise?: number;
+  seed?: number;
+}
+
+/**
+ * One receive slot of `mode` at its sample rate: each signal starts
+ * `leadIn` into the slot over seeded noise of the given level. Clean encoder
+ * output alone does not decode reliably; at the defaults an FT8 signal sits
+ * about 11 dB above the noise in 2.5 kHz.
+ */
+async function modeSlot(
+  lib: WSJTXLib, mode: WSJTXMode, signals: SlotSignal[], options: SlotOptions = {},
+): Promise<Float32Array> {
+  const { period = lib.getSlotPeriod(mode), leadIn = 0.5, noise = 0.1, seed = 1 } = options;
+  const rate = lib.getSampleRate(mode);
+  const slot = new Float32Array(Math.round(period * rate));
+  const start = Math.round(leadIn * rate);
+  for (const { message, frequency, amplitude = 0.1 } of signals) {
+    const { audioData } = await lib.encode(mode, message, frequency);
+    const n = Math.min(audioData.length, slot.length - start);
+    for (let i = 0; i < n; i++) slot[start + i] += amplitude * audioData[i];
+  }
+  if (noise > 0) {
+    const next = noiseSource(seed, noise);
+    for (let i = 0; i < slot.length; i++) slot[i] += next();
+  }
+  return slot;
+}
+
+/** A 15 s FT8 slot, as modeSlot builds it. */
+function ft8Slot(lib: WSJTXLib, signals: SlotSignal[] = [CQ_K1ABC], noise = 0.1, seed = 1): Promise<Float32Array> {
+  return modeSlot(lib, WSJTXMode.FT8, signals, { noise, seed });
+}
+
 describe('WSJTX library — regression', () => {
   let lib: WSJTXLib;
 
@@ -103,14 +169,16 @@ describe('WSJTX library — regression', () => {
       assert.ok(lib.isDecodingSupported(WSJTXMode.FT4));
     });
 
-    it('JT65 is decode-only', () => {
-      assert.strictEqual(lib.isEncodingSupported(WSJTXMode.JT65), false);
-      assert.ok(lib.isDecodingSupported(WSJTXMode.JT65));
+    it('JT65 and WSPR support both encoding and decoding', () => {
+      for (const mode of [WSJTXMode.JT65, WSJTXMode.WSPR]) {
+        assert.ok(lib.isEncodingSupported(mode));
+        assert.ok(lib.isDecodingSupported(mode));
+      }
     });
 
-    it('WSPR is decode-only', () => {
-      assert.strictEqual(lib.isEncodingSupported(WSJTXMode.WSPR), false);
-      assert.ok(lib.isDecodingSupported(WSJTXMode.WSPR));
+    it('JT65JT9 is decode-only', () => {
+      assert.strictEqual(lib.isEncodingSupported(WSJTXMode.JT65JT9), false);
+      assert.ok(lib.isDecodingSupported(WSJTXMode.JT65JT9));
     });
 
     it('mode capabilities array covers all 10 modes', () => {
@@ -196,6 +264,65 @@ describe('WSJTX library — regression', () => {
       assert.strictEqual(result.messageSent.trim(), 'THIS IS CUSTO');
     });
 
+    const slowModes: Array<[string, WSJTXMode, string, number, number]> = [
+      // name, mode, message, symbols, samples per symbol
+      ['JT4', WSJTXMode.JT4, 'CQ K1ABC FN42', 206, 2520],
+      ['JT65', WSJTXMode.JT65, 'CQ K1ABC FN42', 126, 4096],
+      ['JT9', WSJTXMode.JT9, 'CQ K1ABC FN42', 85, 6912],
+      ['FST4', WSJTXMode.FST4, 'CQ K1ABC FN42', 160, 3888],
+      ['Q65', WSJTXMode.Q65, 'CQ K1ABC FN42', 85, 7200],
+      ['FST4W', WSJTXMode.FST4W, 'K1ABC FN42 37', 160, 8200],
+      ['WSPR', WSJTXMode.WSPR, 'K1ABC FN42 37', 162, 8192],
+    ];
+
+    for (const [name, mode, msg, symbols, nsps] of slowModes) {
+      it(`${name} encodes "${msg}" at its own sample rate`, async () => {
+        const result = await lib.encode(mode, msg, 1500);
+        assert.strictEqual(result.audioData.length, symbols * nsps);
+        assert.strictEqual(result.messageSent.trim(), msg);
+      });
+    }
+
+    it('JT9 encoder output decodes back to the encoded message', async () => {
+      // One minute slot, the transmission 1 s in
+      const slot = await modeSlot(lib, WSJTXMode.JT9, [{ message: 'CQ K1ABC FN42', frequency: 1500 }],
+        { leadIn: 1, seed: 9 });
+      const result = await lib.decode(WSJTXMode.JT9, slot, makeOptions({ frequency: 1500, tolerance: 50 }));
+      assert.strictEqual(result.success, true);
+      assert.ok(result.messages.some((m) => m.text.trim() === 'CQ K1ABC FN42'),
+        `decoded ${JSON.stringify(result.messages.map((m) => m.text))}`);
+    });
+
+    it('FT8 and FT4 waveforms have the WSJT-X lengths and unit peak', async () => {
+      // FT8: 79 symbols x 7680; FT4: 103 symbols + 2 pulse-tail symbols x 2304
+      const cases: Array<[WSJTXMode, number]> = [[WSJTXMode.FT8, 79 * 7680], [WSJTXMode.FT4, 105 * 2304]];
+      for (const [mode, length] of cases) {
+        const result = await lib.encode(mode, 'CQ K1ABC FN42', 1500);
+        assert.strictEqual(result.audioData.length, length);
+        let peak = 0;
+        for (const s of result.audioData) peak = Math.max(peak, Math.abs(s));
+        assert.ok(peak > 0.99 && peak <= 1.0001, `peak ${peak}`);
+      }
+    });
+
+    it('synthesized FT8 and FT4 waveforms decode back to the encoded message', async () => {
+      const ft8 = await lib.decode(WSJTXMode.FT8,
+        await ft8Slot(lib, [{ message: 'K1ABC W9XYZ -05', frequency: 1200 }]), makeOptions({ frequency: 1200 }));
+      assert.ok(ft8.messages.some((m) => m.text.trim() === 'K1ABC W9XYZ -05'),
+        `FT8 decoded ${JSON.stringify(ft8.messages.map((m) => m.text))}`);
+
+      const slot = await modeSlot(lib, WSJTXMode.FT4, [{ message: 'K1ABC W9XYZ RR73', frequency: 1200 }], { seed: 4 });
+      const ft4 = await lib.decode(WSJTXMode.FT4, slot, makeOptions({ frequency: 1200 }));
+      assert.ok(ft4.messages.some((m) => m.text.trim() === 'K1ABC W9XYZ RR73'),
+        `FT4 decoded ${JSON.stringify(ft4.messages.map((m) => m.text))}`);
+    });
+
+    it('encode is deterministic', async () => {
+      const a = await lib.encode(WSJTXMode.FT8, 'K1ABC W9XYZ -05', 1000);
+      const b = await lib.encode(WSJTXMode.FT8, 'K1ABC W9XYZ -05', 1000);
+      assert.deepStrictEqual(a.audioData, b.audioData);
+    });
+
     it('encoded audio has non-trivial dynamic range', async () => {
       const result = await lib.encode(WSJTXMode.FT8, 'CQ TEST K1ABC FN20', 1500);
       let min = result.audioData[0];
@@ -258,6 +385,54 @@ describe('WSJTX library — regression', () => {
         assert.ok(typeof m.deltaFrequency === 'number');
       }
     });
+
+    it('reports apType 0 for a message decoded without a-priori information', async () => {
+      const result = await lib.decode(WSJTXMode.FT8, await ft8Slot(lib), makeOptions({ frequency: 1500 }));
+      const m = result.messages.find((x) => x.text.includes('K1ABC'));
+      assert.ok(m, 'expected the slot to decode');
+      assert.strictEqual(m.apType, 0);
+    });
+  });
+
+  // ---- Columnar export ----
+
+  describe('columnar export', () => {
+    it('toColumnar and `columnar: true` lay out decoded messages as Arrow columns', async () => {
+      const slot = await ft8Slot(lib);
+      const opts = makeOptions({ frequency: 1500 });
+      const { messages } = await lib.decode(WSJTXMode.FT8, slot, opts);
+      assert.ok(messages.some((m) => m.text.includes('K1ABC')), 'expected the slot to decode');
+      const columnar = await lib.decode(WSJTXMode.FT8, slot, { ...opts, columnar: true });
+      assert.deepStrictEqual(columnar.messages, []);
+      assert.ok(columnar.columns);
+
+      const utf8 = new TextDecoder();
+      for (const cols of [lib.toColumnar(messages), columnar.columns]) {
+        assert.strictEqual(cols.length, messages.length);
+        assert.strictEqual(cols.nullCount, 0);
+        const views = [cols.text.validity, cols.text.offsets, cols.text.data, cols.snr, cols.deltaTime,
+          cols.deltaFrequency, cols.sync, cols.timestamp];
+        for (const v of views) {
+          assert.strictEqual(v.buffer, cols.buffer);
+          assert.strictEqual(v.byteOffset % 64, 0);
+        }
+        for (const column of [cols.snr, cols.deltaTime, cols.deltaFrequency, cols.sync, cols.timestamp]) {
+          assert.strictEqual(column.length, messages.length);
+        }
+        assert.strictEqual(cols.text.offsets.length, messages.length + 1);
+        assert.strictEqual(cols.text.offsets[messages.length], cols.text.data.length);
+        messages.forEach((m, i) => {
+          assert.strictEqual((cols.text.validity[i >> 3] >> (i & 7)) & 1, 1);
+          const text = utf8.decode(cols.text.data.subarray(cols.text.offsets[i], cols.text.offsets[i + 1]));
+          assert.strictEqual(text, m.text);
+          assert.strictEqual(cols.snr[i], m.snr);
+          assert.strictEqual(cols.deltaTime[i], Math.fround(m.deltaTime));
+          assert.strictEqual(cols.deltaFrequency[i], m.deltaFrequency);
+          assert.strictEqual(cols.sync[i], Math.fround(m.sync));
+          assert.strictEqual(cols.timestamp[i], m.timestamp);
+        });
+      }
+    });
   });
 
   // ---- DecodeOptions field-by-field ----
@@ -323,6 +498,259 @@ describe('WSJTX library — regression', () => {
       assert.strictEqual(r.success, true);
     });
 
+    it('decode with several `apTargets` merges results without duplicates', async () => {
+      const r = await lib.decode(WSJTXMode.FT8, await ft8Slot(lib), {
+        frequency: 1500,
+        threads: 1,
+        apTargets: [{ call: 'K1ABC', grid: 'FN20' }, { call: 'W9XYZ' }, { call: 'G4ABC', grid: 'IO91' }],
+      });
+      assert.strictEqual(r.success, true);
+      const texts = r.messages.map((m) => m.text.trim());
+      assert.ok(texts.includes('CQ TEST K1ABC FN20'), `decoded ${JSON.stringify(texts)}`);
+      assert.strictEqual(new Set(texts).size, texts.length);
+    });
+
+    it('`apTargets` share one candidate stage and skip a target already heard', async () => {
+      startTrace(4096);
+      const r = await lib.decode(WSJTXMode.FT8, await ft8Slot(lib), {
+        frequency: 1500,
+        threads: 1,
+        apTargets: [{ call: 'K1ABC', grid: 'FN20' }],
+      }).finally(() => stopTrace());
+      assert.ok(r.messages.some((m) => m.text.includes('K1ABC')), 'expected the plain pass to decode K1ABC');
+      const names = (JSON.parse(dumpTrace()) as { traceEvents: { name: string }[] }).traceEvents.map((e) => e.name);
+      const count = (name: string) => names.filter((n) => n === name).length;
+      assert.strictEqual(count('core_decode'), 1);
+      assert.strictEqual(count('candidate_stage'), 1);
+      // K1ABC was heard in the plain pass, so no AP pass runs for it
+      assert.strictEqual(count('ap_decode'), 0);
+    });
+
+    /**
+     * ft8Slot plus a signal that syncs but never decodes: one message with
+     * the second data half of another spliced in, Costas arrays intact.
+     */
+    async function slotWithGarbled(): Promise<Float32Array> {
+      const nsps = 7680;
+      const a = (await lib.encode(WSJTXMode.FT8, 'K1ABC W9XYZ EN37', 1000)).audioData;
+      const b = (await lib.encode(WSJTXMode.FT8, 'G4ABC N0AAA EM10', 1000)).audioData;
+      a.set(b.subarray(43 * nsps, 72 * nsps), 43 * nsps);
+      const slot = await ft8Slot(lib);
+      const start = ENCODE_SAMPLE_RATE / 2;
+      for (let i = 0; i < a.length; i++) slot[start + i] += 0.1 * a[i];
+      return slot;
+    }
+
+    it('`apTargets` give a target not heard in the slot an AP pass', async () => {
+      const slot = await slotWithGarbled();
+      startTrace(4096);
+      const r = await lib.decode(WSJTXMode.FT8, slot, {
+        frequency: 1500,
+        threads: 1,
+        apTargets: [{ call: 'K1ABC', grid: 'FN20' }, { call: 'W9XYZ' }],
+      }).finally(() => stopTrace());
+      assert.ok(r.messages.some((m) => m.text.includes('K1ABC')));
+      assert.ok(!r.messages.some((m) => m.text.includes('W9XYZ')), 'the garbled signal decoded');
+      const names = (JSON.parse(dumpTrace()) as { traceEvents: { name: string }[] }).traceEvents.map((e) => e.name);
+      // The garbled signal is left for the candidate stage; only W9XYZ is unheard
+      assert.strictEqual(names.filter((n) => n === 'ap_decode').length, 1);
+    });
+
+    it('`apTargets` do not carry over to later decodes', async () => {
+      const slot = await slotWithGarbled();
+      const opts = { frequency: 1500, threads: 1 };
+      await lib.decode(WSJTXMode.FT8, slot, { ...opts, dxCall: 'G4ABC', apTargets: [{ call: 'W9XYZ', grid: 'EN37' }] });
+      // The plain options' DX station, not the last target, is what remains
+      const after = await lib.decode(WSJTXMode.FT8, slot, opts);
+      const fresh = new WSJTXLib({ maxThreads: 4 });
+      await fresh.decode(WSJTXMode.FT8, silence, { ...opts, dxCall: 'G4ABC' });
+      const expected = await fresh.decode(WSJTXMode.FT8, slot, opts);
+      assert.deepStrictEqual(after.messages.map((m) => m.text), expected.messages.map((m) => m.text));
+    });
+
+    it('`residual` returns the audio with decoded signals removed', async () => {
+      // A low noise floor, so what is left after subtraction is mostly noise
+      const slot = await ft8Slot(lib, [CQ_K1ABC], 0.01);
+      const r = await lib.decode(WSJTXMode.FT8, slot, { frequency: 1500, threads: 1, residual: true });
+      assert.ok(r.messages.some((m) => m.text.includes('K1ABC')), 'expected the slot to decode');
+      assert.ok(r.residual instanceof Float32Array);
+      assert.strictEqual(r.residual.length, slot.length);
+      const energy = (a: Float32Array) => a.reduce((sum, v) => sum + v * v, 0);
+      const ratio = energy(r.residual) / energy(slot);
+      assert.ok(ratio < 0.1, `residual energy ratio ${ratio}`);
+    });
+
+    it('rejects `residual` for modes other than FT8/FT4', async () => {
+      await assert.rejects(
+        () => lib.decode(WSJTXMode.JT65, new Float32Array(11025), { frequency: 1500, residual: true }),
+        WSJTXError,
+      );
+    });
+
+    it('findCandidates locates an FT8 signal and its partition decodes it', async () => {
+      const slot = await ft8Slot(lib);
+      const candidates = await lib.findCandidates(WSJTXMode.FT8, slot);
+      assert.ok(candidates.length > 0);
+      assert.ok(Math.abs(candidates[0].frequency - 1500) <= 6.25, `best candidate at ${candidates[0].frequency} Hz`);
+      assert.ok(Math.abs(candidates[0].deltaTime) < 0.2);
+      const texts: string[] = [];
+      for (const part of partitionCandidates(candidates, 2)) {
+        const r = await lib.decode(WSJTXMode.FT8, slot, { frequency: 1500, threads: 1, partition: part });
+        assert.strictEqual(r.success, true);
+        texts.push(...r.messages.map((m) => m.text.trim()));
+      }
+      assert.ok(texts.includes('CQ TEST K1ABC FN20'), `decoded ${JSON.stringify(texts)}`);
+    });
+
+    it('partitionCandidates splits by frequency into balanced bands', () => {
+      const candidates = [900, 300, 2100, 1500, 600].map((frequency) => ({ frequency, deltaTime: 0, score: 2 }));
+      const parts = partitionCandidates(candidates, 2);
+      assert.deepStrictEqual(parts.map((p) => p.map((c) => c.frequency)), [[300, 600, 900], [1500, 2100]]);
+      assert.strictEqual(partitionCandidates(candidates, 10).length, 5);
+      assert.deepStrictEqual(partitionCandidates([], 4), []);
+    });
+
+    it('rejects findCandidates and `partition` for modes other than FT8/FT4', async () => {
+      await assert.rejects(() => lib.findCandidates(WSJTXMode.JT65, new Float32Array(11025)), WSJTXError);
+      await assert.rejects(
+        () => lib.decode(WSJTXMode.JT9, silence, { frequency: 1500, partition: [] }),
+        WSJTXError,
+      );
+      await assert.rejects(
+        () => lib.decode(WSJTXMode.FT8, silence, { frequency: 1500, partition: [], apTargets: [{ call: 'K1ABC' }] }),
+        /partition and apTargets cannot be combined/,
+      );
+    });
+
+    it('`diversity` combines receivers so a signal too weak for any one of them decodes', async () => {
+      // Independent noise at each receiver and the signal at about -26 dB in
+      // 2.5 kHz (different levels and phases); combined, about -18.5 dB
+      const gains = [0.0026, -0.0026, 0.002, 0.003, -0.0022, 0.0028];
+      const receivers = await Promise.all(gains.map((amplitude, k) =>
+        modeSlot(lib, WSJTXMode.FT8, [{ ...CQ_K1ABC, amplitude }], { noise: 0.2, seed: 100 + k })));
+      const opts = { frequency: 1500, threads: 1 };
+      const heard = (r: DecodeResult) => r.messages.some((m) => m.text.includes('K1ABC'));
+      assert.ok(!heard(await lib.decode(WSJTXMode.FT8, receivers[0], opts)), 'one receiver alone decoded it');
+      const combined = await lib.decode(WSJTXMode.FT8, receivers[0], { ...opts, diversity: receivers.slice(1) });
+      assert.strictEqual(combined.success, true);
+      assert.ok(heard(combined), `combined decode ${JSON.stringify(combined.messages.map((m) => m.text))}`);
+    });
+
+    it('rejects `diversity` channels of a different length', async () => {
+      await assert.rejects(
+        () => lib.decode(WSJTXMode.FT8, silence, { frequency: 1500, diversity: [silence.subarray(1)] }),
+        WSJTXError,
+      );
+    });
+
+    it('decode accepts interleaved PCM and matches the Float32 decode of that channel', async () => {
+      const encoded = await lib.encode(WSJTXMode.FT8, 'CQ TEST K1ABC FN20', 1500);
+      // Stereo f64 with the signal on the right channel only
+      const frames = 15 * ENCODE_SAMPLE_RATE;
+      const mono = new Float32Array(frames);
+      mono.set(encoded.audioData.subarray(0, frames - ENCODE_SAMPLE_RATE / 2), ENCODE_SAMPLE_RATE / 2);
+      const stereo = new Float64Array(frames * 2);
+      for (let i = 0; i < frames; i++) stereo[2 * i + 1] = mono[i];
+      const opts = { frequency: 1500, threads: 1 };
+      const fromPcm = await lib.decode(WSJTXMode.FT8, { data: stereo, format: 'f64', channels: 2, channel: 1 }, opts);
+      const fromFloat = await lib.decode(WSJTXMode.FT8, mono, opts);
+      assert.deepStrictEqual(fromPcm.messages.map((m) => m.text), fromFloat.messages.map((m) => m.text));
+    });
+
+    it('rejects PCM with an unknown format or a channel out of range', async () => {
+      const data = new Uint8Array(1024);
+      await assert.rejects(() => lib.decode(WSJTXMode.FT8, { data, format: 's12' as never }, { frequency: 1500 }), WSJTXError);
+      await assert.rejects(
+        () => lib.decode(WSJTXMode.FT8, { data, format: 's16', channels: 2, channel: 2 }, { frequency: 1500 }),
+        WSJTXError,
+      );
+    });
+
+    it('decodeChannels decodes each channel of an interleaved buffer with its own options', async () => {
+      // Three receivers, the signal on the middle one only, noise on all
+      const mono = await ft8Slot(lib);
+      const quiet = [await ft8Slot(lib, [], 0.1, 2), await ft8Slot(lib, [], 0.1, 3)];
+      const frames = mono.length;
+      const interleaved = new Int16Array(frames * 3);
+      for (let i = 0; i < frames; i++) {
+        interleaved[3 * i] = Math.round(quiet[0][i] * 32767);
+        interleaved[3 * i + 1] = Math.round(mono[i] * 32767);
+        interleaved[3 * i + 2] = Math.round(quiet[1][i] * 32767);
+      }
+      const results = await lib.decodeChannels(WSJTXMode.FT8, interleaved, 3, [
+        { frequency: 1500, threads: 1 },
+        { frequency: 1500, threads: 1, homeGrid: 'JO22' },
+        { frequency: 1500, threads: 1, columnar: true },
+      ]);
+      assert.strictEqual(results.length, 3);
+      assert.ok(results.every((r) => r.success));
+      assert.strictEqual(results[0].messages.length, 0);
+      assert.ok(results[1].messages.some((m) => m.text.trim() === CQ_K1ABC.message), 'signal channel decodes');
+      assert.ok(results[2].columns);
+      const single = await lib.decode(WSJTXMode.FT8, { data: interleaved, format: 's16', channels: 3, channel: 1 },
+        { frequency: 1500, threads: 1 });
+      assert.deepStrictEqual(results[1].messages.map((m) => m.text), single.messages.map((m) => m.text));
+    });
+
+    it('overlapping decode and decodeChannels on one instance keep their own results', async () => {
+      const signal = await ft8Slot(lib);
+      const noise = await ft8Slot(lib, [], 0.1, 2);
+      const opts = { frequency: 1500, threads: 1 };
+      const [a, [b], c] = await Promise.all([
+        lib.decode(WSJTXMode.FT8, noise, opts),
+        lib.decodeChannels(WSJTXMode.FT8, signal, 1, [opts]),
+        lib.decode(WSJTXMode.FT8, noise, opts),
+      ]);
+      assert.strictEqual(a.messages.length, 0);
+      assert.ok(b.messages.some((m) => m.text.trim() === CQ_K1ABC.message));
+      assert.strictEqual(c.messages.length, 0);
+    });
+
+    it('rejects decodeChannels without one options entry per channel', async () => {
+      const interleaved = new Float32Array(silence.length * 2);
+      await assert.rejects(() => lib.decodeChannels(WSJTXMode.FT8, interleaved, 2, [{ frequency: 1500 }]), WSJTXError);
+      await assert.rejects(() => lib.decodeChannels(WSJTXMode.FT8, interleaved, 17, []), WSJTXError);
+      await assert.rejects(
+        () => lib.decodeChannels(WSJTXMode.FT8, { data: interleaved, format: 'f32', channels: 4 }, 2,
+          [{ frequency: 1500 }, { frequency: 1500 }]),
+        WSJTXError,
+      );
+    });
+
+    it('`offset`/`length`/`slotStartOffset` cut and pad a slot out of a longer buffer', async () => {
+      // Noisy ring buffer whose slot starts 3 s in, signal 0.5 s into the slot
+      const rate = ENCODE_SAMPLE_RATE;
+      const ring = new Float32Array(20 * rate);
+      const next = noiseSource(7, 0.1);
+      for (let i = 0; i < ring.length; i++) ring[i] = next();
+      ring.set(await ft8Slot(lib), 3 * rate);
+      const opts = { frequency: 1500, threads: 1 };
+      const expected = await lib.decode(WSJTXMode.FT8, ring.slice(3 * rate, 18 * rate), opts);
+      assert.ok(expected.messages.some((m) => m.text.trim() === CQ_K1ABC.message), 'the full slot decodes');
+      // Capture that began 0.25 s late and stopped 1 s early
+      const r = await lib.decode(WSJTXMode.FT8, ring, {
+        ...opts, offset: 3.25 * rate, length: 13.75 * rate, slotStartOffset: 0.25,
+      });
+      assert.ok(r.messages.length > 0);
+      assert.deepStrictEqual(r.messages.map((m) => m.text), expected.messages.map((m) => m.text));
+      const residual = await lib.decode(WSJTXMode.FT8, ring, {
+        ...opts, offset: 3 * rate, slotStartOffset: 0, residual: true,
+      });
+      assert.strictEqual(residual.residual?.length, 15 * rate);
+    });
+
+    it('rejects an `offset`/`length` outside the buffer or an out-of-slot `slotStartOffset`', async () => {
+      await assert.rejects(() => lib.decode(WSJTXMode.FT8, silence, { frequency: 1500, offset: silence.length + 1 }), WSJTXError);
+      await assert.rejects(() => lib.decode(WSJTXMode.FT8, silence, { frequency: 1500, offset: 10, length: silence.length }), WSJTXError);
+      await assert.rejects(() => lib.decode(WSJTXMode.FT8, silence, { frequency: 1500, length: 0 }), WSJTXError);
+      await assert.rejects(() => lib.decode(WSJTXMode.FT8, silence, { frequency: 1500, slotStartOffset: 15 }), WSJTXError);
+    });
+
+    it('rejects more than 16 `apTargets`', async () => {
+      const apTargets = Array.from({ length: 17 }, (_, i) => ({ call: `K${i}ABC` }));
+      await assert.rejects(() => lib.decode(WSJTXMode.FT8, silence, { frequency: 1500, apTargets }), WSJTXError);
+    });
+
     it('decode with very narrow scan window still succeeds (does not crash)', async () => {
       const r = await lib.decode(WSJTXMode.FT8, silence, {
         frequency: 1500,
@@ -383,6 +811,648 @@ describe('WSJTX library — regression', () => {
         );
       }
     });
+
+    it('selects and converts one channel of interleaved PCM', async () => {
+      // Stereo s24: left = full-scale positive, -0.5; right = 1 LSB, -1 LSB
+      const data = Buffer.from([0xff, 0xff, 0x7f, 0x01, 0x00, 0x00, 0x00, 0x00, 0xc0, 0xff, 0xff, 0xff]);
+      const left = (await lib.convertAudioFormat({ data, format: 's24', channels: 2 }, 'float32')) as Float32Array;
+      assert.strictEqual(left.length, 2);
+      assert.ok(Math.abs(left[0] - 1) < 1e-6);
+      assert.strictEqual(left[1], -0.5);
+      const right = (await lib.convertAudioFormat({ data, format: 's24', channels: 2, channel: 1 }, 'float32')) as Float32Array;
+      assert.deepStrictEqual(Array.from(right, (v) => Math.round(v * 8388608)), [1, -1]);
+      const u8 = (await lib.convertAudioFormat({ data: new Uint8Array([0, 128, 192]), format: 'u8' }, 'float32')) as Float32Array;
+      assert.deepStrictEqual(Array.from(u8), [-1, 0, 0.5]);
+    });
+  });
+
+  // ---- Grid geometry ----
+
+  describe('gridDistances', () => {
+    it('computes distance and bearing for a batch of grids', () => {
+      const r = lib.gridDistances('FN20', ['FN21', 'JO01', 'EM10']);
+      assert.ok(r.distanceKm instanceof Float64Array);
+      assert.strictEqual(r.distanceKm.length, 3);
+      assert.ok(Math.abs(r.distanceKm[0] - 111.2) < 0.5, `FN21: ${r.distanceKm[0]}`);
+      assert.ok(Math.abs(r.bearing[0]) < 1e-6);
+      assert.ok(Math.abs(r.distanceKm[1] - 5724) < 5, `JO01: ${r.distanceKm[1]}`);
+      assert.ok(Math.abs(r.bearing[1] - 50.5) < 0.5, `JO01 bearing: ${r.bearing[1]}`);
+      assert.ok(Math.abs(r.bearing[2] - 247.6) < 0.5, `EM10 bearing: ${r.bearing[2]}`);
+    });
+
+    it('accepts 6-character and lower-case locators', () => {
+      const r = lib.gridDistances('fn20xr', ['FN20XR', 'fn20']);
+      assert.ok(r.distanceKm[0] < 1e-6);
+      assert.ok(r.distanceKm[1] > 0 && r.distanceKm[1] < 150);
+    });
+
+    it('yields NaN for entries that are not locators', () => {
+      const r = lib.gridDistances('FN20', ['ZZ99', 'K1ABC', '']);
+      for (let i = 0; i < 3; i++) {
+        assert.ok(Number.isNaN(r.distanceKm[i]));
+        assert.ok(Number.isNaN(r.bearing[i]));
+      }
+    });
+
+    it('treats RR73 as the locator it is outside message text', () => {
+      const r = lib.gridDistances('RR73', ['RR73', 'RR72']);
+      assert.ok(r.distanceKm[0] < 1e-6);
+      assert.ok(r.distanceKm[1] > 0 && r.distanceKm[1] < 150);
+      const qso = new QsoSequencer(WSJTXMode.FT8, { myCall: 'K1ABC', myGrid: 'RR73' });
+      qso.call('JA1XX', -10, 'RR73');
+      assert.strictEqual(qso.status().dxGrid, 'RR73');
+    });
+
+    it('rejects an invalid home grid', async () => {
+      assert.throws(() => lib.gridDistances('ZZ99', ['FN20']), WSJTXError);
+      await assert.rejects(
+        () => lib.decode(WSJTXMode.FT8, new Float32Array(1000), { frequency: 1500, homeGrid: 'nope' }),
+        WSJTXError,
+      );
+    });
+  });
+
+  // ---- Cross-slot history ----
+
+  describe('MessageHistory', () => {
+    const msg = (text: string, deltaFrequency: number): WSJTXMessage => ({
+      text, deltaFrequency, snr: -10, deltaTime: 0.1, timestamp: 0, sync: 10,
+    });
+
+    it('marks first sighting as new and later ones as repeats', () => {
+      const h = new MessageHistory({ capacity: 16, frequencyTolerance: 10 });
+      const [a] = h.observe([msg('CQ K1ABC FN20', 1500)], 100);
+      assert.strictEqual(a.isNew, true);
+      assert.strictEqual(a.repeatCount, 1);
+      const [b] = h.observe([msg('cq  k1abc fn20', 1504)], 101);
+      assert.strictEqual(b.isNew, false);
+      assert.strictEqual(b.repeatCount, 2);
+      assert.strictEqual(b.firstSeenSlot, 100);
+      assert.strictEqual(b.lastSeenSlot, 100);
+      const [c] = h.observe([msg('CQ K1ABC FN20', 1500)], 102);
+      assert.strictEqual(c.lastSeenSlot, 101);
+    });
+
+    it('treats the same text on a distant frequency as new', () => {
+      const h = new MessageHistory({ frequencyTolerance: 10 });
+      h.observe([msg('CQ K1ABC FN20', 1000)], 1);
+      const [r] = h.observe([msg('CQ K1ABC FN20', 2000)], 2);
+      assert.strictEqual(r.isNew, true);
+    });
+
+    it('evicts the least recently seen entry at capacity', () => {
+      const h = new MessageHistory({ capacity: 2 });
+      h.observe([msg('A', 100), msg('B', 200)], 1);
+      h.observe([msg('A', 100)], 2);
+      h.observe([msg('C', 300)], 3);
+      assert.strictEqual(h.size, 2);
+      assert.strictEqual(h.observe([msg('B', 200)], 4)[0].isNew, true);
+      h.clear();
+      assert.strictEqual(h.size, 0);
+    });
+
+    it('decode accepts a history and slot', async () => {
+      const history = new MessageHistory();
+      const r = await lib.decode(WSJTXMode.FT8, new Float32Array(ENCODE_SAMPLE_RATE * 13), {
+        frequency: 1500, threads: 1, history, slot: 42,
+      });
+      assert.strictEqual(r.success, true);
+      for (const m of r.messages) assert.strictEqual(typeof m.isNew, 'boolean');
+    });
+
+    it('decode rejects a history backed by another native class', async () => {
+      const history = new MessageHistory();
+      Object.defineProperty(history, 'native', { value: new ClockEstimator().native });
+      await assert.rejects(
+        lib.decode(WSJTXMode.FT8, new Float32Array(ENCODE_SAMPLE_RATE * 13), { frequency: 1500, history }),
+        /history must be a MessageHistory/,
+      );
+    });
+
+    it('reports the FT8 slot period', () => {
+      assert.strictEqual(lib.getSlotPeriod(WSJTXMode.FT8), 15);
+      assert.strictEqual(lib.currentSlot(WSJTXMode.FT8, 30_000), 2);
+    });
+  });
+
+  // ---- Band activity ----
+
+  describe('ActivityAggregator', () => {
+    const msg = (text: string, snr: number, deltaFrequency: number): WSJTXMessage => ({
+      text, snr, deltaFrequency, deltaTime: 0, timestamp: 0, sync: 10,
+    });
+    const T0 = 1_700_000_000_000;
+
+    it('counts decodes, distinct calls and histogram bins per band/mode', () => {
+      const agg = new ActivityAggregator({ bucketSeconds: 60, buckets: 10 });
+      agg.add('20m', WSJTXMode.FT8, [
+        msg('CQ K1ABC FN20', -10, 1000),
+        msg('K1ABC W9XYZ -05', -20, 1010),
+        msg('CQ K1ABC FN20', -10, 1000),
+      ], T0);
+      agg.add('40m', WSJTXMode.FT8, [msg('CQ JA1XYZ PM95', 0, 2000)], T0);
+
+      const r20 = agg.query({ band: '20m', fromMs: T0 - 60_000, toMs: T0 });
+      assert.strictEqual(r20.decodes, 3);
+      assert.strictEqual(r20.uniqueCalls, 2);
+      const bin = (-10 - ACTIVITY_BINS.snrMin) / ACTIVITY_BINS.snrStep;
+      assert.strictEqual(r20.snrHistogram[bin], 2);
+      assert.strictEqual(r20.audioOccupancy[1000 / ACTIVITY_BINS.audioStep], 2);
+
+      const all = agg.query({ fromMs: T0 - 60_000, toMs: T0 });
+      assert.strictEqual(all.decodes, 4);
+      assert.strictEqual(all.uniqueCalls, 3);
+    });
+
+    it('returns per-bucket rows and drops buckets outside the ring', () => {
+      const agg = new ActivityAggregator({ bucketSeconds: 60, buckets: 3 });
+      for (let i = 0; i < 5; i++) {
+        agg.add('20m', WSJTXMode.FT4, [msg(`CQ K${i}AB FN20`, -5, 500)], T0 + i * 60_000);
+      }
+      const r = agg.query({ mode: WSJTXMode.FT4, fromMs: T0, toMs: T0 + 10 * 60_000, buckets: true });
+      assert.strictEqual(r.decodes, 3);
+      assert.strictEqual(r.buckets?.length, 3);
+      assert.strictEqual(agg.query({ mode: WSJTXMode.FT8, toMs: T0 + 10 * 60_000 }).decodes, 0);
+    });
+
+    it('decode accepts an aggregator and band', async () => {
+      const activity = new ActivityAggregator();
+      const r = await lib.decode(WSJTXMode.FT8, new Float32Array(ENCODE_SAMPLE_RATE * 13), {
+        frequency: 1500, threads: 1, activity, band: '20m',
+      });
+      assert.strictEqual(r.success, true);
+      assert.strictEqual(activity.query({ band: '20m' }).decodes, r.messages.length);
+    });
+  });
+
+  describe('ClockEstimator', () => {
+    const msg = (deltaTime: number): WSJTXMessage => ({
+      text: 'CQ K1ABC FN20', snr: -10, deltaFrequency: 1000, deltaTime, timestamp: 0, sync: 10,
+    });
+    const T0 = 1_700_000_000_000;
+
+    it('recovers the rate error from DT drifting slot after slot', () => {
+      const clock = new ClockEstimator();
+      assert.strictEqual(clock.estimate(), null);
+      // A card 200 ppm fast: each 15 s slot starts 3 ms later; one station off by a second
+      for (let k = 0; k < 40; k++) {
+        const drift = 0.1 + k * 15 * 200e-6;
+        clock.observe([msg(drift - 0.02), msg(drift), msg(drift + 0.03), msg(drift + 1)], T0 + k * 15_000);
+      }
+      const est = clock.estimate();
+      assert.ok(est);
+      assert.ok(Math.abs(est.ppm - 200) < 20, `ppm ${est.ppm}`);
+      assert.ok(Math.abs(est.dtOffset - (0.1 + 39 * 15 * 200e-6)) < 0.05);
+      assert.strictEqual(est.slots, 40);
+      clock.clear();
+      assert.strictEqual(clock.estimate(), null);
+    });
+
+    it('rejects a window shorter than a minute', () => {
+      assert.throws(() => new ClockEstimator({ windowSeconds: 30 }), WSJTXError);
+    });
+
+    it('decode accepts a clock and an explicit sampleRatePpm', async () => {
+      const clock = new ClockEstimator();
+      const audio = new Float32Array(ENCODE_SAMPLE_RATE * 13);
+      const r = await lib.decode(WSJTXMode.FT8, audio, { frequency: 1500, threads: 1, clock, sampleRatePpm: -150 });
+      assert.strictEqual(r.success, true);
+      await assert.rejects(() => lib.decode(WSJTXMode.FT8, audio, { frequency: 1500, sampleRatePpm: NaN }), WSJTXError);
+    });
+
+    it('sampleRatePpm resamples a tone back to its nominal frequency', async () => {
+      // A card running 1000 ppm fast records a 1500 Hz tone at 1500 / 1.001 Hz
+      const ppm = 1000;
+      const tone = 1500;
+      const audio = new Float32Array(ENCODE_SAMPLE_RATE * 15);
+      const recorded = tone / (1 + ppm * 1e-6);
+      for (let i = 0; i < audio.length; i++) {
+        audio[i] = 0.5 * Math.sin(2 * Math.PI * recorded * i / ENCODE_SAMPLE_RATE);
+      }
+      const r = await lib.decode(WSJTXMode.FT8, audio, { frequency: 1500, threads: 1, sampleRatePpm: ppm, residual: true });
+      assert.strictEqual(r.success, true);
+      assert.strictEqual(r.messages.length, 0);
+      // Nothing decodes, so the residual is the resampled slot: the input's
+      // length, its last samples past the shortened audio left at zero
+      assert.ok(r.residual instanceof Float32Array);
+      const out = r.residual;
+      assert.strictEqual(out.length, audio.length);
+      const count = Math.floor(audio.length * (1 / (1 + ppm * 1e-6)));
+      assert.ok(out[count - 1] !== 0 || out[count - 2] !== 0);
+      assert.ok(out.subarray(count).every((s) => s === 0), 'samples past the resampled length');
+
+      // Rising zero crossings, interpolated, away from the filter's edges
+      const crossings: number[] = [];
+      for (let i = ENCODE_SAMPLE_RATE; i < count - ENCODE_SAMPLE_RATE; i++) {
+        if (out[i - 1] < 0 && out[i] >= 0) crossings.push(i - 1 + out[i - 1] / (out[i - 1] - out[i]));
+      }
+      const measured = (crossings.length - 1) * ENCODE_SAMPLE_RATE /
+        (crossings[crossings.length - 1] - crossings[0]);
+      assert.ok(Math.abs(measured - tone) < 0.05, `resampled tone at ${measured} Hz, recorded at ${recorded} Hz`);
+    });
+  });
+
+  // ---- QSO sequencing ----
+
+  describe('QsoSequencer', () => {
+    const heard = (text: string, snr = -10): WSJTXMessage => ({
+      text, snr, deltaFrequency: 1200, deltaTime: 0.1, timestamp: 0, sync: 10,
+    });
+
+    it('runs a CQ QSO through the standard sequence and back to CQ', () => {
+      const qso = new QsoSequencer(WSJTXMode.FT8, { myCall: 'K1ABC', myGrid: 'FN42ab' });
+      qso.startCq();
+      assert.strictEqual(qso.status().txMessage, 'CQ K1ABC FN42');
+      assert.strictEqual(qso.observe([]), false);
+      // The strongest of two callers is answered with its SNR as the report
+      assert.strictEqual(qso.observe([
+        heard('K1ABC W9XYZ EN37', -12), heard('K1ABC N0AAA EM10', -3), heard('CQ JA1XX PM95', 0),
+      ]), true);
+      let s = qso.status();
+      assert.strictEqual(s.state, 'report');
+      assert.strictEqual(s.dxCall, 'N0AAA');
+      assert.strictEqual(s.dxGrid, 'EM10');
+      assert.strictEqual(s.txMessage, 'N0AAA K1ABC -03');
+      assert.strictEqual(s.reportReceived, null);
+      assert.strictEqual(qso.observe([]), false);
+      assert.strictEqual(qso.status().repeats, 1);
+      qso.observe([heard('K1ABC N0AAA R-07')]);
+      s = qso.status();
+      assert.strictEqual(s.state, 'roger');
+      assert.strictEqual(s.txMessage, 'N0AAA K1ABC RR73');
+      assert.strictEqual(s.reportReceived, -7);
+      assert.strictEqual(s.logged, true);
+      qso.observe([]);
+      assert.strictEqual(qso.status().state, 'cq');
+    });
+
+    it('answers a station and gives up after maxRepeats silent slots', () => {
+      const qso = new QsoSequencer(WSJTXMode.FT4, { myCall: 'K1ABC', myGrid: 'FN42', maxRepeats: 2 });
+      qso.call('JA1XX', -15, 'PM95');
+      assert.strictEqual(qso.status().txMessage, 'JA1XX K1ABC FN42');
+      qso.observe([heard('K1ABC JA1XX -09')]);
+      assert.strictEqual(qso.status().txMessage, 'JA1XX K1ABC R-15');
+      qso.observe([heard('K1ABC JA1XX RR73')]);
+      assert.strictEqual(qso.status().txMessage, 'JA1XX K1ABC 73');
+      qso.observe([]);
+      assert.strictEqual(qso.status().state, 'done');
+
+      qso.call('G4XYZ', 0);
+      qso.observe([]);
+      assert.strictEqual(qso.status().state, 'calling');
+      qso.observe([]);
+      assert.strictEqual(qso.status().state, 'idle');
+      assert.strictEqual(qso.status().txMessage, '');
+    });
+
+    it('serves TX audio pre-encoded after speculate', async () => {
+      const qso = new QsoSequencer(WSJTXMode.FT8, { myCall: 'K1ABC', myGrid: 'FN42' });
+      qso.call('JA1XX', -15);
+      assert.strictEqual(await qso.speculate(), 3);   // Tx1, then R-report or 73
+      const audio = await qso.txAudio();
+      assert.ok(audio.length >= 600_000 && audio.length <= 620_000, `samples ${audio.length}`);
+      qso.observe([heard('K1ABC JA1XX -09')]);
+      assert.ok((await qso.txAudio()).length > 0);
+      assert.deepStrictEqual([qso.status().cacheHits, qso.status().cacheMisses], [2, 0]);
+      qso.stop();
+      assert.strictEqual((await qso.txAudio()).length, 0);
+    });
+
+    it('advances from decode and returns the next transmission', async () => {
+      const reply = await ft8Slot(lib, [{ message: 'K1ABC N0AAA EM10', frequency: 1200 }]);
+      const qso = new QsoSequencer(WSJTXMode.FT8, { myCall: 'K1ABC', myGrid: 'FN42' });
+      qso.startCq();
+      const r = await lib.decode(WSJTXMode.FT8, reply, { frequency: 1200, threads: 1, qso });
+      assert.ok(r.qso);
+      assert.strictEqual(r.qso.state, 'report');
+      assert.match(r.qso.txMessage, /^N0AAA K1ABC [+-]\d\d$/);
+      assert.ok(r.qso.txAudio.length > 0);
+      assert.strictEqual(r.qso.speculateError, null);
+      await qso.speculate();
+      assert.strictEqual(qso.status().speculateError, null);
+      await assert.rejects(
+        () => lib.decode(WSJTXMode.FT4, new Float32Array(ENCODE_SAMPLE_RATE * 7), { frequency: 1500, qso }),
+        WSJTXError,
+      );
+    });
+
+    it('rejects other modes and bad calls', () => {
+      assert.throws(() => new QsoSequencer(WSJTXMode.JT65, { myCall: 'K1ABC', myGrid: 'FN42' }), WSJTXError);
+      assert.throws(() => new QsoSequencer(WSJTXMode.FT8, { myCall: 'K1 ABC', myGrid: 'FN42' }), WSJTXError);
+      const qso = new QsoSequencer(WSJTXMode.FT8, { myCall: 'K1ABC', myGrid: 'FN42' });
+      assert.throws(() => qso.call('??', -10), WSJTXError);
+      assert.throws(() => qso.call('JA1XX', -10, 'ZZ99'), WSJTXError);
+    });
+  });
+
+  // ---- WSJT-X UDP protocol ----
+
+  describe('UdpEmitter', () => {
+    /** Bind a loopback listener and collect `count` datagrams sent by `send(port)`. */
+    async function receive(count: number, send: (port: number) => void): Promise<Buffer[]> {
+      const sock = dgram.createSocket('udp4');
+      await new Promise<void>((resolve) => sock.bind(0, '127.0.0.1', resolve));
+      const got: Buffer[] = [];
+      const done = new Promise<Buffer[]>((resolve, reject) => {
+        const timer = setTimeout(() => reject(new Error(`received ${got.length}/${count} datagrams`)), 2000);
+        sock.on('message', (buf) => {
+          got.push(buf);
+          if (got.length === count) { clearTimeout(timer); resolve(got); }
+        });
+      });
+      try {
+        send(sock.address().port);
+        return await done;
+      } finally {
+        sock.close();
+      }
+    }
+
+    /** Parse the common header: magic, schema, type, id (QDataStream utf8). */
+    function header(buf: Buffer): { magic: number; schema: number; type: number; id: string; end: number } {
+      const idLen = buf.readUInt32BE(12);
+      return {
+        magic: buf.readUInt32BE(0),
+        schema: buf.readUInt32BE(4),
+        type: buf.readUInt32BE(8),
+        id: buf.toString('utf8', 16, 16 + idLen),
+        end: 16 + idLen,
+      };
+    }
+
+    it('serializes Decode messages in the WSJT-X wire format', async () => {
+      const [buf] = await receive(1, (port) => {
+        const udp = new UdpEmitter({ port, id: 'TEST' });
+        const sent = udp.sendDecodes(WSJTXMode.FT8, [{
+          text: 'CQ K1ABC FN20', snr: -7, deltaTime: 0.2, deltaFrequency: 1234,
+          timestamp: 12 * 3600 + 30 * 60 + 15, sync: 10, isNew: false,
+        }]);
+        assert.strictEqual(sent, 1);
+      });
+      const h = header(buf);
+      assert.strictEqual(h.magic, 0xadbccbda);
+      assert.strictEqual(h.schema, 2);
+      assert.strictEqual(h.type, 2);
+      assert.strictEqual(h.id, 'TEST');
+      let o = h.end;
+      assert.strictEqual(buf.readUInt8(o), 0); o += 1;
+      assert.strictEqual(buf.readUInt32BE(o), (12 * 3600 + 30 * 60 + 15) * 1000); o += 4;
+      assert.strictEqual(buf.readInt32BE(o), -7); o += 4;
+      assert.ok(Math.abs(buf.readDoubleBE(o) - 0.2) < 1e-6); o += 8;
+      assert.strictEqual(buf.readUInt32BE(o), 1234); o += 4;
+      const modeLen = buf.readUInt32BE(o); o += 4;
+      assert.strictEqual(buf.toString('utf8', o, o + modeLen), '~'); o += modeLen;
+      const textLen = buf.readUInt32BE(o); o += 4;
+      assert.strictEqual(buf.toString('utf8', o, o + textLen), 'CQ K1ABC FN20');
+    });
+
+    it('sends Heartbeat and Status messages', async () => {
+      const bufs = await receive(2, (port) => {
+        const udp = new UdpEmitter({ port });
+        udp.sendHeartbeat('3.0.0', 'abc');
+        udp.sendStatus({ dialFrequency: 14_074_000, mode: 'FT8', deCall: 'K1ABC', deGrid: 'FN20', trPeriod: 15 });
+      });
+      assert.deepStrictEqual(bufs.map((b) => header(b).type).sort(), [0, 1]);
+      const status = bufs.find((b) => header(b).type === 1)!;
+      const o = header(status).end;
+      assert.strictEqual(Number(status.readBigUInt64BE(o)), 14_074_000);
+    });
+
+    it('decode emits one Decode datagram per result', async () => {
+      const sock = dgram.createSocket('udp4');
+      await new Promise<void>((resolve) => sock.bind(0, '127.0.0.1', resolve));
+      const got: Buffer[] = [];
+      sock.on('message', (buf) => got.push(buf));
+      try {
+        const udp = new UdpEmitter({ port: sock.address().port });
+        const { audioData } = await lib.encode(WSJTXMode.FT8, 'CQ K1ABC FN20', 1500, 1);
+        const r = await lib.decode(WSJTXMode.FT8, audioData, { frequency: 1500, threads: 1, udp });
+        await new Promise((resolve) => setTimeout(resolve, 200));
+        assert.strictEqual(got.length, r.messages.length);
+        for (const b of got) assert.strictEqual(header(b).type, 2);
+      } finally {
+        sock.close();
+      }
+    });
+
+    it('rejects invalid construction options', () => {
+      assert.throws(() => new UdpEmitter({ port: 0 }), WSJTXError);
+      assert.throws(() => new UdpEmitter({ multicastTtl: 300 }), WSJTXError);
+    });
+  });
+
+  // ---- Tracing ----
+
+  describe('trace', () => {
+    it('records decode pipeline spans across threads as Chrome trace JSON', async () => {
+      startTrace(1024);
+      try {
+        await lib.decode(WSJTXMode.FT8, new Float32Array(ENCODE_SAMPLE_RATE * 13), { frequency: 1500, threads: 1 });
+      } finally {
+        stopTrace();
+      }
+      const trace = JSON.parse(dumpTrace()) as {
+        traceEvents: { name: string; ph: string; ts: number; dur: number; tid: number; args?: { job: number } }[];
+      };
+      const byName = new Map(trace.traceEvents.map((e) => [e.name, e]));
+      for (const name of ['js_decode', 'queue_wait', 'execute_decode', 'copy_input', 'apply_options', 'core_decode', 'drain', 'on_ok_decode']) {
+        assert.ok(byName.has(name), `missing span ${name}`);
+        assert.strictEqual(byName.get(name)!.ph, 'X');
+      }
+      const job = byName.get('js_decode')!.args?.job;
+      assert.strictEqual(byName.get('core_decode')!.args?.job, job);
+      assert.notStrictEqual(byName.get('core_decode')!.tid, byName.get('js_decode')!.tid);
+    });
+
+    it('records nothing while stopped', async () => {
+      startTrace(16);
+      stopTrace();
+      await lib.decode(WSJTXMode.FT8, new Float32Array(ENCODE_SAMPLE_RATE * 13), { frequency: 1500, threads: 1 });
+      assert.strictEqual(JSON.parse(dumpTrace()).traceEvents.length, 0);
+    });
+  });
+
+  // ---- Metrics ----
+
+  describe('metrics', () => {
+    it('exports per-receiver decode latency summaries in Prometheus format', async () => {
+      resetMetrics();
+      const rx = new WSJTXLib({ receiver: 'rx-test' });
+      for (let i = 0; i < 3; i++) {
+        await rx.decode(WSJTXMode.FT8, new Float32Array(ENCODE_SAMPLE_RATE * 13), { frequency: 1500, threads: 1 });
+      }
+      const text = getMetrics();
+      const labels = 'receiver="rx-test",op="decode",mode="FT8"';
+      assert.ok(text.includes('# TYPE wsjtx_operation_duration_seconds summary'));
+      assert.match(text, new RegExp(`wsjtx_operation_duration_seconds\\{${labels},quantile="0.99"\\} [0-9.]+`));
+      assert.ok(text.includes(`wsjtx_operation_duration_seconds_count{${labels}} 3`));
+      assert.ok(text.includes(`wsjtx_queue_wait_seconds_count{${labels}} 3`));
+      assert.ok(text.includes('wsjtx_jobs_running{receiver="rx-test"} 0'));
+      assert.ok(text.includes('wsjtx_jobs_queued{receiver="rx-test"} 0'));
+
+      const p99 = rx.latencyQuantile('decode', WSJTXMode.FT8, 0.99);
+      assert.ok(p99 > 0 && p99 >= rx.latencyQuantile('decode', WSJTXMode.FT8, 0.99, true));
+      assert.ok(Number.isNaN(rx.latencyQuantile('encode', WSJTXMode.FT4, 0.5)));
+    });
+  });
+
+  describe('autotune', () => {
+    it('picks and persists a thread setting that decode then defaults to', async () => {
+      freshOutputDir();
+      const file = path.join(OUTPUT_DIR, 'tuning.json');
+      const results = await autotune([WSJTXMode.FT4], { threadCounts: [1, 2], concurrency: [1], repeats: 1, file });
+      assert.strictEqual(results.length, 1);
+      const [r] = results;
+      assert.strictEqual(r.mode, WSJTXMode.FT4);
+      assert.ok([1, 2].includes(r.threads));
+      assert.strictEqual(r.concurrency, 1);
+      assert.ok(r.latencyMs > 0 && r.throughput > 0);
+      assert.deepStrictEqual(getTuning(WSJTXMode.FT4), r);
+
+      assert.deepStrictEqual(loadTuning(file), results);
+      fs.unlinkSync(file);
+      const auto = new WSJTXLib();
+      const decoded = await auto.decode(WSJTXMode.FT4, new Float32Array(ENCODE_SAMPLE_RATE * 7), { frequency: 1500 });
+      assert.strictEqual(decoded.success, true);
+    });
+
+    it('rejects WSPR and out-of-range settings', async () => {
+      await assert.rejects(() => autotune([WSJTXMode.WSPR]), WSJTXError);
+      await assert.rejects(() => autotune([WSJTXMode.FT8], { threadCounts: [0] }), WSJTXError);
+      await assert.rejects(() => autotune([WSJTXMode.FT8], { concurrency: [] }), WSJTXError);
+    });
+
+    it('applies nothing from a tuning file with an invalid entry', () => {
+      freshOutputDir();
+      const file = path.join(OUTPUT_DIR, 'tuning.json');
+      const good = { mode: WSJTXMode.FT8, threads: 3, concurrency: 1, latencyMs: 100, throughput: 10 };
+      const before = getTuning(WSJTXMode.FT8);
+      for (const bad of [{ threads: 0 }, { mode: WSJTXMode.WSPR }, { concurrency: 1.5 }]) {
+        const doc = { version: 1, cpus: Math.max(1, os.cpus().length), results: [good, { ...good, ...bad }] };
+        fs.writeFileSync(file, JSON.stringify(doc));
+        assert.throws(() => loadTuning(file), (e: WSJTXError) => e instanceof WSJTXError && e.code === 'INVALID');
+        assert.deepStrictEqual(getTuning(WSJTXMode.FT8), before);
+      }
+      fs.unlinkSync(file);
+    });
+  });
+
+  describe('OpenMP build', () => {
+    const features = buildFeatures();
+
+    it('reports build features', () => {
+      assert.strictEqual(typeof features.openmp, 'boolean');
+      assert.strictEqual(typeof features.usdt, 'boolean');
+      assert.ok(Number.isInteger(features.openmpMaxThreads) && features.openmpMaxThreads >= 1);
+      if (!features.openmp) assert.strictEqual(features.openmpMaxThreads, 1);
+    });
+
+    it('decodes a busy FT8 slot faster with threads: 4 than threads: 1',
+      { skip: !features.openmp || os.cpus().length < 4 ? 'needs an OpenMP build and 4+ CPUs' : false },
+      async () => {
+        // 15 signals spread over the passband keep every decoder pass busy
+        const slot = new Float32Array(ENCODE_SAMPLE_RATE * 15);
+        for (let i = 0; i < 15; i++) {
+          const call = `K${i}ABC`;
+          const tx = await lib.encode(WSJTXMode.FT8, `CQ ${call} FN42`, 300 + i * 170);
+          const start = ENCODE_SAMPLE_RATE / 2;
+          for (let k = 0; k < tx.audioData.length && start + k < slot.length; k++) {
+            slot[start + k] += tx.audioData[k] / 15;
+          }
+        }
+        const best = async (threads: number): Promise<number> => {
+          let min = Infinity;
+          for (let r = 0; r < 3; r++) {
+            const t0 = process.hrtime.bigint();
+            await lib.decode(WSJTXMode.FT8, slot, { frequency: 1500, threads });
+            min = Math.min(min, Number(process.hrtime.bigint() - t0) / 1e6);
+          }
+          return min;
+        };
+        const single = await best(1);
+        const team = await best(4);
+        assert.ok(team < single * 0.85, `threads 4: ${team.toFixed(0)} ms, threads 1: ${single.toFixed(0)} ms`);
+      });
+  });
+
+  // ---- Decode watchdog ----
+
+  describe('watchdog', () => {
+    it('rejects a decode past its limit and recovers on a fresh decoder', async () => {
+      const wd = new WSJTXLib();
+      const audio = new Float32Array(ENCODE_SAMPLE_RATE * 13);
+      assert.strictEqual(getDecodeTimeLimit(WSJTXMode.FT8), 30);
+      const before = watchdogStats();
+      setDecodeTimeLimit(WSJTXMode.FT8, 0.001);
+      try {
+        await assert.rejects(() => wd.decode(WSJTXMode.FT8, audio, { frequency: 1500, threads: 1 }), /watchdog limit/);
+      } finally {
+        setDecodeTimeLimit(WSJTXMode.FT8, 30);
+      }
+      assert.strictEqual(watchdogStats().timeouts, before.timeouts + 1);
+      const r = await wd.decode(WSJTXMode.FT8, audio, { frequency: 1500, threads: 1 });
+      assert.strictEqual(r.success, true);
+      // The abandoned decode still finishes and frees its decoder
+      for (let i = 0; i < 100 && watchdogStats().runaways > 0; i++) await new Promise((res) => setTimeout(res, 50));
+      assert.strictEqual(watchdogStats().runaways, 0);
+    });
+
+    it('rejects invalid limits', () => {
+      assert.throws(() => setDecodeTimeLimit(WSJTXMode.FT8, -1), WSJTXError);
+      assert.throws(() => setDecodeTimeLimit(99 as WSJTXMode, 10), WSJTXError);
+    });
+  });
+
+  describe('quotas', () => {
+    it('charges CPU to the receiver and rejects jobs over a rejecting quota', async () => {
+      const club = new WSJTXLib({ receiver: 'quota-test' });
+      const audio = new Float32Array(ENCODE_SAMPLE_RATE * 13);
+      assert.strictEqual(getAccounting('quota-test'), undefined);
+      await club.decode(WSJTXMode.FT8, audio, { frequency: 1500, threads: 1 });
+      const used = getAccounting('quota-test')!;
+      assert.strictEqual(used.jobs, 1);
+      assert.ok(used.cpuSeconds > 0);
+      assert.strictEqual(used.quota, null);
+
+      setQuota('quota-test', { cpuShare: 1e-9, action: 'reject' });
+      try {
+        await assert.rejects(() => club.decode(WSJTXMode.FT8, audio, { frequency: 1500 }),
+          (e: WSJTXError) => e.code === 'QUOTA_EXCEEDED');
+        const after = getAccounting('quota-test')!;
+        assert.strictEqual(after.rejected, 1);
+        assert.deepStrictEqual(after.quota, { cpuShare: 1e-9, action: 'reject' });
+      } finally {
+        setQuota('quota-test', null);
+      }
+      const r = await club.decode(WSJTXMode.FT8, audio, { frequency: 1500, threads: 1 });
+      assert.strictEqual(r.success, true);
+    });
+
+    it('runs decodes at lower priority over a deprioritizing quota and counts only those', async () => {
+      const club = new WSJTXLib({ receiver: 'deprioritize-test' });
+      const audio = new Float32Array(ENCODE_SAMPLE_RATE * 13);
+      await club.decode(WSJTXMode.FT8, audio, { frequency: 1500, threads: 1 });
+      setQuota('deprioritize-test', { cpuShare: 1e-9, action: 'deprioritize' });
+      try {
+        const r = await club.decode(WSJTXMode.FT8, audio, { frequency: 1500, threads: 1 });
+        assert.strictEqual(r.success, true);
+        await club.encode(WSJTXMode.FT8, 'CQ K1ABC FN42', 1500);
+        const after = getAccounting('deprioritize-test')!;
+        assert.strictEqual(after.jobs, 3);
+        assert.strictEqual(after.rejected, 0);
+        // The encode was admitted over the quota too, but runs where no priority is lowered
+        assert.strictEqual(after.deprioritized, 1);
+        assert.deepStrictEqual(after.quota, { cpuShare: 1e-9, action: 'deprioritize' });
+      } finally {
+        setQuota('deprioritize-test', null);
+      }
+    });
+
+    it('rejects invalid quotas', () => {
+      assert.throws(() => setQuota('x', { cpuShare: 0 }), WSJTXError);
+      assert.throws(() => setQuota('x', { cpuShare: 2 }), WSJTXError);
+      assert.throws(() => setQuota('x', { cpuShare: 0.5, action: 'drop' as 'reject' }), WSJTXError);
+    });
   });
 
   // ---- pullMessages legacy surface ----
@@ -422,8 +1492,8 @@ describe('WSJTX library — regression', () => {
       await assert.rejects(() => lib.encode(WSJTXMode.FT8, '', 1500), WSJTXError);
     });
 
-    it('rejects encoding for decode-only mode (JT65)', async () => {
-      await assert.rejects(() => lib.encode(WSJTXMode.JT65, 'CQ K1ABC FN20', 1500), WSJTXError);
+    it('rejects encoding for decode-only mode (JT65JT9)', async () => {
+      await assert.rejects(() => lib.encode(WSJTXMode.JT65JT9, 'CQ K1ABC FN20', 1500), WSJTXError);
     });
 
     it('WSJTXError preserves message and code', () => {